@@ -0,0 +1,108 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Benchmark.cpp
+ **
+ ** Minimal microbenchmark harness.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <boost/regex.hpp>
+
+#include "Benchmark.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace
+{
+
+struct Registration
+{
+    const char *name_;
+    BenchmarkFunction function_;
+};
+
+std::vector<Registration> &registrations()
+{
+    // function-local to avoid static initialization order issues with the registering translation units
+    static std::vector<Registration> ret;
+    return ret;
+}
+
+} // namespace
+
+bool registerBenchmark(const char *name, BenchmarkFunction function)
+{
+    const Registration registration = {name, function};
+    registrations().push_back(registration);
+    return true;
+}
+
+static State run(const BenchmarkFunction function, const double minSeconds)
+{
+    static const uint64_t ITERATIONS_MAX = 1000000000;
+    uint64_t iterations = 1;
+    while (true)
+    {
+        State state(iterations);
+        function(state);
+        const double seconds = state.getSeconds();
+        if (minSeconds <= seconds || ITERATIONS_MAX <= iterations)
+        {
+            return state;
+        }
+        // aim a bit over minSeconds but never grow more than 10 times at once as short runs are noisy
+        const double multiplier = seconds > 0.0 ? minSeconds * 1.4 / seconds : 10.0;
+        iterations = std::min(ITERATIONS_MAX,
+            std::max(iterations + 1, uint64_t(iterations * std::min(10.0, multiplier))));
+    }
+}
+
+unsigned runBenchmarks(const std::string &filterRegex, const double minSeconds, std::ostream &report)
+{
+    const boost::regex filter(filterRegex);
+    std::vector<Registration> sorted = registrations();
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Registration &left, const Registration &right){return std::string(left.name_) < right.name_;});
+
+    report << boost::format("%-40s %12s %14s %14s %12s\n") % "#benchmark" % "iterations" % "ns/iteration" % "items/s" % "MB/s";
+    unsigned ret = 0;
+    for (const Registration &registration : sorted)
+    {
+        if (!boost::regex_search(registration.name_, filter))
+        {
+            continue;
+        }
+        const State state = run(registration.function_, minSeconds);
+        const double seconds = state.getSeconds();
+        report << boost::format("%-40s %12d %14.1f %14.0f %12.1f\n") %
+            registration.name_ %
+            state.getIterations() %
+            (seconds * 1e9 / state.getIterations()) %
+            (seconds > 0.0 ? state.getItemsProcessed() / seconds : 0.0) %
+            (seconds > 0.0 ? state.getBytesProcessed() / seconds / 1024 / 1024 : 0.0);
+        report.flush();
+        ++ret;
+    }
+    return ret;
+}
+
+} // namespace benchmark
+} // namespace isaac
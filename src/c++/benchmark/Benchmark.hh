@@ -0,0 +1,102 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Benchmark.hh
+ **
+ ** Minimal microbenchmark harness. Benchmarks are plain functions that do their setup, then loop while
+ ** State::keepRunning returns true. Only the loop is timed. The harness repeats the function with increasing
+ ** iteration counts until the loop runs for at least the requested minimum time.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_BENCHMARK_HH
+#define iSAAC_BENCHMARK_BENCHMARK_HH
+
+#include <stdint.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace isaac
+{
+namespace benchmark
+{
+
+class State
+{
+    typedef std::chrono::steady_clock Clock;
+    const uint64_t iterations_;
+    uint64_t remaining_;
+    Clock::time_point begin_;
+    Clock::time_point end_;
+    uint64_t itemsProcessed_;
+    uint64_t bytesProcessed_;
+
+public:
+    explicit State(const uint64_t iterations) :
+        iterations_(iterations), remaining_(iterations), itemsProcessed_(0), bytesProcessed_(0)
+    {
+    }
+
+    bool keepRunning()
+    {
+        if (iterations_ == remaining_)
+        {
+            begin_ = Clock::now();
+        }
+        if (!remaining_)
+        {
+            end_ = Clock::now();
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+    uint64_t getIterations() const {return iterations_;}
+    double getSeconds() const {return std::chrono::duration<double>(end_ - begin_).count();}
+
+    /// items (reads, kmers, alignments...) processed by all the iterations
+    void setItemsProcessed(const uint64_t items) {itemsProcessed_ = items;}
+    uint64_t getItemsProcessed() const {return itemsProcessed_;}
+    /// input bytes processed by all the iterations
+    void setBytesProcessed(const uint64_t bytes) {bytesProcessed_ = bytes;}
+    uint64_t getBytesProcessed() const {return bytesProcessed_;}
+};
+
+typedef void (*BenchmarkFunction)(State &state);
+
+bool registerBenchmark(const char *name, BenchmarkFunction function);
+
+/**
+ * \brief Runs registered benchmarks with names matching the regex and prints one line per benchmark
+ *
+ * \return number of benchmarks run
+ */
+unsigned runBenchmarks(const std::string &filterRegex, const double minSeconds, std::ostream &report);
+
+/**
+ * \brief Prevents the compiler from discarding the computation of the value
+ */
+template <typename T> inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+} // namespace benchmark
+} // namespace isaac
+
+#define ISAAC_BENCHMARK(function) \
+    static const bool function##Registered_ = isaac::benchmark::registerBenchmark(#function, &function)
+
+#endif // #ifndef iSAAC_BENCHMARK_BENCHMARK_HH
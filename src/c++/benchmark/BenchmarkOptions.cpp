@@ -0,0 +1,103 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BenchmarkOptions.cpp
+ **
+ ** Command line options for 'isaac-benchmark' and 'isaac-simulate-reads'
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "BenchmarkOptions.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace bpo = boost::program_options;
+
+BenchmarkOptions::BenchmarkOptions() :
+    filter("."),
+    minSeconds(1.0)
+{
+    namedOptions_.add_options()
+        ("filter,f",            bpo::value<std::string>(&filter)->default_value(filter),
+                                "Regular expression. Only the benchmarks with matching names are run")
+        ("min-time",            bpo::value<double>(&minSeconds)->default_value(minSeconds),
+                                "Minimum time in seconds each benchmark loop has to run for the result to be reported")
+        ;
+}
+
+SimulateReadsOptions::SimulateReadsOptions() :
+    randomContigs(1),
+    randomContigLength(1000000),
+    lane(1),
+    pairs(100000),
+    readLength(150),
+    fragmentLengthMean(350),
+    fragmentLengthStdDev(35),
+    snvRate(0.001),
+    indelRate(0.0001),
+    errorRate(0.002),
+    seed(1)
+{
+    namedOptions_.add_options()
+        ("fasta",               bpo::value<boost::filesystem::path>(&fastaPath),
+                                "Reference fasta file to sample the reads from. If not set, random contigs are generated")
+        ("random-contigs",      bpo::value<unsigned>(&randomContigs)->default_value(randomContigs),
+                                "Number of random contigs to generate when --fasta is not set")
+        ("random-contig-length",bpo::value<unsigned>(&randomContigLength)->default_value(randomContigLength),
+                                "Length of random contigs to generate when --fasta is not set")
+        ("output-directory,o",  bpo::value<boost::filesystem::path>(&outputDirectory),
+                                "Directory where the lane<N>_read1.fastq and lane<N>_read2.fastq are stored")
+        ("lane",                bpo::value<unsigned>(&lane)->default_value(lane),
+                                "Lane number used in the fastq file names")
+        ("pairs,n",             bpo::value<uint64_t>(&pairs)->default_value(pairs),
+                                "Number of read pairs to generate")
+        ("read-length",         bpo::value<unsigned>(&readLength)->default_value(readLength),
+                                "Length of each read of the pair")
+        ("fragment-length",     bpo::value<unsigned>(&fragmentLengthMean)->default_value(fragmentLengthMean),
+                                "Mean fragment length")
+        ("fragment-length-sd",  bpo::value<unsigned>(&fragmentLengthStdDev)->default_value(fragmentLengthStdDev),
+                                "Standard deviation of the fragment length")
+        ("snv-rate",            bpo::value<double>(&snvRate)->default_value(snvRate),
+                                "Probability of a reference base being substituted in the simulated donor genome")
+        ("indel-rate",          bpo::value<double>(&indelRate)->default_value(indelRate),
+                                "Probability of an indel starting at a reference base in the simulated donor genome")
+        ("error-rate",          bpo::value<double>(&errorRate)->default_value(errorRate),
+                                "Probability of a sequencing error at each read base")
+        ("seed",                bpo::value<unsigned>(&seed)->default_value(seed),
+                                "Random generator seed")
+        ;
+}
+
+void SimulateReadsOptions::postProcess(bpo::variables_map &vm)
+{
+    if(vm.count("help"))
+    {
+        return;
+    }
+    if (!vm.count("output-directory"))
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidOptionException("\n   *** The 'output-directory' option is required ***\n"));
+    }
+    if (fragmentLengthMean < readLength)
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidOptionException(
+            (boost::format("\n   *** fragment-length %d must not be less than read-length %d ***\n") %
+                fragmentLengthMean % readLength).str()));
+    }
+}
+
+} // namespace benchmark
+} // namespace isaac
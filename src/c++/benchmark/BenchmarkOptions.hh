@@ -0,0 +1,70 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BenchmarkOptions.hh
+ **
+ ** Command line options for 'isaac-benchmark' and 'isaac-simulate-reads'
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
+#define iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
+
+#include <string>
+#include <boost/filesystem.hpp>
+
+#include "common/Program.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+class BenchmarkOptions : public isaac::common::Options
+{
+public:
+    BenchmarkOptions();
+private:
+    std::string usagePrefix() const {return "isaac-benchmark";}
+public:
+    std::string filter;
+    double minSeconds;
+};
+
+class SimulateReadsOptions : public isaac::common::Options
+{
+public:
+    SimulateReadsOptions();
+private:
+    std::string usagePrefix() const {return "isaac-simulate-reads";}
+    void postProcess(boost::program_options::variables_map &vm);
+public:
+    boost::filesystem::path fastaPath;
+    unsigned randomContigs;
+    unsigned randomContigLength;
+    boost::filesystem::path outputDirectory;
+    unsigned lane;
+    uint64_t pairs;
+    unsigned readLength;
+    unsigned fragmentLengthMean;
+    unsigned fragmentLengthStdDev;
+    double snvRate;
+    double indelRate;
+    double errorRate;
+    unsigned seed;
+};
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_BENCHMARK_OPTIONS_HH
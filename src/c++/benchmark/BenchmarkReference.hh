@@ -0,0 +1,92 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BenchmarkReference.hh
+ **
+ ** Reference and reads shared by the microbenchmarks.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_BENCHMARK_REFERENCE_HH
+#define iSAAC_BENCHMARK_BENCHMARK_REFERENCE_HH
+
+#include <algorithm>
+
+#include "reference/Contig.hh"
+#include "reference/SortedReferenceMetadata.hh"
+
+#include "ReadSimulator.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+/// Fixed random genome so that the results are comparable between runs
+static const unsigned BENCHMARK_SEED = 1;
+static const std::size_t BENCHMARK_CONTIG_LENGTH = 4000000;
+
+/**
+ * \brief ContigList populated from the simulated contigs the same way the reference loader does it
+ */
+struct BenchmarkContigList : public reference::ContigList
+{
+    explicit BenchmarkContigList(const SimulatedContigs &contigs) :
+        reference::ContigList(makeSortedReferenceMetadata(contigs).getContigs(), 1000)
+    {
+        for (std::size_t contigId = 0; contigId < contigs.size(); ++contigId)
+        {
+            reference::ContigList::UpdateRange rwContig = getUpdateRange(contigId);
+            std::copy(contigs[contigId].bases_.begin(), contigs[contigId].bases_.end(), rwContig.begin());
+        }
+    }
+
+private:
+    static reference::SortedReferenceMetadata makeSortedReferenceMetadata(const SimulatedContigs &contigs)
+    {
+        reference::SortedReferenceMetadata ret;
+        std::size_t genomicOffset = 0;
+        for (const SimulatedContig &contig : contigs)
+        {
+            const std::size_t size = contig.bases_.size();
+            ret.putContig(genomicOffset, contig.name_, "benchmark.fa", genomicOffset, size, size, size,
+                          ret.getContigsCount(), "", "", "");
+            genomicOffset += size;
+        }
+        return ret;
+    }
+};
+
+/// Reference used by all microbenchmarks
+inline const SimulatedContigs &benchmarkReference()
+{
+    static const SimulatedContigs ret = makeRandomReference(1, BENCHMARK_CONTIG_LENGTH, BENCHMARK_SEED);
+    return ret;
+}
+
+/// Simulated pairs with default variant and error rates
+inline std::vector<SimulatedPair> benchmarkPairs(const std::size_t count, const unsigned readLength = 150)
+{
+    ReadSimulator simulator(benchmarkReference(), readLength, 350, 35, 0.001, 0.0001, 0.002, BENCHMARK_SEED);
+    std::vector<SimulatedPair> ret(count);
+    for (SimulatedPair &pair : ret)
+    {
+        simulator.next(pair);
+    }
+    return ret;
+}
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_BENCHMARK_REFERENCE_HH
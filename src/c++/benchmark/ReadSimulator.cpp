@@ -0,0 +1,241 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ReadSimulator.cpp
+ **
+ ** Generates paired reads from a reference with SNVs, indels and sequencing errors for benchmarking.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#include <boost/format.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+
+#include "ReadSimulator.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+static const char BASES[] = {'A', 'C', 'G', 'T'};
+
+SimulatedContigs loadFasta(const boost::filesystem::path &fastaPath)
+{
+    std::ifstream is(fastaPath.c_str());
+    if (!is)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open fasta file " + fastaPath.string()));
+    }
+
+    SimulatedContigs ret;
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (!line.empty() && '>' == line[0])
+        {
+            const SimulatedContig contig = {line.substr(1, line.find_first_of(" \t") - 1), std::string()};
+            ret.push_back(contig);
+        }
+        else if (!ret.empty())
+        {
+            std::transform(line.begin(), line.end(), std::back_inserter(ret.back().bases_), ::toupper);
+        }
+    }
+
+    if (ret.empty())
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "No contigs found in " + fastaPath.string()));
+    }
+    return ret;
+}
+
+SimulatedContigs makeRandomReference(const unsigned contigs, const std::size_t contigLength, const unsigned seed)
+{
+    std::mt19937_64 random(seed);
+    SimulatedContigs ret(contigs);
+    for (unsigned i = 0; contigs != i; ++i)
+    {
+        ret[i].name_ = "chr" + std::to_string(i + 1);
+        ret[i].bases_.resize(contigLength);
+        for (char &base : ret[i].bases_)
+        {
+            base = BASES[random() % 4];
+        }
+    }
+    return ret;
+}
+
+static std::vector<double> contigLengths(const SimulatedContigs &contigs)
+{
+    std::vector<double> ret;
+    for (const SimulatedContig &contig : contigs)
+    {
+        ret.push_back(contig.bases_.size());
+    }
+    return ret;
+}
+
+static void reverseComplement(std::string &bases)
+{
+    std::reverse(bases.begin(), bases.end());
+    for (char &base : bases)
+    {
+        base = 'A' == base ? 'T' : 'C' == base ? 'G' : 'G' == base ? 'C' : 'T' == base ? 'A' : 'N';
+    }
+}
+
+ReadSimulator::ReadSimulator(
+    const SimulatedContigs &reference,
+    const unsigned readLength,
+    const unsigned fragmentLengthMean,
+    const unsigned fragmentLengthStdDev,
+    const double snvRate,
+    const double indelRate,
+    const double errorRate,
+    const unsigned seed) :
+    readLength_(readLength),
+    errorRate_(errorRate),
+    random_(seed),
+    fragmentLength_(fragmentLengthMean, fragmentLengthStdDev),
+    uniform_(0.0, 1.0),
+    snvCount_(0),
+    indelCount_(0),
+    pairsGenerated_(0)
+{
+    makeDonor(reference, snvRate, indelRate);
+    const std::vector<double> lengths = contigLengths(donor_);
+    contigChooser_ = std::discrete_distribution<unsigned>(lengths.begin(), lengths.end());
+}
+
+char ReadSimulator::randomBase()
+{
+    return BASES[random_() % 4];
+}
+
+char ReadSimulator::otherBase(const char base)
+{
+    char ret = base;
+    while (ret == base)
+    {
+        ret = randomBase();
+    }
+    return ret;
+}
+
+void ReadSimulator::makeDonor(const SimulatedContigs &reference, const double snvRate, const double indelRate)
+{
+    donor_.clear();
+    for (const SimulatedContig &contig : reference)
+    {
+        SimulatedContig donorContig = {contig.name_, std::string()};
+        donorContig.bases_.reserve(contig.bases_.size() + contig.bases_.size() / 100);
+        for (std::size_t pos = 0; contig.bases_.size() > pos; ++pos)
+        {
+            const double dice = uniform_(random_);
+            if (dice < snvRate)
+            {
+                donorContig.bases_.push_back(otherBase(contig.bases_[pos]));
+                ++snvCount_;
+            }
+            else if (dice < snvRate + indelRate / 2)
+            {
+                // insertion
+                donorContig.bases_.push_back(contig.bases_[pos]);
+                for (unsigned length = 1 + random_() % INDEL_LENGTH_MAX; length; --length)
+                {
+                    donorContig.bases_.push_back(randomBase());
+                }
+                ++indelCount_;
+            }
+            else if (dice < snvRate + indelRate)
+            {
+                // deletion
+                pos += random_() % INDEL_LENGTH_MAX;
+                ++indelCount_;
+            }
+            else
+            {
+                donorContig.bases_.push_back(contig.bases_[pos]);
+            }
+        }
+        donor_.push_back(donorContig);
+    }
+}
+
+void ReadSimulator::addErrors(std::string &read, std::string &quality)
+{
+    quality.assign(read.size(), QUALITY_GOOD);
+    for (std::size_t i = 0; read.size() != i; ++i)
+    {
+        if (uniform_(random_) < errorRate_)
+        {
+            read[i] = otherBase(read[i]);
+            quality[i] = QUALITY_ERROR;
+        }
+    }
+}
+
+void ReadSimulator::next(SimulatedPair &pair)
+{
+    const SimulatedContig &contig = donor_.at(contigChooser_(random_));
+    const std::size_t fragmentLength = std::max<double>(readLength_, fragmentLength_(random_));
+    ISAAC_ASSERT_MSG(fragmentLength <= contig.bases_.size(),
+                     "Fragment length " << fragmentLength << " exceeds contig length " << contig.bases_.size());
+    const std::size_t fragmentBegin = random_() % (contig.bases_.size() - fragmentLength + 1);
+
+    pair.read1_.assign(contig.bases_, fragmentBegin, readLength_);
+    pair.read2_.assign(contig.bases_, fragmentBegin + fragmentLength - readLength_, readLength_);
+    reverseComplement(pair.read2_);
+    // reads come from both strands of the donor
+    if (random_() % 2)
+    {
+        pair.read1_.swap(pair.read2_);
+    }
+    addErrors(pair.read1_, pair.quality1_);
+    addErrors(pair.read2_, pair.quality2_);
+    pair.name_ = (boost::format("sim:%s:%d:%d") % contig.name_ % (fragmentBegin + 1) % pairsGenerated_++).str();
+}
+
+void ReadSimulator::writeFastq(const boost::filesystem::path &directory, const unsigned lane, const uint64_t pairs)
+{
+    const boost::filesystem::path read1Path = directory / (boost::format("lane%d_read1.fastq") % lane).str();
+    const boost::filesystem::path read2Path = directory / (boost::format("lane%d_read2.fastq") % lane).str();
+    std::ofstream os1(read1Path.c_str());
+    std::ofstream os2(read2Path.c_str());
+    if (!os1 || !os2)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to create fastq files in " + directory.string()));
+    }
+
+    SimulatedPair pair;
+    for (uint64_t i = 0; pairs != i; ++i)
+    {
+        next(pair);
+        os1 << '@' << pair.name_ << "/1\n" << pair.read1_ << "\n+\n" << pair.quality1_ << '\n';
+        os2 << '@' << pair.name_ << "/2\n" << pair.read2_ << "\n+\n" << pair.quality2_ << '\n';
+    }
+
+    if (!os1.flush() || !os2.flush())
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write fastq files in " + directory.string()));
+    }
+}
+
+} // namespace benchmark
+} // namespace isaac
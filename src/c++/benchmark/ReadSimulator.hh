@@ -0,0 +1,111 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ReadSimulator.hh
+ **
+ ** Generates paired reads from a reference with SNVs, indels and sequencing errors for benchmarking.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BENCHMARK_READ_SIMULATOR_HH
+#define iSAAC_BENCHMARK_READ_SIMULATOR_HH
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace isaac
+{
+namespace benchmark
+{
+
+struct SimulatedContig
+{
+    std::string name_;
+    std::string bases_;
+};
+
+typedef std::vector<SimulatedContig> SimulatedContigs;
+
+/// Loads all contigs of a fasta file. Lower case bases are converted to upper case
+SimulatedContigs loadFasta(const boost::filesystem::path &fastaPath);
+
+/// Uniformly random ACGT contigs
+SimulatedContigs makeRandomReference(const unsigned contigs, const std::size_t contigLength, const unsigned seed);
+
+struct SimulatedPair
+{
+    std::string name_;
+    std::string read1_;
+    std::string quality1_;
+    std::string read2_;
+    std::string quality2_;
+};
+
+/**
+ * \brief Applies SNVs and short indels to the reference once to produce the donor genome, then samples
+ *        forward-reverse pairs from the donor and adds sequencing errors.
+ */
+class ReadSimulator
+{
+public:
+    ReadSimulator(
+        const SimulatedContigs &reference,
+        const unsigned readLength,
+        const unsigned fragmentLengthMean,
+        const unsigned fragmentLengthStdDev,
+        const double snvRate,
+        const double indelRate,
+        const double errorRate,
+        const unsigned seed);
+
+    void next(SimulatedPair &pair);
+
+    /**
+     * \brief Stores lane<lane>_read1.fastq and lane<lane>_read2.fastq in the directory as expected by
+     *        --base-calls-format fastq
+     */
+    void writeFastq(const boost::filesystem::path &directory, const unsigned lane, const uint64_t pairs);
+
+    uint64_t getSnvCount() const {return snvCount_;}
+    uint64_t getIndelCount() const {return indelCount_;}
+
+private:
+    static const unsigned INDEL_LENGTH_MAX = 5;
+    static const char QUALITY_GOOD = 'I';
+    static const char QUALITY_ERROR = '+';
+
+    const unsigned readLength_;
+    const double errorRate_;
+    std::mt19937_64 random_;
+    std::normal_distribution<double> fragmentLength_;
+    std::uniform_real_distribution<double> uniform_;
+    SimulatedContigs donor_;
+    // contig picked proportionally to its length
+    std::discrete_distribution<unsigned> contigChooser_;
+    uint64_t snvCount_;
+    uint64_t indelCount_;
+    uint64_t pairsGenerated_;
+
+    char randomBase();
+    char otherBase(const char base);
+    void makeDonor(const SimulatedContigs &reference, const double snvRate, const double indelRate);
+    void addErrors(std::string &read, std::string &quality);
+};
+
+} // namespace benchmark
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BENCHMARK_READ_SIMULATOR_HH
@@ -0,0 +1,212 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file benchmarkAlignment.cpp
+ **
+ ** Microbenchmarks of the seed matching and alignment scoring.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "alignment/BandedSmithWaterman.hh"
+#include "alignment/HashMatchFinder.hh"
+#include "alignment/Mismatch.hh"
+#include "common/Threads.hpp"
+#include "oligo/Nucleotides.hh"
+#include "reference/ReferenceHasher.hh"
+
+#include "Benchmark.hh"
+#include "BenchmarkReference.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace
+{
+
+static const unsigned KMER_LENGTH = 16;
+typedef oligo::BasicKmerType<KMER_LENGTH> KmerT;
+typedef reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > InterleavedHashT;
+typedef reference::NumaReferenceHash<InterleavedHashT> ReferenceHashT;
+static const unsigned READS = 10000;
+
+const BenchmarkContigList &contigList()
+{
+    static const BenchmarkContigList ret(benchmarkReference());
+    return ret;
+}
+
+const ReferenceHashT &referenceHash()
+{
+    // same bucket count order as the isaac-align default for small genomes
+    static common::ThreadVector threads(1);
+    static const ReferenceHashT ret(
+        reference::ReferenceHasher<InterleavedHashT>(contigList(), threads, threads.size()).generate(0x1000000), false);
+    return ret;
+}
+
+KmerT makeKmer(const std::string::const_iterator begin)
+{
+    KmerT ret(0);
+    for (std::string::const_iterator it = begin; begin + KMER_LENGTH != it; ++it)
+    {
+        ret <<= oligo::BITS_PER_BASE;
+        ret |= KmerT(oligo::getValue(*it));
+    }
+    return ret;
+}
+
+} // namespace
+
+void referenceHashFindMatches(State &state)
+{
+    const ReferenceHashT &hash = referenceHash();
+    const std::vector<SimulatedPair> pairs = benchmarkPairs(READS);
+    std::vector<KmerT> kmers;
+    for (const SimulatedPair &pair : pairs)
+    {
+        kmers.push_back(makeKmer(pair.read1_.begin()));
+        kmers.push_back(makeKmer(pair.read2_.begin() + pair.read2_.size() / 2));
+    }
+
+    uint64_t hits = 0;
+    std::vector<KmerT>::const_iterator kmer = kmers.begin();
+    while (state.keepRunning())
+    {
+        const ReferenceHashT::MatchRange range = hash.findMatches(*kmer);
+        hits += std::distance(range.first, range.second);
+        if (kmers.end() == ++kmer)
+        {
+            kmer = kmers.begin();
+        }
+    }
+    doNotOptimize(hits);
+    state.setItemsProcessed(state.getIterations());
+}
+ISAAC_BENCHMARK(referenceHashFindMatches);
+
+void clusterHashMatchFinderFindReadMatches(State &state)
+{
+    static const unsigned SEEDS_PER_MATCH_MAX = 4;
+    const ReferenceHashT &hash = referenceHash();
+    const std::vector<SimulatedPair> pairs = benchmarkPairs(READS);
+    const unsigned readLength = pairs.front().read1_.size();
+
+    const flowcell::ReadMetadataList readMetadataList(1, flowcell::ReadMetadata(1, readLength, 0, 0));
+    alignment::BclClusters bclClusters(readLength);
+    bclClusters.reset(readLength, pairs.size());
+    for (std::size_t i = 0; pairs.size() != i; ++i)
+    {
+        std::transform(pairs[i].read1_.begin(), pairs[i].read1_.end(), bclClusters.cluster(i),
+                       [](const char base){return char((40 << 2) | oligo::getValue(base));});
+    }
+
+    alignment::ClusterHashMatchFinder<ReferenceHashT, SEEDS_PER_MATCH_MAX> matchFinder(hash, 1000, 0, 1000);
+    alignment::MatchLists matchLists(SEEDS_PER_MATCH_MAX + 1);
+    alignment::ReferenceOffsetLists fwMergeBuffers(11, alignment::ReferenceOffsetList(1000));
+    alignment::ReferenceOffsetLists rvMergeBuffers(11, alignment::ReferenceOffsetList(1000));
+    alignment::SeedHitsCache seedHitsCache;
+
+    alignment::Cluster cluster(readLength);
+    std::size_t clusterIndex = 0;
+    uint64_t matches = 0;
+    while (state.keepRunning())
+    {
+        cluster.init(readMetadataList, bclClusters.cluster(clusterIndex), 0, clusterIndex,
+                     alignment::ClusterXy(0, 0), true, 0, 0);
+        for (alignment::Matches &matchList : matchLists)
+        {
+            matchList.clear();
+        }
+        // measure the hash lookups, not the memo hits for the recycled clusters
+        seedHitsCache.clear();
+        matchFinder.findReadMatches(
+            contigList(), cluster, readMetadataList.front(), 1000, seedHitsCache,
+            matchLists, fwMergeBuffers, rvMergeBuffers);
+        matches += matchLists.back().size();
+        clusterIndex = (clusterIndex + 1) % pairs.size();
+    }
+    doNotOptimize(matches);
+    state.setItemsProcessed(state.getIterations());
+    state.setBytesProcessed(state.getIterations() * readLength);
+}
+ISAAC_BENCHMARK(clusterHashMatchFinderFindReadMatches);
+
+void bandedSmithWatermanAlign(State &state)
+{
+    static const unsigned READ_LENGTH = 150;
+    static const unsigned WIDEST_GAP_SIZE = 16;
+    static const unsigned DELETION_LENGTH_MAX = 5;
+    const BenchmarkContigList &contigs = contigList();
+    const reference::Contig &contig = contigs[0];
+
+    // Each query is a reference window with a short deletion in the middle and a mismatch near the end
+    std::vector<std::vector<char> > queries;
+    std::vector<std::size_t> windowBegins;
+    for (std::size_t windowBegin = 0; READS != queries.size(); windowBegin += READ_LENGTH + 2 * WIDEST_GAP_SIZE)
+    {
+        const reference::Contig::const_iterator begin = contig.begin() + windowBegin + WIDEST_GAP_SIZE;
+        const unsigned deletionLength = 1 + queries.size() % DELETION_LENGTH_MAX;
+        std::vector<char> query(begin, begin + READ_LENGTH / 2);
+        query.insert(query.end(), begin + READ_LENGTH / 2 + deletionLength, begin + READ_LENGTH + deletionLength);
+        query[READ_LENGTH - 10] = 'A' == query[READ_LENGTH - 10] ? 'C' : 'A';
+        queries.push_back(query);
+        windowBegins.push_back(windowBegin);
+    }
+
+    const alignment::BandedSmithWaterman<WIDEST_GAP_SIZE> bsw(2, -1, 15, 3, READ_LENGTH);
+    alignment::Cigar cigar;
+    cigar.reserve(1024);
+    std::size_t i = 0;
+    uint64_t score = 0;
+    while (state.keepRunning())
+    {
+        cigar.clear();
+        const reference::Contig::const_iterator windowBegin = contig.begin() + windowBegins[i];
+        score += bsw.align(queries[i], windowBegin, windowBegin + READ_LENGTH + 2 * WIDEST_GAP_SIZE, cigar);
+        i = (i + 1) % queries.size();
+    }
+    doNotOptimize(score);
+    state.setItemsProcessed(state.getIterations());
+    state.setBytesProcessed(state.getIterations() * READ_LENGTH);
+}
+ISAAC_BENCHMARK(bandedSmithWatermanAlign);
+
+void mismatchCountFast(State &state)
+{
+    static const unsigned READ_LENGTH = 150;
+    const SimulatedContig &contig = benchmarkReference().front();
+    std::vector<std::string> sequences;
+    for (const SimulatedPair &pair : benchmarkPairs(READS, READ_LENGTH))
+    {
+        sequences.push_back(pair.read1_);
+    }
+
+    std::size_t i = 0;
+    uint64_t mismatches = 0;
+    while (state.keepRunning())
+    {
+        const std::string &sequence = sequences[i];
+        mismatches += alignment::countMismatchesFast(
+            sequence.data(), sequence.data() + sequence.size(), contig.bases_.data() + i * READ_LENGTH);
+        i = (i + 1) % sequences.size();
+    }
+    doNotOptimize(mismatches);
+    state.setItemsProcessed(state.getIterations());
+    state.setBytesProcessed(state.getIterations() * READ_LENGTH);
+}
+ISAAC_BENCHMARK(mismatchCountFast);
+
+} // namespace benchmark
+} // namespace isaac
@@ -0,0 +1,179 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file benchmarkBuild.cpp
+ **
+ ** Microbenchmarks of the gap realignment and bam compression.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "alignment/Mismatch.hh"
+#include "bgzf/BgzfCompressor.hh"
+#include "build/GapRealigner.hh"
+#include "oligo/Nucleotides.hh"
+
+#include "Benchmark.hh"
+#include "BenchmarkReference.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace
+{
+
+/**
+ * \brief Fragment followed by the storage for its bases and cigar, the way it appears in the bin data
+ */
+struct BenchmarkFragment : public io::FragmentAccessor
+{
+    static const unsigned READ_LENGTH_MAX = 1000;
+    static const unsigned CIGAR_LENGTH_MAX = 100;
+    unsigned char buffer_[READ_LENGTH_MAX + CIGAR_LENGTH_MAX * sizeof(unsigned)];
+
+    BenchmarkFragment(
+        const reference::ReferencePosition fStrandPosition,
+        const std::string &read,
+        const alignment::Cigar &cigar,
+        const unsigned short editDistance)
+    {
+        fStrandPosition_ = fStrandPosition;
+        unsigned char *b = basesBegin();
+        for (const char base : read)
+        {
+            *b++ = (0x03 & oligo::getValue(base)) | 0x20;
+        }
+        readLength_ = read.size();
+        std::copy(cigar.begin(), cigar.end(), cigarBegin());
+        cigarLength_ = cigar.size();
+        rStrandPosition_ = fStrandPosition_ + read.size() - 1;
+        mateFStrandPosition_ = fStrandPosition_;
+        editDistance_ = editDistance;
+        alignmentScore_ = 1;
+        mapQ_ = 30;
+    }
+};
+
+} // namespace
+
+/**
+ * \brief Reads with a short deletion aligned without gaps, realigned against the true gap among a few unrelated ones
+ */
+void gapRealignerRealign(State &state)
+{
+    static const unsigned READ_LENGTH = 150;
+    static const unsigned DELETION_LENGTH = 3;
+    static const unsigned FRAGMENTS = 1000;
+    static const unsigned DISTANCE = READ_LENGTH * 4;
+
+    const SimulatedContig &contig = benchmarkReference().front();
+    static reference::ContigLists contigLists;
+    if (contigLists.empty())
+    {
+        contigLists.push_back(BenchmarkContigList(benchmarkReference()));
+    }
+
+    build::gapRealigner::RealignerGaps realignerGaps;
+    std::vector<BenchmarkFragment> fragments;
+    fragments.reserve(FRAGMENTS);
+    alignment::Cigar cigar;
+    cigar.addOperation(READ_LENGTH, alignment::Cigar::ALIGN);
+    for (unsigned i = 0; FRAGMENTS != i; ++i)
+    {
+        const std::size_t position = DISTANCE + i * DISTANCE;
+        const std::size_t deletionPosition = position + READ_LENGTH / 2;
+        std::string read = contig.bases_.substr(position, READ_LENGTH / 2);
+        read += contig.bases_.substr(deletionPosition + DELETION_LENGTH, READ_LENGTH - read.size());
+        const unsigned short editDistance = alignment::countMismatchesFast(
+            read.data(), read.data() + read.size(), contig.bases_.data() + position);
+        fragments.push_back(BenchmarkFragment(reference::ReferencePosition(0, position), read, cigar, editDistance));
+
+        realignerGaps.addGap(build::gapRealigner::Gap(reference::ReferencePosition(0, deletionPosition), DELETION_LENGTH));
+        realignerGaps.addGap(build::gapRealigner::Gap(reference::ReferencePosition(0, deletionPosition - 20), 1));
+        realignerGaps.addGap(build::gapRealigner::Gap(reference::ReferencePosition(0, deletionPosition + 30), -2));
+    }
+    realignerGaps.finalizeGaps();
+
+    flowcell::BarcodeMetadataList barcodeMetadataList(1);
+    barcodeMetadataList.at(0).setUnknown();
+    barcodeMetadataList.at(0).setIndex(0);
+    barcodeMetadataList.at(0).setReferenceIndex(0);
+
+    build::GapRealigner realigner(false, false, 4, 3, 4, 0, barcodeMetadataList);
+    build::PackedFragmentBuffer dataBuffer;
+    dataBuffer.resize(sizeof(BenchmarkFragment));
+    alignment::Cigar realignedCigars;
+    realignedCigars.reserve(1024);
+
+    const reference::ReferencePosition binStartPos(0, 0);
+    const reference::ReferencePosition binEndPos(0, contig.bases_.size());
+    std::size_t i = 0;
+    uint64_t realigned = 0;
+    while (state.keepRunning())
+    {
+        // realignment updates the fragment in place. Start each iteration from the original one
+        const BenchmarkFragment &original = fragments[i];
+        std::copy(original.begin(), original.end(), dataBuffer.begin());
+        const io::FragmentAccessor &fragment = dataBuffer.getFragment(0);
+        build::PackedFragmentBuffer::Index index(
+            fragment.fStrandPosition_, 0, 0, fragment.cigarBegin(), fragment.cigarEnd(), fragment.isReverse());
+        realignedCigars.clear();
+
+        reference::ReferencePosition newRStrandPosition;
+        unsigned short newEditDistance = 0;
+        realigned += realigner.realign(
+            realignerGaps, binStartPos, binEndPos, fragment, index, newRStrandPosition, newEditDistance,
+            dataBuffer, realignedCigars, contigLists);
+        i = (i + 1) % fragments.size();
+    }
+    doNotOptimize(realigned);
+    state.setItemsProcessed(state.getIterations());
+}
+ISAAC_BENCHMARK(gapRealignerRealign);
+
+/**
+ * \brief Compresses simulated fastq text. Its entropy is close to that of the bam records
+ */
+void bgzfCompressorWrite(State &state)
+{
+    static const std::size_t DATA_SIZE = 1024 * 1024;
+    std::string data;
+    for (const SimulatedPair &pair : benchmarkPairs(DATA_SIZE / 300 + 1))
+    {
+        data += pair.name_ + pair.read1_ + pair.quality1_;
+    }
+    data.resize(DATA_SIZE);
+
+    std::vector<char> compressed;
+    compressed.reserve(DATA_SIZE);
+    while (state.keepRunning())
+    {
+        compressed.clear();
+        boost::iostreams::filtering_ostream bgzfStream;
+        bgzfStream.push(bgzf::BgzfCompressor(boost::iostreams::gzip::default_compression), 65535, 0);
+        bgzfStream.push(boost::iostreams::back_inserter(compressed));
+        bgzfStream.write(data.data(), data.size());
+        bgzfStream.reset();
+    }
+    doNotOptimize(compressed);
+    state.setItemsProcessed(state.getIterations());
+    state.setBytesProcessed(state.getIterations() * DATA_SIZE);
+}
+ISAAC_BENCHMARK(bgzfCompressorWrite);
+
+} // namespace benchmark
+} // namespace isaac
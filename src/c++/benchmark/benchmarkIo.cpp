@@ -0,0 +1,118 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file benchmarkIo.cpp
+ **
+ ** Microbenchmarks of the base calls input parsing.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+
+#include "flowcell/ReadMetadata.hh"
+#include "io/FastqReader.hh"
+#include "rta/BclMapper.hh"
+
+#include "Benchmark.hh"
+#include "BenchmarkReference.hh"
+
+namespace isaac
+{
+namespace benchmark
+{
+
+namespace
+{
+
+/**
+ * \brief BclMapper with the cycle buffers filled in memory instead of being loaded from the bcl files
+ */
+class InMemoryBclMapper : public rta::BclMapper
+{
+public:
+    InMemoryBclMapper(const unsigned cycles, const unsigned clusters, const unsigned seed) :
+        rta::BclMapper(cycles, clusters)
+    {
+        setGeometry(cycles, clusters);
+        std::mt19937 random(seed);
+        for (unsigned cycle = 0; cycles != cycle; ++cycle)
+        {
+            char *cycleBuffer = getCycleBufferStart(cycle);
+            std::generate(cycleBuffer, getCycleBufferStart(cycle + 1), [&random](){return char(random());});
+        }
+    }
+};
+
+} // namespace
+
+/**
+ * \brief One iteration parses a whole flat fastq file
+ */
+void fastqReaderNext(State &state)
+{
+    static const unsigned READ_LENGTH = 150;
+    static const unsigned PAIRS = 100000;
+    const boost::filesystem::path directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+
+    ReadSimulator simulator(benchmarkReference(), READ_LENGTH, 350, 35, 0.001, 0.0001, 0.002, BENCHMARK_SEED);
+    simulator.writeFastq(directory, 1, PAIRS);
+    // FastqReader does not reopen the file it already has open. Alternate between two copies
+    const boost::filesystem::path paths[] = {directory / "lane1_read1.fastq", directory / "lane1_read1.copy.fastq"};
+    boost::filesystem::copy_file(paths[0], paths[1]);
+
+    const flowcell::ReadMetadata readMetadata(1, READ_LENGTH, 0, 0);
+    std::vector<char> bcl(READ_LENGTH);
+    io::FastqReader reader(false, 1, paths[1].string().size());
+    uint64_t records = 0;
+    unsigned pass = 0;
+    while (state.keepRunning())
+    {
+        reader.open(paths[pass++ % 2], '!');
+        while (reader.hasData())
+        {
+            reader.extractBcl(readMetadata, bcl.begin());
+            reader.next();
+            ++records;
+        }
+    }
+    doNotOptimize(bcl);
+    state.setItemsProcessed(records);
+    state.setBytesProcessed(state.getIterations() * boost::filesystem::file_size(paths[0]));
+
+    boost::filesystem::remove_all(directory);
+}
+ISAAC_BENCHMARK(fastqReaderNext);
+
+/**
+ * \brief Cycle-major to cluster-major conversion of one tile of bcl data
+ */
+void bclMapperTranspose(State &state)
+{
+    static const unsigned CYCLES = 302;
+    static const unsigned CLUSTERS = 100000;
+    const InMemoryBclMapper mapper(CYCLES, CLUSTERS, BENCHMARK_SEED);
+    std::vector<char> clusters(std::size_t(CYCLES) * CLUSTERS);
+    while (state.keepRunning())
+    {
+        mapper.transpose(clusters.begin());
+    }
+    doNotOptimize(clusters);
+    state.setItemsProcessed(state.getIterations() * CLUSTERS);
+    state.setBytesProcessed(state.getIterations() * clusters.size());
+}
+ISAAC_BENCHMARK(bclMapperTranspose);
+
+} // namespace benchmark
+} // namespace isaac
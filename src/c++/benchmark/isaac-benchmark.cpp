@@ -0,0 +1,36 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file isaac-benchmark.cpp
+ **
+ ** Runs the microbenchmarks of the hot alignment and build functions.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "Benchmark.hh"
+#include "BenchmarkOptions.hh"
+
+void benchmark(const isaac::benchmark::BenchmarkOptions &options);
+
+int main(int argc, char *argv[])
+{
+    isaac::common::run(benchmark, argc, argv);
+}
+
+void benchmark(const isaac::benchmark::BenchmarkOptions &options)
+{
+    if (!isaac::benchmark::runBenchmarks(options.filter, options.minSeconds, std::cout))
+    {
+        BOOST_THROW_EXCEPTION(isaac::common::InvalidOptionException("No benchmarks match " + options.filter));
+    }
+}
@@ -0,0 +1,45 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file isaac-simulate-reads.cpp
+ **
+ ** Generates paired fastq files with known variants and errors for end-to-end benchmarking.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "BenchmarkOptions.hh"
+#include "ReadSimulator.hh"
+
+void simulateReads(const isaac::benchmark::SimulateReadsOptions &options);
+
+int main(int argc, char *argv[])
+{
+    isaac::common::run(simulateReads, argc, argv);
+}
+
+void simulateReads(const isaac::benchmark::SimulateReadsOptions &options)
+{
+    using namespace isaac::benchmark;
+    const SimulatedContigs reference = options.fastaPath.empty() ?
+        makeRandomReference(options.randomContigs, options.randomContigLength, options.seed) :
+        loadFasta(options.fastaPath);
+
+    ReadSimulator simulator(
+        reference, options.readLength, options.fragmentLengthMean, options.fragmentLengthStdDev,
+        options.snvRate, options.indelRate, options.errorRate, options.seed);
+
+    boost::filesystem::create_directories(options.outputDirectory);
+    simulator.writeFastq(options.outputDirectory, options.lane, options.pairs);
+    ISAAC_THREAD_CERR << "Simulated " << options.pairs << " pairs with " << simulator.getSnvCount() << " SNVs and " <<
+        simulator.getIndelCount() << " indels in " << options.outputDirectory << std::endl;
+}
@@ -17,6 +17,7 @@
  ** \author Come Raczy
  **/
 #include "common/Debug.hh"
+#include "common/PerfTrace.hh"
 #include "common/SystemCompatibility.hh"
 #include "options/AlignOptions.hh"
 #include "package/InstallationPaths.hh"
@@ -54,6 +55,7 @@ void align(const isaac::options::AlignOptions &options)
     {
         ISAAC_THREAD_CERR << "align: NUMA-aware memory management disabled." << std::endl;
     }
+    isaac::common::hugePagesInitialize(options.hugePages);
 
     const uint64_t availableMemory = options.memoryLimit * 1024 * 1024 * 1024;
     if (isaac::options::AlignOptions::memoryLimitUnlimited !=  options.memoryLimit)
@@ -67,6 +69,11 @@ void align(const isaac::options::AlignOptions &options)
         // We're the child process in a fork, just keep running.
     }
 
+    if (options.perfTraceEvents)
+    {
+        isaac::common::perf::enable(options.perfTraceEvents);
+    }
+
     isaac::workflow::AlignWorkflow workflow(
         options.argv,
         options.description,
@@ -75,6 +82,8 @@ void align(const isaac::options::AlignOptions &options)
         options.seedLength,
         options.barcodeMetadataList,
         options.cleanupIntermediary,
+        !options.disableResume,
+        options.resumeAlignment,
         options.bclTilesPerChunk,
         options.ignoreMissingBcls,
         options.ignoreMissingFilters,
@@ -88,6 +97,8 @@ void align(const isaac::options::AlignOptions &options)
         options.matchFinderTooManyRepeats,
         options.matchFinderWayTooManyRepeats,
         options.matchFinderShadowSplitRepeats,
+        options.seedExtensionRepeats,
+        options.seedMismatches,
         options.seedBaseQualityMin,
         options.repeatThreshold,
         options.mateDriftRange,
@@ -109,6 +120,8 @@ void align(const isaac::options::AlignOptions &options)
         options.realignedGapsPerFragment,
         options.clipSemialigned,
         options.clipOverlapping,
+        options.clipAdapterOverlap,
+        options.keepReadNames,
         options.scatterRepeats,
         options.rescueShadows,
         options.trimPEAdapters,
@@ -132,6 +145,7 @@ void align(const isaac::options::AlignOptions &options)
         options.realignGaps,
         options.realignMapqMin,
         options.knownIndelsPath,
+        options.outputFormat,
         options.bamGzipLevel,
         options.bamPuFormat,
         options.bamProduceMd5,
@@ -145,6 +159,7 @@ void align(const isaac::options::AlignOptions &options)
         options.decoyRegexString,
         options.memoryControl,
         options.clusterIdList,
+        options.sampleClusters,
         options.userTemplateLengthStatistics,
         options.statsImageFormat,
         options.qScoreBin,
@@ -196,5 +211,6 @@ void align(const isaac::options::AlignOptions &options)
     {
         workflow.cleanupIntermediary();
     }
+    isaac::common::perf::dump(options.outputDirectory / "Stats");
 }
 
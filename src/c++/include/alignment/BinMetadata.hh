@@ -80,6 +80,19 @@ struct BarcodeCounts
 
 };
 
+/**
+ * \brief Counts for one positional part of a bin. The values are upper bounds of what the part will load, as
+ *        the data stored before the bin got partitioned is attributed to every part.
+ */
+struct BinPartCounts
+{
+    BinPartCounts() : dataSize_(0), seIdxElements_(0), rIdxElements_(0), fIdxElements_(0){}
+    uint64_t dataSize_;
+    uint64_t seIdxElements_;
+    uint64_t rIdxElements_;
+    uint64_t fIdxElements_;
+};
+
 class BinMetadata
 {
     unsigned binIndex_;
@@ -98,6 +111,8 @@ class BinMetadata
     uint64_t fIdxElements_;
     uint64_t nmElements_;
     std::vector<BarcodeCounts> barcodeBreakdown_;
+    // empty unless the bin grew large enough during binning to start counting its data per part
+    std::vector<BinPartCounts> parts_;
 
     /*
      * \brief enable serialization
@@ -105,6 +120,9 @@ class BinMetadata
     template <class Archive> friend void serialize(Archive &ar, BinMetadata &bm, const unsigned int version);
 
 public:
+    /// Number of equal-length positional parts an oversize bin can be broken down into
+    static const unsigned PARTS = 16;
+
     BinMetadata() :
         binIndex_(0),
         binStart_(0),
@@ -149,6 +167,7 @@ public:
         swap(fIdxElements_, that.fIdxElements_);
         swap(nmElements_, that.nmElements_);
         swap(barcodeBreakdown_, that.barcodeBreakdown_);
+        swap(parts_, that.parts_);
     }
 
     friend void swap(BinMetadata &left, BinMetadata &right) throw()
@@ -174,6 +193,8 @@ public:
         fIdxElements_ += that.fIdxElements_;
         nmElements_ += that.nmElements_;
         std::transform(barcodeBreakdown_.begin(), barcodeBreakdown_.end(), that.barcodeBreakdown_.begin(), barcodeBreakdown_.begin(), std::plus<BarcodeCounts>());
+        // parts don't describe the merged range
+        parts_.clear();
     }
 
     unsigned getIndex() const
@@ -414,6 +435,90 @@ public:
         fIdxElements_ = 0;
         nmElements_ = 0;
         std::fill(barcodeBreakdown_.begin(), barcodeBreakdown_.end(), BarcodeCounts());
+        parts_.clear();
+    }
+
+    bool isPartitioned() const {return !parts_.empty();}
+
+    /**
+     * \brief start counting data per positional part. Everything counted so far could be in any of the parts,
+     *        so it is attributed to each of them.
+     */
+    void partition()
+    {
+        ISAAC_ASSERT_MSG(!isUnalignedBin(), "Unaligned bins can't be partitioned " << *this);
+        BinPartCounts counts;
+        counts.dataSize_ = dataSize_;
+        counts.seIdxElements_ = seIdxElements_;
+        counts.rIdxElements_ = rIdxElements_;
+        counts.fIdxElements_ = fIdxElements_;
+        parts_.assign(PARTS, counts);
+    }
+
+    uint64_t getPartLength() const {return (length_ + PARTS - 1) / PARTS;}
+
+    /// \return number of parts that start within the bin. Short bins have fewer than PARTS of them
+    unsigned getPartCount() const {return (length_ + getPartLength() - 1) / getPartLength();}
+
+    unsigned getPart(const reference::ReferencePosition pos) const
+    {
+        ISAAC_ASSERT_MSG(coversPosition(pos), "Position " << pos << " is outside " << *this);
+        return (pos - binStart_) / getPartLength();
+    }
+
+    uint64_t getPartDataSize(const unsigned part) const
+    {
+        return parts_.at(part).dataSize_;
+    }
+
+    /**
+     * \brief count the fragment in every part that has its bit set in partMask
+     */
+    void incrementParts(
+        const unsigned partMask, const uint64_t dataSize, const uint64_t seIdx, const uint64_t rIdx, const uint64_t fIdx)
+    {
+        for (unsigned part = 0; PARTS != part; ++part)
+        {
+            if (partMask & (1U << part))
+            {
+                BinPartCounts &counts = parts_.at(part);
+                counts.dataSize_ += dataSize;
+                counts.seIdxElements_ += seIdx;
+                counts.rIdxElements_ += rIdx;
+                counts.fIdxElements_ += fIdx;
+            }
+        }
+    }
+
+    /**
+     * \return bin that covers parts [partsBegin, partsEnd). Counts that are not tracked per part are kept as is
+     *         except for barcode elements which are capped at the total elements of the parts.
+     */
+    BinMetadata getPartsBin(const unsigned partsBegin, const unsigned partsEnd) const
+    {
+        ISAAC_ASSERT_MSG(partsBegin < partsEnd && partsEnd <= getPartCount(), "Invalid part range [" << partsBegin << "," << partsEnd << ") for " << *this);
+        BinMetadata ret(*this);
+        ret.parts_.clear();
+        ret.binStart_ = binStart_ + partsBegin * getPartLength();
+        ret.length_ = std::min<uint64_t>(length_, partsEnd * getPartLength()) - partsBegin * getPartLength();
+        ret.dataSize_ = 0;
+        ret.seIdxElements_ = 0;
+        ret.rIdxElements_ = 0;
+        ret.fIdxElements_ = 0;
+        for (unsigned part = partsBegin; partsEnd != part; ++part)
+        {
+            const BinPartCounts &counts = parts_.at(part);
+            ret.dataSize_ += counts.dataSize_;
+            ret.seIdxElements_ += counts.seIdxElements_;
+            ret.rIdxElements_ += counts.rIdxElements_;
+            ret.fIdxElements_ += counts.fIdxElements_;
+        }
+        const uint64_t elements = ret.seIdxElements_ + ret.rIdxElements_ + ret.fIdxElements_;
+        for (BarcodeCounts &bc : ret.barcodeBreakdown_)
+        {
+            bc.elements_ = std::min(bc.elements_, elements);
+        }
+        return ret;
     }
 };
 
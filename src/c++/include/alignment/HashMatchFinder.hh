@@ -34,6 +34,105 @@ namespace alignment
 typedef reference::ContigList::Offset ReferenceOffset;
 typedef std::vector<ReferenceOffset> ReferenceOffsetList;
 typedef std::vector<ReferenceOffsetList> ReferenceOffsetLists;
+// hash lookup result independent of the hash allocator type
+typedef std::pair<const ReferenceOffset *, const ReferenceOffset *> ReferenceOffsetRange;
+
+/**
+ * \brief Per-thread memo of the reference hash lookups made for the seeds of the cluster being aligned.
+ *
+ * The first-pass seeding, the head-anchored search for structural variants and the shadow split attempts all
+ * generate seeds at the same read offsets. The hash lookups are the most expensive random memory accesses of the
+ * seeding, so they are done once per cluster, read, offset and strand. The entries are tagged with the epoch of the
+ * cluster they belong to, so switching to the next cluster does not require clearing the table.
+ * Mismatch-tolerant lookups produce position lists that don't exist in the hash. These are kept in a buffer that
+ * lives until the next cluster and is never reallocated so that the ranges stay valid.
+ */
+class SeedHitsCache
+{
+public:
+    struct Entry
+    {
+        Entry() : forwardEpoch_(0), reverseEpoch_(0), mismatchEpoch_(0), mismatchRepeat_(false) {}
+        ReferenceOffsetRange forward_;
+        ReferenceOffsetRange reverse_;
+        uint64_t forwardEpoch_;
+        uint64_t reverseEpoch_;
+        // hits of the seeds that have no exact matches, located allowing for mismatches
+        ReferenceOffsetRange mismatchForward_;
+        ReferenceOffsetRange mismatchReverse_;
+        uint64_t mismatchEpoch_;
+        // mismatch-tolerant lookup produced more positions than the buffer could hold
+        bool mismatchRepeat_;
+    };
+
+    SeedHitsCache() :
+        entries_(READS_MAX * ISAAC_READ_LENGTH_MAX), epoch_(0), matchFinder_(0), tile_(-1UL), clusterId_(-1UL)
+    {
+        mismatchPositions_.reserve(MISMATCH_POSITIONS_MAX);
+    }
+
+    /**
+     * \brief Invalidates the entries unless they have been collected for the same cluster with the same match finder
+     */
+    void prepare(const void *matchFinder, const uint64_t tile, const uint64_t clusterId)
+    {
+        if (matchFinder != matchFinder_ || tile != tile_ || clusterId != clusterId_)
+        {
+            matchFinder_ = matchFinder;
+            tile_ = tile;
+            clusterId_ = clusterId;
+            ++epoch_;
+            mismatchPositions_.clear();
+        }
+    }
+
+    /**
+     * \brief Forces the lookups to be repeated even if the next cluster is the same
+     */
+    void clear()
+    {
+        matchFinder_ = 0;
+    }
+
+    Entry &get(const unsigned readIndex, const unsigned seedOffset)
+    {
+        ISAAC_ASSERT_MSG(READS_MAX > readIndex && ISAAC_READ_LENGTH_MAX > seedOffset,
+                         "Seed out of range " << readIndex << ":" << seedOffset);
+        return entries_[readIndex * ISAAC_READ_LENGTH_MAX + seedOffset];
+    }
+
+    bool hasForward(const Entry &entry) const {return epoch_ == entry.forwardEpoch_;}
+    bool hasReverse(const Entry &entry) const {return epoch_ == entry.reverseEpoch_;}
+    void setForward(Entry &entry, const ReferenceOffsetRange &range) const {entry.forward_ = range; entry.forwardEpoch_ = epoch_;}
+    void setReverse(Entry &entry, const ReferenceOffsetRange &range) const {entry.reverse_ = range; entry.reverseEpoch_ = epoch_;}
+
+    bool hasMismatches(const Entry &entry) const {return epoch_ == entry.mismatchEpoch_;}
+    void setMismatches(
+        Entry &entry, const ReferenceOffsetRange &forward, const ReferenceOffsetRange &reverse, const bool repeat) const
+    {
+        entry.mismatchForward_ = forward;
+        entry.mismatchReverse_ = reverse;
+        entry.mismatchRepeat_ = repeat;
+        entry.mismatchEpoch_ = epoch_;
+    }
+
+    /**
+     * \brief Mismatch-tolerant lookups append here. Never grow beyond getMismatchPositionsAvailable()
+     */
+    ReferenceOffsetList &getMismatchPositions() {return mismatchPositions_;}
+    std::size_t getMismatchPositionsAvailable() const {return mismatchPositions_.capacity() - mismatchPositions_.size();}
+
+private:
+    static const unsigned READS_MAX = 2;
+    static const std::size_t MISMATCH_POSITIONS_MAX = 16384;
+    std::vector<Entry> entries_;
+    ReferenceOffsetList mismatchPositions_;
+    // 0 is never current, so default-constructed entries are invalid
+    uint64_t epoch_;
+    const void *matchFinder_;
+    uint64_t tile_;
+    uint64_t clusterId_;
+};
 
 template <typename ReferenceHash>
 class SeedHashMatchFinder
@@ -64,8 +163,46 @@ public:
         const unsigned seedOffset,
         const flowcell::ReadMetadata &readMetadata,
         const unsigned filterContigId,
-        typename ReferenceHash::MatchRange matchPositions,
+        ReferenceOffsetRange matchPositions,
         ReferenceOffsetList &referencePositions) const;
+
+protected:
+    ReferenceOffsetRange findMatches(const KmerT &kmer) const
+    {
+        return makeOffsetRange(referenceHash_.findMatches(kmer));
+    }
+
+    ReferenceOffsetRange findExtendedMatches(const KmerT &kmer, const KmerT &extension) const
+    {
+        return makeOffsetRange(referenceHash_.findExtendedMatches(kmer, extension));
+    }
+
+    /**
+     * \return false if the positions don't fit into the remaining buffer space
+     */
+    bool findMismatchMatches(const KmerT &kmer, SeedHitsCache &seedHitsCache, ReferenceOffsetRange &range) const
+    {
+        ReferenceOffsetList &positions = seedHitsCache.getMismatchPositions();
+        const std::size_t begin = positions.size();
+        if (!referenceHash_.findMismatchMatches(kmer, seedHitsCache.getMismatchPositionsAvailable(), positions))
+        {
+            return false;
+        }
+        range = begin == positions.size() ?
+            ReferenceOffsetRange(0, 0) : ReferenceOffsetRange(&positions[begin], &positions[0] + positions.size());
+        return true;
+    }
+
+private:
+    static ReferenceOffsetRange makeOffsetRange(const typename ReferenceHash::MatchRange &matches)
+    {
+        if (matches.first == matches.second)
+        {
+            return ReferenceOffsetRange(0, 0);
+        }
+        const ReferenceOffset *begin = &*matches.first;
+        return ReferenceOffsetRange(begin, begin + std::distance(matches.first, matches.second));
+    }
 };
 
 static const unsigned SV_READ_SEEDS_MIN = 1;
@@ -92,8 +229,8 @@ public:
     struct SeedHits
     {
         unsigned seedOffset_;
-        typename ReferenceHash::MatchRange forwardMatches_;
-        typename ReferenceHash::MatchRange reverseMatches_;
+        ReferenceOffsetRange forwardMatches_;
+        ReferenceOffsetRange reverseMatches_;
 
         std::size_t forwardHitCount() const
             {return std::distance(forwardMatches_.first, forwardMatches_.second);}
@@ -121,6 +258,7 @@ public:
         const Cluster& cluster,
         const flowcell::ReadMetadata& readMetadata,
         const std::size_t seedRepeatThreshold,
+        SeedHitsCache &seedHitsCache,
         MatchLists& matchLists,
         ReferenceOffsetLists& fwMergeBuffers,
         ReferenceOffsetLists& rvMergeBuffers) const;
@@ -132,6 +270,7 @@ public:
         const unsigned filterContigId,
         const std::size_t seedRepeatThreshold,
         const unsigned headSeedOffsetMax,
+        SeedHitsCache &seedHitsCache,
         MatchLists& matchLists,
         ReferenceOffsetLists& fwMergeBuffers,
         ReferenceOffsetLists& rvMergeBuffers) const;
@@ -157,7 +296,38 @@ private:
         const unsigned readIndex,
         const std::size_t seedRepeatThreshold,
         const unsigned endSeedOffset,
+        SeedHitsCache &seedHitsCache,
         SeedsHits& seedsHits) const;
+
+    template <typename TranslatorT>
+    bool collectSeedHit(
+        const Cluster& cluster,
+        const unsigned readIndex,
+        const std::size_t seedRepeatThreshold,
+        const unsigned endSeedOffset,
+        const TranslatorT &translator,
+        const BclClusters::const_iterator bclBegin,
+        const unsigned seedOffset,
+        const KmerT &seedKmer,
+        SeedHitsCache &seedHitsCache,
+        SeedsHits& seedsHits,
+        std::size_t &repeatSeeds) const;
+
+    template <typename TranslatorT>
+    bool extendRepeatSeed(
+        const BclClusters::const_iterator bclBegin,
+        const unsigned endSeedOffset,
+        const TranslatorT &translator,
+        const KmerT &seedKmer,
+        SeedHitsCache &seedHitsCache,
+        SeedHitsCache::Entry &cached,
+        SeedHits &hits) const;
+
+    bool findMismatchSeedHits(
+        const KmerT &seedKmer,
+        SeedHitsCache &seedHitsCache,
+        SeedHitsCache::Entry &cached,
+        SeedHits &hits) const;
 };
 
 } // namespace alignment
@@ -40,6 +40,7 @@
 #include "alignment/matchSelector/OverlappingEndsClipper.hh"
 #include "alignment/matchSelector/TemplateDetector.hh"
 #include "common/Threads.hpp"
+#include "common/WorkStealingScheduler.hh"
 #include "flowcell/BarcodeMetadata.hh"
 #include "reference/Contig.hh"
 
@@ -64,6 +65,7 @@ public:
         const std::size_t candidateMatchesMax,
         const unsigned repeatThreshold,
         const std::vector<std::size_t> &clusterIdList,
+        const double sampleClusters,
         const int mateDriftRange,
         const TemplateLengthStatistics &defaultTemplateLengthStatistics,
         const int mapqThreshold,
@@ -79,6 +81,8 @@ public:
         const bool keepUnaligned,
         const bool clipSemialigned,
         const bool clipOverlapping,
+        const bool clipAdapterOverlap,
+        const bool keepReadNames,
         const bool scatterRepeats,
         const bool rescueShadows,
         const bool trimPEAdapters,
@@ -104,19 +108,81 @@ public:
         std::vector<matchSelector::MatchSelectorStats>().swap(threadStats_);
     }
 
+    /**
+     * \brief Writes the xml statistics and their compact columnar counterpart next to it with the .bin extension
+     */
     void dumpStats(const boost::filesystem::path &statsXmlPath);
+
+    /**
+     * \brief Hands the finalized per-tile statistics over to the caller. Must be called after dumpStats.
+     */
+    void releaseStats(std::vector<matchSelector::MatchSelectorStats> &tileStats)
+    {
+        tileStats.clear();
+        tileStats.swap(allStats_);
+    }
     void reserveMemory(
         const flowcell::TileMetadataList &tileMetadataList);
 
+    /**
+     * \brief Statistics collected for the tiles, indexed by tile index. Complete for the tiles that are aligned
+     */
+    const std::vector<matchSelector::MatchSelectorStats> &getTileStats() const
+    {
+        return allStats_;
+    }
+
+    /**
+     * \brief Takes statistics of the tiles aligned by a previous run instead of aligning them again
+     */
+    void restoreTileStats(
+        const flowcell::TileMetadataList &tileMetadataList,
+        const std::vector<matchSelector::MatchSelectorStats> &tileStats);
+
+    /**
+     * \brief Prepares for alignment of the lane tiles. Must be called before any submitTile or alignTiles
+     */
+    void beginTiles(const flowcell::TileMetadataList &laneTiles);
+
+    /**
+     * \brief Aligns clusters of the tiles submitted with submitTile on all compute threads. Returns when
+     *        tileCount tiles have been aligned or cancelTiles is called.
+     *
+     *        Tiles are aligned in the order of submission. Clusters of a tile are handed out to threads in chunks
+     *        by a work-stealing scheduler. Threads that run out of clusters on one tile continue with the next
+     *        one submitted without waiting for the rest of the threads to finish the tile.
+     */
     template <typename MatchFinderT>
-    void parallelSelect(
-        alignment::matchFinder::TileClusterInfo &tileClusterInfo,
-        std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-        const flowcell::TileMetadata &tileMetadata,
-        const MatchFinderT &matchFinder,
-        const BclClusters &bclData,
+    void alignTiles(
+        const unsigned tileCount,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         matchSelector::FragmentStorage &fragmentStorage);
 
+    /**
+     * \brief Queues the tile for alignment. bclData must not change until waitTile returns.
+     *        Template length detection and alignment happen in the order in which the tiles are submitted.
+     *
+     * \return ticket to pass to waitTile
+     */
+    uint64_t submitTile(
+        const flowcell::TileMetadata &tileMetadata,
+        const matchFinder::ClusterInfos &clusterInfos,
+        const BclClusters &bclData);
+
+    /**
+     * \brief Blocks until all clusters of the tile are aligned and its statistics are recorded
+     */
+    void waitTile(const uint64_t ticket);
+
+    /**
+     * \brief Makes alignTiles and waitTile return early. Used to unblock everything when a tile fails to load.
+     */
+    void cancelTiles();
+
+    /// upper limit on the number of tiles that can be submitted without waiting for one of them to be aligned
+    static const unsigned TILES_IN_FLIGHT_MAX = 8;
+
 private:
     // The threading code in selectTileMatches can not deal with exception cleanup. Let it just crash for now.
     common::UnsafeThreadVector computeThreads_;
@@ -134,6 +200,7 @@ private:
     const reference::NumaContigLists &contigLists_;
     const unsigned repeatThreshold_;
     const std::vector<size_t> &clusterIdList_;
+    const double sampleClusters_;
 
     const int mapqThreshold_;
     const bool pfOnly_;
@@ -142,6 +209,8 @@ private:
     const bool keepUnaligned_;
     const bool clipSemialigned_;
     const bool clipOverlapping_;
+    const bool clipAdapterOverlap_;
+    const bool keepReadNames_;
     const std::vector<SequencingAdapterList> barcodeSequencingAdapters_;
 
     std::vector<matchSelector::MatchSelectorStats> allStats_;
@@ -151,22 +220,103 @@ private:
     boost::ptr_vector<TemplateBuilder> threadTemplateBuilders_;
     std::vector<matchSelector::SemialignedEndsClipper> threadSemialignedEndsClippers_;
     std::vector<matchSelector::OverlappingEndsClipper> threadOverlappingEndsClippers_;
-    // updated for barcodes relevant for the current tile
+    // updated for barcodes relevant for the current lane
     std::vector<RestOfGenomeCorrection> restOfGenomeCorrections_;
 
     matchSelector::TemplateDetector templateDetector_;
 
     mutable boost::mutex mutex_;
 
+    struct TileInFlight : boost::noncopyable
+    {
+        TileInFlight(const std::size_t barcodeCount, const unsigned threads) :
+            tileMetadata_(0), clusterInfos_(0), bclData_(0),
+            templateLengthStatistics_(barcodeCount), state_(Free), statsToBuild_(0), detectingThreads_(0),
+            // aim at roughly 10 milliseconds per chunk. Individual clusters can take longer than that
+            clusterScheduler_(threads, CLUSTERS_AT_A_TIME_MIN, CLUSTERS_AT_A_TIME, 0.01),
+            exhausted_(false), statsHolders_(0)
+        {
+        }
+
+        const flowcell::TileMetadata *tileMetadata_;
+        const matchFinder::ClusterInfos *clusterInfos_;
+        const BclClusters *bclData_;
+        // statistics the tile gets aligned with. The detection for the next tile updates the barcode statistics
+        // while threads are still aligning this one
+        std::vector<TemplateLengthStatistics> templateLengthStatistics_;
+        enum State
+        {
+            Free,
+            Submitted,
+            Detecting,
+            Aligning,
+            Aligned
+        } state_;
+        std::size_t statsToBuild_;
+        unsigned detectingThreads_;
+        // hands out the tile clusters to the compute threads
+        common::WorkStealingScheduler clusterScheduler_;
+        // set by the first thread that finds no more clusters to take
+        bool exhausted_;
+        // number of threads which have stats of the tile not yet merged into allStats_
+        unsigned statsHolders_;
+        // serializes merging of the thread stats into allStats_ of this tile only. Threads leaving
+        // different tiles merge concurrently
+        boost::mutex statsMutex_;
+
+        bool dispatched() const {return Aligning == state_ && exhausted_;}
+    };
+
+    boost::ptr_vector<TileInFlight> tilesInFlight_;
+    // tiles are numbered in the order of submission
+    uint64_t submittedTiles_;
+    // oldest tile that has clusters not handed out to threads yet
+    uint64_t dispatchTile_;
+    uint64_t tilesTotal_;
+    uint64_t alignedTiles_;
+    bool cancelled_;
+    boost::condition_variable tilesChangedCondition_;
+
+    TileInFlight &tileInFlight(const uint64_t tile) {return tilesInFlight_.at(tile % tilesInFlight_.size());}
+
     template <typename MatchFinderT>
-    void alignThread(
+    void alignTilesThread(
         const unsigned threadNumber,
-        const flowcell::TileMetadata & tileMetadata,
-        const matchFinder::ClusterInfos &clusterInfos,
-        unsigned &clusterId,
-        const MatchFinderT &matchFinder,
-        const BclClusters &bclData,
-        const std::vector<TemplateLengthStatistics> & templateLengthStatistics,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+        matchSelector::FragmentStorage &fragmentStorage);
+
+    template <typename MatchFinderT>
+    void detectTemplateLengths(
+        const unsigned threadNumber,
+        TileInFlight &tile,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+        boost::unique_lock<boost::mutex> &lock);
+
+    void mergeThreadStats(
+        const unsigned threadNumber,
+        TileInFlight &tile,
+        boost::unique_lock<boost::mutex> &lock);
+
+    void completeIfAligned(TileInFlight &tile);
+
+    /**
+     * \return fraction of the tile clusters to align according to --sample-clusters
+     */
+    double getSampleFraction(const flowcell::TileMetadata &tileMetadata) const;
+    /**
+     * \brief Logs alignment rate and mismatch rate estimates for the clusters sampled with --sample-clusters
+     */
+    void logSampleEstimates() const;
+
+    template <typename MatchFinderT>
+    void alignClusters(
+        const unsigned threadNumber,
+        const TileInFlight &tile,
+        const unsigned clustersBegin,
+        const unsigned clustersEnd,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
         matchSelector::FragmentStorage &fragmentStorage);
 
 
@@ -201,6 +351,8 @@ private:
         matchSelector::MatchSelectorStats& stats,
         matchSelector::FragmentStorage &fragmentStorage);
 
+    // bounds of the number of clusters a thread processes between visits to the scheduler
+    static const unsigned CLUSTERS_AT_A_TIME_MIN = 16;
     static const unsigned CLUSTERS_AT_A_TIME = 10000;
 };
 
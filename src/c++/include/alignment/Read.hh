@@ -21,6 +21,7 @@
 #ifndef iSAAC_ALIGNMENT_READ_HH
 #define iSAAC_ALIGNMENT_READ_HH
 
+#include <algorithm>
 #include <string>
 #include <iostream>
 
@@ -39,7 +40,7 @@ class Read
 public:
     /// Default constructor to enable use in containers
     //explicit Read(unsigned index = 0) : index_(index) {}
-    Read(const unsigned maxReadLength, const unsigned index) : index_(index), /*beginCyclesMasked_(0), */endCyclesMasked_(0)
+    Read(const unsigned maxReadLength, const unsigned index) : index_(index), /*beginCyclesMasked_(0), */endCyclesMasked_(0), adapterCyclesMasked_(0)
     {
         forwardSequence_.reserve(maxReadLength);
         reverseSequence_.reserve(maxReadLength);
@@ -56,6 +57,7 @@ public:
         , reverseQuality_(read.reverseQuality_)
         /*, beginCyclesMasked_(read.beginCyclesMasked_)*/
         , endCyclesMasked_(read.endCyclesMasked_)
+        , adapterCyclesMasked_(read.adapterCyclesMasked_)
     {
         // keep the size of pre-allocated buffers
         forwardSequence_.reserve(read.forwardSequence_.capacity());
@@ -76,6 +78,13 @@ public:
     unsigned getEndCyclesMasked() const {return endCyclesMasked_;}
     unsigned getIndex() const {return index_;}
     void maskCyclesFromEnd(unsigned cycles) {endCyclesMasked_ = cycles;}
+    unsigned getAdapterCyclesMasked() const {return adapterCyclesMasked_;}
+    /// Adapter bases known before the seeding are masked and excluded from the seeding.
+    void maskAdapterCyclesFromEnd(unsigned cycles)
+    {
+        adapterCyclesMasked_ = cycles;
+        endCyclesMasked_ = std::max(endCyclesMasked_, cycles);
+    }
 
     /// storing Read objects in the vector requires this operator although it is not expected to be executed at runtime
     Read &operator=(const Read &read)
@@ -98,6 +107,8 @@ private:
     //unsigned beginCyclesMasked_;
     /// number of cycles masked at the end of the read.
     unsigned endCyclesMasked_;
+    /// number of cycles at the end of the read identified as adapter before seeding. Included in endCyclesMasked_
+    unsigned adapterCyclesMasked_;
 };
 
 std::ostream &operator<<(std::ostream &os, const Read &read);
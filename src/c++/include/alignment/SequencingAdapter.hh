@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include "alignment/Cluster.hh"
 #include "flowcell/SequencingAdapterMetadata.hh"
 #include "oligo/KmerGenerator.hpp"
 
@@ -61,6 +62,17 @@ public:
         return !adapterMetadata_.isUnbounded() || reverse == adapterMetadata_.isReverse();
     }
 
+    /**
+     * \brief Checks if the first adapter bases are found at sequenceBegin
+     */
+    bool startsAt(
+        const std::vector<char>::const_iterator sequenceBegin,
+        const std::vector<char>::const_iterator sequenceEnd) const
+    {
+        unsigned short kmer = 0;
+        return generateKmer(adapterMatchBasesMin_, kmer, sequenceBegin, sequenceEnd) && 0 == kmerPositions_[kmer];
+    }
+
 
     /**
      * \brief returns a kmer from the provided sequence.
@@ -97,6 +109,25 @@ private:
 
 typedef std::vector<SequencingAdapter> SequencingAdapterList;
 
+/**
+ * \brief Finds the insert length of a pair that is shorter than the reads. Such reads are reverse complements of
+ *        each other over the insert length and continue into the adapter.
+ *
+ * \return insert length or 0 if the reads don't overlap like that
+ */
+unsigned findAdapterOverlap(
+    const Read &read1,
+    const Read &read2,
+    const SequencingAdapterList &sequencingAdapters);
+
+/**
+ * \brief Masks the adapter bases of short-insert pairs before seeding, so that the seeds are taken only from the
+ *        bases that can match the reference and the alignments get the adapter soft-clipped.
+ */
+void maskAdapterOverlap(
+    Cluster &cluster,
+    const SequencingAdapterList &sequencingAdapters);
+
 } // namespace alignment
 } // namespace isaac
 
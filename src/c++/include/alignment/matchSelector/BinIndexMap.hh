@@ -36,8 +36,12 @@ class BinIndexMap: public std::vector<std::vector<unsigned> >
     /// the binSize from the MatchDistribution
     const unsigned binLength_;
 public:
+    /**
+     * \param contigs  contigs in the order of their index. When multiple references are aligned against, the union
+     *                 of their contig lists so that a bin covers the same positions in every reference
+     */
     BinIndexMap(
-        const isaac::reference::SortedReferenceMetadata &sortedReference,
+        const isaac::reference::SortedReferenceMetadata::Contigs &contigs,
         const unsigned binLength)
         : binLength_(binLength)
     {
@@ -46,7 +50,7 @@ public:
 
         size_t currentBinIndex = 1;
         // now put in all the contig bins
-        for (const isaac::reference::SortedReferenceMetadata::Contig &contig : sortedReference.getContigs())
+        for (const isaac::reference::SortedReferenceMetadata::Contig &contig : contigs)
         {
             push_back(std::vector<unsigned>((contig.totalBases_ + binLength_ - 1) / binLength_, 0));
             std::iota(back().begin(), back().end(), currentBinIndex);
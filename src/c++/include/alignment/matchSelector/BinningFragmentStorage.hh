@@ -45,6 +45,10 @@ namespace bfs = boost::filesystem;
 class BinningFragmentStorage: FragmentPacker, FragmentBinner, public FragmentStorage
 {
 public:
+    /**
+     * \param checkpointBinMetadataList bins as recorded by an interrupted run. When not empty, the bin files
+     *        are truncated to the recorded sizes and the storage continues from there
+     */
     BinningFragmentStorage(
         const boost::filesystem::path &tempDirectory,
         const bool keepUnaligned,
@@ -55,6 +59,7 @@ public:
         const uint64_t expectedBinSize,
         const uint64_t targetBinLength,
         const unsigned threads,
+        const alignment::BinMetadataList &checkpointBinMetadataList,
         alignment::BinMetadataList &binMetadataList);
 
     ~BinningFragmentStorage();
@@ -74,6 +79,11 @@ public:
     virtual void flush()
     {
     }
+    virtual void sync()
+    {
+        FragmentBinner::flush(binMetadataList_);
+        FragmentBinner::sync();
+    }
     virtual void resize(const uint64_t clusters)
     {
     }
@@ -96,6 +106,8 @@ private:
     alignment::BinMetadataList &binMetadataList_;
     // this is just a bunch of BinMetadata objects ready to be moved into binMetadataList_ to avoid dynamic memory allocation
     alignment::BinMetadataList unalignedBinMetadataReserve_;
+
+    void resume(const alignment::BinMetadataList &checkpointBinMetadataList);
 };
 
 } // namespace matchSelector
@@ -0,0 +1,85 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file ClusterSampling.hh
+ **
+ ** \brief Selection of the tile clusters to align with --sample-clusters
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_MATCH_SELECTOR_CLUSTER_SAMPLING_HH
+#define iSAAC_ALIGNMENT_MATCH_SELECTOR_CLUSTER_SAMPLING_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+class ClusterSampling
+{
+    const uint64_t clusterCount_;
+    const uint64_t sampledCount_;
+
+public:
+    /**
+     * \param sampleClusters  0 to align everything, below 1 the fraction of the tile clusters, otherwise the number
+     *                        of clusters per tile
+     */
+    ClusterSampling(const double sampleClusters, const unsigned clusterCount) :
+        clusterCount_(clusterCount),
+        sampledCount_(getSampledCount(sampleClusters, clusterCount))
+    {
+    }
+
+    uint64_t getSampledCount() const {return sampledCount_;}
+
+    /**
+     * \return fraction of the tile clusters that get aligned. 1.0 for empty tiles
+     */
+    double getFraction() const {return clusterCount_ ? double(sampledCount_) / clusterCount_ : 1.0;}
+
+    /**
+     * \brief True for the clusters at which the count of sampled clusters increments. This spreads them evenly
+     *        over the tile and selects exactly getSampledCount() of them. Integer arithmetic makes sure the
+     *        floating point rounding does not add or lose clusters
+     */
+    bool isSampled(const uint64_t clusterId) const
+    {
+        return sampledCount_ == clusterCount_ ||
+            (clusterId + 1) * sampledCount_ / clusterCount_ != clusterId * sampledCount_ / clusterCount_;
+    }
+
+private:
+    static uint64_t getSampledCount(const double sampleClusters, const unsigned clusterCount)
+    {
+        if (!sampleClusters || !clusterCount)
+        {
+            return clusterCount;
+        }
+        // at least one cluster of each tile to keep the full run extrapolation defined
+        const uint64_t ret = 1.0 > sampleClusters ? uint64_t(std::round(sampleClusters * clusterCount)) : uint64_t(sampleClusters);
+        return std::max<uint64_t>(1, std::min<uint64_t>(ret, clusterCount));
+    }
+};
+
+} // namespace matchSelector
+} // namespace alignment
+} // namespace isaac
+
+#endif // #ifndef iSAAC_ALIGNMENT_MATCH_SELECTOR_CLUSTER_SAMPLING_HH
@@ -173,7 +173,9 @@ namespace bfs = boost::filesystem;
 class DebugStorage: public FragmentStorage
 {
     static const unsigned READS_MAX = 2;
-    const reference::ContigList &contigList_;
+    /// contigs of every reference, the one for the barcode is picked via its reference index
+    const reference::ContigLists &contigLists_;
+    const flowcell::BarcodeMetadataList &barcodeMetadataList_;
     const flowcell::Layout &flowcell_;
     const AlignmentCfg &alignmentCfg_;
     const boost::filesystem::path outputDirectory_;
@@ -193,7 +195,7 @@ class DebugStorage: public FragmentStorage
     std::vector<std::vector<Cigar> > originalCigars_;
 public:
     DebugStorage(
-        const reference::ContigList &contigList,
+        const reference::ContigLists &contigLists,
         const AlignmentCfg &alignmentCfg,
         const flowcell::FlowcellLayoutList &flowcellLayoutList,
         const boost::filesystem::path &outputDirectory,
@@ -221,6 +223,10 @@ public:
     {
         actualStorage_.flush();
     }
+    virtual void sync()
+    {
+        actualStorage_.sync();
+    }
     virtual void resize(const uint64_t clusters)
     {
         actualStorage_.resize(clusters);
@@ -238,8 +244,10 @@ private:
     int updateMapqStats(
             const BamTemplate& bamTemplate,
             const unsigned barcodeIdx);
+    const reference::ContigList &getContigList(const unsigned barcodeIdx) const;
     bool restoreOriginal(
         const unsigned threadNumber,
+        const unsigned barcodeIdx,
         const std::size_t readNumber,
         FragmentMetadata &fragment);
 };
@@ -69,8 +69,7 @@ public:
 
         insertIt = std::copy(header.bytesBegin(), header.bytesEnd(), insertIt);
         insertIt = storeBclAndCigar(fragment, insertIt);
-        insertIt = std::copy(bamTemplate.nameBegin(), bamTemplate.nameEnd(), insertIt);
-        *insertIt++ = 0;
+        insertIt = storeName(bamTemplate, insertIt);
 
 //        ISAAC_ASSERT_MSG("FC:10201664" != std::string(fragment.getCluster().nameBegin(), fragment.getCluster().nameEnd()), fragment);
 
@@ -89,8 +88,7 @@ public:
         const io::FragmentHeader header(bamTemplate, fragment, barcodeIdx);
         insertIt = std::copy(header.bytesBegin(), header.bytesEnd(), insertIt);
         insertIt = storeBclAndCigar(fragment, insertIt);
-        insertIt = std::copy(bamTemplate.nameBegin(), bamTemplate.nameEnd(), insertIt);
-        *insertIt++ = 0;
+        insertIt = storeName(bamTemplate, insertIt);
 
         return insertIt;
     }
@@ -98,6 +96,22 @@ public:
 private:
     static const unsigned READS_MAX = 2;
 
+    /**
+     * \brief names that are not stored get generated from tile and cluster id when the bam is produced
+     */
+    template <typename InsertIT>
+    static InsertIT storeName(
+        const alignment::BamTemplate &bamTemplate,
+        InsertIT insertIt)
+    {
+        if (bamTemplate.getNameLength())
+        {
+            insertIt = std::copy(bamTemplate.nameBegin(), bamTemplate.nameEnd(), insertIt);
+            *insertIt++ = 0;
+        }
+        return insertIt;
+    }
+
     template <typename InsertIT>
     static InsertIT storeBclAndCigar(
         const alignment::FragmentMetadata & fragment,
@@ -136,10 +150,15 @@ private:
 class FragmentBinner: boost::noncopyable
 {
 public:
+    /**
+     * \param partitionedBinSizeMin aligned bins that grow over this size start counting their data per positional
+     *                              part, so that Build can break them down. 0 disables partitioning
+     */
     FragmentBinner(
         const bool keepUnaligned,
         const BinIndexMap &binIndexMap,
         const uint64_t expectedBinSize,
+        const uint64_t partitionedBinSizeMin,
         const unsigned threads);
 
     // opens a range of bins. Multiple opens are called over the lifetime of FragmentBinner
@@ -147,6 +166,17 @@ public:
         const alignment::BinMetadataList::iterator binsBegin,
         const alignment::BinMetadataList::iterator binsEnd);
 
+    /**
+     * \brief same as open but keeps the data that the bin files already have. The files are expected to be
+     *        truncated to the last consistent state by the caller.
+     *
+     * \param binZeroRecordsBinned number of records the unaligned bin received before the files were closed
+     */
+    void resume(
+        const alignment::BinMetadataList::iterator binsBegin,
+        const alignment::BinMetadataList::iterator binsEnd,
+        const uint64_t binZeroRecordsBinned);
+
     /**
      * \brief reclaims any unused storage.
      */
@@ -168,6 +198,20 @@ public:
      */
     void flush(BinMetadataList &binMetadataList);
 
+    /**
+     * \brief pushes everything written so far into the bin files. Must not be called while fragments are stored
+     */
+    void sync();
+
+protected:
+    /**
+     * \brief the mutex that protects the unaligned bin metadata from being updated by the storing threads
+     */
+    boost::mutex &getUnalignedBinMutex()
+    {
+        return binMutex_[unsigned(binFiles_.at(0)) % binMutex_.size()];
+    }
+
 private:
     /// Maximum number of bins a fragment is expected to cover. In theory this can be up to total number of bins.
     static const unsigned FRAGMENT_BINS_MAX = 10*1024;
@@ -179,6 +223,7 @@ private:
     static const unsigned READS_MAX = 2;
     const bool keepUnaligned_;
     const uint64_t expectedBinSize_;
+    const uint64_t partitionedBinSizeMin_;
 
     const BinIndexMap &binIndexMap_;
 
@@ -219,6 +264,7 @@ private:
 
     void flushSingle(
         const io::FragmentAccessor &fragment,
+        const io::FragmentAccessor *mate,
         const BinIndexList &binIndexList,
         alignment::BinMetadataList &binMetadataList,
         const unsigned fileIndex);
@@ -231,8 +277,12 @@ private:
     void getFragmentStorageBins(const io::FragmentAccessor &fragment, FragmentBins &bins);
 
     void reopenBin(const BinMetadata &binMetadata, std::size_t file);
-    void openBinFile(const BinMetadata &binMetadata, std::size_t file);
-    void registerFragment(const io::FragmentAccessor& fragment,
+    void openBinFile(const BinMetadata &binMetadata, std::size_t file, const bool keepData);
+    void openBinFiles(
+        const alignment::BinMetadataList::iterator binsBegin,
+        const alignment::BinMetadataList::iterator binsEnd,
+        const bool keepData);
+    void registerFragment(const io::FragmentAccessor& fragment, const io::FragmentAccessor *mate,
                           const bool splitRead, const bool realignableSplit, BinMetadata& binMetadata);
 };
 
@@ -47,6 +47,11 @@ public:
 
     virtual void prepareFlush() noexcept = 0;
     virtual void flush() = 0;
+    /**
+     * \brief makes everything stored so far reach the storage so that the state can be persisted.
+     *        Must not be called while fragments are stored
+     */
+    virtual void sync() = 0;
     virtual void resize(const uint64_t clusters) = 0;
     virtual void reserve(const uint64_t clusters) = 0;
     virtual void close() = 0;
@@ -47,7 +47,8 @@ public:
         const bool collectCycleStats,
         const flowcell::BarcodeMetadataList &barcodeMetadataList) :
             collectCycleStats_(collectCycleStats),
-            barcodeMetadataList_(barcodeMetadataList)
+            barcodeMetadataList_(barcodeMetadataList),
+            sparse_(true)
     {
         const unsigned tileStatsCount = maxReads_ * filterStates_;
         ISAAC_THREAD_CERR << "Allocating " << tileStatsCount << " tile stats." << std::endl;
@@ -60,15 +61,40 @@ public:
         ISAAC_THREAD_CERR << "Allocating " << tileBarcodeStatsCount << " tile barcode stats." << std::endl;
         tileBarcodeStats_.resize(tileBarcodeStatsCount);
         ISAAC_THREAD_CERR << "Allocating " << tileBarcodeStatsCount << " tile barcode stats done. Total size is " << tileBarcodeStats_.capacity() * sizeof(TileBarcodeStats) << " bytes."<< std::endl;
+
+        tileStatsCycles_.resize(tileStatsCount, noCycles());
+        tileBarcodeStatsTouched_.resize(tileBarcodeStatsCount, false);
     }
 
+    /**
+     * \brief Clears the values. Unless the object has been modified outside of the record* methods,
+     *        only the entries and the cycles that have been recorded are touched.
+     */
     void reset()
     {
-        std::for_each(tileStats_.begin(), tileStats_.end(),
-                      boost::bind(&TileStats::reset, _1));
-        std::for_each(tileBarcodeStats_.begin(), tileBarcodeStats_.end(),
-                      boost::bind(&TileBarcodeStats::reset, _1));
-
+        if (sparse_)
+        {
+            for (unsigned i = 0; tileStats_.size() != i; ++i)
+            {
+                tileStats_[i].reset(tileStatsCycles_[i].first, tileStatsCycles_[i].second);
+            }
+            for (const unsigned i : touchedTileBarcodeStats_)
+            {
+                tileBarcodeStats_[i].reset();
+                tileBarcodeStatsTouched_[i] = false;
+            }
+        }
+        else
+        {
+            std::for_each(tileStats_.begin(), tileStats_.end(),
+                          boost::bind(&TileStats::reset, _1));
+            std::for_each(tileBarcodeStats_.begin(), tileBarcodeStats_.end(),
+                          boost::bind(&TileBarcodeStats::reset, _1));
+            std::fill(tileBarcodeStatsTouched_.begin(), tileBarcodeStatsTouched_.end(), false);
+        }
+        std::fill(tileStatsCycles_.begin(), tileStatsCycles_.end(), noCycles());
+        touchedTileBarcodeStats_.clear();
+        sparse_ = true;
     }
 
     void recordTemplate(
@@ -83,21 +109,22 @@ public:
         if (bamTemplate.getPassesFilter())
         {
             tileStats_.at(tileIndex(bamTemplate.getFragmentMetadata(0), true)).recordTemplate(tileStatsAdapter);
-            tileBarcodeStats_.at(tileBarcodeIndex(bamTemplate.getFragmentMetadata(0), barcodeIndex, true)).recordTemplate(tileStatsAdapter);
+            touchTileBarcodeStats(tileBarcodeIndex(bamTemplate.getFragmentMetadata(0), barcodeIndex, true)).recordTemplate(tileStatsAdapter);
         }
         tileStats_.at(tileIndex(bamTemplate.getFragmentMetadata(0), false)).recordTemplate(tileStatsAdapter);
-        tileBarcodeStats_.at(tileBarcodeIndex(bamTemplate.getFragmentMetadata(0), barcodeIndex, false)).recordTemplate(tileStatsAdapter);
+        touchTileBarcodeStats(tileBarcodeIndex(bamTemplate.getFragmentMetadata(0), barcodeIndex, false)).recordTemplate(tileStatsAdapter);
         for(unsigned i = 0; bamTemplate.getFragmentCount() > i; ++i)
         {
             const FragmentMetadata &fragment = bamTemplate.getFragmentMetadata(i);
+            const flowcell::ReadMetadata &readMetadata = readMetadatalist.at(i);
             FragmentMetadataTileStatsAdapter tileStatsAdapter(fragment);
             if (bamTemplate.getPassesFilter())
             {
-                tileStats_.at(tileIndex(fragment, true)).recordFragment(collectCycleStats_, tileStatsAdapter, readMetadatalist.at(i));
-                tileBarcodeStats_.at(tileBarcodeIndex(fragment, barcodeIndex, true)).recordFragment(tileStatsAdapter, readMetadatalist.at(i));
+                touchTileStats(tileIndex(fragment, true), readMetadata).recordFragment(collectCycleStats_, tileStatsAdapter, readMetadata);
+                touchTileBarcodeStats(tileBarcodeIndex(fragment, barcodeIndex, true)).recordFragment(tileStatsAdapter, readMetadata);
             }
-            tileStats_.at(tileIndex(fragment, false)).recordFragment(collectCycleStats_, tileStatsAdapter, readMetadatalist.at(i));
-            tileBarcodeStats_.at(tileBarcodeIndex(fragment, barcodeIndex, false)).recordFragment(tileStatsAdapter, readMetadatalist.at(i));
+            touchTileStats(tileIndex(fragment, false), readMetadata).recordFragment(collectCycleStats_, tileStatsAdapter, readMetadata);
+            touchTileBarcodeStats(tileBarcodeIndex(fragment, barcodeIndex, false)).recordFragment(tileStatsAdapter, readMetadata);
         }
     }
 
@@ -105,7 +132,7 @@ public:
         const flowcell::BarcodeMetadata &barcodeMetadata,
         const TemplateLengthStatistics &templateLengthStatistics)
     {
-        tileBarcodeStats_.at(tileBarcodeIndex(barcodeMetadata)).recordTemplateLengthStatistics(templateLengthStatistics);
+        touchTileBarcodeStats(tileBarcodeIndex(barcodeMetadata)).recordTemplateLengthStatistics(templateLengthStatistics);
     }
 
     MatchSelectorStats &operator +=(const MatchSelectorStats &right)
@@ -113,13 +140,31 @@ public:
         ISAAC_ASSERT_MSG(right.barcodeMetadataList_.size() == barcodeMetadataList_.size(), "dimensions must match");
         ISAAC_ASSERT_MSG(right.tileBarcodeStats_.size() == tileBarcodeStats_.size(), "size must match");
         ISAAC_ASSERT_MSG(right.tileStats_.size() == tileStats_.size(), "size must match");
-        std::transform(tileStats_.begin(), tileStats_.end(),
-                       right.tileStats_.begin(), tileStats_.begin(), std::plus<TileStats>());
-        unsigned i = 0;
-        BOOST_FOREACH(TileBarcodeStats &tileBarcodeStats, tileBarcodeStats_)
+        if (right.sparse_)
         {
-            tileBarcodeStats += right.tileBarcodeStats_.at(i);
-            ++i;
+            // only the entries and cycles the right side has recorded can be non-zero
+            for (unsigned i = 0; tileStats_.size() != i; ++i)
+            {
+                const CycleRange &cycles = right.tileStatsCycles_[i];
+                tileStats_[i].add(right.tileStats_[i], cycles.first, cycles.second);
+                extendCycles(i, cycles);
+            }
+            for (const unsigned i : right.touchedTileBarcodeStats_)
+            {
+                touchTileBarcodeStats(i) += right.tileBarcodeStats_[i];
+            }
+        }
+        else
+        {
+            std::transform(tileStats_.begin(), tileStats_.end(),
+                           right.tileStats_.begin(), tileStats_.begin(), std::plus<TileStats>());
+            unsigned i = 0;
+            BOOST_FOREACH(TileBarcodeStats &tileBarcodeStats, tileBarcodeStats_)
+            {
+                tileBarcodeStats += right.tileBarcodeStats_.at(i);
+                ++i;
+            }
+            sparse_ = false;
         }
         return *this;
     }
@@ -137,6 +182,10 @@ public:
         ISAAC_ASSERT_MSG(that.tileBarcodeStats_.size() == tileBarcodeStats_.size(), "size must match");
         tileStats_ = that.tileStats_;
         tileBarcodeStats_ = that.tileBarcodeStats_;
+        tileStatsCycles_ = that.tileStatsCycles_;
+        tileBarcodeStatsTouched_ = that.tileBarcodeStatsTouched_;
+        touchedTileBarcodeStats_ = that.touchedTileBarcodeStats_;
+        sparse_ = that.sparse_;
         return *this;
     }
 
@@ -155,13 +204,35 @@ public:
         return tileStats_.at(tileIndex(read, passesFilter));
     }
 
+    TileBarcodeStats &getReadBarcodeTileStat(
+        const flowcell::ReadMetadata& read,
+        const flowcell::BarcodeMetadata& barcode,
+        const bool passesFilter)
+    {
+        // direct modifications are not tracked
+        sparse_ = false;
+        return tileBarcodeStats_.at(tileBarcodeIndex(read, barcode, passesFilter));
+    }
+
+    TileStats &getReadTileStat(
+        const flowcell::ReadMetadata& read,
+        const bool passesFilter)
+    {
+        sparse_ = false;
+        return tileStats_.at(tileIndex(read, passesFilter));
+    }
+
     void finalize()
     {
         std::for_each(tileStats_.begin(), tileStats_.end(), boost::bind(&TileStats::finalize, _1));
         std::for_each(tileBarcodeStats_.begin(), tileBarcodeStats_.end(), boost::bind(&TileBarcodeStats::finalize, _1));
+        // cumulative values spread past the recorded cycles
+        sparse_ = false;
     }
 
 private:
+    template <class Archive> friend void serialize(Archive &ar, MatchSelectorStats &mss, const unsigned int version);
+
     static const unsigned filterStates_ = 2;
     static const unsigned maxReads_ = 2;
     const bool collectCycleStats_;
@@ -176,6 +247,53 @@ private:
      */
     std::vector<TileBarcodeStats>  tileBarcodeStats_;
 
+    typedef std::pair<unsigned, unsigned> CycleRange;
+    // pair constructor binds references, pass a copy of the constant which has no out-of-class definition
+    static CycleRange noCycles() {return CycleRange(unsigned(TileStats::MAX_CYCLES), 0);}
+    /**
+     * \brief [begin, end) of the cycles that have values recorded in the corresponding tileStats_ element
+     */
+    std::vector<CycleRange> tileStatsCycles_;
+    /**
+     * \brief indexes of tileBarcodeStats_ elements that have values recorded, in the order of first recording
+     */
+    std::vector<unsigned> touchedTileBarcodeStats_;
+    std::vector<bool> tileBarcodeStatsTouched_;
+    /**
+     * \brief true when all the non-zero values are covered by tileStatsCycles_ and touchedTileBarcodeStats_. Allows
+     *        reset and merge to skip the parts of the per-thread accumulators that have not been used for the tile.
+     */
+    bool sparse_;
+
+    void extendCycles(const unsigned index, const CycleRange &cycles)
+    {
+        if (cycles.second > cycles.first)
+        {
+            CycleRange &range = tileStatsCycles_[index];
+            range.first = std::min(range.first, cycles.first);
+            range.second = std::max(range.second, cycles.second);
+        }
+    }
+
+    TileStats &touchTileStats(const unsigned index, const flowcell::ReadMetadata &readMetadata)
+    {
+        if (collectCycleStats_)
+        {
+            extendCycles(index, CycleRange(readMetadata.getFirstCycle(), readMetadata.getLastCycle() + 1));
+        }
+        return tileStats_.at(index);
+    }
+
+    TileBarcodeStats &touchTileBarcodeStats(const unsigned index)
+    {
+        if (!tileBarcodeStatsTouched_.at(index))
+        {
+            tileBarcodeStatsTouched_[index] = true;
+            touchedTileBarcodeStats_.push_back(index);
+        }
+        return tileBarcodeStats_[index];
+    }
+
     unsigned tileBarcodeIndex(
         const flowcell::ReadMetadata& read,
         const flowcell::BarcodeMetadata& barcode,
@@ -0,0 +1,119 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file MatchSelectorStatsBinary.hh
+ **
+ ** \brief Compact columnar binary serialization of MatchSelector statistics.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef ISAAC_ALIGNMENT_MATCH_SELECTOR_STATS_BINARY_H
+#define ISAAC_ALIGNMENT_MATCH_SELECTOR_STATS_BINARY_H
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "alignment/matchSelector/MatchSelectorStatsColumns.hh"
+#include "flowcell/Layout.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+/**
+ * \brief Streams the tile statistics one row group per tile so that the whole run never has to be
+ *        materialized in a single document.
+ */
+class MatchSelectorStatsBinaryWriter: boost::noncopyable
+{
+public:
+    /**
+     * \brief writes the header with the metadata dictionaries and the table schemas
+     */
+    MatchSelectorStatsBinaryWriter(
+        std::ostream &os,
+        const bool collectCycleStats,
+        const flowcell::FlowcellLayoutList &flowcellLayoutList,
+        const flowcell::BarcodeMetadataList &barcodeMetadataList,
+        const flowcell::TileMetadataList &tileMetadataList);
+
+    void writeTile(const flowcell::TileMetadata &tile, const MatchSelectorStats &stats);
+    /**
+     * \brief writes the end marker. No writeTile calls are allowed after this
+     */
+    void close();
+
+private:
+    std::ostream &os_;
+    const bool collectCycleStats_;
+    const flowcell::FlowcellLayoutList &flowcellLayoutList_;
+    const flowcell::BarcodeMetadataList &barcodeMetadataList_;
+    std::vector<StatsColumnTable> tables_;
+};
+
+/**
+ * \brief Parses the binary statistics back. The metadata is rebuilt from the file dictionaries and owned
+ *        by the reader, so the reader must outlive the MatchSelectorStats it restores.
+ */
+class MatchSelectorStatsBinaryReader: boost::noncopyable
+{
+public:
+    explicit MatchSelectorStatsBinaryReader(std::istream &is);
+
+    bool getCollectCycleStats() const {return collectCycleStats_;}
+    const flowcell::FlowcellLayoutList &getFlowcellLayoutList() const {return flowcellLayoutList_;}
+    const flowcell::BarcodeMetadataList &getBarcodeMetadataList() const {return barcodeMetadataList_;}
+    const flowcell::TileMetadataList &getTileMetadataList() const {return tileMetadataList_;}
+
+    /**
+     * \brief advances to the next row group
+     * \return false when the end marker is reached
+     */
+    bool nextTile();
+    const flowcell::TileMetadata &getTile() const {return tileMetadataList_.at(tileIndex_);}
+    const StatsColumnTable &getTable(const statsColumns::TableId table) const {return tables_.at(table);}
+
+    /**
+     * \brief stores the current row group values in stats. Values not present in the file are left untouched
+     */
+    void restoreTileStats(MatchSelectorStats &stats) const;
+
+    /**
+     * \brief reads all remaining row groups into stats indexed by tile index.
+     */
+    void readAll(std::vector<MatchSelectorStats> &stats);
+
+private:
+    std::istream &is_;
+    bool collectCycleStats_;
+    flowcell::FlowcellLayoutList flowcellLayoutList_;
+    flowcell::BarcodeMetadataList barcodeMetadataList_;
+    flowcell::TileMetadataList tileMetadataList_;
+    std::vector<StatsColumnTable> tables_;
+    unsigned tileIndex_;
+
+    void readHeader();
+};
+
+} //namespace matchSelector
+} //namespace alignment
+} //namespace isaac
+
+#endif //ISAAC_ALIGNMENT_MATCH_SELECTOR_STATS_BINARY_H
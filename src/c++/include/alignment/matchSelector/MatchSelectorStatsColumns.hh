@@ -0,0 +1,132 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file MatchSelectorStatsColumns.hh
+ **
+ ** \brief Columnar layout and encoding of the binary MatchSelector statistics.
+ **
+ ** The binary file consists of a header with the flowcell, read, barcode and tile dictionaries and the
+ ** column names of each table, followed by one row group per tile. Each row group contains the tables
+ ** below. Every value is stored as a variable-length unsigned integer. Signed columns are zigzag-encoded.
+ ** Each column is prefixed with its size in bytes so that the readers can skip the columns they don't need.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef ISAAC_ALIGNMENT_MATCH_SELECTOR_MATCH_SELECTOR_STATS_COLUMNS_H
+#define ISAAC_ALIGNMENT_MATCH_SELECTOR_MATCH_SELECTOR_STATS_COLUMNS_H
+
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "alignment/matchSelector/TileBarcodeStats.hh"
+#include "alignment/matchSelector/TileStats.hh"
+#include "flowcell/ReadMetadata.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+/**
+ * \brief Values of a single table of a row group. Columns are kept encoded, i.e. signed columns are zigzagged
+ */
+struct StatsColumnTable
+{
+    std::vector<std::string> names_;
+    std::vector<bool> signed_;
+    std::vector<std::vector<uint64_t> > columns_;
+
+    std::size_t getRowCount() const {return columns_.empty() ? 0 : columns_.front().size();}
+    void clearRows();
+    /**
+     * \return the column with the given name or 0 if the table does not have it
+     */
+    const std::vector<uint64_t> *findColumn(const std::string &name) const;
+};
+
+namespace statsColumns
+{
+
+static const char MAGIC[] = {'i', 'S', 'A', 'A', 'C', 'S', 'T', 'B'};
+static const unsigned FORMAT_VERSION = 1;
+
+enum TableId
+{
+    // per tile-read-filter counters. Keys: Read, PassesFilter
+    TileReads,
+    // per-cycle counters for the cycles of each read. Keys: Read, PassesFilter, Cycle
+    TileCycles,
+    // per tile-barcode-read-filter counters of non-empty entries. Keys: Barcode, Read, PassesFilter
+    TileBarcodeReads,
+    TABLES_COUNT
+};
+
+/**
+ * \return empty table with the columns of the current format version
+ */
+StatsColumnTable makeTable(const TableId table);
+
+void appendTileRead(StatsColumnTable &table, const unsigned readKey, const bool passesFilter, const TileStats &stats);
+void appendTileCycles(
+    StatsColumnTable &table, const unsigned readKey, const bool passesFilter,
+    const flowcell::ReadMetadata &read, const TileStats &stats);
+void appendTileBarcodeRead(
+    StatsColumnTable &table, const unsigned barcode, const unsigned readKey, const bool passesFilter,
+    const TileBarcodeStats &stats);
+
+typedef std::function<TileStats &(const unsigned readKey, const bool passesFilter)> TileStatsResolver;
+typedef std::function<TileBarcodeStats &(const unsigned barcode, const unsigned readKey, const bool passesFilter)>
+    TileBarcodeStatsResolver;
+
+/**
+ * \brief Columns missing in table are restored as 0. Columns unknown to this version are ignored.
+ */
+void restoreTileReads(const StatsColumnTable &table, const TileStatsResolver &resolve);
+void restoreTileCycles(const StatsColumnTable &table, const TileStatsResolver &resolve);
+void restoreTileBarcodeReads(const StatsColumnTable &table, const TileBarcodeStatsResolver &resolve);
+
+inline uint64_t zigzag(const int64_t value)
+{
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+inline int64_t unzigzag(const uint64_t value)
+{
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+void writeVarint(std::ostream &os, uint64_t value);
+void writeString(std::ostream &os, const std::string &value);
+void writeTable(std::ostream &os, const StatsColumnTable &table);
+void writeSchema(std::ostream &os, const StatsColumnTable &table);
+
+uint64_t readVarint(std::istream &is);
+std::string readString(std::istream &is);
+/**
+ * \brief reads the row group table into a table that has the names initialized from schema
+ */
+void readTable(std::istream &is, StatsColumnTable &table);
+StatsColumnTable readSchema(std::istream &is);
+
+} // namespace statsColumns
+
+} //namespace matchSelector
+} //namespace alignment
+} //namespace isaac
+
+#endif //ISAAC_ALIGNMENT_MATCH_SELECTOR_MATCH_SELECTOR_STATS_COLUMNS_H
@@ -27,6 +27,7 @@
 #include "alignment/matchSelector/MatchSelectorStats.hh"
 #include "alignment/TemplateBuilder.hh"
 #include "common/Threads.hpp"
+#include "common/WorkStealingScheduler.hh"
 #include "flowcell/Layout.hh"
 #include "reference/Contig.hh"
 
@@ -58,13 +59,37 @@ public:
         const bool perTileTls,
         const unsigned detectTemplateBlockSize);
 
+    /**
+     * \brief Prepares detection of template length statistics for the tile. Resets the lane statistics if
+     *        perTileTls is set.
+     *
+     * \return number of barcodes that still need their statistics to be detected. 0 means
+     *         templateLengthThread does not need to be called for the tile.
+     */
+    std::size_t prepareTile(
+        const flowcell::TileMetadata &tileMetadata,
+        std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics);
+
+    /**
+     * \brief Collects alignment models from the tile clusters until all statsToBuild barcode statistics
+     *        stabilize or clusters run out. Any number of compute threads can join.
+     */
     template <typename MatchFinderT>
-    void determineTemplateLengths(
+    void templateLengthThread(
+        const unsigned threadNumber,
+        const flowcell::TileMetadata& tileMetadata,
+        const BclClusters& bclData,
+        const matchFinder::ClusterInfos& clusterInfos,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        std::size_t &statsToBuild,
+        std::vector<alignment::TemplateLengthStatistics>& templateLengthStatistics);
+
+    /**
+     * \brief Finalizes statistics that did not stabilize and records the tile statistics.
+     *        Must be called after all templateLengthThread calls for the tile have returned.
+     */
+    void finalizeTile(
         const flowcell::TileMetadata &tileMetadata,
-        const matchFinder::ClusterInfos &clusterInfos,
-        const std::vector<RestOfGenomeCorrection> &restOfGenomeCorrections,
-        const MatchFinderT &matchFinder,
-        const BclClusters &bclData,
         std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics,
         matchSelector::MatchSelectorStats &stats);
 
@@ -84,20 +109,12 @@ private:
     std::vector<TemplateLengthDistribution> templateLengthDistributions_;
 
     mutable boost::mutex mutex_;
-    unsigned unprocessedClusterId_;
+    // models are applied in cluster order so that the results do not depend on timing. Chunks are handed out in order
+    common::WorkStealingScheduler clusterScheduler_;
     unsigned pendingClusterId_;
     boost::condition_variable stateChangedCondition_;
 
-    template <typename MatchFinderT>
-    void templateLengthThread(
-        const unsigned threadNumber,
-        const flowcell::TileMetadata& tileMetadata,
-        const BclClusters& bclData,
-        const matchFinder::ClusterInfos& clusterInfos,
-        const MatchFinderT& matchFinder,
-        std::size_t &statsToBuild,
-        std::vector<alignment::TemplateLengthStatistics>& templateLengthStatistics);
-
+    static const unsigned CLUSTERS_AT_A_TIME_MIN = 16;
     static const unsigned CLUSTERS_AT_A_TIME = 10000;
     typedef std::pair<unsigned, TemplateLengthDistribution::AlignmentModel> BarcodeAlignmentModel;
 
@@ -115,7 +132,7 @@ private:
         std::vector<alignment::TemplateLengthStatistics>& templateLengthStatistics,
         Cluster& ourThreadCluster,
         TemplateBuilder& ourThreadTemplateBuilder,
-        const MatchFinderT& matchFinder,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
         common::StaticVector<BarcodeAlignmentModel, CLUSTERS_AT_A_TIME>& threadBarcodeModels);
 };
 
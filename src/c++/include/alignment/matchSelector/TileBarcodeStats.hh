@@ -80,6 +80,14 @@ struct TileBarcodeStats
         std::fill(nominalModelCounts_, nominalModelCounts_ + TemplateLengthStatistics::CheckModelLast, 0);
     }
 
+    /**
+     * \return true if nothing has been recorded or aggregated since the last reset
+     */
+    bool empty() const
+    {
+        return !clusterCount_ && !fragmentCount_ && !templateLengthStatisticsSet_ && !templateLengthStatisticsConflicts_;
+    }
+
     uint64_t yield_;
     uint64_t yieldQ30_;
     uint64_t qualityScoreSum_;
@@ -60,6 +60,27 @@ struct TileStats
     {
     }
 
+    /**
+     * \return number of leading cycles that contain all the non-zero per-cycle values
+     */
+    unsigned getCyclesUsed() const
+    {
+        unsigned ret = MAX_CYCLES;
+        while (ret &&
+            !cycleBlanks_[ret - 1] && !cycleUniquelyAlignedBlanks_[ret - 1] &&
+            !cycleMismatches_[ret - 1] && !cycleUniquelyAlignedMismatches_[ret - 1] &&
+            !cycleUniquelyAligned1MismatchFragments_[ret - 1] && !cycleUniquelyAligned2MismatchFragments_[ret - 1] &&
+            !cycleUniquelyAligned3MismatchFragments_[ret - 1] && !cycleUniquelyAligned4MismatchFragments_[ret - 1] &&
+            !cycleUniquelyAlignedMoreMismatchFragments_[ret - 1] &&
+            !cycle1MismatchFragments_[ret - 1] && !cycle2MismatchFragments_[ret - 1] &&
+            !cycle3MismatchFragments_[ret - 1] && !cycle4MismatchFragments_[ret - 1] &&
+            !cycleMoreMismatchFragments_[ret - 1])
+        {
+            --ret;
+        }
+        return ret;
+    }
+
     static const unsigned MAX_CYCLES = 2 * ISAAC_READ_LENGTH_MAX;
     uint64_t cycleBlanks_[MAX_CYCLES];
     uint64_t cycleUniquelyAlignedBlanks_[MAX_CYCLES];
@@ -135,69 +156,63 @@ struct TileStats
 
     const TileStats &operator +=(const TileStats &right)
     {
-        std::transform(cycleBlanks_, cycleBlanks_ + MAX_CYCLES,
-                       right.cycleBlanks_, cycleBlanks_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleMismatches_, cycleMismatches_ + MAX_CYCLES,
-                       right.cycleMismatches_, cycleMismatches_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycle1MismatchFragments_, cycle1MismatchFragments_ + MAX_CYCLES,
-                       right.cycle1MismatchFragments_, cycle1MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycle2MismatchFragments_, cycle2MismatchFragments_ + MAX_CYCLES,
-                       right.cycle2MismatchFragments_, cycle2MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycle3MismatchFragments_, cycle3MismatchFragments_ + MAX_CYCLES,
-                       right.cycle3MismatchFragments_, cycle3MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycle4MismatchFragments_, cycle4MismatchFragments_ + MAX_CYCLES,
-                       right.cycle4MismatchFragments_, cycle4MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleMoreMismatchFragments_, cycleMoreMismatchFragments_ + MAX_CYCLES,
-                       right.cycleMoreMismatchFragments_, cycleMoreMismatchFragments_,
-                       std::plus<uint64_t>());
-
-
-        std::transform(cycleUniquelyAlignedBlanks_, cycleUniquelyAlignedBlanks_ + MAX_CYCLES,
-                       right.cycleUniquelyAlignedBlanks_, cycleUniquelyAlignedBlanks_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleUniquelyAlignedMismatches_, cycleUniquelyAlignedMismatches_ + MAX_CYCLES,
-                       right.cycleUniquelyAlignedMismatches_, cycleUniquelyAlignedMismatches_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleUniquelyAligned1MismatchFragments_, cycleUniquelyAligned1MismatchFragments_ + MAX_CYCLES,
-                       right.cycleUniquelyAligned1MismatchFragments_, cycleUniquelyAligned1MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleUniquelyAligned2MismatchFragments_, cycleUniquelyAligned2MismatchFragments_ + MAX_CYCLES,
-                       right.cycleUniquelyAligned2MismatchFragments_, cycleUniquelyAligned2MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleUniquelyAligned3MismatchFragments_, cycleUniquelyAligned3MismatchFragments_ + MAX_CYCLES,
-                       right.cycleUniquelyAligned3MismatchFragments_, cycleUniquelyAligned3MismatchFragments_,
-                       std::plus<uint64_t>());
-
-        std::transform(cycleUniquelyAligned4MismatchFragments_, cycleUniquelyAligned4MismatchFragments_ + MAX_CYCLES,
-                       right.cycleUniquelyAligned4MismatchFragments_, cycleUniquelyAligned4MismatchFragments_,
-                       std::plus<uint64_t>());
+        add(right, 0, MAX_CYCLES);
+        return *this;
+    }
 
-        std::transform(cycleUniquelyAlignedMoreMismatchFragments_, cycleUniquelyAlignedMoreMismatchFragments_ + MAX_CYCLES,
-                       right.cycleUniquelyAlignedMoreMismatchFragments_, cycleUniquelyAlignedMoreMismatchFragments_,
-                       std::plus<uint64_t>());
+    /**
+     * \brief Same as operator += except that only the cycles in [cyclesBegin, cyclesEnd) are added. Allows
+     *        merging the accumulators that are known to have values in a few cycles only.
+     */
+    void add(const TileStats &right, const unsigned cyclesBegin, const unsigned cyclesEnd)
+    {
+        addCycles(cycleBlanks_, right.cycleBlanks_, cyclesBegin, cyclesEnd);
+        addCycles(cycleMismatches_, right.cycleMismatches_, cyclesBegin, cyclesEnd);
+        addCycles(cycle1MismatchFragments_, right.cycle1MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycle2MismatchFragments_, right.cycle2MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycle3MismatchFragments_, right.cycle3MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycle4MismatchFragments_, right.cycle4MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycleMoreMismatchFragments_, right.cycleMoreMismatchFragments_, cyclesBegin, cyclesEnd);
+
+        addCycles(cycleUniquelyAlignedBlanks_, right.cycleUniquelyAlignedBlanks_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAlignedMismatches_, right.cycleUniquelyAlignedMismatches_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAligned1MismatchFragments_, right.cycleUniquelyAligned1MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAligned2MismatchFragments_, right.cycleUniquelyAligned2MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAligned3MismatchFragments_, right.cycleUniquelyAligned3MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAligned4MismatchFragments_, right.cycleUniquelyAligned4MismatchFragments_, cyclesBegin, cyclesEnd);
+        addCycles(cycleUniquelyAlignedMoreMismatchFragments_, right.cycleUniquelyAlignedMoreMismatchFragments_, cyclesBegin, cyclesEnd);
 
         fragmentCount_ += right.fragmentCount_;
         alignedFragmentCount_ += right.alignedFragmentCount_;
         uniquelyAlignedFragmentCount_ += right.uniquelyAlignedFragmentCount_;
         adapterBases_ += right.adapterBases_;
+    }
 
-        return *this;
+    /**
+     * \brief Same as reset except that only the cycles in [cyclesBegin, cyclesEnd) are cleared
+     */
+    void reset(const unsigned cyclesBegin, const unsigned cyclesEnd)
+    {
+        clearCycles(cycleBlanks_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleMismatches_, cyclesBegin, cyclesEnd);
+        clearCycles(cycle1MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycle2MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycle3MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycle4MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleMoreMismatchFragments_, cyclesBegin, cyclesEnd);
+
+        clearCycles(cycleUniquelyAlignedBlanks_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAlignedMismatches_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAligned1MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAligned2MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAligned3MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAligned4MismatchFragments_, cyclesBegin, cyclesEnd);
+        clearCycles(cycleUniquelyAlignedMoreMismatchFragments_, cyclesBegin, cyclesEnd);
+
+        fragmentCount_ = 0;
+        alignedFragmentCount_ = 0;
+        uniquelyAlignedFragmentCount_ = 0;
+        adapterBases_ = 0;
     }
 
     const TileStats operator +(const TileStats &right) const
@@ -309,6 +324,24 @@ struct TileStats
     }
 
 private:
+    template <typename T>
+    static void addCycles(T *cycles, const T *right, const unsigned cyclesBegin, const unsigned cyclesEnd)
+    {
+        for (unsigned cycle = cyclesBegin; cyclesEnd > cycle; ++cycle)
+        {
+            cycles[cycle] += right[cycle];
+        }
+    }
+
+    template <typename T>
+    static void clearCycles(T *cycles, const unsigned cyclesBegin, const unsigned cyclesEnd)
+    {
+        if (cyclesEnd > cyclesBegin)
+        {
+            std::fill(cycles + cyclesBegin, cycles + cyclesEnd, 0);
+        }
+    }
+
     void incrementCycleMismatches(const unsigned cycle)
     {
         ISAAC_ASSERT_MSG(cycle < MAX_CYCLES, "Cycle number too high.");
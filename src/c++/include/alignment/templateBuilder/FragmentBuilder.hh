@@ -175,6 +175,8 @@ private:
     mutable ReferenceOffsetLists fwMergeBuffers_;
     mutable ReferenceOffsetLists rvMergeBuffers_;
     mutable MatchLists matchLists_;
+    // shared by all the seed searches done for the same cluster
+    mutable SeedHitsCache seedHitsCache_;
     struct BestMatch
     {
         BestMatch (const Match &match, const unsigned mismatches):
@@ -299,7 +301,7 @@ AlignmentType FragmentBuilder::buildBest(
     fragments.clear();
     ISAAC_ASSERT_MSG(!matchLists_.empty(), "empty matches lists");
     const std::size_t uncheckedSeeds = matchFinder.findReadMatches(
-        contigList, cluster, readMetadata, seedRepeatThreshold, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
+        contigList, cluster, readMetadata, seedRepeatThreshold, seedHitsCache_, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
 
     const AlignmentType ret = findBestAlignments(
         contigList, readMetadata, adapterClipper, cluster, withGaps, matchLists_, uncheckedSeeds, fragments);
@@ -333,7 +335,7 @@ AlignmentType FragmentBuilder::buildAllHeadAnchored(
 
     const std::size_t uncheckedSeeds = matchFinder.findHeadAnchoredReadMatches(
         contigList,
-        cluster, readMetadata, filterContigId, seedRepeatThreshold, headLengthMax, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
+        cluster, readMetadata, filterContigId, seedRepeatThreshold, headLengthMax, seedHitsCache_, matchLists_, fwMergeBuffers_, rvMergeBuffers_);
 
     std::size_t count = 0;
     for (unsigned supportingSeeds = matchLists_.size() - 1; 0 != supportingSeeds; --supportingSeeds)
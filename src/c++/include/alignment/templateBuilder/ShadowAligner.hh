@@ -22,6 +22,7 @@
 
 #include <vector>
 #include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
 
 #include "reference/Contig.hh"
 #include "alignment/BandedSmithWaterman.hh"
@@ -111,17 +112,29 @@ private:
      ** Note that this is a really fast and cheap but imperfect to rescue
      ** shadows or mis-aligned reads. The index used to access elements in the
      ** vector is made from a k-mer of length shadowKmerLength_ (the vector has
-     ** 4 ^ shadowKmerLength_ positions). The values in the table at position i
-     ** is the first position in the read where the k-mer was found (-1 if not
-     ** found). Repeats are recorded only once in the table. This allows to
+     ** 4 ^ shadowKmerLength_ positions). The lower 16 bits of the value at position i
+     ** are the first position in the read where the k-mer was found. The upper 16 bits
+     ** are the shadowKmerEpoch_ of the rescue attempt that stored it. Entries from
+     ** earlier attempts are treated as not found, so the table is cleared only when the
+     ** epoch wraps around. Repeats are recorded only once in the table. This allows to
      ** identify extremely quickly if a k-mer in the reference belongs to the
      ** read. The shadowKmerLength_ should stay small enough to ensure that the
-     ** table stays in the L1 cache.
+     ** table stays in the L2 cache.
      **/
-//    std::vector<short> shadowKmerPositions_;
-    common::StaticVector<short, shadowKmerCount_> shadowKmerPositions_;
-    /// Hash all the k-mers of length shadowKmerLength_ into shadowKmerPositions_
+    common::StaticVector<uint32_t, shadowKmerCount_> shadowKmers_;
+    uint32_t shadowKmerEpoch_;
+    static const unsigned SHADOW_KMER_POSITION_BITS = 16;
+    static const uint32_t SHADOW_KMER_POSITION_MASK = (1 << SHADOW_KMER_POSITION_BITS) - 1;
+    static const uint32_t SHADOW_KMER_EPOCH_MAX = (uint32_t(1) << (32 - SHADOW_KMER_POSITION_BITS)) - 1;
+    BOOST_STATIC_ASSERT(ISAAC_READ_LENGTH_MAX <= SHADOW_KMER_POSITION_MASK);
+    /// Hash all the k-mers of length shadowKmerLength_ into shadowKmers_
     unsigned hashShadowKmers(const std::vector<char> &sequence);
+    /**
+     ** \brief One bit per start position in the rescue range. Candidates are marked while scanning
+     ** the reference and collected in ascending order afterwards, which removes the duplicates
+     ** without sorting. The collection leaves all bits reset.
+     **/
+    std::vector<uint32_t> shadowCandidateMask_;
     /**
      ** \brief Cached storage for the candidate start positions of the shadow
      **
@@ -150,23 +150,17 @@ void serialize(std::ostream &os, const std::pair<IteratorT, IteratorT> &pairBegi
 static const unsigned MAX_LANES_PER_FLOWCELL = 8;
 static const unsigned MAX_TILES_PER_LANE = 2048;
 
+/**
+ * \brief SAM header text shared by bam and cram outputs
+ */
 template <typename THeader>
-void serializeHeader(
-    std::ostream &os,
+std::string makeHeaderText(
     const std::vector<std::string>& argv,
     const std::string &description,
     const std::vector<std::string>& headerTags,
     const std::string &bamPuFormat,
     const THeader &header)
 {
-#pragma pack(push, 1)
-    struct Header
-    {
-        char magic[4];
-        int l_text;
-    };
-#pragma pack(pop)
-
     const std::string commandLine(boost::join(argv, " "));
 
     std::string headerText(
@@ -191,9 +185,7 @@ void serializeHeader(
         headerText += readGroup.getValue() + "\n";
     }
 
-    const typename THeader::RefSeqsType &refSeqs = header.getRefSequences();
-
-    BOOST_FOREACH(const typename THeader::RefSeqType &refSeq, refSeqs)
+    BOOST_FOREACH(const typename THeader::RefSeqType &refSeq, header.getRefSequences())
     {
         std::string sq = "@SQ\tSN:" + refSeq.name() + "\tLN:" + boost::lexical_cast<std::string>(refSeq.length());
 
@@ -215,6 +207,29 @@ void serializeHeader(
         headerText += sq + "\n";
     }
 
+    return headerText;
+}
+
+template <typename THeader>
+void serializeHeader(
+    std::ostream &os,
+    const std::vector<std::string>& argv,
+    const std::string &description,
+    const std::vector<std::string>& headerTags,
+    const std::string &bamPuFormat,
+    const THeader &header)
+{
+#pragma pack(push, 1)
+    struct Header
+    {
+        char magic[4];
+        int l_text;
+    };
+#pragma pack(pop)
+
+    const std::string headerText = makeHeaderText(argv, description, headerTags, bamPuFormat, header);
+    const typename THeader::RefSeqsType &refSeqs = header.getRefSequences();
+
     Header bamHeader ={ {'B','A','M',1}, int(headerText.size())};
 
     if (!os.write(reinterpret_cast<char*>(&bamHeader), sizeof(bamHeader))){
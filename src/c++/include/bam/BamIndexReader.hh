@@ -0,0 +1,94 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BamIndexReader.hh
+ **
+ ** \brief Reader of bai and csi bam index files. Used to find places where bam records begin.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_BAM_BAM_INDEX_READER_HH
+#define iSAAC_BAM_BAM_INDEX_READER_HH
+
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "common/Exceptions.hh"
+
+namespace isaac
+{
+namespace bam
+{
+
+struct BamIndexException : common::IoException
+{
+    BamIndexException(const std::string &message) : common::IoException(EINVAL, message){}
+};
+
+/**
+ * \brief bgzf virtual offset (compressed offset << 16 | uncompressed offset within the block)
+ */
+typedef uint64_t BgzfVirtualOffset;
+inline uint64_t getCompressedOffset(const BgzfVirtualOffset vo) {return vo >> 16;}
+inline unsigned getUncompressedOffset(const BgzfVirtualOffset vo) {return vo & 0xFFFF;}
+
+/**
+ * \brief Region of the bam file. end is the virtual offset of the first record that does not belong to
+ *        the region or END_OF_FILE. begin 0 means the region includes the bam header
+ */
+struct BamFileRegion
+{
+    static const BgzfVirtualOffset END_OF_FILE = -1UL;
+    BamFileRegion(BgzfVirtualOffset begin, BgzfVirtualOffset end) : begin_(begin), end_(end){}
+    BgzfVirtualOffset begin_;
+    BgzfVirtualOffset end_;
+
+    friend std::ostream &operator <<(std::ostream &os, const BamFileRegion &region)
+    {
+        return os << "BamFileRegion(" <<
+            getCompressedOffset(region.begin_) << ":" << getUncompressedOffset(region.begin_) << "-" <<
+            getCompressedOffset(region.end_) << ":" << getUncompressedOffset(region.end_) << ")";
+    }
+};
+
+typedef std::vector<BamFileRegion> BamFileRegions;
+
+class BamIndexReader
+{
+    /// sorted unique offsets at which bam records are known to begin
+    std::vector<BgzfVirtualOffset> recordOffsets_;
+public:
+    /**
+     * \brief Loads bai or csi index. The format is determined by the magic
+     */
+    explicit BamIndexReader(const boost::filesystem::path &indexPath);
+
+    /**
+     * \return path of the index accompanying the bam file or empty path if none is found
+     */
+    static boost::filesystem::path findIndex(const boost::filesystem::path &bamPath);
+
+    /**
+     * \brief Splits bam file into regions of at least minRegionCompressedBytes each. The regions follow
+     *        each other in the file order and together cover all the records of the bam file.
+     */
+    BamFileRegions makeRegions(const uint64_t minRegionCompressedBytes) const;
+
+    const std::vector<BgzfVirtualOffset> &getRecordOffsets() const {return recordOffsets_;}
+};
+
+} // namespace bam
+} // namespace isaac
+
+#endif // #ifndef iSAAC_BAM_BAM_INDEX_READER_HH
@@ -266,6 +266,15 @@ public:
         referenceSequencesToSkip_ = -1;
     }
 
+    /**
+     * \brief prepare for parsing data that starts at a bam record rather than at the beginning of the file
+     */
+    void resetNoHeader()
+    {
+        headerBytesToSkip_ = 0;
+        referenceSequencesToSkip_ = 0;
+    }
+
     template <typename CollectorT>
     bool parse(
         std::vector<char>::const_iterator &uncompressedIt,
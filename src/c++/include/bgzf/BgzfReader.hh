@@ -68,8 +68,10 @@ public:
     {
         memset(&strm_, 0, sizeof(strm_));
     }
-    unsigned readNextBlock(std::istream &is);
+    unsigned readNextBlock(std::istream &is, const uint64_t compressedBytesMax = -1UL);
     void uncompressCurrentBlock(char* p, const std::size_t size);
+    /// number of compressed bytes consumed by the last readNextBlock
+    std::size_t getCompressedSize() const {return compressedBlockBuffer_.size();}
 
     void reserveBuffers()
     {
@@ -125,6 +127,13 @@ class ParallelBgzfReader
     uint64_t pendingBlockSize_;
     /// offset where the next bam block should decompress
     uint64_t nextUncompressedOffset_;
+    /// offset of the next bgzf block in the compressed file
+    uint64_t compressedOffset_;
+    /// compressed offset of the bgzf block containing the end of the range or -1UL
+    uint64_t endCompressedOffset_;
+    /// number of uncompressed bytes of the block at endCompressedOffset_ that belong to the range
+    unsigned endUncompressedBytes_;
+    bool endOfRange_;
 
     boost::mutex stateMutex_;
     boost::condition_variable stateChangedCondition_;
@@ -144,6 +153,10 @@ public:
         threadBlockSizes_(readers_.size(), -1UL),
         pendingBlockSize_(0),
         nextUncompressedOffset_(0),
+        compressedOffset_(0),
+        endCompressedOffset_(-1UL),
+        endUncompressedBytes_(0),
+        endOfRange_(false),
         loadSlotAvailable_(true),
         computeSlotsAvailable_(readers_.size())
     {
@@ -152,14 +165,25 @@ public:
 
     // this set of functions uses internal stream. Take care of not calling them if you are maintaining stream externally
     void open(const boost::filesystem::path &bamPath);
+    /**
+     * \brief open the file for reading of the data between compressedBegin and the first endUncompressedBytes
+     *        of the block at endCompressedOffset. Both compressed offsets must point at a bgzf block boundary.
+     */
+    void open(
+        const boost::filesystem::path &bamPath,
+        const uint64_t compressedBegin,
+        const uint64_t endCompressedOffset,
+        const unsigned endUncompressedBytes);
     bool readMoreData(std::vector<char> &buffer);
     std::size_t readMoreData(char *buffer, const std::size_t capacity);
     bool isEof() {return isEof(is_);}
 
     // this set of functions to be used for clients that own their streams
     std::size_t readMoreData(std::istream &is, char *buffer, const std::size_t capacity);
-    bool isEof(std::istream &is) const {return !pendingBlockSize_ && is.eof();}
+    bool isEof(std::istream &is) const {return !pendingBlockSize_ && noMoreBlocks(is);}
 private:
+    bool noMoreBlocks(std::istream &is) const {return endOfRange_ || is.eof();}
+    unsigned readNextBlock(BgzfReader &reader, std::istream &is);
     void readMoreDataParallel(const unsigned threadNumber, std::istream &is, char *buffer, std::size_t bufferMax, std::size_t &decompressed);
 
     void waitForLoadSlot(boost::unique_lock<boost::mutex> &lock);
@@ -29,6 +29,7 @@
 #include "build/BinData.hh"
 #include "build/FragmentIndex.hh"
 #include "build/PackedFragmentBuffer.hh"
+#include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/TileMetadata.hh"
 
 
@@ -74,7 +75,8 @@ public:
     }
 
     void prepareForBam(
-        const reference::ContigList &contigList,
+        const reference::ContigLists &contigLists,
+        const flowcell::BarcodeMetadataList &barcodeMetadataList,
         PackedFragmentBuffer &data,
         BinData::IndexType &dataIndex,
         alignment::Cigar &splitCigars,
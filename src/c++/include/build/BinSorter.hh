@@ -59,6 +59,7 @@ public:
             singleLibrarySamples_(singleLibrarySamples),
             keepDuplicates_(keepDuplicates),
             markDuplicates_(markDuplicates),
+            barcodeMetadataList_(barcodeMetadataList),
             contigLists_(contigLists),
             bamSerializer_(barcodeBamMapping.getSampleIndexMap(), splitGapLength)
     {
@@ -77,6 +78,7 @@ private:
     const bool singleLibrarySamples_;
     const bool keepDuplicates_;
     const bool markDuplicates_;
+    const flowcell::BarcodeMetadataList &barcodeMetadataList_;
     const reference::ContigLists &contigLists_;
     BamSerializer bamSerializer_;
 
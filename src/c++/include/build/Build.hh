@@ -32,6 +32,8 @@
 #include "build/BuildStats.hh"
 #include "build/BuildContigMap.hh"
 #include "common/Threads.hpp"
+#include "cram/CramEncoder.hh"
+#include "cram/CramIndex.hh"
 #include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/Layout.hh"
 #include "flowcell/TileMetadata.hh"
@@ -45,6 +47,14 @@ namespace isaac
 namespace build
 {
 
+enum OutputFormat
+{
+    /// bgzf-compressed bam with .bai index
+    OUTPUT_BAM,
+    /// CRAM 3.0 with .crai index
+    OUTPUT_CRAM
+};
+
 class Build
 {
     const std::vector<std::string> &argv_;
@@ -62,6 +72,7 @@ class Build
     unsigned allocatedBins_;
     std::vector<unsigned> computeSlotWaitingBins_;
     const unsigned maxSavers_;
+    const OutputFormat outputFormat_;
     const int bamGzipLevel_;
     const std::string &bamPuFormat_;
     const bool bamProduceMd5_;
@@ -95,6 +106,8 @@ class Build
     demultiplexing::BarcodePathMap barcodeBamMapping_;
     //[output file], one stream per bam file path
     boost::ptr_vector<bam::BamIndex> bamIndexes_;
+    //[output file], used instead of bamIndexes_ for cram output
+    boost::ptr_vector<cram::CramIndex> cramIndexes_;
     std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > bamFileStreams_;
 
     BuildStats stats_;
@@ -106,6 +119,10 @@ class Build
     // Geometry: [thread][bam file]. Streams for compressing bam data into threadBgzfBuffers_
     boost::ptr_vector<boost::ptr_vector<boost::iostreams::filtering_ostream> > threadBgzfStreams_;
     boost::ptr_vector<boost::ptr_vector<bam::BamIndexPart> > threadBamIndexParts_;
+    // Geometry: [output file][bam refId]. Reference bases for cram sequence compression
+    std::vector<cram::ReferenceSequences> cramReferences_;
+    // Geometry: [thread][output file]. Containers encoded from uncompressed bam data of threadBgzfBuffers_
+    std::vector<std::vector<cram::Containers> > threadCramContainers_;
 
     const build::gapRealigner::Gaps knownIndels_;
     ParallelGapRealigner gapRealigner_;
@@ -146,6 +163,7 @@ public:
           const build::GapRealignerMode realignGaps,
           const unsigned realignMapqMin,
           const boost::filesystem::path &knownIndelsPath,
+          const OutputFormat outputFormat,
           const int bamGzipLevel,
           const std::string &bamPuFormat,
           const bool bamProduceMd5,
@@ -185,7 +203,12 @@ private:
     std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> >  createOutputFileStreams(
         const flowcell::TileMetadataList &tileMetadataList,
         const flowcell::BarcodeMetadataList &barcodeMetadataList,
-        boost::ptr_vector<bam::BamIndex> &bamIndexes) const;
+        boost::ptr_vector<bam::BamIndex> &bamIndexes,
+        boost::ptr_vector<cram::CramIndex> &cramIndexes) const;
+
+    std::vector<cram::ReferenceSequences> makeCramReferences() const;
+
+    void encodeCramContainers(const std::size_t threadNumber);
 
     void reserveBuffers(
         boost::unique_lock<boost::mutex> &lock,
@@ -276,6 +299,12 @@ private:
         bam::BamIndex &bamIndex,
         const boost::filesystem::path &filePath);
 
+    void saveContainers(
+        const cram::Containers &containers,
+        std::ostream &cramStream,
+        cram::CramIndex &cramIndex,
+        const boost::filesystem::path &filePath);
+
     uint64_t estimateBinCompressedDataRequirements(
         const alignment::BinMetadata & binMetadata,
         const unsigned outputFileIndex) const;
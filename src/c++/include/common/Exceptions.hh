@@ -171,16 +171,6 @@ public:
     PostConditionException(const std::string &message);
 };
 
-/**
- ** \brief Exception thrown when a libxslt method invocation fails.
- **
- **/
-class LibXsltException: public IsaacException
-{
-public:
-    LibXsltException();
-};
-
 } // namespace common
 } // namespace isaac
 
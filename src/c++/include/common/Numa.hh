@@ -40,6 +40,23 @@ static const int defaultNodeInterleave = -2;
 
 } //namespace numa
 
+enum HugePages
+{
+    HugePagesOff,
+    // madvise(MADV_HUGEPAGE) only
+    HugePagesTransparent,
+    // MAP_HUGETLB with fallback to transparent huge pages
+    HugePages2M,
+    // same as HugePages2M except that allocations of 1GB and more go into 1GB pages
+    HugePages1G,
+};
+
+/**
+ * \brief Makes NumaAllocator put allocations of 2MB and more into huge pages. The NUMA node policy of the allocator
+ *        still applies. Call once at the process startup before anything is allocated with NumaAllocator.
+ */
+void hugePagesInitialize(const HugePages hugePages);
+
 /**
  * \brief attempts to initialize NUMA-aware memory management.
  *
@@ -171,7 +188,7 @@ public:
     NumaAllocator() throw() :node_(defaultNode) { }
     explicit NumaAllocator(const int node) throw() :node_(node) { }
 
-    NumaAllocator(const NumaAllocator&) throw() { }
+    NumaAllocator(const NumaAllocator& that) throw() :node_(that.node_) { }
 
     template<typename Tp1>
     NumaAllocator(const NumaAllocator<Tp1, defaultNode>& that) throw(): node_(that.node_) { }
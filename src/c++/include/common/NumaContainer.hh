@@ -20,6 +20,9 @@
 #ifndef iSAAC_COMMON_NUMA_CONTAINER_HH
 #define iSAAC_COMMON_NUMA_CONTAINER_HH
 
+#include <memory>
+#include <vector>
+
 #include <boost/foreach.hpp>
 
 #include "common/config.h"
@@ -39,40 +42,51 @@ namespace isaac
 namespace common
 {
 
-template <typename ReplicaT>
+/**
+ * \brief Keeps one copy of ReplicaT on each NUMA node so that threads bound to a node read local memory
+ *
+ * ReplicaT must be constructible from (const ReplicaT &, const AllocatorT &) with AllocatorT(node) placing the
+ * copy on the node.
+ */
+template <typename ReplicaT, typename AllocatorT = common::NumaAllocator<void, 0> >
 class NumaContainerReplicas
 {
     std::vector<ReplicaT> nodeContainers_;
 public:
-    NumaContainerReplicas(ReplicaT &&node0Container)
+    /**
+     * \param replicate    when false, or when NUMA is unavailable, node0Container is shared by threads of all nodes
+     */
+    NumaContainerReplicas(ReplicaT &&node0Container, const bool replicate = true)
     {
-        if (common::isNumaAvailable())
+        const int nodes = replicate && common::isNumaAvailable() ? getNumaNodeCount() : 1;
+        nodeContainers_.reserve(nodes);
+        nodeContainers_.push_back(std::move(node0Container));
+        if (1 < nodes)
         {
-            const int nodes = getNumaNodeCount();
-
-            nodeContainers_.reserve(nodes);
-//            ISAAC_THREAD_CERR << "before std::move(node0Container)" << std::endl;
-            nodeContainers_.push_back(std::move(node0Container));
-//            ISAAC_THREAD_CERR << "after std::move(node0Container)" << std::endl;
+            // thread n of the vector is bound to node n. Each one copies the replica for its own node
+            // so that the nodes get populated in parallel.
+            std::vector<std::unique_ptr<ReplicaT> > replicas(nodes);
+            SafeThreadVector replicators(nodes);
+            replicators.execute([this, &replicas](const unsigned threadNumber, const unsigned)
+            {
+                if (threadNumber)
+                {
+                    replicas.at(threadNumber).reset(new ReplicaT(nodeContainers_.front(), AllocatorT(threadNumber)));
+                }
+            });
             for (int node = 1; node < nodes; ++node)
             {
-//                ISAAC_THREAD_CERR << "before creating replica from " << typeid(nodeContainers_.front()).name() <<
-//                    " for node " << node << std::endl;
-                ReplicaT replica(nodeContainers_.front(), common::NumaAllocator<void, 0> (node));
-//                ISAAC_THREAD_CERR << "before nodeContainers_.push_back(). replica of type " << typeid(replica).name() << std::endl;
-                nodeContainers_.push_back(std::move(replica));
-//                ISAAC_THREAD_CERR << "after nodeContainers_.push_back()" << std::endl;
+                nodeContainers_.push_back(std::move(*replicas.at(node)));
             }
         }
-        else
-        {
-            nodeContainers_.push_back(std::move(node0Container));
-        }
     }
 
+    bool isReplicated() const {return 1 < nodeContainers_.size();}
     const ReplicaT &node0Container() const {return nodeContainers_.front();}
-    const ReplicaT &threadNodeContainer() const {return nodeContainers_.at(common::ThreadVector::getThreadNumaNode());}
-//        return hashes_[(common::ThreadVector::getThreadNumaNode()+1) % 2].findMatches(kmer);
+    const ReplicaT &threadNodeContainer() const
+    {
+        return isReplicated() ? nodeContainers_.at(common::ThreadVector::getThreadNumaNode()) : nodeContainers_.front();
+    }
 };
 
 } //namespace common
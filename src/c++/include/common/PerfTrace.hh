@@ -0,0 +1,107 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file PerfTrace.hh
+ **
+ ** Per-stage begin/end event recording for performance analysis. Events go into preallocated per-thread
+ ** ring buffers and are dumped as Chrome trace json plus per-stage aggregates at the end of the run.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_COMMON_PERF_TRACE_HH
+#define iSAAC_COMMON_PERF_TRACE_HH
+
+#include <stdint.h>
+
+#include <boost/filesystem.hpp>
+
+namespace isaac
+{
+namespace common
+{
+namespace perf
+{
+
+/**
+ * \brief Turns tracing on. Must be called before any threads that need tracing are created.
+ *
+ * \param eventsPerThread   ring buffer capacity. When exceeded, the oldest events are overwritten but still
+ *                          accounted in the per-stage aggregates
+ */
+void enable(const std::size_t eventsPerThread);
+
+/**
+ * \brief Turns tracing off and discards the recorded events. Must not be called while traced threads are recording.
+ *        Threads that had buffers attached get new ones if they record after tracing is enabled again.
+ */
+void disable();
+
+bool enabled();
+
+/// monotonic time in nanoseconds
+uint64_t now();
+
+/**
+ * \brief Assigns ring buffer to the calling thread. Allocates only when no previously released buffer is
+ *        available. ThreadVector calls this once for each thread it creates, before any work is given.
+ */
+void attachThread();
+
+/**
+ * \brief Returns the ring buffer of the calling thread to the pool. Recorded events are retained until dump.
+ */
+void detachThread();
+
+/**
+ * \brief Records completed stage. stage is expected to be a string literal
+ */
+void record(const char *stage, const uint64_t beginNs, const uint64_t endNs);
+
+/**
+ * \brief Stores PerfTrace.json (chrome://tracing format) and PerfStages.tsv in the directory. Must not be called
+ *        while traced threads are running.
+ */
+void dump(const boost::filesystem::path &directory);
+
+/**
+ * \brief Records the lifetime of the object as one event when tracing is enabled
+ */
+class ScopedEvent
+{
+    const char *stage_;
+    uint64_t begin_;
+public:
+    explicit ScopedEvent(const char *stage) : stage_(stage), begin_(enabled() ? now() : 0) {}
+    ~ScopedEvent()
+    {
+        if (begin_)
+        {
+            record(stage_, begin_, now());
+        }
+    }
+};
+
+} // namespace perf
+} // namespace common
+} // namespace isaac
+
+#define ISAAC_PERF_TRACE_CONCAT_IMPL(a, b) a##b
+#define ISAAC_PERF_TRACE_CONCAT(a, b) ISAAC_PERF_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * \brief Traces the rest of the enclosing scope as a stage
+ */
+#define ISAAC_PERF_SCOPE(stage) \
+    const isaac::common::perf::ScopedEvent ISAAC_PERF_TRACE_CONCAT(perfTraceScope_, __LINE__)(stage)
+
+#endif // #ifndef iSAAC_COMMON_PERF_TRACE_HH
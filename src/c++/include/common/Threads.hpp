@@ -26,6 +26,7 @@
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
 #include "common/Numa.hh"
+#include "common/PerfTrace.hh"
 
 namespace isaac {
 namespace common {
@@ -322,6 +323,8 @@ private:
         runOnNode_ = common::bindCurrentThreadToNumaNode(
             common::numa::defaultNodeInterleave == targetNumaNode_ ?
                 common::getThreadInterleaveNumaNode(threadNum) : targetNumaNode_);
+        // trace buffers are allocated before any work is given to the thread
+        common::perf::attachThread();
 
 //        setitimer(ITIMER_PROF, &itimer_, NULL);
 //        ISAAC_THREAD_CERR << "thread " << threadNum << " created\n";
@@ -357,6 +360,7 @@ private:
                 }
             }
         }
+        common::perf::detachThread();
 
 //        ISAAC_THREAD_CERR << "thread " << threadNum << " terminated\n";
     }
@@ -0,0 +1,108 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file WorkStealingScheduler.hh
+ **
+ ** \brief Hands out chunks of an index range to a fixed set of threads.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_COMMON_WORK_STEALING_SCHEDULER_HH
+#define iSAAC_COMMON_WORK_STEALING_SCHEDULER_HH
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace isaac
+{
+namespace common
+{
+
+/**
+ * \brief Splits [0, items) between threads and hands it out in chunks.
+ *
+ * Each thread owns a contiguous part of the range and claims chunks from its front. A thread that runs out
+ * takes the back half of the largest remaining part of another thread. The chunk size of each thread adapts so
+ * that a chunk takes about chunkSeconds to process, which keeps the locking rare for cheap items and the
+ * imbalance small for expensive ones.
+ *
+ * In ordered mode all threads claim chunks from the front of one shared range. Chunks are then handed out in
+ * increasing order which is required when results must be applied in the order of items.
+ */
+class WorkStealingScheduler: boost::noncopyable
+{
+public:
+    WorkStealingScheduler(
+        const unsigned threads,
+        const unsigned chunkMin,
+        const unsigned chunkMax,
+        const double chunkSeconds);
+
+    /**
+     * \brief Prepares for handing out [0, items). Must not be called while any thread is in next.
+     *        Chunk sizes learned so far are kept.
+     */
+    void reset(const uint64_t items, const bool ordered);
+
+    /**
+     * \brief Claims the next chunk for the thread. The time since the previous successful claim of the same
+     *        thread is taken as the cost of the previous chunk.
+     *
+     * \return false if no more items are available to any thread
+     */
+    bool next(const unsigned threadNumber, uint64_t &begin, uint64_t &end);
+
+    unsigned getChunkSize(const unsigned threadNumber) const {return threads_.at(threadNumber).chunk_;}
+    uint64_t getSteals() const {return steals_;}
+
+private:
+    struct ThreadRange
+    {
+        ThreadRange() : begin_(0), end_(0), remaining_(0), chunk_(0), claimedNs_(0), claimedItems_(0) {}
+
+        // protects begin_ and end_
+        boost::mutex mutex_;
+        uint64_t begin_;
+        uint64_t end_;
+        // end_ - begin_ for choosing the victim without locking every range
+        std::atomic<uint64_t> remaining_;
+
+        // owned by the thread itself
+        unsigned chunk_;
+        uint64_t claimedNs_;
+        uint64_t claimedItems_;
+
+        // keep ranges of different threads in different cache lines
+        char padding_[64];
+    };
+
+    const unsigned chunkMin_;
+    const unsigned chunkMax_;
+    const double chunkSeconds_;
+    bool ordered_;
+    std::vector<ThreadRange> threads_;
+    std::atomic<uint64_t> steals_;
+
+    void adaptChunk(ThreadRange &thread);
+    bool claim(ThreadRange &range, const unsigned chunk, uint64_t &begin, uint64_t &end);
+    bool steal(const unsigned threadNumber, uint64_t &begin, uint64_t &end);
+};
+
+} // namespace common
+} // namespace isaac
+
+#endif // #ifndef iSAAC_COMMON_WORK_STEALING_SCHEDULER_HH
@@ -0,0 +1,173 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Cram.hh
+ **
+ ** CRAM 3.0 file structure primitives: integer encodings, blocks and containers.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_CRAM_CRAM_HH
+#define iSAAC_CRAM_CRAM_HH
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/array.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+typedef std::vector<char> Bytes;
+
+enum BlockMethod
+{
+    RAW = 0,
+    GZIP = 1
+};
+
+enum BlockContentType
+{
+    FILE_HEADER = 0,
+    COMPRESSION_HEADER = 1,
+    MAPPED_SLICE = 2,
+    EXTERNAL_DATA = 4,
+    CORE_DATA = 5
+};
+
+/// Slice and container reference id for records that are not placed on the reference
+static const int UNMAPPED_REF_ID = -1;
+
+inline void appendByte(Bytes &bytes, const unsigned char value)
+{
+    bytes.push_back(value);
+}
+
+inline void appendInt32(Bytes &bytes, const int value)
+{
+    const unsigned u = value;
+    bytes.push_back(u);
+    bytes.push_back(u >> 8);
+    bytes.push_back(u >> 16);
+    bytes.push_back(u >> 24);
+}
+
+/**
+ * \brief CRAM variable length encoding of 32 bit integers. Number of leading 1 bits in the
+ *        first byte tells how many more bytes follow.
+ */
+void appendItf8(Bytes &bytes, const int value);
+/**
+ * \brief Same as itf8 but for 64 bit integers.
+ */
+void appendLtf8(Bytes &bytes, const int64_t value);
+
+inline void appendBytes(Bytes &bytes, const char *begin, const char *end)
+{
+    bytes.insert(bytes.end(), begin, end);
+}
+
+inline void appendBytes(Bytes &bytes, const Bytes &that)
+{
+    bytes.insert(bytes.end(), that.begin(), that.end());
+}
+
+/**
+ * \brief appends length-prefixed array of itf8
+ */
+void appendItf8Array(Bytes &bytes, const std::vector<int> &values);
+
+/**
+ * \brief serializes the block header, data and crc32. Data is compressed with gzip if method is GZIP and
+ *        it actually makes data smaller.
+ */
+void appendBlock(
+    Bytes &bytes,
+    BlockMethod method,
+    const BlockContentType contentType,
+    const int contentId,
+    const Bytes &data,
+    const int gzipLevel);
+
+/**
+ * \brief Encoded container holding a single slice. Fields that depend on the position of the
+ *        container in the file (record counter) are filled when the container gets serialized
+ */
+struct Container
+{
+    Container() : refId_(UNMAPPED_REF_ID), start_(0), span_(0), records_(0), bases_(0), dataBlocksCount_(0)
+    {
+        refMd5_.assign(0);
+    }
+
+    int refId_;
+    /// 1-based position of the leftmost alignment
+    int start_;
+    int span_;
+    int records_;
+    int64_t bases_;
+    Bytes compressionHeaderBlock_;
+    /// content ids of the external blocks
+    std::vector<int> contentIds_;
+    boost::array<unsigned char, 16> refMd5_;
+    /// serialized core and external blocks
+    Bytes dataBlocks_;
+    int dataBlocksCount_;
+};
+
+typedef std::vector<Container> Containers;
+
+/**
+ * \brief Bits the index needs to know about the serialized container
+ */
+struct ContainerLayout
+{
+    ContainerLayout() : size_(0), landmark_(0), sliceSize_(0){}
+    /// total number of bytes including the container header
+    uint64_t size_;
+    /// offset of the slice header relative to the end of container header
+    uint64_t landmark_;
+    /// bytes in slice header and slice data blocks
+    uint64_t sliceSize_;
+};
+
+/**
+ * \brief Produces bytes of the container ready to be stored in the file.
+ */
+ContainerLayout serializeContainer(
+    Bytes &bytes,
+    const Container &container,
+    const int64_t recordCounter);
+
+/**
+ * \brief File definition followed by the container holding SAM header text.
+ *
+ * \return number of bytes written
+ */
+uint64_t serializeHeader(std::ostream &os, const std::string &fileId, const std::string &headerText);
+
+/**
+ * \brief Writes the standard CRAM 3.0 end-of-file container
+ */
+void serializeEof(std::ostream &os);
+
+} // namespace cram
+} // namespace isaac
+
+#endif // #ifndef iSAAC_CRAM_CRAM_HH
@@ -0,0 +1,96 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file CramEncoder.hh
+ **
+ ** Converts serialized bam records into CRAM 3.0 containers.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_CRAM_CRAM_ENCODER_HH
+#define iSAAC_CRAM_CRAM_ENCODER_HH
+
+#include <map>
+
+#include "cram/Cram.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+/**
+ * \brief Reference bases of a contig. Index in the list is the bam refID
+ */
+struct ReferenceSequence
+{
+    ReferenceSequence(const char *begin, const std::size_t length) : begin_(begin), length_(length) {}
+    const char *begin_;
+    std::size_t length_;
+};
+
+typedef std::vector<ReferenceSequence> ReferenceSequences;
+
+/**
+ * \brief Produces one single-slice container per run of up to RECORDS_PER_CONTAINER_MAX records placed on
+ *        the same contig. Sequences of mapped records are stored as differences against the reference.
+ *
+ * All records are stored as detached, so that containers can be produced independently for each bin. Each
+ * data series and each tag goes into its own external block compressed with gzip.
+ */
+class CramEncoder
+{
+public:
+    static const int RECORDS_PER_CONTAINER_MAX = 10000;
+
+    CramEncoder(const ReferenceSequences &references, const int gzipLevel);
+
+    /**
+     * \brief Encodes the bam records found in [bamBegin, bamEnd). Each record is expected to be
+     *        prefixed with block_size as in a bam file.
+     */
+    void encode(const char *bamBegin, const char *bamEnd, Containers &containers);
+
+private:
+    enum DataSeries
+    {
+        BF = 1, CF, RL, AP, RG, RN, MF, NS, NP, TS, TL, FN, FC, FP, BS, IN, SC, DL, RS, HC, PD, BA, QS, MQ,
+        DATA_SERIES_END
+    };
+
+    const ReferenceSequences &references_;
+    const int gzipLevel_;
+
+    std::vector<Bytes> series_;
+    // tag key to content id and data
+    std::map<int, std::pair<int, Bytes> > tagBlocks_;
+    // tag line to its index in the dictionary
+    std::map<std::string, int> tagLines_;
+    std::vector<std::string> tagDictionary_;
+
+    const char *encodeContainer(const char *begin, const char *end, Container &container);
+    void encodeRecord(const char *record, const int refId);
+    void encodeTags(const char *tagsBegin, const char *tagsEnd);
+    void encodeFeatures(
+        const char *record, const char *contigBegin, const std::size_t contigLength, const bool hasQualities);
+    void makeCompressionHeader(Container &container) const;
+    void makeDataBlocks(Container &container) const;
+
+    void put(const DataSeries ds, const int value) {appendItf8(series_[ds], value);}
+    void putByte(const DataSeries ds, const char value) {series_[ds].push_back(value);}
+};
+
+} // namespace cram
+} // namespace isaac
+
+#endif // #ifndef iSAAC_CRAM_CRAM_ENCODER_HH
@@ -0,0 +1,71 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file CramIndex.hh
+ **
+ ** Keeps track of container placement in the cram file and produces the .crai index.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_CRAM_CRAM_INDEX_HH
+#define iSAAC_CRAM_CRAM_INDEX_HH
+
+#include <boost/filesystem.hpp>
+
+#include "cram/Cram.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+class CramIndex
+{
+    struct Entry
+    {
+        int refId_;
+        int start_;
+        int span_;
+        uint64_t containerOffset_;
+        uint64_t sliceOffset_;
+        uint64_t sliceSize_;
+    };
+
+    boost::filesystem::path cramPath_;
+    uint64_t fileOffset_;
+    int64_t recordCounter_;
+    std::vector<Entry> entries_;
+
+public:
+    CramIndex() : fileOffset_(0), recordCounter_(0) {}
+    CramIndex(const boost::filesystem::path &cramPath, const uint64_t headerLength) :
+        cramPath_(cramPath), fileOffset_(headerLength), recordCounter_(0) {}
+
+    /// number of records stored in the file so far
+    int64_t getRecordCounter() const {return recordCounter_;}
+
+    /**
+     * \brief Accounts for the container appended to the end of the file
+     */
+    void processContainer(const Container &container, const ContainerLayout &layout);
+
+    /**
+     * \brief Stores gzip-compressed .crai next to the cram file
+     */
+    void flush() const;
+};
+
+} // namespace cram
+} // namespace isaac
+
+#endif // #ifndef iSAAC_CRAM_CRAM_INDEX_HH
@@ -21,6 +21,7 @@
 #define iSAAC_BUILD_BARCODE_BAM_HH
 
 #include <iterator>
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
 #include "common/FileSystem.hh"
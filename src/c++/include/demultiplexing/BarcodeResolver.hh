@@ -20,6 +20,7 @@
 #ifndef iSAAC_DEMULTIPLEXING_BARCODE_RESOLVER_HH
 #define iSAAC_DEMULTIPLEXING_BARCODE_RESOLVER_HH
 
+#include "common/Threads.hpp"
 #include "demultiplexing/Barcode.hh"
 #include "demultiplexing/DemultiplexingStats.hh"
 #include "flowcell/BarcodeMetadata.hh"
@@ -30,18 +31,33 @@ namespace isaac
 namespace demultiplexing
 {
 
+/**
+ * \brief Resolves cluster barcodes to sample barcodes of a lane.
+ *
+ * When 5^barcodeLength fits into DIRECT_LOOKUP_ENTRIES_MAX, every possible barcode sequence has a slot in a
+ * directly indexed table. Otherwise each index component gets own table mapping its sequence to the distinct
+ * component sequence of the sample sheet it is within mismatches of. The sample is then found by the combination
+ * of the component sequences. Components that are too long for a table or are within mismatches of more than one
+ * sample sheet component are resolved by comparing against every sample barcode.
+ */
 class BarcodeResolver: boost::noncopyable
 {
 public:
+    /// 5 is the number of values a base can take including N
+    static const unsigned BASE_VARIANTS = oligo::INVALID_OLIGO + 1;
+    static const uint64_t DIRECT_LOOKUP_ENTRIES_MAX = 1UL << 24;
+
     BarcodeResolver(
         const flowcell::BarcodeMetadataList &allBarcodeMetadata,
         const flowcell::BarcodeMetadataList &barcodeGroup);
 
     /**
-     * \brief updates the tile information in 'result' with the corresponding barcodeMetadataList_ indexes
+     * \brief updates the tile information in 'result' with the corresponding barcodeMetadataList_ indexes.
+     *        Lookups are done in parallel batches, statistics are collected on the calling thread.
      */
     void resolve(
         Barcodes &barcodes,
+        common::ThreadVector &threads,
         demultiplexing::DemultiplexingStats &demultiplexingStats);
 
     static unsigned getMismatchKmersCount(const unsigned kmerLength, const unsigned maxMismatches);
@@ -61,12 +77,83 @@ public:
                                                       const unsigned componentOffset,
                                                       const unsigned iteration);
 
+    /**
+     * \return number of bases that differ between the two kmers
+     */
+    static unsigned countMismatches(const Kmer left, const Kmer right)
+    {
+        // one bit per base: 001001...001
+        static const Kmer BASE_LOW_BITS = 0x1249249249249249UL;
+        const Kmer diff = left ^ right;
+        return __builtin_popcountll((diff | (diff >> 1) | (diff >> 2)) & BASE_LOW_BITS);
+    }
+
 private:
+    struct SampleBarcode
+    {
+        Kmer sequence_;
+        unsigned barcodeIndex_;
+        std::vector<unsigned> componentMismatches_;
+    };
+    typedef std::vector<SampleBarcode> SampleBarcodes;
+
+    /**
+     * \brief Table entries are 0 for no match, (sample + 1) << MISMATCHES_BITS | mismatches for a match.
+     *        Sample is the index in samples_ for the whole-barcode table and the index of the distinct component
+     *        sequence in the component tables.
+     */
+    typedef uint16_t LookupEntry;
+    typedef std::vector<LookupEntry> LookupTable;
+    static const unsigned MISMATCHES_BITS = 3;
+    static const LookupEntry MISMATCHES_MASK = (1 << MISMATCHES_BITS) - 1;
+    static const LookupEntry AMBIGUOUS_ENTRY = LookupEntry(-1);
+    // largest sample index a table entry can hold without turning into AMBIGUOUS_ENTRY
+    static const unsigned LOOKUP_SAMPLES_MAX = (AMBIGUOUS_ENTRY >> MISMATCHES_BITS) - 1;
+
+    enum LookupMode
+    {
+        LookupBarcode,
+        LookupComponents,
+        CompareAll
+    };
+
     const flowcell::BarcodeMetadataList &allBarcodeMetadata_;
-    const Barcodes mismatchBarcodes_;
     const unsigned unknownBarcodeIndex_;
+    // from the first to the last component
+    std::vector<unsigned> componentLengths_;
+    std::vector<unsigned> componentShifts_;
+    unsigned barcodeLength_;
+    SampleBarcodes samples_;
+    LookupMode lookupMode_;
+
+    LookupTable barcodeTable_;
+    std::vector<LookupTable> componentTables_;
+    // for each component, the distinct sequences in the order of their index in component table entries
+    std::vector<std::vector<Kmer> > componentSequences_;
+    // combination of component sequence indexes to the sample index, ordered by the combination
+    std::vector<std::pair<uint64_t, unsigned> > componentSamples_;
+
     std::vector<uint64_t> barcodeHits_;
 
+    void parseSamples(const flowcell::BarcodeMetadataList &barcodeGroup);
+    void checkCollisions() const;
+    void buildBarcodeTable();
+    bool buildComponentTables();
+
+    Kmer getComponent(const Kmer sequence, const unsigned component) const
+    {
+        return (sequence >> componentShifts_[component]) &
+            (~Kmer(0) >> (sizeof(Kmer) * 8 - BITS_PER_BASE * componentLengths_[component]));
+    }
+    static uint64_t getTableIndex(const Kmer sequence, const unsigned length);
+    static uint64_t getTableSize(const unsigned length);
+
+    bool matchSample(const SampleBarcode &sample, const Kmer sequence, unsigned &mismatches) const;
+    bool compareAll(const Kmer sequence, unsigned &sample, unsigned &mismatches) const;
+    bool lookupComponents(const Kmer sequence, unsigned &sample, unsigned &mismatches) const;
+    bool lookup(const Kmer sequence, unsigned &sample, unsigned &mismatches) const;
+    void resolveBatch(Barcodes::iterator begin, const Barcodes::iterator end) const;
+
     Barcodes::iterator recordSameBarcodeHits(
         const Barcodes::iterator dataBarcodeIterator,
         const Barcodes::const_iterator dataBarcodesEnd,
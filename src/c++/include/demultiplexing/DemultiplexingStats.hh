@@ -66,6 +66,8 @@ struct LaneBarcodeStats
 class DemultiplexingStats
 {
 private:
+    template <class Archive> friend void serialize(Archive &ar, DemultiplexingStats &ds, const unsigned int version);
+
     static const unsigned TOTAL_TILES_MAX = 1000;
     const std::vector<flowcell::BarcodeMetadata> &barcodeMetadataList_;
 
@@ -176,6 +178,13 @@ public:
         topUnknownBarcodes_.clear();
     }
 
+    void swap(DemultiplexingStats &that)
+    {
+        ISAAC_ASSERT_MSG(barcodeMetadataList_.size() == that.barcodeMetadataList_.size(), "dimensions must match");
+        topUnknownBarcodes_.swap(that.topUnknownBarcodes_);
+        laneBarcodeStats_.swap(that.laneBarcodeStats_);
+    }
+
     const LaneBarcodeStats &getLaneBarcodeStat(
         const flowcell::BarcodeMetadata& barcode) const
     {
@@ -25,6 +25,7 @@
 
 #include "bgzf/BgzfReader.hh"
 #include "flowcell/ReadMetadata.hh"
+#include "bam/BamIndexReader.hh"
 #include "bam/BamParser.hh"
 #include "reference/ReferencePosition.hh"
 
@@ -58,6 +59,8 @@ class BamLoader
     // overlap the buffer boundary
     std::vector<char> lastPassBam_;
     unsigned lastUnparsedBytes_;
+    // number of bytes to skip in the first decompressed block when reading starts in the middle of it
+    unsigned firstRecordOffset_;
 
     bam::BamParser bamParser_;
 
@@ -80,13 +83,29 @@ public:
 
     void open(const boost::filesystem::path &bamPath)
     {
-        lastUnparsedBytes_ = 0;
-        nextDecompressorThread_ = 0;
-        nextParserThread_ = 0;
         bgzfReader_.open(bamPath);
         bamParser_.reset();
-        std::fill(unparsedBytes_.begin(), unparsedBytes_.end(), 0);
-        std::for_each(decompressionBuffers_.begin(), decompressionBuffers_.end(), boost::bind(&std::vector<char>::clear, _1));
+        reset(0);
+    }
+
+    /**
+     * \brief Limits the parsing to the records of the region. If the region does not start at the beginning of the
+     *        file, the data is expected to start at a bam record.
+     */
+    void open(const boost::filesystem::path &bamPath, const bam::BamFileRegion &region)
+    {
+        bgzfReader_.open(
+            bamPath, bam::getCompressedOffset(region.begin_),
+            bam::getCompressedOffset(region.end_), bam::getUncompressedOffset(region.end_));
+        if (region.begin_)
+        {
+            bamParser_.resetNoHeader();
+        }
+        else
+        {
+            bamParser_.reset();
+        }
+        reset(bam::getUncompressedOffset(region.begin_));
     }
 
     template <typename ProcessorT>
@@ -103,6 +122,15 @@ private:
     bool waitForParseSlot(boost::unique_lock<boost::mutex> &lock, bool &wantMoreData, bool &exception, const unsigned threadNumber);
     void returnParseSlot(const bool suspending, bool &terminateAll, const bool exceptionStackUnwinding);
     void reserveBuffers(std::size_t maxPathLength);
+    void reset(const unsigned firstRecordOffset)
+    {
+        lastUnparsedBytes_ = 0;
+        firstRecordOffset_ = firstRecordOffset;
+        nextDecompressorThread_ = 0;
+        nextParserThread_ = 0;
+        std::fill(unparsedBytes_.begin(), unparsedBytes_.end(), 0);
+        std::for_each(decompressionBuffers_.begin(), decompressionBuffers_.end(), boost::bind(&std::vector<char>::clear, _1));
+    }
 };
 
 
@@ -255,6 +283,13 @@ void BamLoader::parallelLoad(
                     std::copy(lastPassBam_.end() - lastUnparsedBytes_, lastPassBam_.end(), decompressionBuffers_[threadNumber].begin() + UNPARSED_BYTES_MAX - lastUnparsedBytes_);
                     unparsedBegin = decompressionBuffers_[threadNumber].begin() + UNPARSED_BYTES_MAX - lastUnparsedBytes_;
                     lastUnparsedBytes_ = 0;
+                    if (firstRecordOffset_)
+                    {
+                        ISAAC_ASSERT_MSG(std::size_t(std::distance<std::vector<char>::const_iterator>(unparsedBegin, decompressionBuffers_[threadNumber].end())) >= firstRecordOffset_,
+                                         "First record offset " << firstRecordOffset_ << " is past the end of decompressed data");
+                        unparsedBegin += firstRecordOffset_;
+                        firstRecordOffset_ = 0;
+                    }
                 }
                 wantMoreData = bamParser_.parse(unparsedBegin, decompressionBuffers_[threadNumber].end(), boost::get<0>(processor));
                 // TODO: here the assumption is that unparsedBytes_ will point at the last bam block that did not end in the buffer.
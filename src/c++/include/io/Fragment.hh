@@ -62,43 +62,44 @@ inline std::ostream &operator <<(std::ostream& os, const FragmentIndexAnchor& an
 
 
 /**
- * \brief returns a value which can be used when ranking duplicates to chose the best one
+ * \brief returns a value which can be used when ranking duplicates to chose the best one. Template quality ranks
+ *        first, then the number of matching bases. Both saturate at 16 bits to fit the header field.
  */
-inline uint64_t getTemplateDuplicateRank(const alignment::BamTemplate &templ)
+inline uint32_t getTemplateDuplicateRank(const alignment::BamTemplate &templ)
 {
-    return static_cast<uint64_t>(templ.getQuality()) << 32 |
-        (templ.getTotalReadLength() - templ.getEditDistance()) << 16 |
-        templ.getAlignmentScore();
+    static const unsigned RANK_PART_MAX = 0xFFFF;
+    return std::min(templ.getQuality(), RANK_PART_MAX) << 16 |
+        std::min(templ.getTotalReadLength() - templ.getEditDistance(), RANK_PART_MAX);
 }
 
 struct FragmentHeader
 {
     FragmentHeader():
-        bamTlen_(0),
         fStrandPosition_(),
         fStrandOriginalPosition_(),
         rStrandPosition_(),
+        mateFStrandPosition_(),
+        barcodeSequence_(0),
+        clusterId_(-1U),
+        duplicateClusterRank_(0),
+        mateAnchor_(0),
+        bamTlen_(0),
+        tile_(-1U),
+        barcode_(0),
+        clusterX_(POSITION_NOT_SET),
+        clusterY_(POSITION_NOT_SET),
+        mateStorageBin_(0),
         lowClipped_(0),
         highClipped_(0),
         alignmentScore_(DODGY_ALIGNMENT_SCORE),
         templateAlignmentScore_(DODGY_ALIGNMENT_SCORE),
-        mapQ_(alignment::UNKNOWN_MAPQ),
-        mateFStrandPosition_(),
         readLength_(0),
         cigarLength_(0),
         nameLength_(0),
         gapCount_(0),
         editDistance_(0),
         flags_(false, false, false, false, false, false, false, false, false, false, false),
-        tile_(uint64_t(0)-1),
-        barcode_(0),
-        barcodeSequence_(0),
-        clusterId_(uint64_t(0)-1),
-        clusterX_(POSITION_NOT_SET),
-        clusterY_(POSITION_NOT_SET),
-        duplicateClusterRank_(0),
-        mateAnchor_(0),
-        mateStorageBin_(0)
+        mapQ_(alignment::UNKNOWN_MAPQ)
     {
     }
 
@@ -108,7 +109,6 @@ struct FragmentHeader
                    const unsigned barcodeIdx,
                    const unsigned mateStorageBin)
     :
-        bamTlen_(getTlen(fragment, mate)),
         fStrandPosition_(fragment.isAligned() ?
             fragment.getFStrandReferencePosition() :
             mate.getFStrandReferencePosition()),
@@ -116,15 +116,24 @@ struct FragmentHeader
         rStrandPosition_(!fragment.isAligned() ?
                 reference::ReferencePosition(reference::ReferencePosition::NoMatch) :
                 fragment.getRStrandReferencePosition()),
+        mateFStrandPosition_(mate.isAligned() ?
+            mate.getFStrandReferencePosition() :
+            fragment.getFStrandReferencePosition()),
+        barcodeSequence_(fragment.getCluster().getBarcodeSequence()),
+        clusterId_(fragment.getCluster().getId()),
+        duplicateClusterRank_(getTemplateDuplicateRank(bamTemplate)),
+        mateAnchor_(mate),
+        bamTlen_(getTlen(fragment, mate)),
+        tile_(fragment.getCluster().getTile()),
+        barcode_(barcodeIdx),
+        clusterX_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().x_ : POSITION_NOT_SET),
+        clusterY_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().y_ : POSITION_NOT_SET),
+        mateStorageBin_(mateStorageBin),
         lowClipped_(fragment.lowClipped),
         highClipped_(fragment.highClipped),
         alignmentScore_(fragment.getAlignmentScore()),
         templateAlignmentScore_(
             bamTemplate.getAlignmentScore()),
-        mapQ_(fragment.mapQ),
-        mateFStrandPosition_(mate.isAligned() ?
-            mate.getFStrandReferencePosition() :
-            fragment.getFStrandReferencePosition()),
         readLength_(fragment.getReadLength()),
         cigarLength_(fragment.getCigarLength()),
         nameLength_(bamTemplate.getNameLength()),
@@ -141,15 +150,7 @@ struct FragmentHeader
                fragment.splitAlignment,
                fragment.largeDeletion,
                mate.splitAlignment),
-        tile_(fragment.getCluster().getTile()),
-        barcode_(barcodeIdx),
-        barcodeSequence_(fragment.getCluster().getBarcodeSequence()),
-        clusterId_(fragment.getCluster().getId()),
-        clusterX_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().x_ : POSITION_NOT_SET),
-        clusterY_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().y_ : POSITION_NOT_SET),
-        duplicateClusterRank_(getTemplateDuplicateRank(bamTemplate)),
-        mateAnchor_(mate),
-        mateStorageBin_(mateStorageBin)
+        mapQ_(fragment.mapQ)
         //, magic_(magicValue_)
     {
     }
@@ -159,19 +160,27 @@ struct FragmentHeader
                    const alignment::FragmentMetadata &fragment,
                    const unsigned barcodeIdx)
     :
-        // According to SAM v1.4 TLEN is 0 for single-ended templates.
-        bamTlen_(0),
         fStrandPosition_(fragment.getFStrandReferencePosition()),
         fStrandOriginalPosition_(fStrandPosition_),
         rStrandPosition_(!fragment.isAligned() ?
             reference::ReferencePosition(reference::ReferencePosition::NoMatch) :
             fragment.getRStrandReferencePosition()),
+        mateFStrandPosition_(reference::ReferencePosition::NoMatch),
+        barcodeSequence_(fragment.getCluster().getBarcodeSequence()),
+        clusterId_(fragment.getCluster().getId()),
+        duplicateClusterRank_(0),
+        mateAnchor_(0),
+        // According to SAM v1.4 TLEN is 0 for single-ended templates.
+        bamTlen_(0),
+        tile_(fragment.getCluster().getTile()),
+        barcode_(barcodeIdx),
+        clusterX_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().x_ : POSITION_NOT_SET),
+        clusterY_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().y_ : POSITION_NOT_SET),
+        mateStorageBin_(0),
         lowClipped_(fragment.lowClipped),
         highClipped_(fragment.highClipped),
         alignmentScore_(fragment.getAlignmentScore()),
         templateAlignmentScore_(fragment.getAlignmentScore()),
-        mapQ_(fragment.mapQ),
-        mateFStrandPosition_(reference::ReferencePosition::NoMatch),
         readLength_(fragment.getReadLength()),
         cigarLength_(fragment.getCigarLength()),
         nameLength_(bamTemplate.getNameLength()),
@@ -188,15 +197,7 @@ struct FragmentHeader
                fragment.splitAlignment,
                fragment.largeDeletion,
                false),
-        tile_(fragment.getCluster().getTile()),
-        barcode_(barcodeIdx),
-        barcodeSequence_(fragment.getCluster().getBarcodeSequence()),
-        clusterId_(fragment.getCluster().getId()),
-        clusterX_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().x_ : POSITION_NOT_SET),
-        clusterY_(fragment.getCluster().getXy().isSet() ? fragment.getCluster().getXy().y_ : POSITION_NOT_SET),
-        duplicateClusterRank_(0),
-        mateAnchor_(0),
-        mateStorageBin_(0)
+        mapQ_(fragment.mapQ)
         //, magic_(magicValue_)
     {
     }
@@ -216,8 +217,8 @@ struct FragmentHeader
     }
 
     static unsigned getTotalLength(const unsigned readLength, const unsigned cigarLength, const unsigned nameLength) {
-        // name has terminating 0 in it
-        return sizeof(FragmentHeader) + getDataLength(readLength, cigarLength) + nameLength + 1;
+        // stored names are followed by the terminating 0. Fragments without name don't have it.
+        return sizeof(FragmentHeader) + getDataLength(readLength, cigarLength) + (nameLength ? nameLength + 1 : 0);
     }
 
     unsigned getTotalLength() const {
@@ -309,6 +310,27 @@ struct FragmentHeader
 
     bool isSplit() const {return flags_.splitAlignment_;}
 
+    // The fields are grouped by size so that the compiler does not insert padding between them. The header is
+    // stored uncompressed with every fragment in the bin files and in BinData, so each byte here is multiplied
+    // by the number of fragments.
+
+    // same as fStrandPosition_ initially, but does not get changed by gap realignment and such
+    reference::ReferencePosition fStrandPosition_;
+    reference::ReferencePosition fStrandOriginalPosition_;
+    reference::ReferencePosition rStrandPosition_;
+
+    /**
+     * \brief forward-strand position of mate
+     */
+    reference::ReferencePosition mateFStrandPosition_;
+
+    /**
+     * \brief actual barcode from the data. It might not match exactly to the one from the sample sheet
+     */
+    uint64_t barcodeSequence_;
+
+    FragmentIndexAnchor mateAnchor_;
+
     /**
      * \brief template length as specified by SAM format
      * TLEN: signed observed Template LENgth. If all segments are mapped to the same reference, the
@@ -319,11 +341,37 @@ struct FragmentHeader
      */
     int bamTlen_;
 
+    /**
+     * \brief 0-based cluster index in the tile. Tiles are well below INSANELY_HIGH_NUMBER_OF_CLUSTERS_PER_TILE
+     */
+    uint32_t clusterId_;
 
-    // same as fStrandPosition_ initially, but does not get changed by gap realignment and such
-    reference::ReferencePosition fStrandPosition_;
-    reference::ReferencePosition fStrandOriginalPosition_;
-    reference::ReferencePosition rStrandPosition_;
+    /// see getTemplateDuplicateRank
+    uint32_t duplicateClusterRank_;
+
+    /**
+     * \brief 0-based unique tile index
+     */
+    unsigned tile_;
+
+    /**
+     * \brief 0-based unique barcode index
+     * TODO, rename to barcodeIndex_
+     */
+    unsigned barcode_;
+
+    static const int POSITION_NOT_SET = boost::integer_traits<int>::const_max;
+    /**
+     * \brief pixel X * 100 position of the cluster on the tile. May be negative. Magic value of POSITION_NOT_SET means unset.
+     */
+    int clusterX_;
+
+    /**
+     * \brief pixel Y * 100 position of the cluster on the tile. May be negative. Magic value of POSITION_NOT_SET means unset.
+     */
+    int clusterY_;
+
+    unsigned mateStorageBin_;
 
     /// number of bases clipped from begin and end irrespective of alignment
     unsigned short lowClipped_;
@@ -343,13 +391,6 @@ struct FragmentHeader
      */
     unsigned short templateAlignmentScore_;
 
-    unsigned char mapQ_;
-
-    /**
-     * \brief forward-strand position of mate
-     */
-    reference::ReferencePosition mateFStrandPosition_;
-
     /**
      * \brief number of nucleotides in the fragment
      */
@@ -361,7 +402,7 @@ struct FragmentHeader
     unsigned short cigarLength_;
 
     /**
-     * \brief number of characters in fragment name including the terminating 0
+     * \brief number of characters in fragment name not including the terminating 0. 0 if the name is not stored
      */
     unsigned short nameLength_;
 
@@ -382,63 +423,33 @@ struct FragmentHeader
             reverse_(reverse), mateReverse_(mateReverse), realigned_(false), secondRead_(secondRead),
             failFilter_(failFilter), properPair_(properPair), duplicate_(false),
             splitAlignment_(splitAlignment), realignableSplit_(realignableSplit), mateSplit_(mateSplit){}
-        bool initialized_ : 1;
-        bool paired_ : 1;
-        bool unmapped_ : 1;
-        bool mateUnmapped_ : 1;
-        bool reverse_ : 1;
-        bool mateReverse_ : 1;
-        bool realigned_ : 1;
-        bool secondRead_ : 1;
-        bool failFilter_ : 1;
-        bool properPair_ : 1;
-        bool duplicate_ : 1;
-        bool splitAlignment_ :1;
-        bool realignableSplit_ :1;
-        bool mateSplit_ :1;
+        // single 16-bit storage unit regardless of how the compiler allocates bool bit-fields
+        uint16_t initialized_ : 1;
+        uint16_t paired_ : 1;
+        uint16_t unmapped_ : 1;
+        uint16_t mateUnmapped_ : 1;
+        uint16_t reverse_ : 1;
+        uint16_t mateReverse_ : 1;
+        uint16_t realigned_ : 1;
+        uint16_t secondRead_ : 1;
+        uint16_t failFilter_ : 1;
+        uint16_t properPair_ : 1;
+        uint16_t duplicate_ : 1;
+        uint16_t splitAlignment_ :1;
+        uint16_t realignableSplit_ :1;
+        uint16_t mateSplit_ :1;
     } flags_;
 
-    /**
-     * \brief 0-based unique tile index
-     */
-    uint64_t tile_;
-
-    /**
-     * \brief 0-based unique barcode index
-     * TODO, rename to barcodeIndex_
-     */
-    uint64_t barcode_;
-
-    /**
-     * \brief actual barcode from the data. It might not match exactly to the one from the sample sheet
-     */
-    uint64_t barcodeSequence_;
-
-    /**
-     * \brief 0-based cluster index in the tile
-     */
-    uint64_t clusterId_;
-
-    static const int POSITION_NOT_SET = boost::integer_traits<int>::const_max;
-    /**
-     * \brief pixel X * 100 position of the cluster on the tile. May be negative. Magic value of POSITION_NOT_SET means unset.
-     */
-    int clusterX_;
-
-    /**
-     * \brief pixel Y * 100 position of the cluster on the tile. May be negative. Magic value of POSITION_NOT_SET means unset.
-     */
-    int clusterY_;
-
-    uint64_t duplicateClusterRank_;
-
-    FragmentIndexAnchor mateAnchor_;
+    unsigned char mapQ_;
 
-    unsigned mateStorageBin_;
 //    unsigned short magic_;
 //    static const unsigned short magicValue_ = 0xb1a;
 
 };
+// 97 bytes of fields rounded up to the alignment of the 64-bit ones. Catch fields added or reordered in a way that
+// brings the padding back
+BOOST_STATIC_ASSERT(sizeof(FragmentHeader::Flags) == 2);
+BOOST_STATIC_ASSERT(sizeof(FragmentHeader) == 104);
 
 inline std::ostream & operator <<(std::ostream &os, const FragmentHeader::Flags &headerFlags)
 {
@@ -155,6 +155,29 @@ private:
     }
 };
 
+/**
+ ** \brief Packs kmerLength successive bases into kmer the same way KmerGenerator does
+ **
+ ** \return false if any of the bases does not translate into a valid oligo
+ **/
+template <unsigned kmerLength, class T, typename InputIteratorT, typename TranslatorT>
+bool makeKmer(InputIteratorT begin, const TranslatorT &translator, T &kmer)
+{
+    T ret(0);
+    for (const InputIteratorT end = begin + kmerLength; end != begin; ++begin)
+    {
+        const unsigned baseValue = translator[*begin];
+        if (INVALID_OLIGO <= baseValue)
+        {
+            return false;
+        }
+        ret <<= KMERGENERATOR_BITS_PER_BASE;
+        ret |= T(baseValue);
+    }
+    kmer = ret;
+    return true;
+}
+
 template <unsigned kmerLength, class T, typename InputIteratorT, unsigned step, typename TranslatorT, unsigned offset>
 class InterleavedKmerGeneratorImpl :  InterleavedKmerGeneratorImpl<kmerLength, T, InputIteratorT, step, TranslatorT, offset - 1>
 {
@@ -25,6 +25,7 @@
 #include <boost/regex.hpp>
 
 #include "build/GapRealigner.hh"
+#include "common/Numa.hh"
 #include "common/Program.hh"
 #include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/Layout.hh"
@@ -50,8 +51,11 @@ private:
     void verifyMandatoryPaths(boost::program_options::variables_map &vm);
     void parseParallelization();
     build::GapRealignerMode parseGapRealignment();
+    build::OutputFormat parseOutputFormat();
     void parseExecutionTargets();
+    void parseSampleClusters(const boost::program_options::variables_map &vm);
     void parseMemoryControl();
+    void parseHugePages();
     void parseGapScoring();
     void parseSmithWatermanOptions();
     workflow::AlignWorkflow::OptionalFeatures parseBamExcludeTags(std::string strBamExcludeTags);
@@ -82,9 +86,9 @@ public:
     std::vector<flowcell::Layout> flowcellLayoutList;
     flowcell::BarcodeMetadataList barcodeMetadataList;
     // another workaround for boost and spaces in paths
-    std::string sortedReferenceXmlString;
-    boost::filesystem::path sortedReferenceXml;
-    std::string referenceName;
+    std::vector<std::string> sortedReferenceXmlStringList;
+    std::vector<boost::filesystem::path> sortedReferenceXmlList;
+    std::vector<std::string> referenceNameList;
     reference::ReferenceMetadataList referenceMetadataList;
     std::string tempDirectoryString;
     boost::filesystem::path tempDirectory;
@@ -106,16 +110,22 @@ public:
     // the list of seed metadata
     unsigned jobs;
     bool enableNuma;
+    std::string hugePagesString;
+    common::HugePages hugePages;
     std::size_t candidateMatchesMax;
     unsigned matchFinderTooManyRepeats;
     unsigned matchFinderWayTooManyRepeats;
     unsigned matchFinderShadowSplitRepeats;
+    unsigned seedExtensionRepeats;
+    unsigned seedMismatches;
     unsigned seedBaseQualityMin;
     unsigned repeatThreshold;
     int mateDriftRange;
     unsigned neighborhoodSizeThreshold;
     std::string startFromString;
     workflow::AlignWorkflow::State startFrom;
+    // continue the alignment from the last chunk of tiles recorded by the interrupted run
+    bool resumeAlignment;
     std::string stopAtString;
     workflow::AlignWorkflow::State stopAt;
     unsigned int verbosity;
@@ -137,6 +147,8 @@ public:
     unsigned realignedGapsPerFragment;
     bool clipSemialigned;
     bool clipOverlapping;
+    bool clipAdapterOverlap;
+    bool keepReadNames;
     bool scatterRepeats;
     bool rescueShadows;
     bool trimPEAdapters;
@@ -169,6 +181,8 @@ public:
     unsigned realignMapqMin;
     std::string knownIndelsPathString;
     boost::filesystem::path knownIndelsPath;
+    std::string outputFormatString;
+    build::OutputFormat outputFormat;
     int bamGzipLevel;
     std::vector<std::string> bamHeaderTags;
     std::string bamPuFormat;
@@ -181,6 +195,7 @@ public:
     std::string binRegexString;
     std::string decoyRegexString;
     std::vector<std::size_t> clusterIdList;
+    double sampleClusters;
     alignment::TemplateLengthStatistics userTemplateLengthStatistics;
     std::string tlsString;
     std::vector<std::string> defaultAdapters;
@@ -193,6 +208,7 @@ public:
     workflow::AlignWorkflow::OptionalFeatures optionalFeatures;
     bool pessimisticMapQ;
     unsigned detectTemplateBlockSize;
+    unsigned perfTraceEvents;
     bool disableResume;
 };
 
@@ -0,0 +1,47 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file AlignmentStatsToXmlOptions.hh
+ **
+ ** Command line options for 'alignmentStatsToXml'
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_OPTIONS_ALIGNMENT_STATS_TO_XML_OPTIONS_HH
+#define iSAAC_OPTIONS_ALIGNMENT_STATS_TO_XML_OPTIONS_HH
+
+#include <boost/filesystem.hpp>
+
+#include "common/Program.hh"
+
+namespace isaac
+{
+namespace options
+{
+
+class AlignmentStatsToXmlOptions : public isaac::common::Options
+{
+public:
+    AlignmentStatsToXmlOptions();
+private:
+    std::string usagePrefix() const {return "alignmentStatsToXml";}
+    void postProcess(boost::program_options::variables_map &vm);
+public:
+    boost::filesystem::path inputFile;
+    boost::filesystem::path outputFile;
+};
+
+} // namespace options
+} // namespace isaac
+
+#endif // #ifndef iSAAC_OPTIONS_ALIGNMENT_STATS_TO_XML_OPTIONS_HH
@@ -20,9 +20,13 @@
 #ifndef iSAAC_REFERENCE_REFERENCE_HASH_HH
 #define iSAAC_REFERENCE_REFERENCE_HASH_HH
 
+#include <algorithm>
+
 #include <boost/format.hpp>
+#include "common/BitHacks.hh"
 #include "common/NumaContainer.hh"
 #include "oligo/Kmer.hh"
+#include "oligo/Permutate.hh"
 
 namespace isaac
 {
@@ -47,6 +51,7 @@ public:
     typedef typename Positions::const_iterator const_iterator;
     typedef std::pair<const_iterator, const_iterator> MatchRange;
     typedef void value_type;// compatibility with std containers for numa replications
+    typedef AllocatorT allocator_type;
 
     // the kmers are hashed into keys which are then used as indices into Offsets table
     typedef uint32_t KeyT;
@@ -57,6 +62,23 @@ public:
     // numbers even for genomes larger than 4B bases.
     typedef std::vector<Offset, OffsetAllocator> Offsets;
 
+    /**
+     * \brief Repetitive buckets get their positions indexed again by the KMER_BASES bases that follow the kmer
+     *        in the reference. begin_ and end_ delimit the bucket in extensionKmers_ and extensionPositions_.
+     *        Positions that have no valid extension (reference end or N) are not indexed.
+     */
+    struct ExtendedBucket
+    {
+        KeyT key_;
+        Offset begin_;
+        Offset end_;
+        bool operator <(const KeyT key) const {return key_ < key;}
+    };
+    typedef typename AllocatorT::template rebind<ExtendedBucket> ExtendedBucketAllocatorRebind;
+    typedef std::vector<ExtendedBucket, typename ExtendedBucketAllocatorRebind::other> ExtendedBuckets;
+    typedef typename AllocatorT::template rebind<KmerT> KmerAllocatorRebind;
+    typedef std::vector<KmerT, typename KmerAllocatorRebind::other> ExtensionKmers;
+
     KeyT keyFromKmer(KmerT kmer) const
     {
 //        if (kmer == KmerT(/*0x02cee3cc14 */0x02e2c0c82b))
@@ -71,6 +93,9 @@ public:
 
     ReferenceHash(const uint64_t bucketCount)
         : a_(3308323), b_(7048005), largePrime_(1699023365707), bucketCount_(bucketCount), offsets_(bucketCount_, 0)
+        , extensionRepeatsMin_(0)
+        , seedMismatches_(0)
+        , prefixBits_(0)
     {
         if (!bucketCount_)
         {
@@ -88,9 +113,19 @@ public:
 
     ReferenceHash(ReferenceHash &&that, const AllocatorT &allocator = AllocatorT())
         : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_)
+        , extensionRepeatsMin_(that.extensionRepeatsMin_)
     {
         offsets_.swap(that.offsets_);
         positions_.swap(that.positions_);
+        extendedBuckets_.swap(that.extendedBuckets_);
+        extensionKmers_.swap(that.extensionKmers_);
+        extensionPositions_.swap(that.extensionPositions_);
+        seedMismatches_ = that.seedMismatches_;
+        prefixBits_ = that.prefixBits_;
+        permutations_.swap(that.permutations_);
+        permutedPrefixOffsets_.swap(that.permutedPrefixOffsets_);
+        permutedKmers_.swap(that.permutedKmers_);
+        permutedPositions_.swap(that.permutedPositions_);
 //        ISAAC_THREAD_CERR << "ReferenceHash(ReferenceHash &&that, allocator)" << std::endl;
     }
 
@@ -98,6 +133,16 @@ public:
         : a_(that.a_), b_(that.b_), largePrime_(that.largePrime_), bucketCount_(that.bucketCount_)
         , offsets_(that.offsets_, allocator)
         , positions_(that.positions_, allocator)
+        , extensionRepeatsMin_(that.extensionRepeatsMin_)
+        , extendedBuckets_(that.extendedBuckets_, allocator)
+        , extensionKmers_(that.extensionKmers_, allocator)
+        , extensionPositions_(that.extensionPositions_, allocator)
+        , seedMismatches_(that.seedMismatches_)
+        , prefixBits_(that.prefixBits_)
+        , permutations_(that.permutations_)
+        , permutedPrefixOffsets_(that.permutedPrefixOffsets_, allocator)
+        , permutedKmers_(that.permutedKmers_, allocator)
+        , permutedPositions_(that.permutedPositions_, allocator)
     {
 //        ISAAC_THREAD_CERR << "ReferenceHash(ReferenceHash &that, allocator)" << std::endl;
     }
@@ -152,6 +197,84 @@ public:
         return std::make_pair(positions_.end(), positions_.end());
     }
 
+    /**
+     * \brief Buckets that have at least this many positions can be looked up with findExtendedMatches.
+     *        0 if no buckets are extended.
+     */
+    unsigned getExtensionRepeatsMin() const {return extensionRepeatsMin_;}
+
+    /**
+     * \return positions of kmer that are followed in the reference by extension
+     */
+    MatchRange findExtendedMatches(const KmerT &kmer, const KmerT &extension) const
+    {
+        const KeyT key = keyFromKmer(kmer);
+        const typename ExtendedBuckets::const_iterator bucket =
+            std::lower_bound(extendedBuckets_.begin(), extendedBuckets_.end(), key);
+        if (extendedBuckets_.end() == bucket || key != bucket->key_)
+        {
+            return std::make_pair(extensionPositions_.end(), extensionPositions_.end());
+        }
+
+        const std::pair<typename ExtensionKmers::const_iterator, typename ExtensionKmers::const_iterator> kmers =
+            std::equal_range(extensionKmers_.begin() + bucket->begin_, extensionKmers_.begin() + bucket->end_, extension);
+        return std::make_pair(
+            extensionPositions_.begin() + std::distance(extensionKmers_.begin(), kmers.first),
+            extensionPositions_.begin() + std::distance(extensionKmers_.begin(), kmers.second));
+    }
+
+    /**
+     * \brief Number of mismatches tolerated by findMismatchMatches. 0 if the permuted tables are not built.
+     */
+    unsigned getSeedMismatches() const {return seedMismatches_;}
+
+    /**
+     * \brief Appends the ordered positions of the reference kmers that differ from kmer in at most getSeedMismatches()
+     *        bases. Each permutation brings a different subset of kmer blocks to the front. At least one of them has
+     *        all the mismatching blocks in the suffix, so scanning the kmers sharing the permuted prefix is enough.
+     *
+     * \return false if more than positionsMax positions would have to be appended. positions is left unchanged then.
+     */
+    template <typename PositionsT>
+    bool findMismatchMatches(const KmerT &kmer, const std::size_t positionsMax, PositionsT &positions) const
+    {
+        const std::size_t positionsBegin = positions.size();
+        const uint64_t prefixCount = uint64_t(1) << prefixBits_;
+        const unsigned suffixBits = oligo::KmerTraits<KmerT>::KMER_BITS - prefixBits_;
+        for (std::size_t permutation = 0; permutations_.size() != permutation; ++permutation)
+        {
+            const KmerT permuted = permutations_[permutation](kmer);
+            const std::size_t prefixOffsetsBase = permutation * (prefixCount + 1) + (permuted.bits_ >> suffixBits);
+            for (Offset entry = permutedPrefixOffsets_[prefixOffsetsBase];
+                permutedPrefixOffsets_[prefixOffsetsBase + 1] != entry; ++entry)
+            {
+                if (seedMismatches_ >= countMismatches(permuted, permutedKmers_[entry]))
+                {
+                    if (positions.size() - positionsBegin == positionsMax)
+                    {
+                        positions.resize(positionsBegin);
+                        return false;
+                    }
+                    positions.push_back(permutedPositions_[entry]);
+                }
+            }
+        }
+        // kmers with fewer mismatches than allowed are found by more than one permutation
+        std::sort(positions.begin() + positionsBegin, positions.end());
+        positions.erase(std::unique(positions.begin() + positionsBegin, positions.end()), positions.end());
+        return true;
+    }
+
+    /// bytes occupied by the tables, which is what each NUMA replica costs
+    uint64_t getMemorySize() const
+    {
+        return offsets_.size() * sizeof(Offset) + positions_.size() * sizeof(Offset) +
+            extendedBuckets_.size() * sizeof(ExtendedBucket) +
+            extensionKmers_.size() * sizeof(KmerT) + extensionPositions_.size() * sizeof(Offset) +
+            permutedPrefixOffsets_.size() * sizeof(Offset) +
+            permutedKmers_.size() * sizeof(KmerT) + permutedPositions_.size() * sizeof(Offset);
+    }
+
     uint64_t getBucketCount() const {return bucketCount_;}
     uint64_t getA() const {return a_;}
     uint64_t getB() const {return b_;}
@@ -165,14 +288,43 @@ private:
 //    std::vector<KmerT> uniqueKmers_;
     Positions positions_;
 
+    unsigned extensionRepeatsMin_;
+    // ordered by key_
+    ExtendedBuckets extendedBuckets_;
+    // within each bucket, ordered by extension kmer then by position
+    ExtensionKmers extensionKmers_;
+    Positions extensionPositions_;
+
+    unsigned seedMismatches_;
+    // bits of the permuted kmer that must match exactly
+    unsigned prefixBits_;
+    std::vector<oligo::Permutate> permutations_;
+    // for each permutation, (1 << prefixBits_) + 1 offsets into permutedKmers_ and permutedPositions_
+    Offsets permutedPrefixOffsets_;
+    // all reference kmers once for each permutation, ordered by permuted kmer then by position
+    ExtensionKmers permutedKmers_;
+    Positions permutedPositions_;
+
+    static unsigned countMismatches(const KmerT &left, const KmerT &right)
+    {
+        static const uint64_t BASE_LOW_BITS = 0x5555555555555555UL;
+        const uint64_t diff = uint64_t((left ^ right).bits_);
+        return common::countBitsSet(uint64_t((diff | (diff >> 1)) & BASE_LOW_BITS));
+    }
+
     friend class ReferenceHasher<MyT>;
 };
 
 
+/**
+ * \brief Gives each compute thread the replica of the hash that resides on the NUMA node the thread is bound to.
+ *        Without replication all threads share the single copy which is expected to be interleaved
+ */
 template <typename HashType>
 class NumaReferenceHash
 {
-    common::NumaContainerReplicas<HashType> replicas_;
+    typedef typename HashType::allocator_type AllocatorT;
+    common::NumaContainerReplicas<HashType, AllocatorT> replicas_;
 public:
     typedef typename HashType::KmerT KmerT;
     typedef typename HashType::MatchRange MatchRange;
@@ -182,15 +334,53 @@ public:
     typedef typename HashType::Offsets Offsets;
     static const unsigned SEED_LENGTH = HashType::SEED_LENGTH;
 
-    NumaReferenceHash(HashType &&hash) :replicas_(std::move(hash))
+    /**
+     * \param replicate when true and NUMA is available, every node gets own copy including node 0 as hash
+     *                  normally comes interleaved from the hasher.
+     */
+    NumaReferenceHash(HashType &&hash, const bool replicate) :
+        replicas_(makeNode0Replica(std::move(hash), replicate), replicate)
     {
-        ISAAC_THREAD_CERR << "NumaReferenceHash copy constructor" << std::endl;
     }
 
+    bool isReplicated() const {return replicas_.isReplicated();}
+
     MatchRange findMatches(const KmerT &kmer) const
     {
         return replicas_.threadNodeContainer().findMatches(kmer);
     }
+
+    unsigned getExtensionRepeatsMin() const
+    {
+        return replicas_.threadNodeContainer().getExtensionRepeatsMin();
+    }
+
+    MatchRange findExtendedMatches(const KmerT &kmer, const KmerT &extension) const
+    {
+        return replicas_.threadNodeContainer().findExtendedMatches(kmer, extension);
+    }
+
+    unsigned getSeedMismatches() const
+    {
+        return replicas_.threadNodeContainer().getSeedMismatches();
+    }
+
+    template <typename PositionsT>
+    bool findMismatchMatches(const KmerT &kmer, const std::size_t positionsMax, PositionsT &positions) const
+    {
+        return replicas_.threadNodeContainer().findMismatchMatches(kmer, positionsMax, positions);
+    }
+
+private:
+    // takes the hash by value so that the interleaved original is released as soon as node 0 has its copy
+    static HashType makeNode0Replica(HashType hash, const bool replicate)
+    {
+        if (replicate && 1 < common::getNumaNodeCount())
+        {
+            return HashType(hash, AllocatorT(0));
+        }
+        return hash;
+    }
 };
 
 } // namespace reference
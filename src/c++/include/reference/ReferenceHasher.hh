@@ -43,12 +43,30 @@ class ReferenceHasher
     typedef typename ReferenceHashT::Offset Offset;
     typedef typename ReferenceHashT::Offsets Offsets;
     static const std::size_t THREAD_BUFFER_KMERS_MAX = 8192; // arbitrary number that reduces the cost/benefit of acquiring a mutex
+    static const unsigned PERMUTED_PREFIX_BITS_MAX = 24; // 16M buckets per permutation
 public:
 
     ReferenceHasher(const ContigList &contigList, common::ThreadVector &threads, const unsigned threadsMax);
 
     ReferenceHashT generate(const uint64_t bucketCount);
+    /**
+     * \param extensionRepeatsMin  buckets with at least this many positions get indexed by extended kmers too.
+     *                             0 disables the extension.
+     */
+    ReferenceHashT generate(const uint64_t bucketCount, const unsigned extensionRepeatsMin);
+    /**
+     * \param seedMismatches  number of mismatches to be tolerated by ReferenceHashT::findMismatchMatches.
+     *                        0 disables the permuted tables.
+     */
+    ReferenceHashT generate(const uint64_t bucketCount, const unsigned extensionRepeatsMin, const unsigned seedMismatches);
     void generate(ReferenceHashT &ret);
+    void extend(ReferenceHashT &ret, const unsigned extensionRepeatsMin);
+    void permutate(ReferenceHashT &ret, const unsigned seedMismatches);
+
+    /**
+     * \return true if the kmers can be split into blocks required to tolerate seedMismatches
+     */
+    static bool canPermutate(const unsigned seedMismatches);
 
 private:
     const ContigList &contigList_;
@@ -88,6 +106,8 @@ private:
         const ContigList &contigList);
 
     static void sortPositions(ReferenceHashT &referenceHash, const unsigned threadNumber, const std::size_t threads);
+    void extendBuckets(ReferenceHashT &referenceHash, const unsigned threadNumber, const std::size_t threads) const;
+    static void sortPermutedPrefixes(ReferenceHashT &referenceHash, const unsigned threadNumber, const std::size_t threads);
     static void updateEmptyOffsets(Offsets& offsets);
     static Offset countsToOffsets(Offsets& offsets);
     static void dumpCounts(boost::mutex& mutex, MutexBuffer& buffer, ReferenceHashT& referenceHash);
@@ -22,6 +22,7 @@
 
 #include <numeric>
 
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/foreach.hpp>
 
@@ -283,6 +284,13 @@ inline uint64_t getLongestGenomeLength(const isaac::reference::SortedReferenceMe
     return longestGenome;
 }
 
+/**
+ * \brief Union of the contig lists of the references aligned against in a single pass. Each contig index gets the
+ *        longest of the contigs with that index so that positions of any of the references fall within the
+ *        merged contig. index_ and genomicPosition_ are recomputed for the merged list.
+ */
+SortedReferenceMetadata::Contigs mergeContigs(const SortedReferenceMetadataList &sortedReferenceMetadataList);
+
 /**
  * \brief Translate from genomic offset to reference position. Not particularly fast as it uses binary search to
  *        locate the relevant contig.
@@ -12,7 +12,7 @@
  **
  ** \file AlignmentReportGenerator.hh
  **
- ** Reorders alingments and stores them in bam file.
+ ** Generates the html alignment reports and svg charts from the alignment statistics.
  ** 
  ** \author Roman Petrovski
  **/
@@ -20,16 +20,25 @@
 #ifndef iSAAC_REPORTS_ALIGNMENT_REPORT_GENERATOR_HH
 #define iSAAC_REPORTS_ALIGNMENT_REPORT_GENERATOR_HH
 
+#include <map>
+#include <ostream>
+#include <tuple>
+
 #include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
 
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "demultiplexing/DemultiplexingStats.hh"
+#include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/Layout.hh"
+#include "flowcell/TileMetadata.hh"
 
 namespace isaac
 {
 namespace reports
 {
 
-class AlignmentReportGenerator
+class AlignmentReportGenerator: boost::noncopyable
 {
 public:
     /**
@@ -37,32 +46,95 @@ public:
      */
     enum ImageFileFormat
     {
-        gif,       // Produce .gif files for plots
+        svg,       // Produce .svg files for plots
         none       // Do not produce any plot files
     };
 
+    /**
+     * \param tileStats finalized alignment statistics indexed by tile index
+     */
+    AlignmentReportGenerator(
+        const flowcell::FlowcellLayoutList &flowcellLayoutList,
+        const flowcell::BarcodeMetadataList &barcodeMetadataList,
+        const flowcell::TileMetadataList &tileMetadataList,
+        const std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats,
+        const demultiplexing::DemultiplexingStats &demultiplexingStats,
+        const boost::filesystem::path &outputDirectory,
+        const ImageFileFormat imageFileFormat,
+        const unsigned threads);
+
+    void run();
+
+private:
+    /**
+     * \brief flowcell id, project, sample and barcode name. 'all' designates aggregation over all values
+     */
+    typedef std::tuple<std::string, std::string, std::string, std::string> Node;
+
+    struct ReadStats
+    {
+        alignment::matchSelector::TileBarcodeStats pf_;
+        alignment::matchSelector::TileBarcodeStats raw_;
+    };
+
+    struct LaneStats
+    {
+        // by read number
+        std::map<unsigned, ReadStats> reads_;
+        // template length statistics of each tile that has them without conflicts
+        std::vector<alignment::TemplateLengthStatistics> tileTemplateLengthStatistics_;
+        demultiplexing::LaneBarcodeStats demultiplexing_;
+        // only set for individual barcodes
+        std::string referenceName_;
+    };
+
+    // by lane number
+    typedef std::map<unsigned, LaneStats> NodeLaneStats;
+    typedef std::map<Node, NodeLaneStats> NodeStats;
+
+    /**
+     * \brief single row of the lane tables
+     */
+    struct Row
+    {
+        unsigned lane_;
+        const Node *node_;
+        const LaneStats *laneStats_;
+    };
 
-    const std::vector<flowcell::Layout> &flowcellLayoutList_;
-    const boost::filesystem::path alignmentStatsXmlPath_;
-    const boost::filesystem::path demultiplexingStatsXmlPath_;
-    const boost::filesystem::path tempDirectory_;
-    const boost::filesystem::path gnuplotScriptPath_;
+    const flowcell::FlowcellLayoutList &flowcellLayoutList_;
+    const flowcell::BarcodeMetadataList &barcodeMetadataList_;
+    const flowcell::TileMetadataList &tileMetadataList_;
+    const std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats_;
+    const demultiplexing::DemultiplexingStats &demultiplexingStats_;
     const boost::filesystem::path outputDirectoryHtml_;
     const boost::filesystem::path outputDirectoryImages_;
     const ImageFileFormat imageFileFormat_;
+    const unsigned threads_;
 
-public:
-    AlignmentReportGenerator(
-        const std::vector<flowcell::Layout> &flowcellLayoutList,
-        const flowcell::BarcodeMetadataList &barcodeMetadataList,
-        const boost::filesystem::path &alignmentStatsXmlPath,
-        const boost::filesystem::path &demultiplexingStatsXmlPath,
-        const boost::filesystem::path &tempDirectory,
-        const boost::filesystem::path &outputDirectory,
-        const ImageFileFormat imageFileFormat);
+    NodeStats nodeStats_;
 
-    void run();
+    static std::vector<Node> getBarcodeNodes(const flowcell::BarcodeMetadata &barcode);
+    static boost::filesystem::path getNodePath(const Node &node);
 
+    void aggregateStats();
+    void createDirectories() const;
+
+    void writeIndexPage() const;
+    void writeTreePage() const;
+    void writeSummaryPage(const Node &node, const bool showBarcodes) const;
+    void writeYieldSummaryTable(std::ostream &os, const Node &node) const;
+    void writeLaneSummaryTable(std::ostream &os, const Node &node, const std::vector<Row> &rows, const bool showBarcodes,
+        const unsigned readNumber) const;
+    void writeLanePairedStatsTable(std::ostream &os, const Node &node, const std::vector<Row> &rows, const bool showBarcodes) const;
+    void writeUnknownBarcodesTable(std::ostream &os, const std::string &flowcellId) const;
+    void writeTileMismatchPage(const flowcell::Layout &flowcell, const bool passesFilter, const bool curves) const;
+    void writeTileImages(const flowcell::TileMetadata &tile) const;
+
+    /**
+     * \return rows of the lane tables of the node page ordered by lane, then by node
+     */
+    std::vector<Row> getRows(const Node &node, const bool showBarcodes) const;
 };
 
 } // namespace reports
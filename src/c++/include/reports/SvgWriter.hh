@@ -0,0 +1,66 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SvgWriter.hh
+ **
+ ** \brief Minimal writer of svg images for the report charts.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_REPORTS_SVG_WRITER_HH
+#define iSAAC_REPORTS_SVG_WRITER_HH
+
+#include <ostream>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+namespace isaac
+{
+namespace reports
+{
+
+/**
+ * \brief replaces the characters that have special meaning in xml and html text and attributes
+ */
+std::string escapeXml(const std::string &text);
+
+/**
+ * \brief Writes the svg document element on construction and closes it on destruction. Coordinates are in pixels
+ *        with the origin in the top left corner.
+ */
+class SvgWriter: boost::noncopyable
+{
+public:
+    SvgWriter(std::ostream &os, const unsigned width, const unsigned height);
+    ~SvgWriter();
+
+    void rect(const double x, const double y, const double width, const double height, const char *fill);
+    void line(const double x1, const double y1, const double x2, const double y2, const char *stroke);
+    /**
+     * \param anchor svg text-anchor: start, middle or end
+     */
+    void text(const double x, const double y, const char *anchor, const std::string &text);
+    /**
+     * \brief same as text but rotated 90 degrees counterclockwise around x,y
+     */
+    void verticalText(const double x, const double y, const std::string &text);
+
+private:
+    std::ostream &os_;
+};
+
+} // namespace reports
+} // namespace isaac
+
+#endif // #ifndef iSAAC_REPORTS_SVG_WRITER_HH
@@ -0,0 +1,63 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file TileMismatchCharts.hh
+ **
+ ** \brief Per-cycle mismatch charts of a tile in svg format.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_REPORTS_TILE_MISMATCH_CHARTS_HH
+#define iSAAC_REPORTS_TILE_MISMATCH_CHARTS_HH
+
+#include <ostream>
+#include <string>
+
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "flowcell/ReadMetadata.hh"
+
+namespace isaac
+{
+namespace reports
+{
+
+/**
+ * \brief Percentage of uniquely aligned fragments having a mismatch (top half) or a blank (bottom half) at each cycle
+ *
+ * \param thumbnail if true, a small image without axes and labels is produced
+ */
+void writeTileMismatchesChart(
+    std::ostream &os,
+    const std::string &title,
+    const flowcell::ReadMetadataList &readMetadataList,
+    const alignment::matchSelector::MatchSelectorStats &tileStats,
+    const bool passesFilter,
+    const bool thumbnail);
+
+/**
+ * \brief Percentage of uniquely aligned fragments having up to 0, 1, 2, 3 and 4 mismatches by the cycle
+ *
+ * \param thumbnail if true, a small image without axes and labels is produced
+ */
+void writeTileMismatchCurvesChart(
+    std::ostream &os,
+    const std::string &title,
+    const flowcell::ReadMetadataList &readMetadataList,
+    const alignment::matchSelector::MatchSelectorStats &tileStats,
+    const bool passesFilter,
+    const bool thumbnail);
+
+} // namespace reports
+} // namespace isaac
+
+#endif // #ifndef iSAAC_REPORTS_TILE_MISMATCH_CHARTS_HH
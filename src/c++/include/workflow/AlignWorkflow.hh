@@ -35,6 +35,7 @@
 #include "alignment/TemplateLengthStatistics.hh"
 #include "alignment/matchFinder/TileClusterInfo.hh"
 #include "build/BinSorter.hh"
+#include "build/Build.hh"
 #include "common/Threads.hpp"
 #include "demultiplexing/BarcodeLoader.hh"
 #include "demultiplexing/BarcodeResolver.hh"
@@ -84,6 +85,8 @@ public:
         const unsigned seedLength,
         const flowcell::BarcodeMetadataList &barcodeMetadataList,
         const bool cleanupIntermediary,
+        const bool checkpointAlignment,
+        const bool resumeAlignment,
         const unsigned bclTilesPerChunk,
         const bool ignoreMissingBcls,
         const bool ignoreMissingFilters,
@@ -97,6 +100,8 @@ public:
         const unsigned matchFinderTooManyRepeats,
         const unsigned matchFinderWayTooManyRepeats,
         const unsigned matchFinderShadowSplitRepeats,
+        const unsigned seedExtensionRepeats,
+        const unsigned seedMismatches,
         const unsigned seedBaseQualityMin,
         const unsigned repeatThreshold,
         const int mateDriftRange,
@@ -118,6 +123,8 @@ public:
         const unsigned realignedGapsPerFragment,
         const bool clipSemialigned,
         const bool clipOverlapping,
+        const bool clipAdapterOverlap,
+        const bool keepReadNames,
         const bool scatterRepeats,
         const bool rescueShadows,
         const bool trimPEAdapters,
@@ -141,6 +148,7 @@ public:
         const build::GapRealignerMode realignGaps,
         const unsigned realignMapqMin,
         const boost::filesystem::path &knownIndelsPath,
+        const build::OutputFormat outputFormat,
         const int bamGzipLevel,
         const std::string &bamPuFormat,
         const bool bamProduceMd5,
@@ -154,6 +162,7 @@ public:
         const std::string &decoyRegexString,
         const common::ScopedMallocBlock::Mode memoryControl,
         const std::vector<std::size_t> &clusterIdList,
+        const double sampleClusters,
         const alignment::TemplateLengthStatistics &userTemplateLengthStatistics,
         const reports::AlignmentReportGenerator::ImageFileFormat statsImageFormat,
         const bool qScoreBin,
@@ -222,6 +231,8 @@ private:
     const unsigned matchFinderTooManyRepeats_;
     const unsigned matchFinderWayTooManyRepeats_;
     const unsigned matchFinderShadowSplitRepeats_;
+    const unsigned seedExtensionRepeats_;
+    const unsigned seedMismatches_;
     const unsigned seedBaseQualityMin_;
     const unsigned repeatThreshold_;
     const int mateDriftRange_;
@@ -229,8 +240,11 @@ private:
     const bool ignoreNeighbors_;
     const bool ignoreRepeats_;
     const std::vector<std::size_t> &clusterIdList_;
+    const double sampleClusters_;
     const flowcell::BarcodeMetadataList &barcodeMetadataList_;
     const bool cleanupIntermediary_;
+    const bool checkpointAlignment_;
+    const bool resumeAlignment_;
     const unsigned bclTilesPerChunk_;
     const bool ignoreMissingBcls_;
     const bool ignoreMissingFilters_;
@@ -256,6 +270,8 @@ private:
     const unsigned realignedGapsPerFragment_;
     const bool clipSemialigned_;
     const bool clipOverlapping_;
+    const bool clipAdapterOverlap_;
+    const bool keepReadNames_;
     const bool scatterRepeats_;
     const bool rescueShadows_;
     const bool trimPEAdapters_;
@@ -274,6 +290,7 @@ private:
     const build::GapRealignerMode realignGaps_;
     const unsigned realignMapqMin_;
     const boost::filesystem::path &knownIndelsPath_;
+    const build::OutputFormat outputFormat_;
     const int bamGzipLevel_;
     const std::string &bamPuFormat_;
     const bool bamProduceMd5_;
@@ -300,6 +317,9 @@ private:
     alignWorkflow::FoundMatchesMetadata foundMatchesMetadata_;
     SelectedMatchesMetadata selectedMatchesMetadata_;
     std::vector<alignment::TemplateLengthStatistics> barcodeTemplateLengthStatistics_;
+    // finalized per-tile alignment statistics, indexed by tile index. Valid after AlignDone
+    std::vector<alignment::matchSelector::MatchSelectorStats> matchSelectorStats_;
+    demultiplexing::DemultiplexingStats demultiplexingStats_;
     demultiplexing::BarcodePathMap barcodeBamMapping_;
     const unsigned detectTemplateBlockSize_;
 
@@ -311,7 +331,9 @@ private:
     void findMatches(
         alignWorkflow::FoundMatchesMetadata &foundMatches,
         alignment::BinMetadataList &binMetadataList,
-        std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics) const;
+        std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats) const;
     void cleanupBins() const;
     void generateAlignmentReports() const;
     const demultiplexing::BarcodePathMap generateBam(
@@ -23,6 +23,8 @@
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
 
 #include "common/BoostArchiveHelpers.hh"
@@ -68,6 +70,15 @@ void serialize(Archive &ar, BarcodeCounts &bc, const unsigned int version)
     ar & BOOST_SERIALIZATION_NVP(bc.alignedBases_);
 }
 
+template <class Archive>
+void serialize(Archive &ar, BinPartCounts &bpc, const unsigned int version)
+{
+    ar & BOOST_SERIALIZATION_NVP(bpc.dataSize_);
+    ar & BOOST_SERIALIZATION_NVP(bpc.seIdxElements_);
+    ar & BOOST_SERIALIZATION_NVP(bpc.rIdxElements_);
+    ar & BOOST_SERIALIZATION_NVP(bpc.fIdxElements_);
+}
+
 template <class Archive>
 void serialize(Archive &ar, BinMetadata &bm, const unsigned int version)
 {
@@ -82,6 +93,7 @@ void serialize(Archive &ar, BinMetadata &bm, const unsigned int version)
     ar & BOOST_SERIALIZATION_NVP(bm.fIdxElements_);
     ar & BOOST_SERIALIZATION_NVP(bm.nmElements_);
     ar & BOOST_SERIALIZATION_NVP(bm.barcodeBreakdown_);
+    ar & BOOST_SERIALIZATION_NVP(bm.parts_);
 }
 
 template <class Archive>
@@ -108,6 +120,104 @@ void serialize(Archive &ar, TemplateLengthStatistics &tls, const unsigned int ve
     ar & BOOST_SERIALIZATION_NVP(tls.mateMax_);
 }
 
+namespace matchSelector {
+
+template <class Archive>
+void serialize(Archive &ar, TileStats &ts, const unsigned int version)
+{
+    // per-cycle arrays are sized for the longest supported reads. Only the cycles that have data are stored
+    unsigned cycles = 0;
+    if (Archive::is_saving::value)
+    {
+        cycles = ts.getCyclesUsed();
+    }
+    else
+    {
+        ts.reset();
+    }
+    ar & BOOST_SERIALIZATION_NVP(cycles);
+    ISAAC_ASSERT_MSG(TileStats::MAX_CYCLES >= cycles, "Too many cycles in the stored tile stats: " << cycles);
+    ar & boost::serialization::make_array(ts.cycleBlanks_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAlignedBlanks_, cycles);
+    ar & boost::serialization::make_array(ts.cycleMismatches_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAlignedMismatches_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAligned1MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAligned2MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAligned3MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAligned4MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycleUniquelyAlignedMoreMismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycle1MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycle2MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycle3MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycle4MismatchFragments_, cycles);
+    ar & boost::serialization::make_array(ts.cycleMoreMismatchFragments_, cycles);
+    ar & BOOST_SERIALIZATION_NVP(ts.fragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(ts.alignedFragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(ts.uniquelyAlignedFragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(ts.adapterBases_);
+}
+
+template <class Archive>
+void serialize(Archive &ar, TileBarcodeStats &tbs, const unsigned int version)
+{
+    ar & BOOST_SERIALIZATION_NVP(tbs.yield_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.yieldQ30_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.qualityScoreSum_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.clusterCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.unanchoredClusterCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.nmnmClusterCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.rmClusterCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.qcClusterCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.alignedFragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.uniquelyAlignedFragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.adapterBases_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.uniquelyAlignedPerfectFragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.alignmentScoreSum_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.basesOutsideIndels_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.uniquelyAlignedBasesOutsideIndels_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.mismatches_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.uniquelyAlignedMismatches_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.alignmentModelCounts_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.nominalModelCounts_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.fragmentCount_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.templateLengthStatistics_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.templateLengthStatisticsSet_);
+    ar & BOOST_SERIALIZATION_NVP(tbs.templateLengthStatisticsConflicts_);
+}
+
+template <class Archive>
+void serialize(Archive &ar, MatchSelectorStats &mss, const unsigned int version)
+{
+    ar & BOOST_SERIALIZATION_NVP(mss.tileStats_);
+
+    // a tile contains clusters of only the barcodes of its lane. Only the non-empty tile barcode stats are stored
+    std::vector<unsigned> nonEmpty;
+    if (Archive::is_saving::value)
+    {
+        for (unsigned i = 0; mss.tileBarcodeStats_.size() != i; ++i)
+        {
+            if (!mss.tileBarcodeStats_[i].empty())
+            {
+                nonEmpty.push_back(i);
+            }
+        }
+    }
+    else
+    {
+        std::for_each(mss.tileBarcodeStats_.begin(), mss.tileBarcodeStats_.end(),
+                      boost::bind(&TileBarcodeStats::reset, _1));
+        // the loaded values are not covered by the touched entries tracking
+        mss.sparse_ = false;
+    }
+    ar & BOOST_SERIALIZATION_NVP(nonEmpty);
+    for (const unsigned i : nonEmpty)
+    {
+        ar & boost::serialization::make_nvp("tileBarcodeStats", mss.tileBarcodeStats_.at(i));
+    }
+}
+
+} //namespace matchSelector
+
 } //namespace alignment
 
 namespace flowcell {
@@ -147,6 +257,22 @@ void serialize(Archive &ar, BarcodePathMap &bbm, const unsigned int version)
     ar & BOOST_SERIALIZATION_NVP(bbm.samplePaths);
 }
 
+template <class Archive>
+void serialize(Archive &ar, LaneBarcodeStats &lbs, const unsigned int version)
+{
+    ar & BOOST_SERIALIZATION_NVP(lbs.topUnknownBarcodes_);
+    ar & BOOST_SERIALIZATION_NVP(lbs.barcodeCount_);
+    ar & BOOST_SERIALIZATION_NVP(lbs.perfectBarcodeCount_);
+    ar & BOOST_SERIALIZATION_NVP(lbs.oneMismatchBarcodeCount_);
+}
+
+template <class Archive>
+void serialize(Archive &ar, DemultiplexingStats &ds, const unsigned int version)
+{
+    ar & BOOST_SERIALIZATION_NVP(ds.topUnknownBarcodes_);
+    ar & BOOST_SERIALIZATION_NVP(ds.laneBarcodeStats_);
+}
+
 }
 
 namespace workflow {
@@ -160,6 +286,29 @@ void serialize(Archive &ar, FoundMatchesMetadata &fmm, const unsigned int versio
 
 } //namespace alignWorkflow
 
+/**
+ * \brief MatchSelectorStats is not default-constructible. The entries get constructed before they are loaded.
+ */
+template <class Archive>
+void serializeTileStats(
+    Archive &ar,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats,
+    const bool collectCycleStats,
+    const flowcell::BarcodeMetadataList &barcodeMetadataList)
+{
+    std::size_t count = tileStats.size();
+    ar & BOOST_SERIALIZATION_NVP(count);
+    if (Archive::is_loading::value)
+    {
+        tileStats.clear();
+        tileStats.resize(count, alignment::matchSelector::MatchSelectorStats(collectCycleStats, barcodeMetadataList));
+    }
+    for (alignment::matchSelector::MatchSelectorStats &stats : tileStats)
+    {
+        ar & boost::serialization::make_nvp("tileStats", stats);
+    }
+}
+
 template <class Archive>
 void serialize(Archive &ar, AlignWorkflow &a, const unsigned int version)
 {
@@ -170,6 +319,10 @@ void serialize(Archive &ar, AlignWorkflow &a, const unsigned int version)
         ar & BOOST_SERIALIZATION_NVP(a.foundMatchesMetadata_);
         ar & BOOST_SERIALIZATION_NVP(a.selectedMatchesMetadata_);
         ar & BOOST_SERIALIZATION_NVP(a.barcodeTemplateLengthStatistics_);
+        serializeTileStats(
+            ar, a.matchSelectorStats_,
+            reports::AlignmentReportGenerator::none != a.statsImageFormat_, a.barcodeMetadataList_);
+        ar & BOOST_SERIALIZATION_NVP(a.demultiplexingStats_);
         if (AlignWorkflow::BamDone <= a.state_)
         {
             ar & BOOST_SERIALIZATION_NVP(a.barcodeBamMapping_);
@@ -0,0 +1,113 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file AlignProgress.hh
+ **
+ ** \brief Persistent record of the tile chunks completed by the alignment phase.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_WORKFLOW_ALIGN_WORKFLOW_ALIGN_PROGRESS_HH
+#define iSAAC_WORKFLOW_ALIGN_WORKFLOW_ALIGN_PROGRESS_HH
+
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "alignment/BinMetadata.hh"
+#include "alignment/TemplateLengthStatistics.hh"
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "demultiplexing/DemultiplexingStats.hh"
+#include "flowcell/BarcodeMetadata.hh"
+#include "flowcell/TileMetadata.hh"
+
+namespace isaac
+{
+namespace workflow
+{
+namespace alignWorkflow
+{
+
+/**
+ * \brief Each completed chunk of tiles gets its own file with the statistics of its tiles and the state of the bins,
+ *        template length statistics and demultiplexing statistics as of the moment the chunk was done. This keeps
+ *        the cost of a checkpoint independent of the number of tiles aligned before it.
+ */
+class AlignProgress: boost::noncopyable
+{
+public:
+    AlignProgress(
+        const boost::filesystem::path &tempDirectory,
+        const bool collectCycleStats,
+        const flowcell::BarcodeMetadataList &barcodeMetadataList);
+
+    /**
+     * \brief Removes the records left by previous runs
+     */
+    void clear();
+
+    /**
+     * \brief Loads the chunks recorded by an interrupted run. The state as of the last recorded chunk is stored
+     *        in binMetadataList, barcodeTemplateLengthStatistics and demultiplexingStats
+     */
+    void load(
+        alignment::BinMetadataList &binMetadataList,
+        std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+        demultiplexing::DemultiplexingStats &demultiplexingStats);
+
+    /**
+     * \brief Records the chunk as complete. The bins must be synchronized with their files
+     *
+     * \param tileStats statistics of all tiles indexed by tile index. Only the chunkTiles ones are recorded
+     */
+    void save(
+        const flowcell::TileMetadataList &chunkTiles,
+        const std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats,
+        const alignment::BinMetadataList &binMetadataList,
+        const std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+        const demultiplexing::DemultiplexingStats &demultiplexingStats);
+
+    /// Number of chunks loaded from the interrupted run
+    std::size_t getLoadedChunkCount() const {return loadedChunks_.size();}
+
+    const flowcell::TileMetadataList &getChunkTiles(const std::size_t chunk) const
+    {
+        return loadedChunks_.at(chunk).tiles_;
+    }
+
+    const std::vector<alignment::matchSelector::MatchSelectorStats> &getChunkTileStats(const std::size_t chunk) const
+    {
+        return loadedChunks_.at(chunk).tileStats_;
+    }
+
+private:
+    const boost::filesystem::path tempDirectory_;
+    const bool collectCycleStats_;
+    const flowcell::BarcodeMetadataList &barcodeMetadataList_;
+
+    struct Chunk
+    {
+        flowcell::TileMetadataList tiles_;
+        std::vector<alignment::matchSelector::MatchSelectorStats> tileStats_;
+    };
+    std::vector<Chunk> loadedChunks_;
+    // index of the next chunk to be saved
+    std::size_t nextChunk_;
+
+    boost::filesystem::path getChunkPath(const std::size_t chunk) const;
+};
+
+} // namespace alignWorkflow
+} // namespace workflow
+} // namespace isaac
+
+#endif // #ifndef iSAAC_WORKFLOW_ALIGN_WORKFLOW_ALIGN_PROGRESS_HH
@@ -21,9 +21,13 @@
 #define iSAAC_WORKFLOW_ALIGN_WORKFLOW_BAM_DATA_SOURCE_HH
 
 #include <condition_variable>
+#include <memory>
 #include <thread>
 
+#include <boost/exception_ptr.hpp>
+
 #include "alignment/BclClusters.hh"
+#include "bam/BamIndexReader.hh"
 #include "flowcell/BarcodeMetadata.hh"
 #include "flowcell/BamLayout.hh"
 #include "flowcell/TileMetadata.hh"
@@ -42,6 +46,9 @@ namespace alignWorkflow
 class BamClusterLoader
 {
     std::string flowcellId_;
+    // when false, the reads that remain unpaired at the end of the input are left for the caller to collect
+    bool resolveUnpaired_;
+    bool inputExhausted_;
 
     io::BamLoader bamLoader_;
     bamDataSource::PairedEndClusterExtractor clusterExtractor_;
@@ -56,11 +63,15 @@ public:
         const std::size_t maxFlowcellIdLength,
         const std::size_t maxReadNameLength,
         const std::size_t minClusterLength,
-        const std::size_t minReadLength) :
+        const std::size_t minReadLength,
+        const std::size_t pendingMatesMemory) :
+        resolveUnpaired_(true),
+        inputExhausted_(false),
         bamLoader_(maxPathLength, threads, coresMax),
         clusterExtractor_(tempDirectoryPath, maxBamFileLength, maxFlowcellIdLength, maxReadNameLength, minClusterLength, cleanupIntermediary,
                           // assume each uncompressed bam record is roughly sizeof(header) + (read length * 2). Double the estimate.
-                          bamLoader_.BUFFER_SIZE / (sizeof(bam::BamBlockHeader) + minReadLength * 2) * 2)
+                          bamLoader_.BUFFER_SIZE / (sizeof(bam::BamBlockHeader) + minReadLength * 2) * 2,
+                          pendingMatesMemory)
     {
         flowcellId_.reserve(maxFlowcellIdLength);
     }
@@ -69,6 +80,24 @@ public:
         const std::string &flowcellId,
         const boost::filesystem::path &bamPath);
 
+    /**
+     * \brief Loads clusters from the region only. The reads that don't find their mates within the region
+     *        are available via forEachUnpaired once loadClusters returns 0.
+     *
+     * \param tempKey unique among the BamClusterLoader instances that share the temporary directory
+     */
+    void open(
+        const std::string &tempKey,
+        const boost::filesystem::path &bamPath,
+        const bam::BamFileRegion &region);
+
+    template <typename F>
+    void forEachUnpaired(F f)
+    {
+        ISAAC_ASSERT_MSG(inputExhausted_, "Unpaired reads can be collected only at the end of input");
+        clusterExtractor_.forEachUnpaired(f);
+    }
+
     template <typename ClusterInsertIt, typename PfInserIt>
     unsigned loadClusters(unsigned clusterCount, const unsigned nameLengthMax, const flowcell::ReadMetadataList &readMetadataList,
         ClusterInsertIt &clusterIt, PfInserIt &pfIt);
@@ -88,6 +117,8 @@ private:
 
 class BamBaseCallsSource : virtual public TileSource, virtual public BarcodeSource
 {
+    // fraction of availableMemory to keep the reads that did not find their mates in the same bam buffer
+    static const unsigned PENDING_MATES_MEMORY_FRACTION = 16;
 protected:
     const flowcell::Layout &bamFlowcellLayout_;
 private:
@@ -237,6 +268,134 @@ struct DataSourceTraits<BackgroundBamBaseCallsSource> : public DataSourceTraits<
 {
 };
 
+/**
+ * \brief Loads regions of an indexed bam file on multiple threads. Each region produces its own tiles, the
+ *        tiles are handed out in the region order. Reads that don't find their mates within the region are
+ *        paired up in a shared cache once the region is done. The ones that remain unpaired at the end of
+ *        the file go into the last tiles.
+ */
+class RegionBamBaseCallsSource : virtual public TileSource, virtual public BarcodeSource
+{
+    // fraction of availableMemory for the tile buffers of the region loaders
+    static const unsigned REGION_TILES_MEMORY_FRACTION = 4;
+    // fraction of availableMemory to keep the reads that did not find their mates in the same bam buffer
+    static const unsigned PENDING_MATES_MEMORY_FRACTION = 16;
+
+    struct RegionLoader
+    {
+        static const std::size_t NO_REGION = -1UL;
+
+        RegionLoader(
+            const bool cleanupIntermediary,
+            const unsigned coresMax,
+            const boost::filesystem::path &tempDirectoryPath,
+            const std::size_t maxBamFileLength,
+            const std::size_t maxTempKeyLength,
+            const flowcell::Layout &bamFlowcellLayout,
+            const unsigned clusterLength,
+            const std::size_t pendingMatesMemory);
+
+        common::ThreadVector threads_;
+        BamClusterLoader bamClusterLoader_;
+        alignment::BclClusters loading_;
+        alignment::BclClusters loaded_;
+        // region being loaded or NO_REGION
+        std::size_t region_;
+        bool tileLoaded_;
+        bool regionDone_;
+    };
+
+    const flowcell::Layout &bamFlowcellLayout_;
+    const boost::filesystem::path bamPath_;
+    const unsigned tileClustersMax_;
+    const unsigned clusterLength_;
+    const bam::BamFileRegions regions_;
+    bamDataSource::UnpairedReadsCache unpairedReadsCache_;
+    std::vector<std::unique_ptr<RegionLoader> > regionLoaders_;
+    alignment::BclClusters clusters_;
+
+    std::size_t nextRegion_ = 0;
+    std::size_t currentRegion_ = 0;
+    unsigned loadedTile_ = 0;
+    bool terminateRequested_ = false;
+    // first failure of a load thread, rethrown on the client thread
+    boost::exception_ptr loaderException_;
+    std::vector<std::thread> loadThreads_;
+    std::condition_variable stateChangeEvent_;
+    std::mutex stateMutex_;
+
+public:
+    RegionBamBaseCallsSource(
+        const boost::filesystem::path &tempDirectoryPath,
+        const uint64_t availableMemory,
+        const unsigned clustersAtATimeMax,
+        const bool cleanupIntermediary,
+        const unsigned coresMax,
+        const flowcell::Layout &bamFlowcellLayout,
+        const bam::BamFileRegions &regions,
+        const unsigned regionLoadersCount);
+
+    ~RegionBamBaseCallsSource();
+
+    /**
+     * \return number of regions that can be loaded at the same time given the memory and cores available.
+     */
+    static unsigned getRegionLoadersMax(
+        const uint64_t availableMemory,
+        const unsigned clustersAtATimeMax,
+        const unsigned coresMax,
+        const flowcell::Layout &bamFlowcellLayout);
+
+    /**
+     * \brief Splits the bam file into regions expected to produce about clustersAtATimeMax clusters each
+     */
+    static bam::BamFileRegions makeRegions(
+        const bam::BamIndexReader &bamIndex,
+        const unsigned clustersAtATimeMax,
+        const flowcell::Layout &bamFlowcellLayout);
+
+    // TileSource implementation
+    flowcell::TileMetadataList discoverTiles();
+
+    // BarcodeSource implementation
+    virtual void loadBarcodes(
+        const flowcell::Layout &flowcell,
+        const unsigned unknownBarcodeIndex,
+        const flowcell::TileMetadataList &tiles,
+        std::vector<demultiplexing::Barcode> &barcodes)
+    {
+        ISAAC_ASSERT_MSG(false, "Barcode resolution is not implemented for Bam data");
+    }
+
+    // prepare bclData buffers to receive new tile data
+    void resetBclData(
+        const flowcell::TileMetadata& tileMetadata,
+        alignment::BclClusters& bclData) const
+    {
+        // this implementation does nothing as chunk sizes are pre-determined
+    }
+
+    void loadClusters(
+        const flowcell::TileMetadata &tileMetadata,
+        alignment::BclClusters &bclData);
+
+    unsigned getMaxTileClusters() const
+    {
+        return tileClustersMax_;
+    }
+
+private:
+    void loadRegionsThread(RegionLoader &regionLoader, const std::size_t regionLoaderIndex);
+    unsigned loadTile(BamClusterLoader &bamClusterLoader, alignment::BclClusters &clusters);
+    unsigned extractCached(const bool unpaired);
+    RegionLoader &waitForCurrentRegionLoader(std::unique_lock<std::mutex> &lock);
+};
+
+template <>
+struct DataSourceTraits<RegionBamBaseCallsSource> : public DataSourceTraits<BamBaseCallsSource>
+{
+};
+
 
 } // namespace alignWorkflow
 } // namespace workflow
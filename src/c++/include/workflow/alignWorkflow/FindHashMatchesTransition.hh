@@ -37,6 +37,7 @@
 #include "reference/ReferenceMetadata.hh"
 #include "reference/SortedReferenceMetadata.hh"
 
+#include "workflow/alignWorkflow/AlignProgress.hh"
 #include "workflow/alignWorkflow/BclDataSource.hh"
 #include "workflow/alignWorkflow/DataSource.hh"
 #include "workflow/alignWorkflow/FoundMatchesMetadata.hh"
@@ -94,10 +95,17 @@ public:
         unsigned &currentTile,
         unsigned &nextUnprocessedTile,
         DataSourceT &dataSource,
-        const HashMatchFinder &matchFinder,
+        const std::vector<const HashMatchFinder *> &referenceMatchFinders,
         alignment::matchFinder::TileClusterInfo &tileClusterInfo,
-        std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         common::ScopedMallocBlock &mallocBlock);
+
+    /**
+     * \brief Loads the tiles without aligning them so that the data source moves on to the ones that follow
+     */
+    template <typename DataSourceT>
+    void skip(
+        const flowcell::TileMetadataList &tiles,
+        DataSourceT &dataSource);
 private:
     boost::mutex &mutex_;
     boost::condition_variable &stateChangedCondition_;
@@ -131,6 +139,8 @@ public:
         const flowcell::FlowcellLayoutList &flowcellLayoutList,
         const flowcell::BarcodeMetadataList &barcodeMetadataList,
         const bool cleanupIntermediary,
+        const bool checkpointAlignment,
+        const bool resumeAlignment,
         const unsigned bclTilesPerChunk,
         const bool ignoreMissingBcls,
         const bool ignoreMissingFilters,
@@ -144,6 +154,8 @@ public:
         const unsigned matchFinderTooManyRepeats,
         const unsigned matchFinderWayTooManyRepeats,
         const unsigned matchFinderShadowSplitRepeats,
+        const unsigned seedExtensionRepeats,
+        const unsigned seedMismatches,
         const unsigned seedBaseQualityMin,
         const unsigned repeatThreshold,
         const unsigned neighborhoodSizeThreshold,
@@ -153,6 +165,7 @@ public:
         const unsigned tempSaversMax,
         const common::ScopedMallocBlock::Mode memoryControl,
         const std::vector<std::size_t> &clusterIdList,
+        const double sampleClusters,
         const reference::SortedReferenceMetadataList &sortedReferenceMetadataList,
         const reference::NumaContigLists &contigLists,
         const bool extractClusterXy,
@@ -166,6 +179,8 @@ public:
         const bool keepUnaligned,
         const bool clipSemialigned,
         const bool clipOverlapping,
+        const bool clipAdapterOverlap,
+        const bool keepReadNames,
         const bool scatterRepeats,
         const bool rescueShadows,
         const bool trimPEAdapters,
@@ -192,7 +207,9 @@ public:
         alignWorkflow::FoundMatchesMetadata &foundMatches,
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-        const boost::filesystem::path &matchSelectorStatsXmlPath);
+        const boost::filesystem::path &matchSelectorStatsXmlPath,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats);
 
     template<class It, class End>
     void perform(
@@ -201,6 +218,8 @@ public:
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         const boost::filesystem::path &matchSelectorStatsXmlPath,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats,
         boost::mpl::true_ endofvec);
 
     template<class It, class End>
@@ -210,6 +229,8 @@ public:
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         const boost::filesystem::path &matchSelectorStatsXmlPath,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats,
         boost::mpl::false_);
 
     void perform(
@@ -217,12 +238,37 @@ public:
         alignWorkflow::FoundMatchesMetadata &foundMatches,
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-        const boost::filesystem::path &matchSelectorStatsXmlPath);
+        const boost::filesystem::path &matchSelectorStatsXmlPath,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats);
+
+    /**
+     * \brief Highest memory use while the interleaved hashes are replicated one after another. At that point the
+     *        earlier hashes have all their replicas, the later ones are still interleaved and the one being
+     *        replicated has its interleaved original alive next to the replicas of every node.
+     */
+    static uint64_t getReferenceHashReplicationPeak(
+        const std::vector<uint64_t> &hashMemorySizes,
+        const unsigned nodes);
+
+    /**
+     * \brief True if every NUMA node can have own copy of the reference hashes. Otherwise the threads of all
+     *        nodes share one interleaved copy.
+     *
+     * \param availableMemory  memory limit which must accommodate the replication peak as well as the replicas
+     *                         together with the tiles in flight
+     */
+    static bool canReplicateReferenceHash(
+        const uint64_t availableMemory,
+        const std::vector<uint64_t> &hashMemorySizes,
+        const unsigned nodes);
 
 private:
     template<class Archive> friend void serialize(Archive & ar, FindHashMatchesTransition &, const unsigned int file_version);
 
     static const unsigned SEEDS_PER_MATCH_MAX = 4;
+    // fraction of availableMemory for the tiles that are loaded and waiting to be aligned or being aligned
+    static const unsigned TILES_IN_FLIGHT_MEMORY_FRACTION = 8;
     const std::size_t hashTableBucketCount_;
     const flowcell::FlowcellLayoutList &flowcellLayoutList_;
     const bfs::path tempDirectory_;
@@ -230,12 +276,18 @@ private:
     const unsigned coresMax_;
     const std::size_t candidateMatchesMax_;
     const unsigned matchFinderMaxRepeats_;
+    const unsigned seedExtensionRepeats_;
+    const unsigned seedMismatches_;
     const unsigned seedBaseQualityMin_;
     const unsigned seedLength_;
     const unsigned repeatThreshold_;
     const unsigned neighborhoodSizeThreshold_;
     const flowcell::BarcodeMetadataList &barcodeMetadataList_;
     const bool cleanupIntermediary_;
+    // record the progress after each chunk of tiles
+    const bool checkpointAlignment_;
+    // skip the chunks of tiles recorded by the interrupted run
+    const bool resumeAlignment_;
     const unsigned bclTilesPerChunk_;
     const bool ignoreMissingBcls_;
     const bool ignoreMissingFilters_;
@@ -275,25 +327,33 @@ private:
     bool qScoreBin_;
     const boost::array<char, 256> &fullBclQScoreTable_;
 
+    AlignProgress alignProgress_;
+    // index of the chunk of tiles processFlowcellTiles is at
+    std::size_t chunk_;
+
 
     template <typename KmerT>
     void align(
         FoundMatchesMetadata &foundMatches,
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-        const boost::filesystem::path &matchSelectorStatsXmlPath);
+        const boost::filesystem::path &matchSelectorStatsXmlPath,
+        std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+        demultiplexing::DemultiplexingStats &demultiplexingStats);
 
-    template <typename ReferenceHashT>
+    template <typename MatchFinderT>
     void alignFlowcells(
-        const ReferenceHashT &referenceHash,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        const alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         demultiplexing::DemultiplexingStats &demultiplexingStats,
         FoundMatchesMetadata &foundMatches,
         alignment::matchSelector::FragmentStorage &fragmentStorage);
 
-    template <typename ReferenceHashT>
+    template <typename MatchFinderT>
     void alignFlowcells(
-        const ReferenceHashT &referenceHash,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        const alignment::BinMetadataList &checkpointBinMetadataList,
         alignment::BinMetadataList &binMetadataList,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         demultiplexing::DemultiplexingStats &demultiplexingStats,
@@ -307,9 +367,9 @@ private:
         alignment::matchFinder::TileClusterInfo &tileClusterInfo,
         demultiplexing::DemultiplexingStats &demultiplexingStats);
 
-    template <typename ReferenceHashT, typename DataSourceT>
+    template <typename MatchFinderT, typename DataSourceT>
     void findLaneMatches(
-        const ReferenceHashT &referenceHash,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
         const flowcell::Layout &flowcell,
         const unsigned lane,
         const flowcell::BarcodeMetadataList &barcodeGroup,
@@ -317,18 +377,28 @@ private:
         DataSourceT &dataSource,
         demultiplexing::DemultiplexingStats &demultiplexingStats,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-        std::vector<findHashMatchesTransition::IoOverlapThreadWorker> &ioOverlapThreadWorkers);
+        std::vector<findHashMatchesTransition::IoOverlapThreadWorker> &ioOverlapThreadWorkers,
+        alignment::matchSelector::FragmentStorage &fragmentStorage);
 
-    template <typename ReferenceHashT, typename DataSourceT>
+    template <typename MatchFinderT, typename DataSourceT>
     void processFlowcellTiles(
-        const ReferenceHashT &referenceHash,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
         const flowcell::Layout& flowcell,
         DataSourceT &dataSource,
+        const alignment::BinMetadataList &binMetadataList,
         demultiplexing::DemultiplexingStats &demultiplexingStats,
         std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
         FoundMatchesMetadata &foundMatches,
         alignment::matchSelector::FragmentStorage &fragmentStorage);
 
+    /**
+     * \brief Number of tiles that can be loaded and aligned at the same time without risking to run out of memory
+     */
+    static unsigned getTilesInFlightMax(
+        const uint64_t availableMemory,
+        const unsigned maxTileClusters,
+        const flowcell::Layout &flowcell);
+
     void dumpStats(
         const demultiplexing::DemultiplexingStats &demultiplexingStats,
         const flowcell::TileMetadataList &tileMetadataList) const;
@@ -35,6 +35,7 @@
 #include "flowcell/ReadMetadata.hh"
 #include "io/FileBufCache.hh"
 #include "reference/ReferencePosition.hh"
+#include "workflow/alignWorkflow/bamDataSource/PendingMatesTable.hh"
 
 //#pragma GCC push_options
 //#pragma GCC optimize ("0")
@@ -300,6 +301,17 @@ class UnpairedReadsCache
     std::vector<io::FileBufHolder<io::FileBufWithReopen> > tempFiles_;
     common::PathStringType tempFilePathBuffer_;
     TempFileClusterExtractor extractor_;
+
+    // reads waiting for their mates. Partitions that don't fit in memory are spilled into tempFiles_
+    PendingMatesTable pendingMates_;
+    std::vector<bool> spilledPartitions_;
+    // clusters paired through pendingMates_ that have not been extracted yet
+    std::vector<char> matedClusters_;
+    std::vector<bool> matedPf_;
+    std::size_t matedExtracted_;
+    // next pendingMates_ record to be extracted as unpaired
+    std::size_t unpairedOffset_;
+
     // aim to have ~3 gigabyte temp files assuming none of the input reads pair
     static const std::size_t UNPAIRED_BUFFER_SIZE = 1024UL * 1024UL * 1024UL * 3UL;
 public:
@@ -309,7 +321,8 @@ public:
         const std::size_t maxFlowcellIdLength,
         const std::size_t maxReadNameLength,
         const std::size_t minClusterLength,
-        const bool cleanupIntermediary) :
+        const bool cleanupIntermediary,
+        const std::size_t pendingMatesMemory) :
             crcWidth_(log2(std::max<std::size_t>(1, maxBamFileSize / UNPAIRED_BUFFER_SIZE))),
             maxReadNameLength_(maxReadNameLength),
             cleanupIntermediary_(cleanupIntermediary),
@@ -322,7 +335,13 @@ public:
                 1 << getEffectiveCrcWidth<7>(crcWidth_),
                 io::FileBufHolder<io::FileBufWithReopen>(std::ios_base::out | std::ios_base::app | std::ios_base::binary,
                                                          getMaxTempFilePathLength(maxFlowcellIdLength))),
-            extractor_(getMaxTempFilePathLength(maxFlowcellIdLength), UNPAIRED_BUFFER_SIZE, minClusterLength)
+            extractor_(getMaxTempFilePathLength(maxFlowcellIdLength), UNPAIRED_BUFFER_SIZE, minClusterLength),
+            pendingMates_(
+                pendingMatesMemory, tempFilePaths_.size(), maxReadNameLength,
+                sizeof(unsigned) + sizeof(TempFileClusterExtractor::FlagsType) + maxReadNameLength + 1 + minClusterLength),
+            spilledPartitions_(tempFilePaths_.size(), false),
+            matedExtracted_(0),
+            unpairedOffset_(0)
     {
         tempFilePathBuffer_.reserve(getMaxTempFilePathLength(maxFlowcellIdLength));
         BOOST_FOREACH(common::PathStringType &tempPath, tempFilePaths_)
@@ -374,6 +393,12 @@ public:
             tempFileSizes_[i] = 0;
             ++i;
         }
+        pendingMates_.clear();
+        std::fill(spilledPartitions_.begin(), spilledPartitions_.end(), false);
+        matedClusters_.clear();
+        matedPf_.clear();
+        matedExtracted_ = 0;
+        unpairedOffset_ = 0;
         extracting_ = false;
     }
 
@@ -385,15 +410,82 @@ public:
         extractorFileIterator_ = tempFilePaths_.begin();
         extractor_.open(
             *extractorFileIterator_, tempFileSizes_[extractorFileIterator_ - tempFilePaths_.begin()]);
+        unpairedOffset_ = 0;
         extracting_ = true;
     }
 
+    /**
+     * \brief Extracts clusters which got both reads through storeUnpaired
+     *
+     * \return number of clusters not extracted
+     */
+    template <typename ClusterInsertIt, typename PfInsertIt>
+    unsigned extractMated(
+        const unsigned r1Length,
+        const unsigned r2Length,
+        const unsigned nameLengthMax,
+        unsigned clusterCount,
+        ClusterInsertIt &clusterIt,
+        PfInsertIt &pfIt)
+    {
+        ISAAC_ASSERT_MSG(nameLengthMax == maxReadNameLength_, "Mated clusters are stored with " << maxReadNameLength_ <<
+                         " name bytes, requested " << nameLengthMax);
+        const std::size_t clusterLength = r1Length + r2Length + nameLengthMax;
+        for (; clusterCount && matedPf_.size() != matedExtracted_; --clusterCount)
+        {
+            const std::vector<char>::const_iterator clusterBegin = matedClusters_.begin() + clusterLength * matedExtracted_;
+            clusterIt = std::copy(clusterBegin, clusterBegin + clusterLength, clusterIt);
+            const bool pf = matedPf_[matedExtracted_++];
+            *pfIt++ = pf;
+        }
+
+        if (matedPf_.size() == matedExtracted_)
+        {
+            matedClusters_.clear();
+            matedPf_.clear();
+            matedExtracted_ = 0;
+        }
+        return clusterCount;
+    }
+
     template <typename IteratorT>
     void storeUnpaired(
         IteratorT unpairedBegin,
         IteratorT unpairedEnd,
         const flowcell::ReadMetadataList &readMetadataList);
 
+    void storeRecord(const char *record);
+
+    std::size_t getMatedCount() const {return matedPf_.size() - matedExtracted_;}
+
+    /**
+     * \brief calls f(record) for each read that did not find its mate yet, including the spilled ones
+     */
+    template <typename F>
+    void forEachUnpaired(F f)
+    {
+        for (std::size_t offset = 0; pendingMates_.getStorageEnd() != offset;)
+        {
+            const char *record = pendingMates_.getStorageRecord(offset);
+            offset += PendingMatesTable::getRecordLength(record);
+            if (!(PendingMatesTable::getFlags(record) & PendingMatesTable::DEAD_FLAG))
+            {
+                f(record);
+            }
+        }
+
+        std::vector<char> spilled;
+        for (unsigned partition = 0; tempFiles_.size() != partition; ++partition)
+        {
+            readSpilled(partition, spilled);
+            for (std::vector<char>::const_iterator it = spilled.begin(); spilled.end() != it;
+                it += PendingMatesTable::getRecordLength(&*it))
+            {
+                f(&*it);
+            }
+        }
+    }
+
     template <typename ClusterInsertIt, typename PfInsertIt>
     unsigned extractClusters(
         const unsigned r1Length,
@@ -403,6 +495,9 @@ public:
         ClusterInsertIt &clusterIt,
         PfInsertIt &pfIt)
     {
+        clusterCount = extractMated(r1Length, r2Length, nameLengthMax, clusterCount, clusterIt, pfIt);
+        clusterCount = extractPending(r1Length, r2Length, nameLengthMax, clusterCount, clusterIt, pfIt);
+
         while (tempFilePaths_.end() != extractorFileIterator_ && clusterCount)
         {
             clusterCount = extractor_.extractClusters(r1Length, r2Length, nameLengthMax, clusterCount, clusterIt, pfIt);
@@ -422,6 +517,52 @@ public:
 
 
 private:
+    /**
+     * \brief Extracts reads that remained in pendingMates_ at the end of the input as unpaired clusters.
+     *        Their mates can only be in the partitions that have been spilled, so they don't have any.
+     */
+    template <typename ClusterInsertIt, typename PfInsertIt>
+    unsigned extractPending(
+        const unsigned r1Length,
+        const unsigned r2Length,
+        const unsigned nameLengthMax,
+        unsigned clusterCount,
+        ClusterInsertIt &clusterIt,
+        PfInsertIt &pfIt)
+    {
+        while (clusterCount && pendingMates_.getStorageEnd() != unpairedOffset_)
+        {
+            const char *record = pendingMates_.getStorageRecord(unpairedOffset_);
+            unpairedOffset_ += PendingMatesTable::getRecordLength(record);
+            const PendingMatesTable::FlagsType flags = PendingMatesTable::getFlags(record);
+            if (!(flags & PendingMatesTable::DEAD_FLAG))
+            {
+                if (flags & TempFileClusterExtractor::READ_ONE_FLAG)
+                {
+                    clusterIt = std::copy(pendingMates_.getBcl(record), pendingMates_.getBclEnd(record), clusterIt);
+                    clusterIt = std::fill_n(clusterIt, r2Length, 0);
+                }
+                else
+                {
+                    clusterIt = std::fill_n(clusterIt, r1Length, 0);
+                    clusterIt = std::copy(pendingMates_.getBcl(record), pendingMates_.getBclEnd(record), clusterIt);
+                }
+                clusterIt = bam::extractReadName(PendingMatesTable::getName(record), maxReadNameLength_, nameLengthMax, clusterIt);
+                const bool pf = flags & TempFileClusterExtractor::PASS_FILTER_FLAG;
+                *pfIt++ = pf;
+                --clusterCount;
+            }
+        }
+        return clusterCount;
+    }
+
+    void storeMated(
+        const char *pendingRecord,
+        const char *record);
+    void spillPartition(const unsigned partition);
+    void writeRecord(const unsigned partition, const char *record);
+    void readSpilled(const unsigned partition, std::vector<char> &buffer);
+
     const common::PathCharType* makeTempFilePath(const std::string &flowcellId, unsigned crc)
     {
         return makeTempFilePath(flowcellId, crc, tempFilePathBuffer_).c_str();
@@ -499,7 +640,8 @@ public:
         const std::size_t maxReadNameLength,
         const std::size_t minClusterLength,
         const bool cleanupIntermediary,
-        const std::size_t expectedClustersPerClusterBlock) :
+        const std::size_t expectedClustersPerClusterBlock,
+        const std::size_t pendingMatesMemory) :
             firstUnextracted_(end()),
             unpairedReadCache_(
                 tempDirectoryPath,
@@ -507,7 +649,8 @@ public:
                 maxFlowcellIdLength,
                 maxReadNameLength,
                 minClusterLength,
-                cleanupIntermediary)
+                cleanupIntermediary,
+                pendingMatesMemory)
     {
         ISAAC_THREAD_CERR << "Reserving IndexRecord buffer for " << expectedClustersPerClusterBlock << " records" << std::endl;
         reserve(expectedClustersPerClusterBlock);
@@ -568,6 +711,25 @@ public:
         return unpairedReadCache_.extractClusters(r1Length, r2Length, nameLengthMax, clusterCount, clusterIt, pfIt);
     }
 
+    template <typename F>
+    void forEachUnpaired(F f)
+    {
+        ISAAC_ASSERT_MSG(empty(), "Unpaired reads are expected to be all in the cache");
+        unpairedReadCache_.forEachUnpaired(f);
+    }
+
+    template <typename ClusterInsertIt, typename PfInsertIt>
+    unsigned extractMated(
+        const unsigned r1Length,
+        const unsigned r2Length,
+        const unsigned nameLengthMax,
+        unsigned clusterCount,
+        ClusterInsertIt &clusterIt,
+        PfInsertIt &pfIt)
+    {
+        return unpairedReadCache_.extractMated(r1Length, r2Length, nameLengthMax, clusterCount, clusterIt, pfIt);
+    }
+
 
     /**
      * \brief For index entries that have all the reads needed, copies bcl data into the output and removes the index entry
@@ -0,0 +1,174 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file PendingMatesTable.hh
+ **
+ ** Bounded-memory store of bam reads waiting for their mates.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_WORKFLOW_ALIGN_WORKFLOW_BAM_DATA_SOURCE_PENDING_MATES_TABLE_HH
+#define iSAAC_WORKFLOW_ALIGN_WORKFLOW_BAM_DATA_SOURCE_PENDING_MATES_TABLE_HH
+
+#include <vector>
+
+#include "common/Debug.hh"
+
+namespace isaac
+{
+namespace workflow
+{
+namespace alignWorkflow
+{
+namespace bamDataSource
+{
+
+/**
+ * \brief Open addressing hash of unpaired read records keyed by the hash of the read name.
+ *
+ * Records are stored in the same format as the one used by TempFileClusterExtractor:
+ * [unsigned recordLength][unsigned char flags][name of nameLength bytes][0][bcl]
+ * so that a record can be spilled into a temporary file as is.
+ *
+ * The memory used is fixed at construction. Each record belongs to one of partitionCount
+ * partitions. When the memory runs out, the caller is expected to remove the partition
+ * that holds the most bytes and redirect all its subsequent reads to the temporary storage.
+ */
+class PendingMatesTable
+{
+public:
+    typedef uint64_t NameHashType;
+    typedef unsigned char FlagsType;
+
+private:
+    struct Slot
+    {
+        static const uint64_t EMPTY = -1UL;
+        static const uint64_t ERASED = -2UL;
+        NameHashType nameHash_;
+        uint64_t offset_;
+        Slot() : nameHash_(0), offset_(EMPTY) {}
+        bool isLive() const {return EMPTY != offset_ && ERASED != offset_;}
+    };
+
+    const std::size_t nameLength_;
+    std::vector<Slot> slots_;
+    std::size_t usedSlots_;
+    std::size_t liveRecords_;
+
+    std::vector<char> arena_;
+    std::size_t deadBytes_;
+    std::vector<std::size_t> partitionBytes_;
+
+public:
+    static const FlagsType DEAD_FLAG = 0x80;
+    static const std::size_t NOT_FOUND = -1UL;
+
+    PendingMatesTable(
+        const std::size_t memoryBudget,
+        const std::size_t partitionCount,
+        const std::size_t nameLength,
+        const std::size_t minRecordLength);
+
+    std::size_t getMemoryBudget() const
+    {
+        return slots_.size() * sizeof(Slot) + arena_.capacity();
+    }
+
+    bool empty() const {return !liveRecords_;}
+    std::size_t size() const {return liveRecords_;}
+
+    static NameHashType hashName(const char *name, const std::size_t nameLength)
+    {
+        // FNV-1a
+        NameHashType ret = 14695981039346656037UL;
+        for (const char *end = name + nameLength; end != name; ++name)
+        {
+            ret ^= static_cast<unsigned char>(*name);
+            ret *= 1099511628211UL;
+        }
+        return ret;
+    }
+
+    static unsigned getRecordLength(const char *record) {return reinterpret_cast<const unsigned &>(*record);}
+    static FlagsType getFlags(const char *record) {return *reinterpret_cast<const FlagsType*>(record + sizeof(unsigned));}
+    static const char *getName(const char *record) {return record + sizeof(unsigned) + sizeof(FlagsType);}
+    const char *getBcl(const char *record) const {return getName(record) + nameLength_ + 1;}
+    const char *getBclEnd(const char *record) const {return record + getRecordLength(record);}
+
+    /**
+     * \return index of the slot holding the record with the name or NOT_FOUND
+     */
+    std::size_t find(const NameHashType nameHash, const char *name) const;
+    const char *getRecord(const std::size_t slot) const {return &arena_[slots_[slot].offset_];}
+
+    /**
+     * \brief releases the record. The memory is reclaimed when the arena runs out of space.
+     */
+    void erase(const std::size_t slot, const std::size_t partition);
+
+    /**
+     * \return false if there is not enough memory to store the record.
+     */
+    bool insert(const NameHashType nameHash, const std::size_t partition, const char *record);
+
+    /**
+     * \return partition that occupies the most of the arena
+     */
+    std::size_t getLargestPartition() const;
+    std::size_t getPartitionBytes(const std::size_t partition) const {return partitionBytes_.at(partition);}
+
+    /**
+     * \brief calls store(record) for each live record of the partition and removes it from the table
+     *        partitionOf(record) is used to determine the record partition.
+     */
+    template <typename PartitionOfF, typename StoreF>
+    void removePartition(const std::size_t partition, PartitionOfF partitionOf, StoreF store)
+    {
+        std::size_t slot = 0;
+        for (Slot &s : slots_)
+        {
+            if (s.isLive() && partition == partitionOf(&arena_[s.offset_]))
+            {
+                store(&arena_[s.offset_]);
+                erase(slot, partition);
+            }
+            ++slot;
+        }
+    }
+
+    /**
+     * \brief Sequential access to the stored records in the order they were inserted. Records that have
+     *        DEAD_FLAG set are not part of the table anymore.
+     */
+    std::size_t getStorageEnd() const {return arena_.size();}
+    const char *getStorageRecord(const std::size_t offset) const {return &arena_[offset];}
+
+    void clear();
+
+private:
+    std::size_t findFreeSlot(const NameHashType nameHash) const;
+    void compact();
+    void rehash();
+    bool namesMatch(const char *record, const char *name) const
+    {
+        return std::equal(name, name + nameLength_, getName(record));
+    }
+};
+
+} // namespace bamDataSource
+} // namespace alignWorkflow
+} // namespace workflow
+} // namespace isaac
+
+#endif // #ifndef iSAAC_WORKFLOW_ALIGN_WORKFLOW_BAM_DATA_SOURCE_PENDING_MATES_TABLE_HH
@@ -17,6 +17,8 @@
  ** \author Roman Petrovski
  **/
 
+#include <bitset>
+
 #include "flowcell/Layout.hh"
 #include "alignment/HashMatchFinder.hh"
 #include "alignment/Quality.hh"
@@ -66,7 +68,7 @@ std::size_t iSAAC_PROFILING_NOINLINE SeedHashMatchFinder<ReferenceHash>::getSeed
     const unsigned seedOffset,
     const flowcell::ReadMetadata &readMetadata,
     const unsigned filterContigId,
-    typename ReferenceHash::MatchRange matchPositions,
+    ReferenceOffsetRange matchPositions,
     ReferenceOffsetList& referenceOffsets) const
 {
     const std::size_t before = referenceOffsets.size();
@@ -392,14 +394,196 @@ void iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatc
     // else we either have too many candidate alignments or we have not used enough seeds to trust them.
 }
 
+/**
+ * \brief Replaces the repetitive forward and reverse hits of the seed with the hits of the seed extended by the
+ *        following KMER_BASES bases on the reference strand.
+ *
+ * When the read does not have enough good bases to extend one strand, the repetitive hits of that strand are
+ * dropped and the other strand is still tried.
+ *
+ * \return false if the reference hash has no extension for the seed or no hits are left on either strand
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+template <typename TranslatorT>
+bool ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::extendRepeatSeed(
+    const BclClusters::const_iterator bclBegin,
+    const unsigned endSeedOffset,
+    const TranslatorT &translator,
+    const KmerT &seedKmer,
+    SeedHitsCache &seedHitsCache,
+    SeedHitsCache::Entry &cached,
+    SeedHits &hits) const
+{
+    static const unsigned KMER_BASES = oligo::KmerTraits<KmerT>::KMER_BASES;
+    const std::size_t extensionRepeatsMin = BaseT::referenceHash_.getExtensionRepeatsMin();
+    if (!extensionRepeatsMin)
+    {
+        return false;
+    }
+
+    if (hits.forwardHitCount() >= extensionRepeatsMin)
+    {
+        // forward seed is followed on the reference by the read bases that follow it
+        KmerT extension(0);
+        if (hits.seedOffset_ + KMER_BASES * 2 <= endSeedOffset &&
+            oligo::makeKmer<KMER_BASES>(bclBegin + hits.seedOffset_ + KMER_BASES, translator, extension))
+        {
+            hits.forwardMatches_ = BaseT::findExtendedMatches(seedKmer, extension);
+        }
+        else
+        {
+            // too close to the end of the read. Leave the forward strand to the other seeds
+            hits.forwardMatches_ = ReferenceOffsetRange(0, 0);
+        }
+    }
+
+    if (!seedHitsCache.hasReverse(cached))
+    {
+        seedHitsCache.setReverse(cached, BaseT::findMatches(oligo::reverseComplement(seedKmer)));
+    }
+    hits.reverseMatches_ = cached.reverse_;
+    if (hits.reverseHitCount() >= extensionRepeatsMin)
+    {
+        // reverse-complemented seed is followed on the reference by the reverse-complemented read bases preceding it
+        KmerT extension(0);
+        if (KMER_BASES <= hits.seedOffset_ &&
+            oligo::makeKmer<KMER_BASES>(bclBegin + hits.seedOffset_ - KMER_BASES, translator, extension))
+        {
+            hits.reverseMatches_ = BaseT::findExtendedMatches(
+                oligo::reverseComplement(seedKmer), oligo::reverseComplement(extension));
+        }
+        else
+        {
+            // too close to the beginning of the read. Leave the reverse strand to the other seeds
+            hits.reverseMatches_ = ReferenceOffsetRange(0, 0);
+        }
+    }
+    return !hits.empty();
+}
+
+/**
+ * \brief Replaces the hits of a seed that has no exact matches with the hits that tolerate mismatches.
+ *
+ * \return false if there are too many hits to keep.
+ */
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+bool ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findMismatchSeedHits(
+    const KmerT &seedKmer,
+    SeedHitsCache &seedHitsCache,
+    SeedHitsCache::Entry &cached,
+    SeedHits &hits) const
+{
+    if (!seedHitsCache.hasMismatches(cached))
+    {
+        ReferenceOffsetRange forward(0, 0);
+        ReferenceOffsetRange reverse(0, 0);
+        const bool fit = BaseT::findMismatchMatches(seedKmer, seedHitsCache, forward) &&
+            BaseT::findMismatchMatches(oligo::reverseComplement(seedKmer), seedHitsCache, reverse);
+        seedHitsCache.setMismatches(cached, forward, reverse, !fit);
+    }
+    hits.forwardMatches_ = cached.mismatchForward_;
+    hits.reverseMatches_ = cached.mismatchReverse_;
+    return !cached.mismatchRepeat_;
+}
+
+template <typename ReferenceHash, unsigned seedsPerMatchMax>
+template <typename TranslatorT>
+bool ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::collectSeedHit(
+    const Cluster& cluster,
+    const unsigned readIndex,
+    const std::size_t seedRepeatThreshold,
+    const unsigned endSeedOffset,
+    const TranslatorT &translator,
+    const BclClusters::const_iterator bclBegin,
+    const unsigned seedOffset,
+    const KmerT &seedKmer,
+    SeedHitsCache &seedHitsCache,
+    SeedsHits& seedsHits,
+    std::size_t &repeatSeeds) const
+{
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(
+        cluster.getId(), "seed at offset : " << seedOffset << " " <<
+        (oligo::Bases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << "/" <<
+        (oligo::ReverseBases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << " endSeedOffset:" << endSeedOffset);
+    SeedHitsCache::Entry &cached = seedHitsCache.get(readIndex, seedOffset);
+    if (!seedHitsCache.hasForward(cached))
+    {
+        seedHitsCache.setForward(cached, BaseT::findMatches(seedKmer));
+    }
+    const ReferenceOffsetRange fwMatchRange = cached.forward_;
+//    ISAAC_ASSERT_MSG(fwMatchRange.second == std::adjacent_find(fwMatchRange.first, fwMatchRange.second),
+//                     "Duplicate matches unexpected:" << *std::adjacent_find(fwMatchRange.first, fwMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
+//        for(auto it = fwMatchRange.first; it != fwMatchRange.second; ++it)
+//        {
+//            const reference::ContigList::Offset &referenceOffset = *it;
+//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "fw Hit offset:" << referenceOffset);
+//        }
+    if (std::size_t(std::distance(fwMatchRange.first, fwMatchRange.second)) >= seedRepeatThreshold)
+    {
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " fwMatchRange: MatchRange(" << std::distance(fwMatchRange.first, fwMatchRange.second) << ")");
+        SeedHits hits = { seedOffset, fwMatchRange, ReferenceOffsetRange(0, 0) };
+        if (extendRepeatSeed(bclBegin, endSeedOffset, translator, seedKmer, seedHitsCache, cached, hits) &&
+            !hits.empty() && hits.hitCount() < seedRepeatThreshold)
+        {
+            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: extended " << hits);
+            seedsHits.push_back(hits);
+            return true;
+        }
+        ++repeatSeeds;
+        return false;
+    }
+
+    if (!seedHitsCache.hasReverse(cached))
+    {
+        seedHitsCache.setReverse(cached, BaseT::findMatches(oligo::reverseComplement(seedKmer)));
+    }
+    const ReferenceOffsetRange rvMatchRange = cached.reverse_;
+//    ISAAC_ASSERT_MSG(rvMatchRange.second == std::adjacent_find(rvMatchRange.first, rvMatchRange.second),
+//                     "Duplicate matches unexpected:" << *std::adjacent_find(rvMatchRange.first, rvMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
+//        for(auto it = rvMatchRange.first; it != rvMatchRange.second; ++it)
+//        {
+//            const reference::ContigList::Offset &referenceOffset = *it;
+//            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "rv Hit offset:" << referenceOffset);
+//        }
+    SeedHits hits = { seedOffset, fwMatchRange, rvMatchRange };
+    if (hits.empty() && BaseT::referenceHash_.getSeedMismatches() &&
+        !findMismatchSeedHits(seedKmer, seedHitsCache, cached, hits))
+    {
+        ++repeatSeeds;
+        return false;
+    }
+    ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " " << hits);
+    if (hits.hitCount() >= seedRepeatThreshold)
+    {
+        ++repeatSeeds;
+    }
+    else if (!hits.empty()) //empty hits are either due to no match (unlikely in human) or seed base quality filtering.
+    {
+        seedsHits.push_back(hits);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Looks up non-overlapping seeds of the read, best quality windows first.
+ *
+ * Each window is ranked by the lowest base quality it contains. Windows are tried in the order
+ * of decreasing rank with ties resolved by the read offset, so that for uniform quality the placement
+ * is the same as the greedy left-to-right walk. A window is skipped if it overlaps a seed that
+ * has already produced usable hits. Windows that fail due to repeats don't block their neighbours.
+ */
 template <typename ReferenceHash, unsigned seedsPerMatchMax>
 std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::collectSeedHits(
     const Cluster& cluster,
     const unsigned readIndex,
     const std::size_t seedRepeatThreshold,
     const unsigned endSeedOffset,
+    SeedHitsCache &seedHitsCache,
     SeedsHits& seedsHits) const
 {
+    seedHitsCache.prepare(this, cluster.getTile(), cluster.getId());
+
     struct BadBaseMasker
     {
         BadBaseMasker(const unsigned char seedBaseQualityMin = 0) : seedBaseQualityMin_(seedBaseQualityMin){}
@@ -412,56 +596,61 @@ std::size_t iSAAC_PROFILING_NOINLINE ClusterHashMatchFinder<ReferenceHash, seeds
     } translator(BaseT::seedBaseQualityMin_);
 
     typedef reference::Seed <KmerT> Seed;
+    BOOST_STATIC_ASSERT_MSG(1 == Seed::STEP, "Quality-ranked seed placement assumes every read offset is a seed candidate");
+    static const unsigned KMER_BASES = Seed::KMER_BASES;
     const BclClusters::const_iterator bclBegin = cluster.getBclData(readIndex);
-    oligo::InterleavedKmerGenerator<Seed::KMER_BASES, typename Seed::KmerType, BclClusters::const_iterator, Seed::STEP, decltype(translator)>
-        kmerGenerator(bclBegin, bclBegin + endSeedOffset, translator);
 
     std::size_t repeatSeeds = 0;
-    KmerT seedKmer(0);
-    BclClusters::const_iterator bclCurrent;
-    while (kmerGenerator.next(seedKmer, bclCurrent))
+    if (KMER_BASES > endSeedOffset)
+    {
+        return repeatSeeds;
+    }
+
+    // rank every window by its worst base quality using a monotonic queue of read offsets
+    static const unsigned QUALITY_MAX = oligo::BCL_QUALITY_MASK >> 2;
+    const unsigned windows = endSeedOffset - KMER_BASES + 1;
+    common::StaticVector<unsigned, ISAAC_READ_LENGTH_MAX> minQualityQueue;
+    common::StaticVector<unsigned, ISAAC_READ_LENGTH_MAX> windowOrder;
+    std::size_t queueFront = 0;
+    for (unsigned offset = 0; offset < endSeedOffset; ++offset)
     {
-        const unsigned seedOffset = std::distance(bclBegin, bclCurrent);
-
-        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(
-            cluster.getId(), "seed at offset : " << seedOffset << " " <<
-            (oligo::Bases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << "/" <<
-            (oligo::ReverseBases<oligo::BITS_PER_BASE, KmerT>(seedKmer, oligo::KmerTraits<KmerT>::KMER_BASES)) << " endSeedOffset:" << endSeedOffset);
-        const typename ReferenceHash::MatchRange fwMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
-//        ISAAC_ASSERT_MSG(fwMatchRange.second == std::adjacent_find(fwMatchRange.first, fwMatchRange.second),
-//                         "Duplicate matches unexpected:" << *std::adjacent_find(fwMatchRange.first, fwMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
-//            for(auto it = fwMatchRange.first; it != fwMatchRange.second; ++it)
-//            {
-//                const reference::ContigList::Offset &referenceOffset = *it;
-//                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "fw Hit offset:" << referenceOffset);
-//            }
-        if (std::size_t(std::distance(fwMatchRange.first, fwMatchRange.second)) >= seedRepeatThreshold)
+        const unsigned quality = oligo::getQuality(bclBegin[offset]);
+        while (minQualityQueue.size() > queueFront && oligo::getQuality(bclBegin[minQualityQueue.back()]) >= quality)
         {
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " fwMatchRange: MatchRange(" << std::distance(fwMatchRange.first, fwMatchRange.second) << ")");
-            ++repeatSeeds;
+            minQualityQueue.pop_back();
         }
-        else
+        minQualityQueue.push_back(offset);
+        if (offset + 1 >= KMER_BASES)
         {
-            seedKmer = oligo::reverseComplement(seedKmer);
-
-            const typename ReferenceHash::MatchRange rvMatchRange = BaseT::referenceHash_.findMatches(seedKmer);
-//            ISAAC_ASSERT_MSG(rvMatchRange.second == std::adjacent_find(rvMatchRange.first, rvMatchRange.second),
-//                             "Duplicate matches unexpected:" << *std::adjacent_find(rvMatchRange.first, rvMatchRange.second) << " " << oligo::bases<2>(seedKmer, Seed::KMER_BASES));
-//            for(auto it = rvMatchRange.first; it != rvMatchRange.second; ++it)
-//            {
-//                const reference::ContigList::Offset &referenceOffset = *it;
-//                ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "rv Hit offset:" << referenceOffset);
-//            }
-            const SeedHits hits = { seedOffset, fwMatchRange, rvMatchRange };
-            ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "findReadMatches: " << seedOffset << " " << hits);
-            if (hits.hitCount() >= seedRepeatThreshold)
+            const unsigned windowOffset = offset + 1 - KMER_BASES;
+            if (minQualityQueue[queueFront] < windowOffset)
             {
-                ++repeatSeeds;
+                ++queueFront;
             }
-            else if (!hits.empty()) //empty hits are either due to no match (unlikely in human) or seed base quality filtering.
+            const unsigned windowQuality = oligo::getQuality(bclBegin[minQualityQueue[queueFront]]);
+            windowOrder.push_back(((QUALITY_MAX - windowQuality) << 16) | windowOffset);
+        }
+    }
+    ISAAC_ASSERT_MSG(windows == windowOrder.size(), "Expected one rank per window " << windows << " got " << windowOrder.size());
+    std::sort(windowOrder.begin(), windowOrder.end());
+
+    std::bitset<ISAAC_READ_LENGTH_MAX> seeded;
+    KmerT seedKmer(0);
+    for (const unsigned rank : windowOrder)
+    {
+        const unsigned seedOffset = rank & 0xFFFF;
+        if (seeded.test(seedOffset) || seeded.test(seedOffset + KMER_BASES - 1) ||
+            !oligo::makeKmer<KMER_BASES>(bclBegin + seedOffset, translator, seedKmer))
+        {
+            continue;
+        }
+        if (collectSeedHit(
+            cluster, readIndex, seedRepeatThreshold, endSeedOffset, translator, bclBegin,
+            seedOffset, seedKmer, seedHitsCache, seedsHits, repeatSeeds))
+        {
+            for (unsigned offset = seedOffset; offset < seedOffset + KMER_BASES; ++offset)
             {
-                seedsHits.push_back(hits);
-                kmerGenerator.skip(KmerT::KMER_BASES - 1);
+                seeded.set(offset);
             }
         }
     }
@@ -475,6 +664,7 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findReadMat
     const Cluster& cluster,
     const flowcell::ReadMetadata& readMetadata,
     const std::size_t seedRepeatThreshold,
+    SeedHitsCache &seedHitsCache,
     MatchLists& matchLists,
     ReferenceOffsetLists& fwMergeBuffers,
     ReferenceOffsetLists& rvMergeBuffers) const
@@ -485,10 +675,12 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findReadMat
     for (Matches &matches : matchLists) {matches.clear();}
 
     SeedsHits seedsHits;
-    const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, readMetadata.getLength(), seedsHits);
+    // adapter bases identified up front can't produce useful seeds
+    const unsigned seedableLength = readMetadata.getLength() - cluster[readMetadata.getIndex()].getAdapterCyclesMasked();
+    const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, seedableLength, seedHitsCache, seedsHits);
 
     // demand LONG_READ_SEEDS_MIN unless read is too short, otherwise demand SHORT_READ_SEEDS_MIN.
-    const unsigned seedsMin = std::min(LONG_READ_SEEDS_MIN, std::max(SHORT_READ_SEEDS_MIN, readMetadata.getLength() / 2 / SEED_LENGTH));
+    const unsigned seedsMin = std::min(LONG_READ_SEEDS_MIN, std::max(SHORT_READ_SEEDS_MIN, seedableLength / 2 / SEED_LENGTH));
     if (seedsMin <= seedsHits.size())
     {
         std::sort(seedsHits.begin(), seedsHits.end());
@@ -508,6 +700,7 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findHeadAnc
     const unsigned filterContigId,
     const std::size_t seedRepeatThreshold,
     const unsigned headSeedOffsetMax,
+    SeedHitsCache &seedHitsCache,
     MatchLists& matchLists,
     ReferenceOffsetLists& fwMergeBuffers,
     ReferenceOffsetLists& rvMergeBuffers) const
@@ -521,7 +714,7 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findHeadAnc
 //    if (headSeedOffsetMax + reference::Seed<KmerT>::SEED_LENGTH <= readMetadata.getLength())
     {
         SeedsHits seedsHits;
-        const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, headSeedOffsetMax, seedsHits);
+        const std::size_t repeatSeeds = collectSeedHits(cluster, readMetadata.getIndex(), seedRepeatThreshold, headSeedOffsetMax, seedHitsCache, seedsHits);
         if (SV_READ_SEEDS_MIN <= seedsHits.size())
         {
             std::sort(seedsHits.begin(), seedsHits.end());
@@ -545,21 +738,21 @@ std::size_t ClusterHashMatchFinder<ReferenceHash, seedsPerMatchMax>::findHeadAnc
 
 template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::VeryShortKmerType>, 4>;
 
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<10>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<11>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<12>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<13>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<14>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<15>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<16>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<17>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<18>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<19>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<20>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<21>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<22>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<23>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
-template class ClusterHashMatchFinder<reference::ReferenceHash<oligo::BasicKmerType<24>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<10>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<11>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<12>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<13>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<14>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<15>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<16>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<17>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<18>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<19>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<20>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<21>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<22>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<23>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
+template class ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<oligo::BasicKmerType<24>, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > >;
 
 
 } // namespace alignment
@@ -17,6 +17,8 @@
  ** \author Come Raczy
  **/
 
+#include <cmath>
+#include <map>
 #include <numeric>
 #include <fstream>
 #include <cerrno>
@@ -32,9 +34,12 @@
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
 #include "common/FastIo.hh"
+#include "common/PerfTrace.hh"
 #include "reference/Contig.hh"
 #include "reference/ContigLoader.hh"
 
+#include "alignment/matchSelector/ClusterSampling.hh"
+#include "alignment/matchSelector/MatchSelectorStatsBinary.hh"
 #include "alignment/matchSelector/MatchSelectorStatsXml.hh"
 
 namespace isaac
@@ -68,6 +73,7 @@ MatchSelector::MatchSelector(
         const std::size_t candidateMatchesMax,
         const unsigned repeatThreshold,
         const std::vector<std::size_t> &clusterIdList,
+        const double sampleClusters,
         const int mateDriftRange,
         const TemplateLengthStatistics &userTemplateLengthStatistics,
         const int mapqThreshold,
@@ -83,6 +89,8 @@ MatchSelector::MatchSelector(
         const bool keepUnaligned,
         const bool clipSemialigned,
         const bool clipOverlapping,
+        const bool clipAdapterOverlap,
+        const bool keepReadNames,
         const bool scatterRepeats,
         const bool rescueShadows,
         const bool trimPEAdapters,
@@ -105,6 +113,7 @@ MatchSelector::MatchSelector(
       contigLists_(contigLists),
       repeatThreshold_(repeatThreshold),
       clusterIdList_(clusterIdList),
+      sampleClusters_(sampleClusters),
       mapqThreshold_(mapqThreshold),
       pfOnly_(pfOnly),
       collectCycleStats_(collectCycleStats),
@@ -112,6 +121,8 @@ MatchSelector::MatchSelector(
       keepUnaligned_(keepUnaligned),
       clipSemialigned_(clipSemialigned),
       clipOverlapping_(clipOverlapping),
+      clipAdapterOverlap_(clipAdapterOverlap),
+      keepReadNames_(keepReadNames),
       barcodeSequencingAdapters_(generateSequencingAdapters(barcodeMetadataList_)),
       allStats_(),//(tileMetadataList_.size(), matchSelector::MatchSelectorStats(barcodeMetadataList_)),
       threadStats_(computeThreads_.size(), matchSelector::MatchSelectorStats(collectCycleStats_, barcodeMetadataList_)),
@@ -131,7 +142,13 @@ MatchSelector::MatchSelector(
           mateDriftRange,
           userTemplateLengthStatistics,
           perTileTls,
-          detectTemplateBlockSize)
+          detectTemplateBlockSize),
+      tilesInFlight_(),
+      submittedTiles_(0),
+      dispatchTile_(0),
+      tilesTotal_(0),
+      alignedTiles_(0),
+      cancelled_(false)
 {
     ISAAC_TRACE_STAT("Constructing match selector");
     while(threadTemplateBuilders_.size() < computeThreads_.size())
@@ -157,6 +174,10 @@ MatchSelector::MatchSelector(
                                                               alignmentCfg,
                                                               dodgyAlignmentScore, anomalousPairHandicap, reserveBuffers));
     }
+    while (tilesInFlight_.size() < TILES_IN_FLIGHT_MAX)
+    {
+        tilesInFlight_.push_back(new TileInFlight(barcodeMetadataList_.size(), computeThreads_.size()));
+    }
     ISAAC_TRACE_STAT("Constructed match selector");
 }
 
@@ -172,6 +193,85 @@ void MatchSelector::dumpStats(const boost::filesystem::path &statsXmlPath)
     matchSelector::MatchSelectorStatsXml statsXml(
         collectCycleStats_, flowcellLayoutList_, barcodeMetadataList_, tileMetadataList_, allStats_);
     statsXml.serialize(os);
+
+    if (sampleClusters_)
+    {
+        logSampleEstimates();
+    }
+
+    const boost::filesystem::path statsBinPath = boost::filesystem::path(statsXmlPath).replace_extension(".bin");
+    std::ofstream bos(statsBinPath.string().c_str(), std::ios_base::binary);
+    if (!bos) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to open file for writing: " + statsBinPath.string()));
+    }
+    matchSelector::MatchSelectorStatsBinaryWriter statsBin(
+        bos, collectCycleStats_, flowcellLayoutList_, barcodeMetadataList_, tileMetadataList_);
+    BOOST_FOREACH(const flowcell::TileMetadata &tile, tileMetadataList_)
+    {
+        statsBin.writeTile(tile, allStats_.at(tile.getIndex()));
+    }
+    statsBin.close();
+    if (!bos) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Failed to write: " + statsBinPath.string()));
+    }
+}
+
+double MatchSelector::getSampleFraction(const flowcell::TileMetadata &tileMetadata) const
+{
+    return matchSelector::ClusterSampling(sampleClusters_, tileMetadata.getClusterCount()).getFraction();
+}
+
+void MatchSelector::logSampleEstimates() const
+{
+    // normal approximation. Samples worth looking at are large enough for it to hold
+    static const double Z95 = 1.96;
+
+    typedef std::map<unsigned, matchSelector::TileBarcodeStats> ReadStats;
+    ReadStats readSampleStats;
+    std::map<unsigned, double> readFullRunFragments;
+    BOOST_FOREACH(const flowcell::TileMetadata &tile, tileMetadataList_)
+    {
+        const double sampleFraction = getSampleFraction(tile);
+        BOOST_FOREACH(const flowcell::ReadMetadata &read, flowcellLayoutList_.at(tile.getFlowcellIndex()).getReadMetadataList())
+        {
+            BOOST_FOREACH(const flowcell::BarcodeMetadata &barcode, barcodeMetadataList_)
+            {
+                if (barcode.getFlowcellId() == tile.getFlowcellId() && barcode.getLane() == tile.getLane())
+                {
+                    const matchSelector::TileBarcodeStats &pfStat = allStats_.at(tile.getIndex()).getReadBarcodeTileStat(read, barcode, true);
+                    readSampleStats[read.getNumber()] += pfStat;
+                    readFullRunFragments[read.getNumber()] += pfStat.fragmentCount_ / sampleFraction;
+                }
+            }
+        }
+    }
+
+    BOOST_FOREACH(const ReadStats::value_type &readStats, readSampleStats)
+    {
+        const matchSelector::TileBarcodeStats &stats = readStats.second;
+        if (!stats.fragmentCount_)
+        {
+            continue;
+        }
+        const double aligned = double(stats.alignedFragmentCount_) / stats.fragmentCount_;
+        const double alignedMargin = Z95 * std::sqrt(aligned * (1.0 - aligned) / stats.fragmentCount_);
+        const double fullRunFragments = readFullRunFragments[readStats.first];
+        ISAAC_THREAD_CERR << "Sample estimate for read " << readStats.first << ": " <<
+            aligned * 100 << "% of " << stats.fragmentCount_ << " pf fragments aligned (95% CI " <<
+            std::max(0.0, aligned - alignedMargin) * 100 << "%-" << std::min(1.0, aligned + alignedMargin) * 100 << "%), " <<
+            uint64_t(aligned * fullRunFragments) << " of " << uint64_t(fullRunFragments) << " expected in the full run" << std::endl;
+
+        if (stats.basesOutsideIndels_)
+        {
+            // treats bases as independent. Mismatches cluster in fragments, so the real interval is wider.
+            const double mismatches = double(stats.mismatches_) / stats.basesOutsideIndels_;
+            const double mismatchesMargin = Z95 * std::sqrt(mismatches * (1.0 - mismatches) / stats.basesOutsideIndels_);
+            ISAAC_THREAD_CERR << "Sample estimate for read " << readStats.first << ": " <<
+                mismatches * 100 << "% mismatches (approximate 95% CI assuming independent bases " <<
+                std::max(0.0, mismatches - mismatchesMargin) * 100 << "%-" <<
+                std::min(1.0, mismatches + mismatchesMargin) * 100 << "%)" << std::endl;
+        }
+    }
 }
 
 /**
@@ -222,136 +322,332 @@ matchSelector::TemplateAlignmentType MatchSelector::alignCluster(
 }
 
 template <typename MatchFinderT>
-void MatchSelector::alignThread(
+void MatchSelector::alignClusters(
     const unsigned threadNumber,
-    const flowcell::TileMetadata & tileMetadata,
-    const matchFinder::ClusterInfos &clusterInfos,
-    unsigned &threadClusterId,
-    const MatchFinderT &matchFinder,
-    const BclClusters &bclData,
-    const std::vector<TemplateLengthStatistics> & templateLengthStatistics,
+    const TileInFlight &tile,
+    const unsigned clustersBegin,
+    const unsigned clustersEnd,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     matchSelector::FragmentStorage &fragmentStorage)
 {
     Cluster &ourThreadCluster = threadCluster_[threadNumber];
     TemplateBuilder &ourThreadTemplateBuilder = threadTemplateBuilders_.at(threadNumber);
     matchSelector::MatchSelectorStats &ourThreadStats = threadStats_.at(threadNumber);
 
+    const flowcell::TileMetadata &tileMetadata = *tile.tileMetadata_;
+    const matchFinder::ClusterInfos &clusterInfos = *tile.clusterInfos_;
+    const BclClusters &bclData = *tile.bclData_;
+    const std::vector<TemplateLengthStatistics> &templateLengthStatistics = tile.templateLengthStatistics_;
+
     const flowcell::Layout &flowcell = flowcellLayoutList_.at(tileMetadata.getFlowcellIndex());
     const flowcell::ReadMetadataList &tileReads = flowcell.getReadMetadataList();
     const std::size_t barcodeLength = flowcell.getBarcodeLength();
-    const unsigned readNameLength = flowcell.getReadNameLength();
+    // without the name the fragment gets it generated from the tile and cluster id during bam generation
+    const unsigned readNameLength = keepReadNames_ ? flowcell.getReadNameLength() : 0;
+    const matchSelector::ClusterSampling sampling(sampleClusters_, tileMetadata.getClusterCount());
 
     const reference::ContigLists &threadContigLists = contigLists_.threadNodeContainer();
 
-    boost::unique_lock<boost::mutex> lock(mutex_);
-
-    while (tileMetadata.getClusterCount() != threadClusterId)
+    // matches are looked up while templates are built, so the two are traced together
+    ISAAC_PERF_SCOPE("align.findMatchesBuildTemplates");
+    for (unsigned clusterId = clustersBegin; clustersEnd != clusterId; ++clusterId)
     {
-        const unsigned clustersBegin = threadClusterId;
-        static const unsigned clustersAtATime = CLUSTERS_AT_A_TIME;
-        threadClusterId += std::min(clustersAtATime, tileMetadata.getClusterCount() - threadClusterId);
-        const unsigned clustersEnd = threadClusterId;
+        if (!clusterIdList_.empty() && clusterIdList_.end() == std::find(clusterIdList_.begin(), clusterIdList_.end(), clusterId))
         {
-            common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
-            for (unsigned clusterId = clustersBegin; clustersEnd != clusterId; ++clusterId)
+            continue;
+        }
+        if (!sampling.isSampled(clusterId))
+        {
+            continue;
+        }
+        const flowcell::BarcodeMetadata &barcodeMetadata = barcodeMetadataList_[clusterInfos[clusterId].getBarcodeIndex()];
+
+        // uninitialize cluster in case it does not get stored in as storage that buffers data
+        // not relevant anymore as BufferingFragmentStorage is gone
+        fragmentStorage.reset(clusterId, 2 == tileReads.size());
+
+        // initialize the cluster with the bcl data
+        ourThreadCluster.init(tileReads, bclData.cluster(clusterId), tileMetadata.getIndex(), clusterId,
+                              bclData.xy(clusterId), bclData.pf(clusterId), barcodeLength, readNameLength);
+        BamTemplate bamTemplate(tileReads, ourThreadCluster);
+
+        matchSelector::TemplateAlignmentType result = matchSelector::Filtered;
+        if (!barcodeMetadata.isUnmappedReference())
+        {
+            const reference::ContigList &barcodeContigList = threadContigLists.at(barcodeMetadata.getReferenceIndex());
+            const MatchFinderT &barcodeMatchFinder = *referenceMatchFinders.at(barcodeMetadata.getReferenceIndex());
+            const SequencingAdapterList &sequencingAdapters = barcodeSequencingAdapters_.at(barcodeMetadata.getIndex());
+
+            ISAAC_ASSERT_MSG(clusterId < tileMetadata.getClusterCount(), "Cluster ids are expected to be 0-based within the tile.");
+
+            trimLowQualityEnds(ourThreadCluster, baseQualityCutoff_);
+            if (clipAdapterOverlap_)
             {
-                if (!clusterIdList_.empty() && clusterIdList_.end() == std::find(clusterIdList_.begin(), clusterIdList_.end(), clusterId))
-                {
-                    continue;
-                }
-                const flowcell::BarcodeMetadata &barcodeMetadata = barcodeMetadataList_[clusterInfos[clusterId].getBarcodeIndex()];
+                maskAdapterOverlap(ourThreadCluster, sequencingAdapters);
+            }
 
-                // uninitialize cluster in case it does not get stored in as storage that buffers data
-                // not relevant anymore as BufferingFragmentStorage is gone
-                fragmentStorage.reset(clusterId, 2 == tileReads.size());
+            // if pfOnly_ is set, this non-pf cluster will not be reported as a regularly-processed one.
+            // if match list begins with noMatchReferencePosition, then this cluster does not have any matches at all. This is
+            // because noMatchReferencePosition has the highest possible contig number and sort will put it to the end of match list
+            // In either case report it as skipped to ensure statistics consistency
+            if (!pfOnly_ || bclData.pf(clusterId))
+            {
+                result = alignCluster(
+                    barcodeContigList, tileReads, sequencingAdapters,
+                    templateLengthStatistics[barcodeMetadata.getIndex()], barcodeMetadata.getIndex(), barcodeMatchFinder,
+                    restOfGenomeCorrections_[barcodeMetadata.getIndex()],
+                    threadNumber, ourThreadTemplateBuilder, ourThreadCluster, bamTemplate, ourThreadStats,
+                    fragmentStorage);
+            }
+        }
+        ourThreadStats.recordTemplate(
+            tileReads, templateLengthStatistics[barcodeMetadata.getIndex()],
+            bamTemplate, barcodeMetadata.getIndex(), result);
+    }
+}
 
-                // initialize the cluster with the bcl data
-                ourThreadCluster.init(tileReads, bclData.cluster(clusterId), tileMetadata.getIndex(), clusterId,
-                                      bclData.xy(clusterId), bclData.pf(clusterId), barcodeLength, readNameLength);
-                BamTemplate bamTemplate(tileReads, ourThreadCluster);
+/**
+ * \brief Runs template length detection of the tile on the calling thread together with any other threads that
+ *        come to it. The last thread to finish makes the tile available for alignment.
+ */
+template <typename MatchFinderT>
+void MatchSelector::detectTemplateLengths(
+    const unsigned threadNumber,
+    TileInFlight &tile,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
+    std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+    boost::unique_lock<boost::mutex> &lock)
+{
+    if (TileInFlight::Submitted == tile.state_)
+    {
+        // detection for this tile starts from where the detection on the previous one ended
+        std::copy(barcodeTemplateLengthStatistics.begin(), barcodeTemplateLengthStatistics.end(),
+                  tile.templateLengthStatistics_.begin());
+        tile.statsToBuild_ = templateDetector_.prepareTile(*tile.tileMetadata_, tile.templateLengthStatistics_);
+        tile.state_ = TileInFlight::Detecting;
+    }
 
-                matchSelector::TemplateAlignmentType result = matchSelector::Filtered;
-                if (!barcodeMetadata.isUnmappedReference())
-                {
-                    const reference::ContigList &barcodeContigList = threadContigLists.at(barcodeMetadata.getReferenceIndex());
-                    const SequencingAdapterList &sequencingAdapters = barcodeSequencingAdapters_.at(barcodeMetadata.getIndex());
-
-                    ISAAC_ASSERT_MSG(clusterId < tileMetadata.getClusterCount(), "Cluster ids are expected to be 0-based within the tile.");
-
-                    trimLowQualityEnds(ourThreadCluster, baseQualityCutoff_);
-
-                    // if pfOnly_ is set, this non-pf cluster will not be reported as a regularly-processed one.
-                    // if match list begins with noMatchReferencePosition, then this cluster does not have any matches at all. This is
-                    // because noMatchReferencePosition has the highest possible contig number and sort will put it to the end of match list
-                    // In either case report it as skipped to ensure statistics consistency
-                    if (!pfOnly_ || bclData.pf(clusterId))
-                    {
-                        result = alignCluster(
-                            barcodeContigList, tileReads, sequencingAdapters,
-                            templateLengthStatistics[barcodeMetadata.getIndex()], barcodeMetadata.getIndex(), matchFinder,
-                            restOfGenomeCorrections_[barcodeMetadata.getIndex()],
-                            threadNumber, ourThreadTemplateBuilder, ourThreadCluster, bamTemplate, ourThreadStats,
-                            fragmentStorage);
-                    }
-                }
-                ourThreadStats.recordTemplate(
-                    tileReads, templateLengthStatistics[barcodeMetadata.getIndex()],
-                    bamTemplate, barcodeMetadata.getIndex(), result);
+    ++tile.detectingThreads_;
+    {
+        common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+        ISAAC_PERF_SCOPE("align.detectTemplateLengths");
+        // returns immediately if there is nothing to detect or other threads have taken all the clusters
+        templateDetector_.templateLengthThread(
+            threadNumber, *tile.tileMetadata_, *tile.bclData_, *tile.clusterInfos_, referenceMatchFinders,
+            tile.statsToBuild_, tile.templateLengthStatistics_);
+    }
+    if (--tile.detectingThreads_)
+    {
+        // others are still collecting models. Let the last one to finish finalize the statistics
+        while (!cancelled_ && TileInFlight::Detecting == tile.state_)
+        {
+            tilesChangedCondition_.wait(lock);
+        }
+        return;
+    }
+
+    // the tile statistics are not touched by anyone until the tile goes into Aligning state
+    templateDetector_.finalizeTile(
+        *tile.tileMetadata_, tile.templateLengthStatistics_, allStats_.at(tile.tileMetadata_->getIndex()));
+    std::copy(tile.templateLengthStatistics_.begin(), tile.templateLengthStatistics_.end(),
+              barcodeTemplateLengthStatistics.begin());
+    // no thread can be in the scheduler before the tile goes into Aligning state
+    tile.clusterScheduler_.reset(tile.tileMetadata_->getClusterCount(), false);
+    tile.state_ = TileInFlight::Aligning;
+    tilesChangedCondition_.notify_all();
+}
+
+void MatchSelector::completeIfAligned(TileInFlight &tile)
+{
+    if (tile.dispatched() && !tile.statsHolders_)
+    {
+        tile.state_ = TileInFlight::Aligned;
+        ++alignedTiles_;
+        tilesChangedCondition_.notify_all();
+    }
+}
+
+void MatchSelector::mergeThreadStats(
+    const unsigned threadNumber,
+    TileInFlight &tile,
+    boost::unique_lock<boost::mutex> &lock)
+{
+    {
+        common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+        {
+            boost::lock_guard<boost::mutex> statsLock(tile.statsMutex_);
+            // only the entries and cycles the thread has recorded for the tile are merged
+            allStats_.at(tile.tileMetadata_->getIndex()) += threadStats_.at(threadNumber);
+        }
+        threadStats_.at(threadNumber).reset();
+    }
+    --tile.statsHolders_;
+    completeIfAligned(tile);
+}
+
+template <typename MatchFinderT>
+void MatchSelector::alignTilesThread(
+    const unsigned threadNumber,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
+    std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+    matchSelector::FragmentStorage &fragmentStorage)
+{
+    static const uint64_t NO_TILE = -1UL;
+    // tile for which the thread has stats not merged into allStats_ yet
+    uint64_t statsTile = NO_TILE;
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (!cancelled_)
+    {
+        if (NO_TILE != statsTile && statsTile != dispatchTile_)
+        {
+            // no more clusters will come from that tile to this thread
+            mergeThreadStats(threadNumber, tileInFlight(statsTile), lock);
+            statsTile = NO_TILE;
+            continue;
+        }
+
+        if (tilesTotal_ == dispatchTile_)
+        {
+            break;
+        }
+
+        if (submittedTiles_ == dispatchTile_)
+        {
+            tilesChangedCondition_.wait(lock);
+            continue;
+        }
+
+        TileInFlight &tile = tileInFlight(dispatchTile_);
+        if (TileInFlight::Submitted == tile.state_ || TileInFlight::Detecting == tile.state_)
+        {
+            detectTemplateLengths(threadNumber, tile, referenceMatchFinders, barcodeTemplateLengthStatistics, lock);
+            continue;
+        }
+
+        if (NO_TILE == statsTile)
+        {
+            statsTile = dispatchTile_;
+            ++tile.statsHolders_;
+        }
+
+        {
+            common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+            uint64_t clustersBegin = 0;
+            uint64_t clustersEnd = 0;
+            while (tile.clusterScheduler_.next(threadNumber, clustersBegin, clustersEnd))
+            {
+                alignClusters(threadNumber, tile, clustersBegin, clustersEnd, referenceMatchFinders, fragmentStorage);
             }
         }
+
+        if (!tile.exhausted_)
+        {
+            // other threads might still be aligning the last chunks but there is nothing left to take
+            tile.exhausted_ = true;
+            ++dispatchTile_;
+            ISAAC_THREAD_CERR << "Aligning clusters dispatched for " << *tile.tileMetadata_ << " with " <<
+                tile.clusterScheduler_.getSteals() << " steals" << std::endl;
+        }
     }
 }
 
 template <typename MatchFinderT>
-void MatchSelector::parallelSelect(
-    alignment::matchFinder::TileClusterInfo &tileClusterInfo,
+void MatchSelector::alignTiles(
+    const unsigned tileCount,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-    const flowcell::TileMetadata &tileMetadata,
-    const MatchFinderT &matchFinder,
-    const BclClusters &bclData,
     matchSelector::FragmentStorage &fragmentStorage)
 {
-    const reference::ContigLists &threadContigLists = contigLists_.threadNodeContainer();
-    std::for_each(threadStats_.begin(), threadStats_.end(), boost::bind(&matchSelector::MatchSelectorStats::reset, _1));
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        tilesTotal_ = tileCount;
+    }
+    ISAAC_THREAD_CERR << "Selecting matches on " <<  computeThreads_.size() << " threads for " << tileCount << " tiles" << std::endl;
 
-    ISAAC_THREAD_CERR << "Resizing fragment storage for " <<  tileMetadata.getClusterCount() << " clusters " << std::endl;
-    fragmentStorage.resize(tileMetadata.getClusterCount());
-    ISAAC_THREAD_CERR << "Resizing fragment storage done for " <<  tileMetadata.getClusterCount() << " clusters " << std::endl;
+    computeThreads_.execute(boost::bind(&MatchSelector::alignTilesThread<MatchFinderT>, this, _1,
+                                        boost::ref(referenceMatchFinders),
+                                        boost::ref(barcodeTemplateLengthStatistics),
+                                        boost::ref(fragmentStorage)));
 
-    // Recompute relevant genome corrections
-    const flowcell::Layout &flowcell = flowcellLayoutList_.at(tileMetadata.getFlowcellIndex());
+    ISAAC_THREAD_CERR << "Selecting matches done on " <<  computeThreads_.size() << " threads for " << alignedTiles_ << " tiles" << std::endl;
+}
+
+void MatchSelector::beginTiles(const flowcell::TileMetadataList &laneTiles)
+{
+    ISAAC_ASSERT_MSG(!laneTiles.empty(), "Expected at least one tile");
+    const flowcell::TileMetadata &laneTile = laneTiles.front();
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    submittedTiles_ = 0;
+    dispatchTile_ = 0;
+    // alignTiles sets the real value. Until then compute threads must not consider the lane done
+    tilesTotal_ = -1UL;
+    alignedTiles_ = 0;
+    cancelled_ = false;
+    for (TileInFlight &tile : tilesInFlight_)
+    {
+        tile.state_ = TileInFlight::Free;
+    }
+    std::for_each(threadStats_.begin(), threadStats_.end(), boost::bind(&matchSelector::MatchSelectorStats::reset, _1));
+
+    // All tiles of the lane share the read layout and the barcodes. Compute the genome corrections once
+    const reference::ContigLists &threadContigLists = contigLists_.threadNodeContainer();
+    const flowcell::Layout &flowcell = flowcellLayoutList_.at(laneTile.getFlowcellIndex());
     const flowcell::ReadMetadataList &tileReads = flowcell.getReadMetadataList();
     BOOST_FOREACH(const flowcell::BarcodeMetadata &barcodeMetadata, barcodeMetadataList_)
     {
-        if (tileMetadata.getLane() == barcodeMetadata.getLane() && !barcodeMetadata.isUnmappedReference())
+        if (laneTile.getLane() == barcodeMetadata.getLane() && !barcodeMetadata.isUnmappedReference())
         {
             const reference::ContigList &barcodeContigList = threadContigLists.at(barcodeMetadata.getReferenceIndex());
             restOfGenomeCorrections_[barcodeMetadata.getIndex()] = RestOfGenomeCorrection(barcodeContigList, tileReads);
         }
     }
+}
 
-    templateDetector_.determineTemplateLengths(
-        tileMetadata, tileClusterInfo.at(tileMetadata.getIndex()),
-        restOfGenomeCorrections_,
-        matchFinder, bclData, barcodeTemplateLengthStatistics, threadStats_[0]);
-
-    ISAAC_THREAD_CERR << "Selecting matches on " <<  computeThreads_.size() << " threads for " << tileMetadata << "\n" << std::endl;
-    unsigned clusterId = 0;
-    computeThreads_.execute(boost::bind(&MatchSelector::alignThread<MatchFinderT>, this, _1,
-                                        boost::ref(tileMetadata),
-                                        boost::ref(tileClusterInfo.at(tileMetadata.getIndex())),
-                                        boost::ref(clusterId),
-                                        boost::ref(matchFinder),
-                                        boost::ref(bclData),
-                                        boost::cref(barcodeTemplateLengthStatistics),
-                                        boost::ref(fragmentStorage)));
-
-    ISAAC_THREAD_CERR << "Selecting matches done on " <<  computeThreads_.size() << " threads for " << clusterId << " clusters of " << tileMetadata  << std::endl;
+uint64_t MatchSelector::submitTile(
+    const flowcell::TileMetadata &tileMetadata,
+    const matchFinder::ClusterInfos &clusterInfos,
+    const BclClusters &bclData)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    const uint64_t ret = submittedTiles_;
+    TileInFlight &tile = tileInFlight(ret);
+    // each submitter has at most one tile in flight and there are no more submitters than TILES_IN_FLIGHT_MAX
+    ISAAC_ASSERT_MSG(TileInFlight::Free == tile.state_, "Too many tiles in flight, " << tileMetadata);
+    tile.tileMetadata_ = &tileMetadata;
+    tile.clusterInfos_ = &clusterInfos;
+    tile.bclData_ = &bclData;
+    tile.statsToBuild_ = 0;
+    tile.detectingThreads_ = 0;
+    tile.exhausted_ = false;
+    tile.statsHolders_ = 0;
+    tile.state_ = TileInFlight::Submitted;
+    ++submittedTiles_;
+    tilesChangedCondition_.notify_all();
+    return ret;
+}
 
-    BOOST_FOREACH(const matchSelector::MatchSelectorStats &threadStats, threadStats_)
+void MatchSelector::waitTile(const uint64_t ticket)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    TileInFlight &tile = tileInFlight(ticket);
+    while (TileInFlight::Aligned != tile.state_)
     {
-        allStats_.at(tileMetadata.getIndex()) += threadStats;
+        if (cancelled_)
+        {
+            BOOST_THROW_EXCEPTION(common::ThreadingException("Terminating due to failures on other threads"));
+        }
+        tilesChangedCondition_.wait(lock);
     }
+    tile.state_ = TileInFlight::Free;
+}
+
+void MatchSelector::cancelTiles()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    cancelled_ = true;
+    tilesChangedCondition_.notify_all();
 }
 
 void MatchSelector::reserveMemory(
@@ -365,17 +661,27 @@ void MatchSelector::reserveMemory(
     }
 }
 
+void MatchSelector::restoreTileStats(
+    const flowcell::TileMetadataList &tileMetadataList,
+    const std::vector<matchSelector::MatchSelectorStats> &tileStats)
+{
+    ISAAC_ASSERT_MSG(tileMetadataList.size() == tileStats.size(), "Expected stats for each tile");
+    reserveMemory(tileMetadataList);
+    for (std::size_t i = 0; tileMetadataList.size() != i; ++i)
+    {
+        allStats_.at(tileMetadataList[i].getIndex()) = tileStats[i];
+    }
+}
+
 template <typename KmerT> struct InstantiateTemplates : MatchSelector
 {
-    typedef ClusterHashMatchFinder<reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > MatchFinderT;
-    void parallelSelectInstance(alignment::matchFinder::TileClusterInfo &tileClusterInfo,
-                                std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-                                const flowcell::TileMetadata &tileMetadata,
-                                const MatchFinderT &matchFinder,
-                                const BclClusters &bclData,
-                                matchSelector::FragmentStorage &fragmentStorage)
+    typedef ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > > MatchFinderT;
+    void alignTilesInstance(const unsigned tileCount,
+                            const std::vector<const MatchFinderT *> &referenceMatchFinders,
+                            std::vector<TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+                            matchSelector::FragmentStorage &fragmentStorage)
     {
-        MatchSelector::parallelSelect(tileClusterInfo, barcodeTemplateLengthStatistics, tileMetadata, matchFinder, bclData, fragmentStorage);
+        MatchSelector::alignTiles(tileCount, referenceMatchFinders, barcodeTemplateLengthStatistics, fragmentStorage);
     }
 };
 
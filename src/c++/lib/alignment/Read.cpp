@@ -48,6 +48,7 @@ void Read::decodeBcl(
     reverseQuality_.clear();
     /*beginCyclesMasked_ = 0L;*/
     endCyclesMasked_ = 0L;
+    adapterCyclesMasked_ = 0L;
 
     for (BclClusters::const_iterator bcl = bclBegin; bclEnd > bcl; ++bcl)
     {
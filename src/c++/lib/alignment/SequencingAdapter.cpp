@@ -16,6 +16,8 @@
  ** 
  ** \author Roman Petrovski
  **/
+#include <algorithm>
+
 #include <boost/format.hpp>
 
 #include "alignment/SequencingAdapter.hh"
@@ -138,5 +140,76 @@ SequencingAdapter::getMatchRange(
     return std::make_pair(mismatchBase, mismatchBase);
 }
 
+/**
+ * \brief Counts the positions where the sequences differ. Ns never match.
+ */
+static unsigned countMismatches(const char *left, const char *right, const unsigned length)
+{
+    // plain loop over contiguous bytes without early exit for the compiler to vectorize
+    unsigned ret = 0;
+    for (unsigned i = 0; length != i; ++i)
+    {
+        ret += (left[i] != right[i]) | (oligo::SEQUENCE_OLIGO_N == left[i]);
+    }
+    return ret;
+}
+
+unsigned findAdapterOverlap(
+    const Read &read1,
+    const Read &read2,
+    const SequencingAdapterList &sequencingAdapters)
+{
+    // anything shorter is either unreliable or too short to seed anyway
+    static const unsigned OVERLAP_LENGTH_MIN = 32;
+    // one mismatch per this many overlapping bases
+    static const unsigned OVERLAP_BASES_PER_MISMATCH = 10;
+
+    const std::vector<char> &forward1 = read1.getForwardSequence();
+    const std::vector<char> &forward2 = read2.getForwardSequence();
+    // the bases of the first read appear at the end of the reverse-complemented second read
+    const std::vector<char> &reverse2 = read2.getReverseSequence();
+    const unsigned insertLengthMax = std::min(read1.getLength(), read2.getLength());
+    for (unsigned insertLength = OVERLAP_LENGTH_MIN; insertLengthMax >= insertLength; ++insertLength)
+    {
+        // adapter kmer lookup is cheap and rejects most of the lengths before the sequences are compared
+        if (sequencingAdapters.end() == std::find_if(
+            sequencingAdapters.begin(), sequencingAdapters.end(),
+            [&](const SequencingAdapter &adapter)
+            {
+                return adapter.isStrandCompatible(false) &&
+                    (adapter.startsAt(forward1.begin() + insertLength, forward1.end()) ||
+                        adapter.startsAt(forward2.begin() + insertLength, forward2.end()));
+            }))
+        {
+            continue;
+        }
+
+        if (insertLength / OVERLAP_BASES_PER_MISMATCH >=
+            countMismatches(&forward1.front(), &reverse2.front() + reverse2.size() - insertLength, insertLength))
+        {
+            return insertLength;
+        }
+    }
+    return 0;
+}
+
+void maskAdapterOverlap(
+    Cluster &cluster,
+    const SequencingAdapterList &sequencingAdapters)
+{
+    if (2 != cluster.getNonEmptyReadsCount() || sequencingAdapters.empty())
+    {
+        return;
+    }
+
+    const unsigned insertLength = findAdapterOverlap(cluster[0], cluster[1], sequencingAdapters);
+    if (insertLength)
+    {
+        ISAAC_THREAD_CERR_DEV_TRACE_CLUSTER_ID(cluster.getId(), "maskAdapterOverlap: insert length " << insertLength);
+        cluster[0].maskAdapterCyclesFromEnd(cluster[0].getLength() - insertLength);
+        cluster[1].maskAdapterCyclesFromEnd(cluster[1].getLength() - insertLength);
+    }
+}
+
 } // namespace alignment
 } // namespace isaac
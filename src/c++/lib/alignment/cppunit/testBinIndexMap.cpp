@@ -0,0 +1,113 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinIndexMap.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "RegistryName.hh"
+#include "testBinIndexMap.hh"
+
+#include "alignment/matchSelector/BinIndexMap.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBinIndexMap, registryName("BinIndexMap"));
+
+using isaac::alignment::matchSelector::BinIndexMap;
+using isaac::reference::ReferencePosition;
+using isaac::reference::SortedReferenceMetadata;
+using isaac::reference::SortedReferenceMetadataList;
+
+static void putContig(
+    SortedReferenceMetadata &reference, const std::string &name, const uint64_t genomicOffset, const uint64_t totalBases)
+{
+    reference.putContig(genomicOffset, name, "genome.fa", 0, totalBases, totalBases, totalBases,
+                        reference.getContigsCount(), "", "", "");
+}
+
+void TestBinIndexMap::setUp()
+{
+    // contigs interleave: the first reference has the longest contig 0, the second one the longest contig 1 and
+    // the only contig 2
+    references_.resize(2);
+    putContig(references_[0], "a1", 0, 1000);
+    putContig(references_[0], "a2", 1000, 200);
+    putContig(references_[1], "b1", 0, 300);
+    putContig(references_[1], "b2", 300, 800);
+    putContig(references_[1], "b3", 1100, 500);
+}
+
+void TestBinIndexMap::tearDown()
+{
+    references_.clear();
+}
+
+void TestBinIndexMap::testMergeContigs()
+{
+    const SortedReferenceMetadata::Contigs merged = isaac::reference::mergeContigs(references_);
+    CPPUNIT_ASSERT_EQUAL(3UL, merged.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("a1"), merged[0].name_);
+    CPPUNIT_ASSERT_EQUAL(std::string("b2"), merged[1].name_);
+    CPPUNIT_ASSERT_EQUAL(std::string("b3"), merged[2].name_);
+    CPPUNIT_ASSERT_EQUAL(1000UL, merged[0].totalBases_);
+    CPPUNIT_ASSERT_EQUAL(800UL, merged[1].totalBases_);
+    CPPUNIT_ASSERT_EQUAL(500UL, merged[2].totalBases_);
+    for (std::size_t i = 0; merged.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(unsigned(i), merged[i].index_);
+    }
+    CPPUNIT_ASSERT_EQUAL(0UL, merged[0].genomicPosition_);
+    CPPUNIT_ASSERT_EQUAL(1000UL, merged[1].genomicPosition_);
+    CPPUNIT_ASSERT_EQUAL(1800UL, merged[2].genomicPosition_);
+
+    // the order of references does not matter
+    const SortedReferenceMetadataList reversed(references_.rbegin(), references_.rend());
+    CPPUNIT_ASSERT(merged == isaac::reference::mergeContigs(reversed));
+
+    // single reference is taken as is
+    const SortedReferenceMetadataList single(1, references_[1]);
+    CPPUNIT_ASSERT(references_[1].getContigs() == isaac::reference::mergeContigs(single));
+}
+
+void TestBinIndexMap::testMultiReferenceRouting()
+{
+    static const unsigned BIN_LENGTH = 100;
+    const SortedReferenceMetadata::Contigs merged = isaac::reference::mergeContigs(references_);
+    const BinIndexMap binIndexMap(merged, BIN_LENGTH);
+    // bin 0 for unaligned, then 10 + 8 + 5 bins for the merged contigs
+    CPPUNIT_ASSERT_EQUAL(4UL, binIndexMap.size());
+    CPPUNIT_ASSERT_EQUAL(23U, binIndexMap.back().back());
+
+    // every position of every reference ends up in a bin of its own contig, including the tails of the contigs
+    // that are shorter than the merged ones
+    for (const SortedReferenceMetadata &reference : references_)
+    {
+        unsigned lastContigBin = 0;
+        for (const SortedReferenceMetadata::Contig &contig : reference.getContigs())
+        {
+            for (uint64_t position = 0; contig.totalBases_ > position; position += BIN_LENGTH / 2)
+            {
+                const ReferencePosition pos(contig.index_, position);
+                const unsigned bin = binIndexMap.getBinIndex(pos);
+                CPPUNIT_ASSERT(lastContigBin < bin);
+                CPPUNIT_ASSERT(binIndexMap.getBinFirstPos(bin) <= pos);
+                CPPUNIT_ASSERT(pos < binIndexMap.getBinFirstInvalidPos(bin));
+            }
+            const unsigned lastBin = binIndexMap.getBinIndex(ReferencePosition(contig.index_, contig.totalBases_ - 1));
+            CPPUNIT_ASSERT_EQUAL(binIndexMap.at(contig.index_ + 1).at((contig.totalBases_ - 1) / BIN_LENGTH), lastBin);
+            lastContigBin = binIndexMap.at(contig.index_ + 1).back();
+        }
+    }
+
+    // a2 and b2 share the bins of the merged contig 1 which follow the 10 bins of contig 0
+    CPPUNIT_ASSERT_EQUAL(12U, binIndexMap.getBinIndex(ReferencePosition(1, 150)));
+}
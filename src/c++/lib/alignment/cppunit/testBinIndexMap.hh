@@ -0,0 +1,41 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinIndexMap.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_BIN_INDEX_MAP_HH
+#define iSAAC_ALIGNMENT_TEST_BIN_INDEX_MAP_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "reference/SortedReferenceMetadata.hh"
+
+class TestBinIndexMap : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBinIndexMap );
+    CPPUNIT_TEST( testMergeContigs );
+    CPPUNIT_TEST( testMultiReferenceRouting );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    isaac::reference::SortedReferenceMetadataList references_;
+
+public:
+    void setUp();
+    void tearDown();
+    void testMergeContigs();
+    void testMultiReferenceRouting();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_BIN_INDEX_MAP_HH
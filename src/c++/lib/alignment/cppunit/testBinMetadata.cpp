@@ -0,0 +1,98 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinMetadata.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "RegistryName.hh"
+#include "testBinMetadata.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBinMetadata, registryName("BinMetadata"));
+
+using isaac::alignment::BinMetadata;
+using isaac::reference::ReferencePosition;
+
+void TestBinMetadata::setUp()
+{
+}
+
+void TestBinMetadata::tearDown()
+{
+}
+
+void TestBinMetadata::testPartition()
+{
+    BinMetadata bin(1, 1, ReferencePosition(2, 10000), 10000, "bin-00000003-000010000.dat");
+    CPPUNIT_ASSERT(!bin.isPartitioned());
+    CPPUNIT_ASSERT_EQUAL(625UL, bin.getPartLength());
+    CPPUNIT_ASSERT_EQUAL(unsigned(BinMetadata::PARTS), bin.getPartCount());
+    CPPUNIT_ASSERT_EQUAL(0U, bin.getPart(ReferencePosition(2, 10000)));
+    CPPUNIT_ASSERT_EQUAL(1U, bin.getPart(ReferencePosition(2, 10625)));
+    CPPUNIT_ASSERT_EQUAL(15U, bin.getPart(ReferencePosition(2, 19999)));
+
+    bin.incrementDataSize(ReferencePosition(2, 10000), 100);
+    bin.incrementFIdxElements(ReferencePosition(2, 10000), 1, 0);
+    bin.partition();
+    CPPUNIT_ASSERT(bin.isPartitioned());
+    // data stored before partitioning could be in any part
+    for (unsigned part = 0; BinMetadata::PARTS != part; ++part)
+    {
+        CPPUNIT_ASSERT_EQUAL(100UL, bin.getPartDataSize(part));
+    }
+
+    bin.incrementParts((1 << 3) | (1 << 4), 50, 0, 1, 0);
+    CPPUNIT_ASSERT_EQUAL(100UL, bin.getPartDataSize(2));
+    CPPUNIT_ASSERT_EQUAL(150UL, bin.getPartDataSize(3));
+    CPPUNIT_ASSERT_EQUAL(150UL, bin.getPartDataSize(4));
+
+    // short bins have fewer parts
+    const BinMetadata shortBin(1, 2, ReferencePosition(3, 0), 20, "bin-00000004-000000000.dat");
+    CPPUNIT_ASSERT_EQUAL(2UL, shortBin.getPartLength());
+    CPPUNIT_ASSERT_EQUAL(10U, shortBin.getPartCount());
+}
+
+void TestBinMetadata::testPartsBin()
+{
+    BinMetadata bin(1, 1, ReferencePosition(2, 10000), 10000, "bin-00000003-000010000.dat");
+    bin.incrementDataSize(ReferencePosition(2, 10000), 100);
+    bin.incrementFIdxElements(ReferencePosition(2, 10000), 1, 0);
+    bin.partition();
+    bin.incrementDataSize(ReferencePosition(2, 12000), 50);
+    bin.incrementRIdxElements(ReferencePosition(2, 12000), 1, 0);
+    bin.incrementParts(1 << 3, 50, 0, 1, 0);
+
+    const BinMetadata first = bin.getPartsBin(0, 3);
+    CPPUNIT_ASSERT(!first.isPartitioned());
+    CPPUNIT_ASSERT_EQUAL(ReferencePosition(2, 10000), first.getBinStart());
+    CPPUNIT_ASSERT_EQUAL(1875UL, first.getLength());
+    CPPUNIT_ASSERT_EQUAL(300UL, first.getDataSize());
+    CPPUNIT_ASSERT_EQUAL(3UL, first.getFIdxElements());
+    CPPUNIT_ASSERT_EQUAL(0UL, first.getRIdxElements());
+    // barcode elements can't be more than the bin has
+    CPPUNIT_ASSERT_EQUAL(2UL, bin.getTotalElements());
+    CPPUNIT_ASSERT_EQUAL(2UL, first.getTotalElements());
+    CPPUNIT_ASSERT_EQUAL(bin.getPath(), first.getPath());
+
+    const BinMetadata hot = bin.getPartsBin(3, 4);
+    CPPUNIT_ASSERT_EQUAL(ReferencePosition(2, 11875), hot.getBinStart());
+    CPPUNIT_ASSERT_EQUAL(625UL, hot.getLength());
+    CPPUNIT_ASSERT_EQUAL(150UL, hot.getDataSize());
+    CPPUNIT_ASSERT_EQUAL(1UL, hot.getRIdxElements());
+    CPPUNIT_ASSERT_EQUAL(2UL, hot.getTotalElements());
+
+    const BinMetadata last = bin.getPartsBin(4, BinMetadata::PARTS);
+    CPPUNIT_ASSERT_EQUAL(ReferencePosition(2, 12500), last.getBinStart());
+    CPPUNIT_ASSERT_EQUAL(7500UL, last.getLength());
+    CPPUNIT_ASSERT_EQUAL(bin.getBinEnd(), last.getBinEnd());
+}
@@ -0,0 +1,40 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinMetadata.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_BIN_METADATA_HH
+#define iSAAC_ALIGNMENT_TEST_BIN_METADATA_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "alignment/BinMetadata.hh"
+
+class TestBinMetadata : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBinMetadata );
+    CPPUNIT_TEST( testPartition );
+    CPPUNIT_TEST( testPartsBin );
+    CPPUNIT_TEST_SUITE_END();
+private:
+
+public:
+    void setUp();
+    void tearDown();
+    void testPartition();
+    void testPartsBin();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_BIN_METADATA_HH
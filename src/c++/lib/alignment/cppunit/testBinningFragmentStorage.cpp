@@ -0,0 +1,172 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinningFragmentStorage.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <boost/assign.hpp>
+
+#include "RegistryName.hh"
+#include "testBinningFragmentStorage.hh"
+
+#include "alignment/matchSelector/BinningFragmentStorage.hh"
+#include "common/Exceptions.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBinningFragmentStorage, registryName("BinningFragmentStorage"));
+
+using namespace isaac;
+using alignment::BinMetadata;
+using alignment::BinMetadataList;
+using alignment::matchSelector::BinningFragmentStorage;
+using reference::ReferencePosition;
+using reference::SortedReferenceMetadata;
+
+static const unsigned BIN_LENGTH = 500;
+// what the interrupted run left in each bin file
+static const uint64_t WRITTEN_BYTES = 300;
+
+TestBinningFragmentStorage::TestBinningFragmentStorage() :
+    contigs_(boost::assign::list_of
+        (SortedReferenceMetadata::Contig(0, "chr1", false, "", 0, 0, 0, 1000, 1000, "", "", ""))
+        (SortedReferenceMetadata::Contig(1, "chr2", false, "", 0, 0, 1000, 1000, 1000, "", "", ""))),
+    binIndexMap_(contigs_, BIN_LENGTH)
+{
+    barcodeMetadataList_.push_back(flowcell::BarcodeMetadata("FC1", 0, 1, 0, false, flowcell::SequencingAdapterMetadataList()));
+    barcodeMetadataList_.back().setIndex(0);
+}
+
+void TestBinningFragmentStorage::setUp()
+{
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory_);
+}
+
+void TestBinningFragmentStorage::tearDown()
+{
+    boost::filesystem::remove_all(directory_);
+}
+
+/**
+ * \brief Opens fresh bins, fills their files with WRITTEN_BYTES and returns the bins with some of the data
+ *        recorded as complete
+ */
+BinMetadataList TestBinningFragmentStorage::makeCheckpoint()
+{
+    BinMetadataList bins;
+    {
+        BinningFragmentStorage storage(
+            directory_, true, binIndexMap_, contigs_, barcodeMetadataList_, false, 4096, BIN_LENGTH, 1,
+            BinMetadataList(), bins);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(5), bins.size());
+
+    for (const BinMetadata &bin : bins)
+    {
+        std::ofstream os(bin.getPath().c_str(), std::ios_base::binary);
+        os << std::string(WRITTEN_BYTES, 'x');
+    }
+
+    bins.at(0).incrementDataSize(ReferencePosition(ReferencePosition::TooManyMatch), 50);
+    bins.at(0).incrementNmElements(0, 5, 0);
+    // unaligned bin that got flushed while the chunk was being aligned
+    bins.push_back(bins.at(0));
+    bins.back().startNew();
+    bins.back().incrementDataSize(ReferencePosition(ReferencePosition::TooManyMatch), 25);
+    bins.back().incrementNmElements(0, 2, 0);
+
+    bins.at(1).incrementDataSize(bins.at(1).getBinStart(), 100);
+    // data before the offset belongs to the bins that were sent for sorting
+    bins.at(3).incrementDataSize(bins.at(3).getBinStart(), 20);
+    bins.at(3).startNew();
+    bins.at(3).incrementDataSize(bins.at(3).getBinStart(), 40);
+    return bins;
+}
+
+void TestBinningFragmentStorage::testResume()
+{
+    const BinMetadataList checkpoint = makeCheckpoint();
+
+    // bins may share a file. The file keeps the data of the bin that extends furthest
+    std::map<boost::filesystem::path, uint64_t> expectedSizes;
+    for (const BinMetadata &bin : checkpoint)
+    {
+        uint64_t &size = expectedSizes[bin.getPath()];
+        size = std::max(size, bin.getDataEndOffset());
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(75), expectedSizes[checkpoint.at(0).getPath()]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(60), expectedSizes[checkpoint.at(3).getPath()]);
+
+    BinMetadataList bins;
+    {
+        BinningFragmentStorage storage(
+            directory_, true, binIndexMap_, contigs_, barcodeMetadataList_, false, 4096, BIN_LENGTH, 1,
+            checkpoint, bins);
+
+        CPPUNIT_ASSERT_EQUAL(checkpoint.size(), bins.size());
+        for (std::size_t i = 0; checkpoint.size() != i; ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(checkpoint.at(i).getPath(), bins.at(i).getPath());
+            CPPUNIT_ASSERT_EQUAL(checkpoint.at(i).getDataOffset(), bins.at(i).getDataOffset());
+            CPPUNIT_ASSERT_EQUAL(checkpoint.at(i).getDataSize(), bins.at(i).getDataSize());
+        }
+
+        for (const std::map<boost::filesystem::path, uint64_t>::value_type &file : expectedSizes)
+        {
+            CPPUNIT_ASSERT_EQUAL(file.second, uint64_t(boost::filesystem::file_size(file.first)));
+        }
+        storage.sync();
+    }
+
+    // closing without storing anything must not change the files
+    for (const std::map<boost::filesystem::path, uint64_t>::value_type &file : expectedSizes)
+    {
+        CPPUNIT_ASSERT_EQUAL(file.second, uint64_t(boost::filesystem::file_size(file.first)));
+    }
+}
+
+void TestBinningFragmentStorage::testResumeMismatch()
+{
+    const BinMetadataList checkpoint = makeCheckpoint();
+
+    {
+        BinMetadataList missingBin(checkpoint);
+        missingBin.erase(missingBin.begin() + 1);
+        BinMetadataList bins;
+        CPPUNIT_ASSERT_THROW(
+            BinningFragmentStorage(
+                directory_, true, binIndexMap_, contigs_, barcodeMetadataList_, false, 4096, BIN_LENGTH, 1,
+                missingBin, bins),
+            common::PreConditionException);
+    }
+
+    {
+        BinMetadataList tooLong(checkpoint);
+        tooLong.at(2).incrementDataSize(tooLong.at(2).getBinStart(), WRITTEN_BYTES + 1);
+        BinMetadataList bins;
+        CPPUNIT_ASSERT_THROW(
+            BinningFragmentStorage(
+                directory_, true, binIndexMap_, contigs_, barcodeMetadataList_, false, 4096, BIN_LENGTH, 1,
+                tooLong, bins),
+            common::IoException);
+    }
+
+    // failed attempts leave the data in place
+    for (const BinMetadata &bin : checkpoint)
+    {
+        CPPUNIT_ASSERT_EQUAL(WRITTEN_BYTES, uint64_t(boost::filesystem::file_size(bin.getPath())));
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testBinningFragmentStorage.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_BINNING_FRAGMENT_STORAGE_HH
+#define iSAAC_ALIGNMENT_TEST_BINNING_FRAGMENT_STORAGE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include "alignment/BinMetadata.hh"
+#include "alignment/matchSelector/BinIndexMap.hh"
+#include "flowcell/BarcodeMetadata.hh"
+#include "reference/SortedReferenceMetadata.hh"
+
+class TestBinningFragmentStorage : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBinningFragmentStorage );
+    CPPUNIT_TEST( testResume );
+    CPPUNIT_TEST( testResumeMismatch );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    const isaac::reference::SortedReferenceMetadata::Contigs contigs_;
+    const isaac::alignment::matchSelector::BinIndexMap binIndexMap_;
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList_;
+    boost::filesystem::path directory_;
+
+    isaac::alignment::BinMetadataList makeCheckpoint();
+
+public:
+    TestBinningFragmentStorage();
+    void setUp();
+    void tearDown();
+    void testResume();
+    void testResumeMismatch();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_BINNING_FRAGMENT_STORAGE_HH
@@ -0,0 +1,98 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testClusterSampling.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "RegistryName.hh"
+#include "testClusterSampling.hh"
+
+#include "alignment/matchSelector/ClusterSampling.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestClusterSampling, registryName("ClusterSampling"));
+
+using isaac::alignment::matchSelector::ClusterSampling;
+
+void TestClusterSampling::setUp()
+{
+}
+
+void TestClusterSampling::tearDown()
+{
+}
+
+void TestClusterSampling::testSampleFraction()
+{
+    // sampling off
+    CPPUNIT_ASSERT_EQUAL(1.0, ClusterSampling(0.0, 1000).getFraction());
+    // fraction of the tile
+    CPPUNIT_ASSERT_EQUAL(0.25, ClusterSampling(0.25, 1000).getFraction());
+    CPPUNIT_ASSERT_EQUAL(0.1, ClusterSampling(0.1, 1000).getFraction());
+    // clusters per tile
+    CPPUNIT_ASSERT_EQUAL(0.1, ClusterSampling(100, 1000).getFraction());
+    CPPUNIT_ASSERT_EQUAL(1.0, ClusterSampling(1, 1).getFraction());
+    CPPUNIT_ASSERT_EQUAL(1.0, ClusterSampling(5000, 1000).getFraction());
+    // empty tile
+    CPPUNIT_ASSERT_EQUAL(1.0, ClusterSampling(100, 0).getFraction());
+    CPPUNIT_ASSERT_EQUAL(1.0, ClusterSampling(0.5, 0).getFraction());
+    // small tiles keep at least one cluster
+    CPPUNIT_ASSERT_EQUAL(0.1, ClusterSampling(0.01, 10).getFraction());
+}
+
+void TestClusterSampling::testSampledCount()
+{
+    static const struct
+    {
+        double sampleClusters_;
+        unsigned clusterCount_;
+        uint64_t expected_;
+    } cases[] =
+    {
+        {0.0, 1000, 1000},
+        {0.1, 1000, 100},
+        {0.3, 10, 3},
+        {0.7, 3, 2},
+        {1.0 / 3, 1000, 333},
+        {0.999, 1001, 1000},
+        {1, 1000, 1},
+        {7, 1000, 7},
+        {999, 1000, 999},
+        {1000, 1000, 1000},
+        {1001, 1000, 1000},
+        {3, 7, 3},
+        {0.01, 10, 1},
+    };
+
+    for (const auto &c : cases)
+    {
+        const ClusterSampling sampling(c.sampleClusters_, c.clusterCount_);
+        CPPUNIT_ASSERT_EQUAL(c.expected_, sampling.getSampledCount());
+
+        uint64_t selected = 0;
+        uint64_t lastSelected = 0;
+        uint64_t maxGap = 0;
+        for (uint64_t clusterId = 0; c.clusterCount_ != clusterId; ++clusterId)
+        {
+            if (sampling.isSampled(clusterId))
+            {
+                maxGap = std::max(maxGap, clusterId - lastSelected);
+                lastSelected = clusterId;
+                ++selected;
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(c.expected_, selected);
+        // spread evenly over the tile
+        CPPUNIT_ASSERT(maxGap <= (c.clusterCount_ + c.expected_ - 1) / c.expected_);
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testClusterSampling.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_CLUSTER_SAMPLING_HH
+#define iSAAC_ALIGNMENT_TEST_CLUSTER_SAMPLING_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestClusterSampling : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestClusterSampling );
+    CPPUNIT_TEST( testSampleFraction );
+    CPPUNIT_TEST( testSampledCount );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void tearDown();
+    void testSampleFraction();
+    void testSampledCount();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_CLUSTER_SAMPLING_HH
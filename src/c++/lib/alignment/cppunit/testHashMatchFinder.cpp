@@ -56,6 +56,19 @@ void TestHashMatchFinder::tearDown()
 TestMatchStorage TestHashMatchFinder::findMatches(
     const std::string& reference, const std::string& sequence,
     const isaac::flowcell::ReadMetadataList &readMetadataList)
+{
+    const unsigned clusterLength = isaac::flowcell::getTotalReadLength(readMetadataList);
+    isaac::alignment::SeedHitsCache seedHitsCache;
+    return findMatches(reference, getBcl(sequence.substr(0, clusterLength)), readMetadataList, 0, seedHitsCache);
+}
+
+TestMatchStorage TestHashMatchFinder::findMatches(
+    const std::string& reference, const std::vector<char>& bcls,
+    const isaac::flowcell::ReadMetadataList &readMetadataList,
+    const unsigned seedBaseQualityMin,
+    isaac::alignment::SeedHitsCache &seedHitsCache,
+    const std::size_t seedRepeatThreshold,
+    const unsigned extensionRepeatsMin)
 {
     TestContigList contigList(reference);
 
@@ -63,7 +76,7 @@ TestMatchStorage TestHashMatchFinder::findMatches(
     isaac::reference::ReferenceHasher<isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> > referenceHasher(
         contigList, threads, threads.size());
 
-    const isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> referenceHash = referenceHasher.generate(0x10000);
+    const isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> referenceHash = referenceHasher.generate(0x10000, extensionRepeatsMin);
 
     isaac::flowcell::FlowcellLayoutList flowcells(1, isaac::flowcell::Layout("", isaac::flowcell::Layout::Fastq, isaac::flowcell::FastqFlowcellData(false, '!', false), 8, 0, std::vector<unsigned>(),
                                          readMetadataList, "blah"));
@@ -78,8 +91,6 @@ TestMatchStorage TestHashMatchFinder::findMatches(
     tileClusters.reset(clusterLength, 1);
 
 //    const std::vector<char>& bcls = getBcl(readMetadataList, contigList, 0, 0, readMetadataList.front().getLength());
-    const std::vector<char>& bcls = getBcl(sequence.substr(0, clusterLength));
-
     std::copy(bcls.begin(), bcls.end(), tileClusters.cluster(0));
 
     isaac::alignment::Cluster cluster(readMetadataList.front().getLength());
@@ -92,7 +103,7 @@ TestMatchStorage TestHashMatchFinder::findMatches(
 //        referenceHash, flowcells, isaac::flowcell::BarcodeMetadataList(), 0, repeatThreshold, std::vector<std::size_t>(),
 //        sortedReferenceMetadataList, seedMetadataList, seedMetadataList.size());
     isaac::alignment::ClusterHashMatchFinder< isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType>, 4> matchFinder(
-        referenceHash, 1000, 0, 1000);
+        referenceHash, 1000, seedBaseQualityMin, 1000);
 
     isaac::alignment::ReferenceOffsetLists fwMergeBuffers(11, isaac::alignment::ReferenceOffsetList(1000));
     isaac::alignment::ReferenceOffsetLists rvMergeBuffers(11, isaac::alignment::ReferenceOffsetList(1000));
@@ -100,11 +111,43 @@ TestMatchStorage TestHashMatchFinder::findMatches(
     isaac::alignment::matchFinder::TileClusterInfo tileClusterInfo(tileMetadataList);
     tileClusterInfo.setBarcodeIndex(0, 0, 0);
     matchFinder.findReadMatches(
-        contigList, cluster, flowcells.front().getReadMetadataList().front(), 1000, matchLists, fwMergeBuffers, rvMergeBuffers);
+        contigList, cluster, flowcells.front().getReadMetadataList().front(), seedRepeatThreshold, seedHitsCache,
+        matchLists, fwMergeBuffers, rvMergeBuffers);
 
     return matchLists;
 }
 
+/**
+ * \brief Returns the read offsets at which the seeds were looked up in the reference hash.
+ *
+ * The reference is the read itself, so every seed that gets looked up produces hits and is used.
+ */
+std::vector<unsigned> TestHashMatchFinder::findSeedOffsets(
+    const std::string& sequence,
+    const std::vector<unsigned char>& qualities,
+    const unsigned seedBaseQualityMin)
+{
+    std::vector<char> bcls = getBcl(sequence);
+    for (std::size_t i = 0; bcls.size() != i; ++i)
+    {
+        bcls[i] = (qualities.at(i) << 2) | (bcls[i] & isaac::oligo::BCL_BASE_MASK);
+    }
+
+    isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, sequence.length(), 0, 0));
+    isaac::alignment::SeedHitsCache seedHitsCache;
+    findMatches(sequence, bcls, readMetadataList, seedBaseQualityMin, seedHitsCache);
+
+    std::vector<unsigned> ret;
+    for (unsigned offset = 0; sequence.length() != offset; ++offset)
+    {
+        if (seedHitsCache.hasForward(seedHitsCache.get(0, offset)))
+        {
+            ret.push_back(offset);
+        }
+    }
+    return ret;
+}
+
 void TestHashMatchFinder::testEverything()
 {
 //    ISAAC_SCOPE_BLOCK_CERR
@@ -278,3 +321,135 @@ void TestHashMatchFinder::testEverything()
 //    }
     }
 }
+
+void TestHashMatchFinder::testExtendedMatches()
+{
+    typedef isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> ReferenceHash;
+    typedef ReferenceHash::KmerT KmerT;
+    const std::string reference("ACGTACGATTTTGGGG" "ACGTACGACCCCAAAA" "ACGTACGATTTTGGGG" "ACGTACGA");
+    TestContigList contigList(reference);
+
+    isaac::common::ThreadVector threads(1);
+    isaac::reference::ReferenceHasher<ReferenceHash> referenceHasher(contigList, threads, threads.size());
+    const ReferenceHash referenceHash = referenceHasher.generate(0x10000, 3);
+    CPPUNIT_ASSERT_EQUAL(3U, referenceHash.getExtensionRepeatsMin());
+
+    const isaac::oligo::Translator<> translator;
+    KmerT kmer(0), tttt(0), cccc(0), other(0);
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(reference.begin(), translator, kmer));
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(reference.begin() + 8, translator, tttt));
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(reference.begin() + 24, translator, cccc));
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(reference.begin() + 12, translator, other));
+
+    const ReferenceHash::MatchRange all = referenceHash.findMatches(kmer);
+    CPPUNIT_ASSERT(4 <= std::distance(all.first, all.second));
+
+    const std::size_t contigBegin = contigList.contigBeginOffset(0);
+    // the last occurrence is at the end of the contig and can't be extended
+    const ReferenceHash::MatchRange followedByT = referenceHash.findExtendedMatches(kmer, tttt);
+    CPPUNIT_ASSERT_EQUAL(2L, long(std::distance(followedByT.first, followedByT.second)));
+    CPPUNIT_ASSERT_EQUAL(contigBegin + 0, std::size_t(*followedByT.first));
+    CPPUNIT_ASSERT_EQUAL(contigBegin + 32, std::size_t(*(followedByT.first + 1)));
+
+    const ReferenceHash::MatchRange followedByC = referenceHash.findExtendedMatches(kmer, cccc);
+    CPPUNIT_ASSERT_EQUAL(1L, long(std::distance(followedByC.first, followedByC.second)));
+    CPPUNIT_ASSERT_EQUAL(contigBegin + 16, std::size_t(*followedByC.first));
+
+    const ReferenceHash::MatchRange followedByOther = referenceHash.findExtendedMatches(kmer, other);
+    CPPUNIT_ASSERT(followedByOther.first == followedByOther.second);
+}
+
+void TestHashMatchFinder::testRepeatSeedExtension()
+{
+    // ACGTACGT is its own reverse complement and occurs 4 times on either strand
+    const std::string read("TTGCAGGC" "CATTCGGA" "ACGTACGT");
+    const std::string reference(
+        "ACGTACGTGGGGAAAA" "ACGTACGTCCCCTTTT" "ACGTACGTAAAACCCC"
+        // reverse complement of the read
+        "ACGTACGT" "TCCGAATG" "GCCTGCAA");
+    isaac::flowcell::ReadMetadataList readMetadataList(1, isaac::flowcell::ReadMetadata(1, read.length(), 0, 0));
+
+    isaac::alignment::SeedHitsCache seedHitsCache;
+    const TestMatchStorage matchLists = findMatches(reference, getBcl(read), readMetadataList, 0, seedHitsCache, 3, 2);
+
+    // the last seed can't be extended on the forward strand as the read ends there. It must still be
+    // resolved by extending the reverse strand with the preceding read bases
+    CPPUNIT_ASSERT(seedHitsCache.hasReverse(seedHitsCache.get(0, 16)));
+    CPPUNIT_ASSERT_EQUAL(1UL, matchLists.at(3).size());
+    CPPUNIT_ASSERT_EQUAL(true, matchLists.at(3).at(0).reverse_);
+    CPPUNIT_ASSERT_EQUAL(unsigned(TestContigList(reference).contigBeginOffset(0) + 48),
+                         unsigned(matchLists.at(3).at(0).contigListOffset_));
+}
+
+void TestHashMatchFinder::testMismatchMatches()
+{
+    typedef isaac::reference::ReferenceHash<isaac::oligo::VeryShortKmerType> ReferenceHash;
+    typedef ReferenceHash::KmerT KmerT;
+    const std::string reference("ACGTACGATTTTGGGG" "ACGTACGACCCCAAAA" "ACGTACGATTTTGGGG" "ACGTACGA");
+    TestContigList contigList(reference);
+
+    isaac::common::ThreadVector threads(1);
+    isaac::reference::ReferenceHasher<ReferenceHash> referenceHasher(contigList, threads, threads.size());
+    const ReferenceHash referenceHash = referenceHasher.generate(0x10000, 0, 1);
+    CPPUNIT_ASSERT_EQUAL(1U, referenceHash.getSeedMismatches());
+
+    const isaac::oligo::Translator<> translator;
+    const std::string oneMismatch("ACGTTCGA");
+    const std::string twoMismatches("AGGTTCGA");
+    KmerT kmer(0), kmer2(0);
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(oneMismatch.begin(), translator, kmer));
+    CPPUNIT_ASSERT(isaac::oligo::makeKmer<KmerT::KMER_BASES>(twoMismatches.begin(), translator, kmer2));
+    const ReferenceHash::MatchRange exact = referenceHash.findMatches(kmer);
+    CPPUNIT_ASSERT(exact.first == exact.second);
+
+    const std::size_t contigBegin = contigList.contigBeginOffset(0);
+    std::vector<ReferenceHash::Offset> positions;
+    CPPUNIT_ASSERT(referenceHash.findMismatchMatches(kmer, 100, positions));
+    CPPUNIT_ASSERT_EQUAL(4UL, positions.size());
+    for (std::size_t i = 0; positions.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(contigBegin + i * 16, std::size_t(positions[i]));
+    }
+
+    positions.clear();
+    CPPUNIT_ASSERT(referenceHash.findMismatchMatches(kmer2, 100, positions));
+    CPPUNIT_ASSERT(positions.empty());
+
+    // too many hits leave the positions unchanged
+    positions.assign(1, 123);
+    CPPUNIT_ASSERT(!referenceHash.findMismatchMatches(kmer, 2, positions));
+    CPPUNIT_ASSERT_EQUAL(1UL, positions.size());
+}
+
+void TestHashMatchFinder::testSeedPlacementByQuality()
+{
+    static const unsigned KMER_BASES = isaac::oligo::VeryShortKmerType::KMER_BASES;
+    const std::string sequence("GTGGGGGAAGCTGAGTCTCACTTTGTCGCCCAGGCTGGAGTGCAGCGG");
+
+    // uniform quality places the seeds next to each other from the start of the read
+    const std::vector<unsigned char> uniform(sequence.length(), 40);
+    const std::vector<unsigned> uniformOffsets = findSeedOffsets(sequence, uniform, 10);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(6), uniformOffsets.size());
+    for (std::size_t i = 0; uniformOffsets.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(unsigned(i * KMER_BASES), uniformOffsets[i]);
+    }
+
+    // base 11 is below seedBaseQualityMin, base 30 is usable but worse than the rest
+    std::vector<unsigned char> qualities(uniform);
+    qualities[11] = 2;
+    qualities[30] = 20;
+    const std::vector<unsigned> offsets = findSeedOffsets(sequence, qualities, 10);
+    for (std::size_t i = 0; offsets.size() != i; ++i)
+    {
+        CPPUNIT_ASSERT(offsets[i] > 11 || offsets[i] + KMER_BASES <= 11);
+        CPPUNIT_ASSERT(offsets[i] > 30 || offsets[i] + KMER_BASES <= 30);
+        if (i)
+        {
+            CPPUNIT_ASSERT(offsets[i - 1] + KMER_BASES <= offsets[i]);
+        }
+    }
+    const std::vector<unsigned> expected = boost::assign::list_of(0)(12)(20)(31)(39);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), offsets.size());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), offsets.begin()));
+}
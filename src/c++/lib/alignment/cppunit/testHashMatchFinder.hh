@@ -17,9 +17,11 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <string>
+#include <vector>
 
 #include "flowcell/Layout.hh"
 #include "flowcell/ReadMetadata.hh"
+#include "alignment/HashMatchFinder.hh"
 #include "alignment/Match.hh"
 
 //struct TestMatchStorage : public  std::vector<isaac::alignment::Match>
@@ -38,6 +40,10 @@ class TestHashMatchFinder : public CppUnit::TestFixture
 {
     CPPUNIT_TEST_SUITE( TestHashMatchFinder );
     CPPUNIT_TEST( testEverything );
+    CPPUNIT_TEST( testExtendedMatches );
+    CPPUNIT_TEST( testRepeatSeedExtension );
+    CPPUNIT_TEST( testMismatchMatches );
+    CPPUNIT_TEST( testSeedPlacementByQuality );
     CPPUNIT_TEST_SUITE_END();
 private:
 
@@ -46,12 +52,28 @@ public:
     void setUp();
     void tearDown();
     void testEverything();
+    void testExtendedMatches();
+    void testRepeatSeedExtension();
+    void testMismatchMatches();
+    void testSeedPlacementByQuality();
 
 private:
     TestMatchStorage findMatches(
         const std::string& reference,
         const std::string& sequence,
         const isaac::flowcell::ReadMetadataList &readMetadataList);
+    TestMatchStorage findMatches(
+        const std::string& reference,
+        const std::vector<char>& bcls,
+        const isaac::flowcell::ReadMetadataList &readMetadataList,
+        const unsigned seedBaseQualityMin,
+        isaac::alignment::SeedHitsCache &seedHitsCache,
+        const std::size_t seedRepeatThreshold = 1000,
+        const unsigned extensionRepeatsMin = 0);
+    std::vector<unsigned> findSeedOffsets(
+        const std::string& sequence,
+        const std::vector<unsigned char>& qualities,
+        const unsigned seedBaseQualityMin);
 };
 
 #endif // #ifndef iSAAC_ALIGNMENT_TEST_SEQUENCING_ADAPTER_HH
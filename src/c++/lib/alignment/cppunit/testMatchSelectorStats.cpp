@@ -0,0 +1,169 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testMatchSelectorStats.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/assign.hpp>
+
+#include "alignment/Cluster.hh"
+
+#include "BuilderInit.hh"
+#include "RegistryName.hh"
+#include "testMatchSelectorStats.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestMatchSelectorStats, registryName("MatchSelectorStats"));
+
+using namespace isaac;
+using alignment::matchSelector::MatchSelectorStats;
+using alignment::matchSelector::TileStats;
+using alignment::matchSelector::TileBarcodeStats;
+
+TestMatchSelectorStats::TestMatchSelectorStats() :
+    readMetadataList_(boost::assign::list_of
+        (flowcell::ReadMetadata(1, 4, 0, 0))
+        (flowcell::ReadMetadata(5, 10, 1, 4)))
+{
+    for (unsigned i = 0; 3 != i; ++i)
+    {
+        barcodeMetadataList_.push_back(flowcell::BarcodeMetadata("FC1", 0, 1, 0, false, flowcell::SequencingAdapterMetadataList()));
+        barcodeMetadataList_.back().setIndex(i);
+    }
+}
+
+void TestMatchSelectorStats::setUp()
+{
+}
+
+void TestMatchSelectorStats::tearDown()
+{
+}
+
+/**
+ * \brief records an unaligned cluster. Ns in bases become blank cycles
+ */
+void TestMatchSelectorStats::recordCluster(
+    MatchSelectorStats &stats,
+    const std::string &bases, const bool pf, const unsigned barcodeIndex) const
+{
+    std::vector<char> bcl;
+    for (const char base : bases)
+    {
+        bcl.push_back('N' == base ? 0 : char((30 << 2) | oligo::getValue(base)));
+    }
+    const alignment::BclClusters bclClusters = getBclClusters(readMetadataList_, bcl);
+    alignment::Cluster cluster(flowcell::getMaxReadLength(readMetadataList_));
+    cluster.init(readMetadataList_, bclClusters.cluster(0), 1, 0, alignment::ClusterXy(0, 0), pf, 0, 0);
+
+    const alignment::BamTemplate bamTemplate(readMetadataList_, cluster);
+    stats.recordTemplate(readMetadataList_, alignment::TemplateLengthStatistics(), bamTemplate, barcodeIndex,
+                         alignment::matchSelector::NmNm);
+}
+
+static void assertEqual(const TileBarcodeStats &expected, const TileBarcodeStats &actual)
+{
+    CPPUNIT_ASSERT_EQUAL(expected.clusterCount_, actual.clusterCount_);
+    CPPUNIT_ASSERT_EQUAL(expected.nmnmClusterCount_, actual.nmnmClusterCount_);
+    CPPUNIT_ASSERT_EQUAL(expected.fragmentCount_, actual.fragmentCount_);
+    CPPUNIT_ASSERT_EQUAL(expected.yield_, actual.yield_);
+    CPPUNIT_ASSERT_EQUAL(expected.yieldQ30_, actual.yieldQ30_);
+    CPPUNIT_ASSERT_EQUAL(expected.qualityScoreSum_, actual.qualityScoreSum_);
+    CPPUNIT_ASSERT(std::equal(expected.alignmentModelCounts_,
+                              expected.alignmentModelCounts_ + alignment::TemplateLengthStatistics::InvalidAlignmentModel + 1,
+                              actual.alignmentModelCounts_));
+    CPPUNIT_ASSERT(std::equal(expected.nominalModelCounts_,
+                              expected.nominalModelCounts_ + alignment::TemplateLengthStatistics::CheckModelLast,
+                              actual.nominalModelCounts_));
+    CPPUNIT_ASSERT_EQUAL(expected.templateLengthStatisticsSet_, actual.templateLengthStatisticsSet_);
+}
+
+void TestMatchSelectorStats::testSparseMatchesDense()
+{
+    // one accumulator per representation, reused for each tile the same way the MatchSelector does
+    MatchSelectorStats sparse(true, barcodeMetadataList_);
+    MatchSelectorStats dense(true, barcodeMetadataList_);
+    MatchSelectorStats sparseTotal(true, barcodeMetadataList_);
+    MatchSelectorStats denseTotal(true, barcodeMetadataList_);
+
+    for (unsigned tile = 0; 4 != tile; ++tile)
+    {
+        sparse.reset();
+        dense.reset();
+        // non-const access switches the accumulator to the untracked path
+        dense.getReadTileStat(readMetadataList_.at(0), false);
+
+        for (MatchSelectorStats *stats : {&sparse, &dense})
+        {
+            switch (tile)
+            {
+            case 0:
+                recordCluster(*stats, "ACGTACGTAC", true, 0);
+                recordCluster(*stats, "NCGTACGTAN", false, 0);
+                stats->recordTemplateLengthStatistics(barcodeMetadataList_.at(0), alignment::TemplateLengthStatistics());
+                break;
+            case 1:
+                // no clusters on this tile
+                break;
+            case 2:
+                // only the second read has blanks
+                recordCluster(*stats, "ACGTANNNNN", true, 2);
+                break;
+            case 3:
+                recordCluster(*stats, "NNNNACGTAC", false, 0);
+                recordCluster(*stats, "ACGTNCGTAC", true, 2);
+                break;
+            }
+        }
+
+        sparseTotal += sparse;
+        denseTotal += dense;
+    }
+
+    for (const flowcell::ReadMetadata &read : readMetadataList_)
+    {
+        for (const bool pf : {false, true})
+        {
+            const TileStats &expected = static_cast<const MatchSelectorStats &>(denseTotal).getReadTileStat(read, pf);
+            const TileStats &actual = static_cast<const MatchSelectorStats &>(sparseTotal).getReadTileStat(read, pf);
+            CPPUNIT_ASSERT_EQUAL(expected.fragmentCount_, actual.fragmentCount_);
+            // TileStats consists of 64-bit counters only
+            CPPUNIT_ASSERT(!memcmp(&expected, &actual, sizeof(TileStats)));
+
+            for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+            {
+                assertEqual(
+                    static_cast<const MatchSelectorStats &>(denseTotal).getReadBarcodeTileStat(read, barcode, pf),
+                    static_cast<const MatchSelectorStats &>(sparseTotal).getReadBarcodeTileStat(read, barcode, pf));
+            }
+        }
+    }
+
+    const MatchSelectorStats &total = sparseTotal;
+    // 5 clusters, 3 of them pass filter. Non-pf entries count all clusters
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), total.getReadTileStat(readMetadataList_.at(1), false).fragmentCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), total.getReadTileStat(readMetadataList_.at(1), true).fragmentCount_);
+    // arrays are indexed by 1-based cycle number
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), total.getReadTileStat(readMetadataList_.at(0), false).cycleBlanks_[1]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), total.getReadTileStat(readMetadataList_.at(1), true).cycleBlanks_[5]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), total.getReadTileStat(readMetadataList_.at(1), false).cycleBlanks_[10]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), total.getReadTileStat(readMetadataList_.at(1), true).cycleBlanks_[10]);
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), total.getReadBarcodeTileStat(readMetadataList_.at(0), barcodeMetadataList_.at(0), false).clusterCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), total.getReadBarcodeTileStat(readMetadataList_.at(0), barcodeMetadataList_.at(2), true).clusterCount_);
+    CPPUNIT_ASSERT(total.getReadBarcodeTileStat(readMetadataList_.at(0), barcodeMetadataList_.at(1), false).empty());
+    CPPUNIT_ASSERT(total.getReadBarcodeTileStat(readMetadataList_.at(1), barcodeMetadataList_.at(1), true).empty());
+}
@@ -0,0 +1,45 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testMatchSelectorStats.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_HH
+#define iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+
+class TestMatchSelectorStats : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestMatchSelectorStats );
+    CPPUNIT_TEST( testSparseMatchesDense );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    const isaac::flowcell::ReadMetadataList readMetadataList_;
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList_;
+
+    void recordCluster(
+        isaac::alignment::matchSelector::MatchSelectorStats &stats,
+        const std::string &bases, const bool pf, const unsigned barcodeIndex) const;
+
+public:
+    TestMatchSelectorStats();
+    void setUp();
+    void tearDown();
+    void testSparseMatchesDense();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_HH
@@ -0,0 +1,170 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testMatchSelectorStatsBinary.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <limits>
+#include <sstream>
+#include <boost/assign.hpp>
+
+#include "alignment/matchSelector/MatchSelectorStatsBinary.hh"
+#include "common/Exceptions.hh"
+
+#include "RegistryName.hh"
+#include "testMatchSelectorStatsBinary.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestMatchSelectorStatsBinary, registryName("MatchSelectorStatsBinary"));
+
+using namespace isaac;
+using alignment::matchSelector::MatchSelectorStats;
+using alignment::matchSelector::TileStats;
+using alignment::matchSelector::TileBarcodeStats;
+using alignment::TemplateLengthStatistics;
+
+TestMatchSelectorStatsBinary::TestMatchSelectorStatsBinary()
+{
+    const flowcell::ReadMetadataList reads = boost::assign::list_of
+        (flowcell::ReadMetadata(1, 5, 0, 0))
+        (flowcell::ReadMetadata(6, 10, 1, 5));
+    flowcellLayoutList_.push_back(
+        flowcell::Layout("", flowcell::Layout::Fastq, flowcell::FastqFlowcellData(false, '!', false),
+                         8, 0, std::vector<unsigned>(), reads, "FC1"));
+    flowcellLayoutList_.back().setIndex(0);
+
+    barcodeMetadataList_.push_back(flowcell::BarcodeMetadata::constructUnknownBarcode(
+        "FC1", 0, 1, 0, flowcell::SequencingAdapterMetadataList()));
+    barcodeMetadataList_.back().setIndex(0);
+    flowcell::BarcodeMetadata barcode("FC1", 0, 1, 0, false, flowcell::SequencingAdapterMetadataList());
+    barcode.setSequence("ACGT");
+    barcode.setSampleName("sample1");
+    barcode.setProject("project1");
+    barcode.setReference("hg19");
+    barcode.setIndex(1);
+    barcodeMetadataList_.push_back(barcode);
+
+    tileMetadataList_.push_back(flowcell::TileMetadata("FC1", 0, 1101, 1, 1000, 0));
+    tileMetadataList_.push_back(flowcell::TileMetadata("FC1", 0, 1102, 1, 2000, 1));
+    flowcellLayoutList_.back().addTile(1, 1101);
+    flowcellLayoutList_.back().addTile(1, 1102);
+}
+
+void TestMatchSelectorStatsBinary::setUp()
+{
+}
+
+void TestMatchSelectorStatsBinary::tearDown()
+{
+}
+
+void TestMatchSelectorStatsBinary::testVarint()
+{
+    using namespace alignment::matchSelector::statsColumns;
+    const uint64_t values[] = {0, 1, 127, 128, 300, 0xFFFFFFFFUL, 0xFFFFFFFFFFFFFFFFUL};
+    std::stringstream ss;
+    for (const uint64_t value : values)
+    {
+        writeVarint(ss, value);
+    }
+    for (const uint64_t value : values)
+    {
+        CPPUNIT_ASSERT_EQUAL(value, readVarint(ss));
+    }
+    CPPUNIT_ASSERT_THROW(readVarint(ss), common::IoException);
+
+    const int64_t signedValues[] = {0, -1, 1, -1000000, 1000000, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()};
+    for (const int64_t value : signedValues)
+    {
+        CPPUNIT_ASSERT_EQUAL(value, unzigzag(zigzag(value)));
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), zigzag(-1));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), zigzag(1));
+}
+
+void TestMatchSelectorStatsBinary::testRoundTrip()
+{
+    const flowcell::ReadMetadataList &reads = flowcellLayoutList_.front().getReadMetadataList();
+    std::vector<MatchSelectorStats> original(tileMetadataList_.size(), MatchSelectorStats(true, barcodeMetadataList_));
+
+    TileStats &tileStats = original.at(1).getReadTileStat(reads.at(1), true);
+    tileStats.fragmentCount_ = 123456789012ULL;
+    tileStats.adapterBases_ = 17;
+    tileStats.cycleMismatches_[7] = 42;
+    tileStats.cycleUniquelyAligned2MismatchFragments_[8] = -5;
+    tileStats.cycleMoreMismatchFragments_[10] = 3;
+
+    TileBarcodeStats &barcodeStats = original.at(1).getReadBarcodeTileStat(reads.at(0), barcodeMetadataList_.at(1), false);
+    barcodeStats.clusterCount_ = 1000;
+    barcodeStats.yield_ = 99999;
+    barcodeStats.alignmentModelCounts_[TemplateLengthStatistics::FRp] = 900;
+    barcodeStats.nominalModelCounts_[TemplateLengthStatistics::Nominal] = 800;
+    barcodeStats.recordTemplateLengthStatistics(TemplateLengthStatistics(
+        100, 500, 300, 30, 40, TemplateLengthStatistics::FRp, TemplateLengthStatistics::RFm, -1, true));
+
+    std::stringstream ss;
+    {
+        alignment::matchSelector::MatchSelectorStatsBinaryWriter writer(
+            ss, true, flowcellLayoutList_, barcodeMetadataList_, tileMetadataList_);
+        for (const flowcell::TileMetadata &tile : tileMetadataList_)
+        {
+            writer.writeTile(tile, original.at(tile.getIndex()));
+        }
+        writer.close();
+    }
+
+    alignment::matchSelector::MatchSelectorStatsBinaryReader reader(ss);
+    CPPUNIT_ASSERT(reader.getCollectCycleStats());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), reader.getFlowcellLayoutList().size());
+    CPPUNIT_ASSERT_EQUAL(std::string("FC1"), reader.getFlowcellLayoutList().front().getFlowcellId());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), reader.getFlowcellLayoutList().front().getReadMetadataList().size());
+    CPPUNIT_ASSERT_EQUAL(6U, reader.getFlowcellLayoutList().front().getReadMetadataList().at(1).getFirstCycle());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), reader.getBarcodeMetadataList().size());
+    CPPUNIT_ASSERT(reader.getBarcodeMetadataList().at(0).isUnknown());
+    CPPUNIT_ASSERT_EQUAL(std::string("ACGT"), reader.getBarcodeMetadataList().at(1).getName());
+    CPPUNIT_ASSERT_EQUAL(std::string("sample1"), reader.getBarcodeMetadataList().at(1).getSampleName());
+    CPPUNIT_ASSERT_EQUAL(std::string("project1"), reader.getBarcodeMetadataList().at(1).getProject());
+    CPPUNIT_ASSERT_EQUAL(1102U, reader.getTileMetadataList().at(1).getTile());
+    CPPUNIT_ASSERT_EQUAL(2000U, reader.getTileMetadataList().at(1).getClusterCount());
+
+    std::vector<MatchSelectorStats> restored;
+    reader.readAll(restored);
+    CPPUNIT_ASSERT_EQUAL(original.size(), restored.size());
+
+    const flowcell::ReadMetadataList &restoredReads = reader.getFlowcellLayoutList().front().getReadMetadataList();
+    const TileStats &restoredTileStats = restored.at(1).getReadTileStat(restoredReads.at(1), true);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(123456789012ULL), restoredTileStats.fragmentCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(17), restoredTileStats.adapterBases_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(42), restoredTileStats.cycleMismatches_[7]);
+    CPPUNIT_ASSERT_EQUAL(int64_t(-5), restoredTileStats.cycleUniquelyAligned2MismatchFragments_[8]);
+    CPPUNIT_ASSERT_EQUAL(int64_t(3), restoredTileStats.cycleMoreMismatchFragments_[10]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), restored.at(0).getReadTileStat(restoredReads.at(1), true).fragmentCount_);
+
+    const TileBarcodeStats &restoredBarcodeStats =
+        restored.at(1).getReadBarcodeTileStat(restoredReads.at(0), reader.getBarcodeMetadataList().at(1), false);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), restoredBarcodeStats.clusterCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(99999), restoredBarcodeStats.yield_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(900), restoredBarcodeStats.alignmentModelCounts_[TemplateLengthStatistics::FRp]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(800), restoredBarcodeStats.nominalModelCounts_[TemplateLengthStatistics::Nominal]);
+    CPPUNIT_ASSERT(restoredBarcodeStats.templateLengthStatisticsSet_);
+    CPPUNIT_ASSERT_EQUAL(300U, restoredBarcodeStats.templateLengthStatistics_.getMedian());
+    CPPUNIT_ASSERT_EQUAL(40U, restoredBarcodeStats.templateLengthStatistics_.getHighStdDev());
+    CPPUNIT_ASSERT_EQUAL(TemplateLengthStatistics::RFm, restoredBarcodeStats.templateLengthStatistics_.getBestModel(1));
+    CPPUNIT_ASSERT(restored.at(1).getReadBarcodeTileStat(restoredReads.at(0), reader.getBarcodeMetadataList().at(0), false).empty());
+}
+
+void TestMatchSelectorStatsBinary::testBadMagic()
+{
+    std::stringstream ss("<?xml version=\"1.0\"?>");
+    CPPUNIT_ASSERT_THROW(alignment::matchSelector::MatchSelectorStatsBinaryReader reader(ss), common::IoException);
+}
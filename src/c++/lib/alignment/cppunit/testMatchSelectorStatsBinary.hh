@@ -0,0 +1,47 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testMatchSelectorStatsBinary.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_BINARY_HH
+#define iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_BINARY_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "flowcell/Layout.hh"
+
+class TestMatchSelectorStatsBinary : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestMatchSelectorStatsBinary );
+    CPPUNIT_TEST( testVarint );
+    CPPUNIT_TEST( testRoundTrip );
+    CPPUNIT_TEST( testBadMagic );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    isaac::flowcell::FlowcellLayoutList flowcellLayoutList_;
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList_;
+    isaac::flowcell::TileMetadataList tileMetadataList_;
+
+public:
+    TestMatchSelectorStatsBinary();
+    void setUp();
+    void tearDown();
+    void testVarint();
+    void testRoundTrip();
+    void testBadMagic();
+};
+
+#endif // #ifndef iSAAC_ALIGNMENT_TEST_MATCH_SELECTOR_STATS_BINARY_HH
@@ -137,6 +137,7 @@ void TestSequencingAdapter::testEverything()
     testStdReverseAfterSequence();
     testStdReverseSequenceTooGood();
     testConstMethods();
+    testAdapterOverlap();
     }
 
 }
@@ -513,3 +514,36 @@ void TestSequencingAdapter::testConstMethods()
         CPPUNIT_ASSERT_EQUAL(kmer, unsigned(BOOST_BINARY(00 00 01 10 11 00 00)));
     }
 }
+
+void TestSequencingAdapter::testAdapterOverlap()
+{
+    const std::string insert("CGATTGTCTTTGCTGCCAATTTTAGCGTTGGCGTTAACGTCATGCTTAAGGATTACAGAT");
+    const std::string adapter("CTGTCTCTTATACACATCT");
+    const std::string tail(readMetadataList[0].getLength() - insert.length() - adapter.length(), 'A');
+    const std::vector<char> insertReverse = reverseComplement(insert);
+    const std::string read1 = insert + adapter + tail;
+    const std::string read2 = std::string(insertReverse.begin(), insertReverse.end()) + adapter + tail;
+
+    {
+        const isaac::alignment::BclClusters bcl(getBclClusters(readMetadataList, getBcl(read1 + read2)));
+        isaac::alignment::Cluster cluster(getMaxReadLength(readMetadataList));
+        cluster.init(readMetadataList, bcl.cluster(0), 1101, 0, isaac::alignment::ClusterXy(0,0), true, 0, 0);
+        CPPUNIT_ASSERT_EQUAL(unsigned(insert.length()),
+                             isaac::alignment::findAdapterOverlap(cluster[0], cluster[1], standardAdapters));
+
+        isaac::alignment::maskAdapterOverlap(cluster, standardAdapters);
+        CPPUNIT_ASSERT_EQUAL(40U, cluster[0].getAdapterCyclesMasked());
+        CPPUNIT_ASSERT_EQUAL(40U, cluster[0].getEndCyclesMasked());
+        CPPUNIT_ASSERT_EQUAL(40U, cluster[1].getAdapterCyclesMasked());
+        CPPUNIT_ASSERT_EQUAL(40U, cluster[1].getEndCyclesMasked());
+    }
+    {
+        // second read does not come from the same insert
+        const isaac::alignment::BclClusters bcl(getBclClusters(readMetadataList, getBcl(read1 + read1)));
+        isaac::alignment::Cluster cluster(getMaxReadLength(readMetadataList));
+        cluster.init(readMetadataList, bcl.cluster(0), 1101, 0, isaac::alignment::ClusterXy(0,0), true, 0, 0);
+        isaac::alignment::maskAdapterOverlap(cluster, standardAdapters);
+        CPPUNIT_ASSERT_EQUAL(0U, cluster[0].getAdapterCyclesMasked());
+        CPPUNIT_ASSERT_EQUAL(0U, cluster[1].getAdapterCyclesMasked());
+    }
+}
@@ -60,6 +60,7 @@ public:
     void testStdReverseAfterSequence();
     void testStdReverseSequenceTooGood();
     void testConstMethods();
+    void testAdapterOverlap();
 
 
 private:
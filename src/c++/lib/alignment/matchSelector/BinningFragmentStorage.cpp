@@ -17,9 +17,13 @@
 
 #include <cerrno>
 #include <fstream>
+#include <map>
+
+#include <boost/format.hpp>
 
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
+#include "common/SystemCompatibility.hh"
 #include "alignment/BinMetadata.hh"
 #include "alignment/matchSelector/BinningFragmentStorage.hh"
 
@@ -159,8 +163,11 @@ BinningFragmentStorage::BinningFragmentStorage(
     const uint64_t expectedBinSize,
     const uint64_t targetBinLength,
     const unsigned threads,
+    const alignment::BinMetadataList &checkpointBinMetadataList,
     alignment::BinMetadataList &binMetadataList):
-        FragmentBinner(keepUnaligned, binIndexMap, preAllocateBins ? expectedBinSize : 0, threads),
+        FragmentBinner(keepUnaligned, binIndexMap, preAllocateBins ? expectedBinSize : 0,
+                       // start tracking the parts early enough for the data stored before that to not matter much
+                       expectedBinSize / BinMetadata::PARTS, threads),
         binIndexMap_(binIndexMap),
         expectedBinSize_(expectedBinSize),
         binMetadataList_(binMetadataList)
@@ -185,7 +192,81 @@ BinningFragmentStorage::BinningFragmentStorage(
 
     unalignedBinMetadataReserve_.resize(worstCaseEstimatedUnalignedBins, binMetadataList_.back());
 
-    FragmentBinner::open(binMetadataList_.begin(), binMetadataList_.end());
+    if (checkpointBinMetadataList.empty())
+    {
+        FragmentBinner::open(binMetadataList_.begin(), binMetadataList_.end());
+    }
+    else
+    {
+        resume(checkpointBinMetadataList);
+    }
+}
+
+void BinningFragmentStorage::resume(const alignment::BinMetadataList &checkpointBinMetadataList)
+{
+    const std::size_t binCount = binMetadataList_.size();
+    if (checkpointBinMetadataList.size() < binCount ||
+        checkpointBinMetadataList.size() - binCount > unalignedBinMetadataReserve_.size())
+    {
+        BOOST_THROW_EXCEPTION(common::PreConditionException(
+            (boost::format("Recorded progress has %d bins while %d are expected") %
+                checkpointBinMetadataList.size() % binCount).str()));
+    }
+
+    // several bins share the same file. The file is as long as the furthest data any of them has
+    std::map<bfs::path, uint64_t> fileSizes;
+    uint64_t binZeroRecordsBinned = 0;
+    for (std::size_t i = 0; checkpointBinMetadataList.size() != i; ++i)
+    {
+        const BinMetadata &checkpointBin = checkpointBinMetadataList[i];
+        if (i < binCount ?
+            checkpointBin.getPath() != binMetadataList_[i].getPath() || checkpointBin.getIndex() != binMetadataList_[i].getIndex() :
+            !checkpointBin.isUnalignedBin())
+        {
+            BOOST_THROW_EXCEPTION(common::PreConditionException(
+                (boost::format("Recorded progress bin %s does not match the expected bin %s") %
+                    checkpointBin % (i < binCount ? binMetadataList_[i] : binMetadataList_.front())).str()));
+        }
+        uint64_t &fileSize = fileSizes[checkpointBin.getPath()];
+        fileSize = std::max(fileSize, checkpointBin.getDataEndOffset());
+        if (checkpointBin.isUnalignedBin())
+        {
+            binZeroRecordsBinned += checkpointBin.getNmElements();
+        }
+    }
+
+    for (const std::map<bfs::path, uint64_t>::value_type &file : fileSizes)
+    {
+        if (file.second && (!bfs::exists(file.first) || bfs::file_size(file.first) < file.second))
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(
+                ENOENT, (boost::format("Bin file %s is shorter than the recorded %d bytes") % file.first % file.second).str()));
+        }
+    }
+
+    // nothing gets truncated unless all the files are consistent with the record
+    for (const std::map<bfs::path, uint64_t>::value_type &file : fileSizes)
+    {
+        if (bfs::exists(file.first))
+        {
+            // drop whatever the interrupted run managed to write after the checkpoint
+            common::truncateFile(file.first.c_str(), file.second);
+        }
+    }
+
+    std::copy(checkpointBinMetadataList.begin(), checkpointBinMetadataList.begin() + binCount, binMetadataList_.begin());
+    for (std::size_t i = binCount; checkpointBinMetadataList.size() != i; ++i)
+    {
+        // same as prepareFlush. Keeps the reserve consistent with the number of unaligned bins in the list
+        binMetadataList_.resize(binMetadataList_.size() + 1);
+        using std::swap;
+        swap(binMetadataList_.back(), unalignedBinMetadataReserve_.back());
+        unalignedBinMetadataReserve_.pop_back();
+        binMetadataList_.back() = checkpointBinMetadataList[i];
+    }
+
+    ISAAC_THREAD_CERR << "Resuming " << binMetadataList_.size() << " bins in " << fileSizes.size() << " files" << std::endl;
+    FragmentBinner::resume(binMetadataList_.begin(), binMetadataList_.begin() + binCount, binZeroRecordsBinned);
 }
 
 BinningFragmentStorage::~BinningFragmentStorage()
@@ -218,6 +299,8 @@ void BinningFragmentStorage::store(
 
 void BinningFragmentStorage::prepareFlush() noexcept
 {
+    // tiles are aligned continuously. Other threads can be storing fragments of the next tiles
+    boost::lock_guard<boost::mutex> lock(getUnalignedBinMutex());
     if (binMetadataList_.front().getDataSize() > expectedBinSize_)
     {
         ISAAC_ASSERT_MSG(!unalignedBinMetadataReserve_.empty(), "Unexpectedly ran out of reserved BinMetadata when extending the unaligned bin");
@@ -33,14 +33,15 @@ namespace matchSelector
 const int READ_LENGTH_MAX = 1000;
 
 DebugStorage::DebugStorage(
-    const reference::ContigList &contigList,
+    const reference::ContigLists &contigLists,
     const AlignmentCfg &alignmentCfg,
     const flowcell::FlowcellLayoutList &flowcellLayoutList,
     const boost::filesystem::path &outputDirectory,
     const flowcell::BarcodeMetadataList &barcodeMetadataList,
     const unsigned threads,
     alignment::matchSelector::FragmentStorage &actualStorage):
-    contigList_(contigList),
+    contigLists_(contigLists),
+    barcodeMetadataList_(barcodeMetadataList),
     flowcell_(flowcellLayoutList.at(0)),
     alignmentCfg_(alignmentCfg),
     outputDirectory_(outputDirectory),
@@ -74,15 +75,22 @@ DebugStorage::DebugStorage(
 
     for (unsigned sampleId = 0; sampleId < barcodeQQR1Paths_.getTotalSamples(); ++sampleId)
     {
+        // all barcodes of a sample are aligned against the same reference
+        const flowcell::BarcodeMetadataList::const_iterator sampleBarcode = std::find_if(
+            barcodeMetadataList.begin(), barcodeMetadataList.end(),
+            [this, sampleId](const flowcell::BarcodeMetadata &barcode)
+            {return sampleId == barcodeQQR1Paths_.getSampleIndex(barcode.getIndex());});
+        ISAAC_ASSERT_MSG(barcodeMetadataList.end() != sampleBarcode, "Sample without barcodes: " << sampleId);
+        const reference::ContigList &contigList = getContigList(sampleBarcode->getIndex());
         pairMapqStatistics_.push_back(new debugStorage::MapqStatistics(
                 pairMapqStatistics_.size(),
                 barcodeMapqPaths_.getSampleFilePath(sampleId),
                 barcodeSMPaths_.getSampleFilePath(sampleId),
                 barcodeASPaths_.getSampleFilePath(sampleId)));
-        r1QqStatistics_.push_back(new debugStorage::QqStatistics(contigList_, barcodeQQR1Paths_.getSampleFilePath(sampleId)));
-        r2QqStatistics_.push_back(new debugStorage::QqStatistics(contigList_, barcodeQQR2Paths_.getSampleFilePath(sampleId)));
-        r1QqOriginalStatistics_.push_back(new debugStorage::QqStatistics(contigList_, barcodeQQR1OriPaths_.getSampleFilePath(sampleId)));
-        r2QqOriginalStatistics_.push_back(new debugStorage::QqStatistics(contigList_, barcodeQQR2OriPaths_.getSampleFilePath(sampleId)));
+        r1QqStatistics_.push_back(new debugStorage::QqStatistics(contigList, barcodeQQR1Paths_.getSampleFilePath(sampleId)));
+        r2QqStatistics_.push_back(new debugStorage::QqStatistics(contigList, barcodeQQR2Paths_.getSampleFilePath(sampleId)));
+        r1QqOriginalStatistics_.push_back(new debugStorage::QqStatistics(contigList, barcodeQQR1OriPaths_.getSampleFilePath(sampleId)));
+        r2QqOriginalStatistics_.push_back(new debugStorage::QqStatistics(contigList, barcodeQQR2OriPaths_.getSampleFilePath(sampleId)));
     }
 
     originalCigars_.at(0).resize(threads);
@@ -99,8 +107,16 @@ DebugStorage::~DebugStorage()
 {
 }
 
+const reference::ContigList &DebugStorage::getContigList(const unsigned barcodeIdx) const
+{
+    const flowcell::BarcodeMetadata &barcode = barcodeMetadataList_.at(barcodeIdx);
+    // nothing aligns for barcodes without reference, any contig list will do
+    return contigLists_.at(barcode.isUnmappedReference() ? 0 : barcode.getReferenceIndex());
+}
+
 bool DebugStorage::restoreOriginal(
     const unsigned threadNumber,
+    const unsigned barcodeIdx,
     const std::size_t readNumber,
     FragmentMetadata &fragment)
 {
@@ -121,7 +137,7 @@ bool DebugStorage::restoreOriginal(
             false,
             alignmentCfg_,
             flowcell_.getReadMetadataList().at(fragment.getReadIndex()),
-            contigList_,
+            getContigList(barcodeIdx),
             oriPos.reverse(),
             oriPos.getContigId(),
             oriPos.getPosition(),
@@ -173,7 +189,7 @@ void DebugStorage::store(
     bool storeOriginal = false;
     isaac::alignment::FragmentMetadata r1 = originalTemplate.getFragmentMetadata(0);
     r1QqStatistics_[barcodeQQR1Paths_.getSampleIndex(barcodeIdx)].updateStat(0, bamTemplate, true);
-    if (restoreOriginal(threadNumber, flowcell_.getReadMetadataList().at(r1.getReadIndex()).getNumber(), r1))
+    if (restoreOriginal(threadNumber, barcodeIdx, flowcell_.getReadMetadataList().at(r1.getReadIndex()).getNumber(), r1))
     {
         if (r1Aligned.hasMapQ() &&
             !debugStorage::alignsCorrectly(r1Number, r1Aligned))
@@ -214,7 +230,7 @@ void DebugStorage::store(
 
     //        store |= r2.getCluster().getId() == 1761956 || r2Aligned.gapCount || (r2Aligned.isAligned() && debugStorage::alignsCorrectly(r2Number, r2Aligned) && r2Aligned.mismatchCount > 20 && r2Aligned.secondBestMismatchDelta);
 
-            if (restoreOriginal(threadNumber, r2Number, r2))
+            if (restoreOriginal(threadNumber, barcodeIdx, r2Number, r2))
             {
                 originalTemplate = BamTemplate(originalTemplate.getFragmentMetadata(0), r2,
                     originalTemplate.isProperPair(), originalTemplate.getAlignmentScore());
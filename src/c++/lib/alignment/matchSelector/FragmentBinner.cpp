@@ -39,16 +39,50 @@ FragmentBinner::FragmentBinner(
     const bool keepUnaligned,
     const BinIndexMap &binIndexMap,
     const uint64_t expectedBinSize,
+    const uint64_t partitionedBinSizeMin,
     const unsigned threads):
         keepUnaligned_(keepUnaligned),
         expectedBinSize_(expectedBinSize),
+        partitionedBinSizeMin_(partitionedBinSizeMin),
         binIndexMap_(binIndexMap),
         binZeroRecordsBinned_(0),
         threadFileBuffers_(threads)
 {
 }
 
+/**
+ * \return mask of bin parts that contain either end of any of the fragment alignment components. This is what
+ *         BinLoader checks to decide whether the fragment belongs to the bin.
+ */
+static unsigned getPartMask(const io::FragmentAccessor &fragment, const BinMetadata &binMetadata)
+{
+    unsigned ret = 0;
+    if (fragment.isAligned())
+    {
+        for (CigarPosition<const unsigned *> it(
+            fragment.cigarBegin(), fragment.cigarEnd(), fragment.getFStrandReferencePosition(), fragment.isReverse(), fragment.readLength_);
+            !it.end(); ++it)
+        {
+            if (Cigar::ALIGN == it.component().second)
+            {
+                const reference::ReferencePosition first = it.referencePos_;
+                const reference::ReferencePosition last = it.referencePos_ + it.component().first - 1;
+                if (binMetadata.coversPosition(first))
+                {
+                    ret |= 1U << binMetadata.getPart(first);
+                }
+                if (binMetadata.coversPosition(last))
+                {
+                    ret |= 1U << binMetadata.getPart(last);
+                }
+            }
+        }
+    }
+    return ret;
+}
+
 void FragmentBinner::registerFragment(const io::FragmentAccessor& fragment,
+                                      const io::FragmentAccessor *mate,
                                       const bool splitRead,
                                       const bool realignableSplit,
                                       BinMetadata& binMetadata)
@@ -64,6 +98,23 @@ void FragmentBinner::registerFragment(const io::FragmentAccessor& fragment,
     }
     else
     {
+        if (partitionedBinSizeMin_ && !binMetadata.isPartitioned() && partitionedBinSizeMin_ <= binMetadata.getDataSize())
+        {
+            ISAAC_THREAD_CERR << "Partitioning " << binMetadata << std::endl;
+            binMetadata.partition();
+        }
+        if (binMetadata.isPartitioned())
+        {
+            // mates are loaded together if any of them belongs to the part
+            const bool reverseOrShadow = fragment.flags_.reverse_ || fragment.flags_.unmapped_;
+            binMetadata.incrementParts(
+                getPartMask(fragment, binMetadata) | (mate ? getPartMask(*mate, binMetadata) : 0),
+                fragment.getTotalLength(),
+                !fragment.flags_.paired_,
+                fragment.flags_.paired_ && reverseOrShadow,
+                fragment.flags_.paired_ && !reverseOrShadow);
+        }
+
         binMetadata.incrementDataSize(fragment.fStrandPosition_, fragment.getTotalLength());
         if (!fragment.flags_.paired_)
         {
@@ -150,6 +201,7 @@ bool FragmentBinner::bufferPair(
 
 void FragmentBinner::flushSingle(
     const io::FragmentAccessor &fragment,
+    const io::FragmentAccessor *mate,
     const BinIndexList &binIndexList,
     alignment::BinMetadataList &binMetadataList,
     const unsigned fileIndex)
@@ -159,7 +211,7 @@ void FragmentBinner::flushSingle(
     {
         lastBinIndex = binIndexList.indexes_[i];
         registerFragment(
-                fragment,
+                fragment, mate,
                 // looks like some historical check for unaligned bin. Currently 
                 // results in massive undercounting of split alignments. Commented out: //0 != i &&
                 fragment.isAligned() && fragment.flags_.splitAlignment_,
@@ -197,14 +249,14 @@ void FragmentBinner::flushBuffer(
             ISAAC_ASSERT_MSG(fragment1.flags_.initialized_, "Attempt to store an uninitialised " << fragment1);
 
             const BinIndexList &binIndexList = *reinterpret_cast<const BinIndexList *>(fragment1.end());
-            flushSingle(fragment0, binIndexList, binMetadataList, fileIndex);
-            flushSingle(fragment1, binIndexList, binMetadataList, fileIndex);
+            flushSingle(fragment0, &fragment1, binIndexList, binMetadataList, fileIndex);
+            flushSingle(fragment1, &fragment0, binIndexList, binMetadataList, fileIndex);
             p = reinterpret_cast<const char*>(&binIndexList.indexes_[binIndexList.indexCount_]);
         }
         else
         {
             const BinIndexList &binIndexList = *reinterpret_cast<const BinIndexList *>(fragment0.end());
-            flushSingle(fragment0, binIndexList, binMetadataList, fileIndex);
+            flushSingle(fragment0, 0, binIndexList, binMetadataList, fileIndex);
             p = reinterpret_cast<const char*>(&binIndexList.indexes_[binIndexList.indexCount_]);
         }
     }
@@ -330,12 +382,12 @@ void FragmentBinner::getFragmentStorageBins(const io::FragmentAccessor &fragment
     bins.erase(std::unique(bins.begin(), bins.end()), bins.end());
 }
 
-void FragmentBinner::openBinFile(const BinMetadata &binMetadata, std::size_t file)
+void FragmentBinner::openBinFile(const BinMetadata &binMetadata, std::size_t file, const bool keepData)
 {
     ISAAC_THREAD_CERR << "openBin file: " << file << " for " << binMetadata << std::endl;
     // make sure file is empty first time we decide to put data in it.
     // boost::filesystem::remove for some stupid reason needs to allocate strings for this...
-    if (common::deleteFile(binMetadata.getPath().c_str()) && ENOENT != errno)
+    if (!keepData && common::deleteFile(binMetadata.getPath().c_str()) && ENOENT != errno)
     {
         BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to unlink " + binMetadata.getPath().string()));
     }
@@ -347,6 +399,12 @@ void FragmentBinner::openBinFile(const BinMetadata &binMetadata, std::size_t fil
     {
         BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open bin file " + binMetadata.getPathString()));
     }
+
+    // appending does not move the position until the first write. Don't let flush truncate the existing data
+    if (keepData && std::streampos(-1) == files_[file].pubseekoff(0, std::ios_base::end, std::ios_base::out))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to seek to the end of bin file " + binMetadata.getPathString()));
+    }
 }
 
 static std::size_t uniquePathCount(
@@ -366,6 +424,23 @@ static std::size_t uniquePathCount(
 void FragmentBinner::open(
     const BinMetadataList::iterator binsBegin,
     const BinMetadataList::iterator binsEnd)
+{
+    openBinFiles(binsBegin, binsEnd, false);
+}
+
+void FragmentBinner::resume(
+    const BinMetadataList::iterator binsBegin,
+    const BinMetadataList::iterator binsEnd,
+    const uint64_t binZeroRecordsBinned)
+{
+    openBinFiles(binsBegin, binsEnd, true);
+    binZeroRecordsBinned_ = binZeroRecordsBinned;
+}
+
+void FragmentBinner::openBinFiles(
+    const BinMetadataList::iterator binsBegin,
+    const BinMetadataList::iterator binsEnd,
+    const bool keepData)
 {
     std::vector<io::FileBufWithReopen>(uniquePathCount(binsBegin, binsEnd), io::FileBufWithReopen(std::ios_base::out | std::ios_base::app | std::ios_base::binary)).swap(files_);
     binFiles_.resize(std::max_element(binsBegin, binsEnd, [](const BinMetadata& left, const BinMetadata& right){return left.getIndex() < right.getIndex();})->getIndex() + 1);
@@ -383,14 +458,14 @@ void FragmentBinner::open(
 
     alignment::BinMetadataList::iterator last = binsBegin;
     std::size_t file = 0;
-    openBinFile(*binsBegin, file);
+    openBinFile(*binsBegin, file, keepData);
     for (alignment::BinMetadataList::iterator current = binsBegin; binsEnd != current; ++current)
     {
         // multiple BinMetadata may refer to the same storage file. Open each file only once
         if (last->getPath() != current->getPath())
         {
             ++file;
-            openBinFile(*current, file);
+            openBinFile(*current, file, keepData);
         }
         binFiles_.at(current->getIndex()) = file;
 //        ISAAC_THREAD_CERR << "mapped " << *current << " to file: " << file << std::endl;
@@ -426,6 +501,11 @@ void FragmentBinner::flush(BinMetadataList &binMetadataList)
     ISAAC_THREAD_CERR << "flushing " << files_.size() << " output buffers done for " << threadFileBuffers_.size() << " threads "<< std::endl;
 }
 
+void FragmentBinner::sync()
+{
+    std::for_each(files_.begin(), files_.end(), boost::bind(&io::FileBufWithReopen::flush, _1));
+}
+
 void FragmentBinner::close() noexcept
 {
     ISAAC_THREAD_CERR << "truncating " << files_.size() << " output files for " << std::endl;
@@ -0,0 +1,329 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file MatchSelectorStatsBinary.cpp
+ **
+ ** \brief Compact columnar binary serialization of MatchSelector statistics.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <cerrno>
+
+#include <boost/format.hpp>
+
+#include "alignment/matchSelector/MatchSelectorStatsBinary.hh"
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+using namespace statsColumns;
+
+namespace
+{
+
+void writeUnsignedList(std::ostream &os, const std::vector<unsigned> &values)
+{
+    writeVarint(os, values.size());
+    for (const unsigned value : values)
+    {
+        writeVarint(os, value);
+    }
+}
+
+std::vector<unsigned> readUnsignedList(std::istream &is)
+{
+    std::vector<unsigned> ret(readVarint(is));
+    for (unsigned &value : ret)
+    {
+        value = readVarint(is);
+    }
+    return ret;
+}
+
+} // namespace
+
+MatchSelectorStatsBinaryWriter::MatchSelectorStatsBinaryWriter(
+    std::ostream &os,
+    const bool collectCycleStats,
+    const flowcell::FlowcellLayoutList &flowcellLayoutList,
+    const flowcell::BarcodeMetadataList &barcodeMetadataList,
+    const flowcell::TileMetadataList &tileMetadataList) :
+    os_(os),
+    collectCycleStats_(collectCycleStats),
+    flowcellLayoutList_(flowcellLayoutList),
+    barcodeMetadataList_(barcodeMetadataList)
+{
+    os_.write(MAGIC, sizeof(MAGIC));
+    writeVarint(os_, FORMAT_VERSION);
+    os_.put(collectCycleStats_);
+
+    writeVarint(os_, flowcellLayoutList_.size());
+    for (const flowcell::Layout &flowcell : flowcellLayoutList_)
+    {
+        writeString(os_, flowcell.getFlowcellId());
+        writeVarint(os_, flowcell.getLaneNumberMax());
+        writeUnsignedList(os_, flowcell.getBarcodeCycles());
+        writeVarint(os_, flowcell.getReadMetadataList().size());
+        for (const flowcell::ReadMetadata &read : flowcell.getReadMetadataList())
+        {
+            writeVarint(os_, read.getNumber());
+            writeVarint(os_, read.getIndex());
+            writeVarint(os_, read.getOffset());
+            writeVarint(os_, read.getFirstReadCycle());
+            writeUnsignedList(os_, read.getCycles());
+        }
+    }
+
+    writeVarint(os_, barcodeMetadataList_.size());
+    for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+    {
+        writeVarint(os_, barcode.getFlowcellIndex());
+        writeVarint(os_, barcode.getLane());
+        os_.put(barcode.isUnknown());
+        writeString(os_, barcode.getSequence());
+        writeString(os_, barcode.getProject());
+        writeString(os_, barcode.getSampleName());
+        writeString(os_, barcode.getReference());
+        writeVarint(os_, barcode.getReferenceIndex());
+    }
+
+    writeVarint(os_, tileMetadataList.size());
+    for (const flowcell::TileMetadata &tile : tileMetadataList)
+    {
+        writeVarint(os_, tile.getFlowcellIndex());
+        writeVarint(os_, tile.getLane());
+        writeVarint(os_, tile.getTile());
+        writeVarint(os_, tile.getClusterCount());
+        writeVarint(os_, tile.getIndex());
+    }
+
+    writeVarint(os_, TABLES_COUNT);
+    for (unsigned table = 0; TABLES_COUNT != table; ++table)
+    {
+        tables_.push_back(makeTable(TableId(table)));
+        writeSchema(os_, tables_.back());
+    }
+}
+
+void MatchSelectorStatsBinaryWriter::writeTile(const flowcell::TileMetadata &tile, const MatchSelectorStats &stats)
+{
+    for (StatsColumnTable &table : tables_)
+    {
+        table.clearRows();
+    }
+
+    const flowcell::ReadMetadataList &reads = flowcellLayoutList_.at(tile.getFlowcellIndex()).getReadMetadataList();
+    for (const bool passesFilter : {true, false})
+    {
+        for (const flowcell::ReadMetadata &read : reads)
+        {
+            const TileStats &tileStats = stats.getReadTileStat(read, passesFilter);
+            appendTileRead(tables_[TileReads], read.getIndex(), passesFilter, tileStats);
+            if (collectCycleStats_)
+            {
+                appendTileCycles(tables_[TileCycles], read.getIndex(), passesFilter, read, tileStats);
+            }
+            for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+            {
+                if (barcode.getFlowcellIndex() == tile.getFlowcellIndex() && barcode.getLane() == tile.getLane())
+                {
+                    const TileBarcodeStats &barcodeStats = stats.getReadBarcodeTileStat(read, barcode, passesFilter);
+                    if (!barcodeStats.empty())
+                    {
+                        appendTileBarcodeRead(
+                            tables_[TileBarcodeReads], barcode.getIndex(), read.getIndex(), passesFilter, barcodeStats);
+                    }
+                }
+            }
+        }
+    }
+
+    writeVarint(os_, tile.getIndex() + 1);
+    for (const StatsColumnTable &table : tables_)
+    {
+        writeTable(os_, table);
+    }
+}
+
+void MatchSelectorStatsBinaryWriter::close()
+{
+    writeVarint(os_, 0);
+    os_.flush();
+}
+
+MatchSelectorStatsBinaryReader::MatchSelectorStatsBinaryReader(std::istream &is) :
+    is_(is), collectCycleStats_(false), tileIndex_(0)
+{
+    readHeader();
+}
+
+void MatchSelectorStatsBinaryReader::readHeader()
+{
+    char magic[sizeof(MAGIC)];
+    if (!is_.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "Not an alignment statistics binary file"));
+    }
+    const uint64_t version = readVarint(is_);
+    if (FORMAT_VERSION < version)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(
+            EINVAL, (boost::format("Unsupported alignment statistics format version %d") % version).str()));
+    }
+    collectCycleStats_ = readVarint(is_);
+
+    const uint64_t flowcells = readVarint(is_);
+    for (uint64_t flowcellIndex = 0; flowcells != flowcellIndex; ++flowcellIndex)
+    {
+        const std::string flowcellId = readString(is_);
+        const unsigned laneNumberMax = readVarint(is_);
+        const std::vector<unsigned> barcodeCycles = readUnsignedList(is_);
+        flowcell::ReadMetadataList reads;
+        const uint64_t readCount = readVarint(is_);
+        for (uint64_t i = 0; readCount != i; ++i)
+        {
+            const unsigned number = readVarint(is_);
+            const unsigned index = readVarint(is_);
+            const unsigned offset = readVarint(is_);
+            const unsigned firstReadCycle = readVarint(is_);
+            reads.push_back(flowcell::ReadMetadata(number, readUnsignedList(is_), index, offset, firstReadCycle));
+        }
+        flowcellLayoutList_.push_back(
+            flowcell::Layout("", flowcell::Layout::Fastq, flowcell::FastqFlowcellData(false, '!', false),
+                             laneNumberMax, 0, barcodeCycles, reads, flowcellId));
+        flowcellLayoutList_.back().setIndex(flowcellIndex);
+    }
+
+    const uint64_t barcodes = readVarint(is_);
+    for (uint64_t index = 0; barcodes != index; ++index)
+    {
+        const unsigned flowcellIndex = readVarint(is_);
+        const unsigned lane = readVarint(is_);
+        const bool unknown = is_.get();
+        const std::string sequence = readString(is_);
+        const std::string project = readString(is_);
+        const std::string sampleName = readString(is_);
+        const std::string reference = readString(is_);
+        const unsigned referenceIndex = readVarint(is_);
+        flowcell::BarcodeMetadata barcode(
+            flowcellLayoutList_.at(flowcellIndex).getFlowcellId(), flowcellIndex, lane, referenceIndex, unknown,
+            flowcell::SequencingAdapterMetadataList());
+        if (!unknown)
+        {
+            barcode.setSequence(sequence);
+            barcode.setSampleName(sampleName);
+        }
+        barcode.setProject(project);
+        barcode.setReference(reference);
+        barcode.setIndex(index);
+        barcodeMetadataList_.push_back(barcode);
+    }
+
+    const uint64_t tiles = readVarint(is_);
+    for (uint64_t i = 0; tiles != i; ++i)
+    {
+        const unsigned flowcellIndex = readVarint(is_);
+        const unsigned lane = readVarint(is_);
+        const unsigned tile = readVarint(is_);
+        const unsigned clusterCount = readVarint(is_);
+        const unsigned index = readVarint(is_);
+        flowcell::Layout &flowcell = flowcellLayoutList_.at(flowcellIndex);
+        tileMetadataList_.push_back(
+            flowcell::TileMetadata(flowcell.getFlowcellId(), flowcellIndex, tile, lane, clusterCount, index));
+        flowcell.addTile(lane, tile);
+    }
+
+    const uint64_t tables = readVarint(is_);
+    for (uint64_t i = 0; tables != i; ++i)
+    {
+        tables_.push_back(readSchema(is_));
+    }
+    // tables that appear in later versions are ignored, the missing ones are treated as empty
+    tables_.resize(std::max<std::size_t>(tables_.size(), TABLES_COUNT));
+}
+
+bool MatchSelectorStatsBinaryReader::nextTile()
+{
+    const uint64_t tileKey = readVarint(is_);
+    if (!tileKey)
+    {
+        return false;
+    }
+    if (tileMetadataList_.size() < tileKey)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(
+            EINVAL, (boost::format("Tile index %d is out of range in binary stats data") % (tileKey - 1)).str()));
+    }
+    tileIndex_ = tileKey - 1;
+    for (StatsColumnTable &table : tables_)
+    {
+        if (table.names_.empty())
+        {
+            table.clearRows();
+        }
+        else
+        {
+            readTable(is_, table);
+        }
+    }
+    return true;
+}
+
+void MatchSelectorStatsBinaryReader::restoreTileStats(MatchSelectorStats &stats) const
+{
+    const flowcell::ReadMetadataList &reads =
+        flowcellLayoutList_.at(getTile().getFlowcellIndex()).getReadMetadataList();
+    restoreTileReads(
+        tables_.at(TileReads),
+        [&](const unsigned read, const bool passesFilter) -> TileStats&
+        {
+            return stats.getReadTileStat(reads.at(read), passesFilter);
+        });
+    restoreTileCycles(
+        tables_.at(TileCycles),
+        [&](const unsigned read, const bool passesFilter) -> TileStats&
+        {
+            return stats.getReadTileStat(reads.at(read), passesFilter);
+        });
+    restoreTileBarcodeReads(
+        tables_.at(TileBarcodeReads),
+        [&](const unsigned barcode, const unsigned read, const bool passesFilter) -> TileBarcodeStats&
+        {
+            return stats.getReadBarcodeTileStat(reads.at(read), barcodeMetadataList_.at(barcode), passesFilter);
+        });
+}
+
+void MatchSelectorStatsBinaryReader::readAll(std::vector<MatchSelectorStats> &stats)
+{
+    stats.clear();
+    stats.reserve(tileMetadataList_.size());
+    while (stats.size() < tileMetadataList_.size())
+    {
+        stats.push_back(MatchSelectorStats(collectCycleStats_, barcodeMetadataList_));
+    }
+    while (nextTile())
+    {
+        restoreTileStats(stats.at(tileIndex_));
+    }
+}
+
+} //namespace matchSelector
+} //namespace alignment
+} //namespace isaac
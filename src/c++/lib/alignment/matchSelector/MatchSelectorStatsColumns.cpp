@@ -0,0 +1,493 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file MatchSelectorStatsColumns.cpp
+ **
+ ** \brief Columnar layout and encoding of the binary MatchSelector statistics.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+
+#include "alignment/matchSelector/MatchSelectorStatsColumns.hh"
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+
+namespace isaac
+{
+namespace alignment
+{
+namespace matchSelector
+{
+
+void StatsColumnTable::clearRows()
+{
+    for (std::vector<uint64_t> &column : columns_)
+    {
+        column.clear();
+    }
+}
+
+const std::vector<uint64_t> *StatsColumnTable::findColumn(const std::string &name) const
+{
+    const std::vector<std::string>::const_iterator it = std::find(names_.begin(), names_.end(), name);
+    return names_.end() == it ? 0 : &columns_.at(it - names_.begin());
+}
+
+namespace statsColumns
+{
+
+namespace
+{
+
+typedef uint64_t (TileStats::*UnsignedCycles)[TileStats::MAX_CYCLES];
+typedef int64_t (TileStats::*SignedCycles)[TileStats::MAX_CYCLES];
+
+static const struct {const char *name_; uint64_t TileStats::*field_;} TILE_READ_COLUMNS[] =
+{
+    {"FragmentCount", &TileStats::fragmentCount_},
+    {"AlignedFragmentCount", &TileStats::alignedFragmentCount_},
+    {"UniquelyAlignedFragmentCount", &TileStats::uniquelyAlignedFragmentCount_},
+    {"AdapterBases", &TileStats::adapterBases_},
+};
+
+static const struct {const char *name_; UnsignedCycles field_;} TILE_CYCLE_UNSIGNED_COLUMNS[] =
+{
+    {"Blanks", &TileStats::cycleBlanks_},
+    {"UniquelyAlignedBlanks", &TileStats::cycleUniquelyAlignedBlanks_},
+    {"Mismatches", &TileStats::cycleMismatches_},
+    {"UniquelyAlignedMismatches", &TileStats::cycleUniquelyAlignedMismatches_},
+};
+
+// cumulative counts can go negative after TileStats::finalize
+static const struct {const char *name_; SignedCycles field_;} TILE_CYCLE_SIGNED_COLUMNS[] =
+{
+    {"UniquelyAligned1MismatchFragments", &TileStats::cycleUniquelyAligned1MismatchFragments_},
+    {"UniquelyAligned2MismatchFragments", &TileStats::cycleUniquelyAligned2MismatchFragments_},
+    {"UniquelyAligned3MismatchFragments", &TileStats::cycleUniquelyAligned3MismatchFragments_},
+    {"UniquelyAligned4MismatchFragments", &TileStats::cycleUniquelyAligned4MismatchFragments_},
+    {"UniquelyAlignedMoreMismatchFragments", &TileStats::cycleUniquelyAlignedMoreMismatchFragments_},
+    {"1MismatchFragments", &TileStats::cycle1MismatchFragments_},
+    {"2MismatchFragments", &TileStats::cycle2MismatchFragments_},
+    {"3MismatchFragments", &TileStats::cycle3MismatchFragments_},
+    {"4MismatchFragments", &TileStats::cycle4MismatchFragments_},
+    {"MoreMismatchFragments", &TileStats::cycleMoreMismatchFragments_},
+};
+
+static const struct {const char *name_; uint64_t TileBarcodeStats::*field_;} TILE_BARCODE_READ_COLUMNS[] =
+{
+    {"Yield", &TileBarcodeStats::yield_},
+    {"YieldQ30", &TileBarcodeStats::yieldQ30_},
+    {"QualityScoreSum", &TileBarcodeStats::qualityScoreSum_},
+    {"ClusterCount", &TileBarcodeStats::clusterCount_},
+    {"UnanchoredClusterCount", &TileBarcodeStats::unanchoredClusterCount_},
+    {"NmNmClusterCount", &TileBarcodeStats::nmnmClusterCount_},
+    {"RmClusterCount", &TileBarcodeStats::rmClusterCount_},
+    {"QcClusterCount", &TileBarcodeStats::qcClusterCount_},
+    {"AlignedFragmentCount", &TileBarcodeStats::alignedFragmentCount_},
+    {"UniquelyAlignedFragmentCount", &TileBarcodeStats::uniquelyAlignedFragmentCount_},
+    {"AdapterBases", &TileBarcodeStats::adapterBases_},
+    {"UniquelyAlignedPerfectFragmentCount", &TileBarcodeStats::uniquelyAlignedPerfectFragmentCount_},
+    {"AlignmentScoreSum", &TileBarcodeStats::alignmentScoreSum_},
+    {"BasesOutsideIndels", &TileBarcodeStats::basesOutsideIndels_},
+    {"UniquelyAlignedBasesOutsideIndels", &TileBarcodeStats::uniquelyAlignedBasesOutsideIndels_},
+    {"Mismatches", &TileBarcodeStats::mismatches_},
+    {"UniquelyAlignedMismatches", &TileBarcodeStats::uniquelyAlignedMismatches_},
+    {"FragmentCount", &TileBarcodeStats::fragmentCount_},
+};
+
+static const char *ALIGNMENT_MODEL_COLUMNS[TemplateLengthStatistics::InvalidAlignmentModel + 1] =
+{
+    "AlignmentModelFFp", "AlignmentModelFRp", "AlignmentModelRFp", "AlignmentModelRRp",
+    "AlignmentModelFFm", "AlignmentModelFRm", "AlignmentModelRFm", "AlignmentModelRRm",
+    "AlignmentModelInvalid"
+};
+
+static const char *NOMINAL_MODEL_COLUMNS[TemplateLengthStatistics::CheckModelLast] =
+{
+    "Oversized", "Undersized", "Nominal", "NoMatch"
+};
+
+static const char *TEMPLATE_LENGTH_COLUMNS[] =
+{
+    "TemplateLengthSet", "TemplateLengthConflicts", "TemplateLengthStable",
+    "TemplateLengthMin", "TemplateLengthMax", "TemplateLengthMedian",
+    "TemplateLengthLowStdDev", "TemplateLengthHighStdDev",
+    "TemplateLengthModel1", "TemplateLengthModel2"
+};
+
+void addColumn(StatsColumnTable &table, const std::string &name, const bool isSigned)
+{
+    table.names_.push_back(name);
+    table.signed_.push_back(isSigned);
+    table.columns_.push_back(std::vector<uint64_t>());
+}
+
+/**
+ * \brief Sequential appending of the values of a row in the order in which makeTable has declared the columns
+ */
+class RowAppender
+{
+public:
+    explicit RowAppender(StatsColumnTable &table) : table_(table), column_(0) {}
+    ~RowAppender()
+    {
+        ISAAC_ASSERT_MSG(table_.columns_.size() == column_, "Incomplete row: " << column_ << " values for " << table_.columns_.size() << " columns");
+    }
+    RowAppender &operator <<(const uint64_t value)
+    {
+        table_.columns_.at(column_++).push_back(value);
+        return *this;
+    }
+private:
+    StatsColumnTable &table_;
+    std::size_t column_;
+};
+
+/**
+ * \brief Gives 0 for any row when the column is not present in the file
+ */
+class ColumnReader
+{
+public:
+    ColumnReader(const StatsColumnTable &table, const std::string &name) : column_(table.findColumn(name)) {}
+    uint64_t operator[](const std::size_t row) const {return column_ ? column_->at(row) : 0;}
+private:
+    const std::vector<uint64_t> *column_;
+};
+
+template <typename ArrayT>
+std::size_t arraySize(const ArrayT &array)
+{
+    return sizeof(array) / sizeof(array[0]);
+}
+
+} // namespace
+
+StatsColumnTable makeTable(const TableId tableId)
+{
+    StatsColumnTable ret;
+    switch (tableId)
+    {
+    case TileReads:
+        addColumn(ret, "Read", false);
+        addColumn(ret, "PassesFilter", false);
+        for (const auto &column : TILE_READ_COLUMNS)
+        {
+            addColumn(ret, column.name_, false);
+        }
+        break;
+    case TileCycles:
+        addColumn(ret, "Read", false);
+        addColumn(ret, "PassesFilter", false);
+        addColumn(ret, "Cycle", false);
+        for (const auto &column : TILE_CYCLE_UNSIGNED_COLUMNS)
+        {
+            addColumn(ret, column.name_, false);
+        }
+        for (const auto &column : TILE_CYCLE_SIGNED_COLUMNS)
+        {
+            addColumn(ret, column.name_, true);
+        }
+        break;
+    case TileBarcodeReads:
+        addColumn(ret, "Barcode", false);
+        addColumn(ret, "Read", false);
+        addColumn(ret, "PassesFilter", false);
+        for (const auto &column : TILE_BARCODE_READ_COLUMNS)
+        {
+            addColumn(ret, column.name_, false);
+        }
+        for (const char *name : ALIGNMENT_MODEL_COLUMNS)
+        {
+            addColumn(ret, name, false);
+        }
+        for (const char *name : NOMINAL_MODEL_COLUMNS)
+        {
+            addColumn(ret, name, false);
+        }
+        for (const char *name : TEMPLATE_LENGTH_COLUMNS)
+        {
+            addColumn(ret, name, false);
+        }
+        break;
+    default:
+        ISAAC_ASSERT_MSG(false, "Unknown stats table " << tableId);
+        break;
+    }
+    return ret;
+}
+
+void appendTileRead(StatsColumnTable &table, const unsigned readKey, const bool passesFilter, const TileStats &stats)
+{
+    RowAppender row(table);
+    row << readKey << passesFilter;
+    for (const auto &column : TILE_READ_COLUMNS)
+    {
+        row << stats.*column.field_;
+    }
+}
+
+void appendTileCycles(
+    StatsColumnTable &table, const unsigned readKey, const bool passesFilter,
+    const flowcell::ReadMetadata &read, const TileStats &stats)
+{
+    for (unsigned cycle = read.getFirstCycle(); read.getLastCycle() >= cycle; ++cycle)
+    {
+        RowAppender row(table);
+        row << readKey << passesFilter << cycle;
+        for (const auto &column : TILE_CYCLE_UNSIGNED_COLUMNS)
+        {
+            row << (stats.*column.field_)[cycle];
+        }
+        for (const auto &column : TILE_CYCLE_SIGNED_COLUMNS)
+        {
+            row << zigzag((stats.*column.field_)[cycle]);
+        }
+    }
+}
+
+void appendTileBarcodeRead(
+    StatsColumnTable &table, const unsigned barcode, const unsigned readKey, const bool passesFilter,
+    const TileBarcodeStats &stats)
+{
+    RowAppender row(table);
+    row << barcode << readKey << passesFilter;
+    for (const auto &column : TILE_BARCODE_READ_COLUMNS)
+    {
+        row << stats.*column.field_;
+    }
+    for (std::size_t i = 0; arraySize(ALIGNMENT_MODEL_COLUMNS) != i; ++i)
+    {
+        row << stats.alignmentModelCounts_[i];
+    }
+    for (std::size_t i = 0; arraySize(NOMINAL_MODEL_COLUMNS) != i; ++i)
+    {
+        row << stats.nominalModelCounts_[i];
+    }
+    const TemplateLengthStatistics &tls = stats.templateLengthStatistics_;
+    row << stats.templateLengthStatisticsSet_ << stats.templateLengthStatisticsConflicts_ << tls.isStable()
+        << tls.getMin() << tls.getMax() << tls.getMedian() << tls.getLowStdDev() << tls.getHighStdDev()
+        << tls.getBestModel(0) << tls.getBestModel(1);
+}
+
+void restoreTileReads(const StatsColumnTable &table, const TileStatsResolver &resolve)
+{
+    const ColumnReader read(table, "Read");
+    const ColumnReader passesFilter(table, "PassesFilter");
+    for (const auto &column : TILE_READ_COLUMNS)
+    {
+        const ColumnReader values(table, column.name_);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            resolve(read[row], passesFilter[row]).*column.field_ = values[row];
+        }
+    }
+}
+
+void restoreTileCycles(const StatsColumnTable &table, const TileStatsResolver &resolve)
+{
+    const ColumnReader read(table, "Read");
+    const ColumnReader passesFilter(table, "PassesFilter");
+    const ColumnReader cycle(table, "Cycle");
+    for (std::size_t row = 0; table.getRowCount() != row; ++row)
+    {
+        ISAAC_ASSERT_MSG(TileStats::MAX_CYCLES > cycle[row], "Cycle number is too great: " << cycle[row]);
+    }
+    for (const auto &column : TILE_CYCLE_UNSIGNED_COLUMNS)
+    {
+        const ColumnReader values(table, column.name_);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            (resolve(read[row], passesFilter[row]).*column.field_)[cycle[row]] = values[row];
+        }
+    }
+    for (const auto &column : TILE_CYCLE_SIGNED_COLUMNS)
+    {
+        const ColumnReader values(table, column.name_);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            (resolve(read[row], passesFilter[row]).*column.field_)[cycle[row]] = unzigzag(values[row]);
+        }
+    }
+}
+
+void restoreTileBarcodeReads(const StatsColumnTable &table, const TileBarcodeStatsResolver &resolve)
+{
+    const ColumnReader barcode(table, "Barcode");
+    const ColumnReader read(table, "Read");
+    const ColumnReader passesFilter(table, "PassesFilter");
+    for (const auto &column : TILE_BARCODE_READ_COLUMNS)
+    {
+        const ColumnReader values(table, column.name_);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            resolve(barcode[row], read[row], passesFilter[row]).*column.field_ = values[row];
+        }
+    }
+    for (std::size_t i = 0; arraySize(ALIGNMENT_MODEL_COLUMNS) != i; ++i)
+    {
+        const ColumnReader values(table, ALIGNMENT_MODEL_COLUMNS[i]);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            resolve(barcode[row], read[row], passesFilter[row]).alignmentModelCounts_[i] = values[row];
+        }
+    }
+    for (std::size_t i = 0; arraySize(NOMINAL_MODEL_COLUMNS) != i; ++i)
+    {
+        const ColumnReader values(table, NOMINAL_MODEL_COLUMNS[i]);
+        for (std::size_t row = 0; table.getRowCount() != row; ++row)
+        {
+            resolve(barcode[row], read[row], passesFilter[row]).nominalModelCounts_[i] = values[row];
+        }
+    }
+
+    std::vector<ColumnReader> tl;
+    for (const char *name : TEMPLATE_LENGTH_COLUMNS)
+    {
+        tl.push_back(ColumnReader(table, name));
+    }
+    for (std::size_t row = 0; table.getRowCount() != row; ++row)
+    {
+        TileBarcodeStats &stats = resolve(barcode[row], read[row], passesFilter[row]);
+        stats.templateLengthStatisticsSet_ = tl[0][row];
+        stats.templateLengthStatisticsConflicts_ = tl[1][row];
+        if (stats.templateLengthStatisticsSet_)
+        {
+            stats.templateLengthStatistics_ = TemplateLengthStatistics(
+                tl[3][row], tl[4][row], tl[5][row], tl[6][row], tl[7][row],
+                TemplateLengthStatistics::AlignmentModel(tl[8][row]),
+                TemplateLengthStatistics::AlignmentModel(tl[9][row]),
+                -1, tl[2][row]);
+        }
+    }
+}
+
+void writeVarint(std::ostream &os, uint64_t value)
+{
+    while (0x80 <= value)
+    {
+        os.put(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    os.put(char(value));
+}
+
+void writeString(std::ostream &os, const std::string &value)
+{
+    writeVarint(os, value.size());
+    os.write(value.data(), value.size());
+}
+
+void writeSchema(std::ostream &os, const StatsColumnTable &table)
+{
+    writeVarint(os, table.names_.size());
+    for (std::size_t i = 0; table.names_.size() != i; ++i)
+    {
+        writeString(os, table.names_[i]);
+        os.put(table.signed_[i]);
+    }
+}
+
+void writeTable(std::ostream &os, const StatsColumnTable &table)
+{
+    writeVarint(os, table.getRowCount());
+    if (table.getRowCount())
+    {
+        std::ostringstream column;
+        for (const std::vector<uint64_t> &values : table.columns_)
+        {
+            column.str(std::string());
+            for (const uint64_t value : values)
+            {
+                writeVarint(column, value);
+            }
+            writeString(os, column.str());
+        }
+    }
+}
+
+uint64_t readVarint(std::istream &is)
+{
+    uint64_t ret = 0;
+    for (unsigned shift = 0; 64 > shift; shift += 7)
+    {
+        const int byte = is.get();
+        if (std::istream::traits_type::eof() == byte)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "Unexpected end of binary stats data"));
+        }
+        ret |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return ret;
+        }
+    }
+    BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "Malformed variable-length integer in binary stats data"));
+}
+
+std::string readString(std::istream &is)
+{
+    const uint64_t size = readVarint(is);
+    std::string ret(size, '\0');
+    if (size && !is.read(&ret[0], size))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "Unexpected end of binary stats data"));
+    }
+    return ret;
+}
+
+StatsColumnTable readSchema(std::istream &is)
+{
+    StatsColumnTable ret;
+    const uint64_t columns = readVarint(is);
+    for (uint64_t i = 0; columns != i; ++i)
+    {
+        const std::string name = readString(is);
+        const int isSigned = is.get();
+        if (std::istream::traits_type::eof() == isSigned)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "Unexpected end of binary stats data"));
+        }
+        addColumn(ret, name, isSigned);
+    }
+    return ret;
+}
+
+void readTable(std::istream &is, StatsColumnTable &table)
+{
+    table.clearRows();
+    const uint64_t rows = readVarint(is);
+    if (rows)
+    {
+        std::istringstream column;
+        for (std::vector<uint64_t> &values : table.columns_)
+        {
+            column.clear();
+            column.str(readString(is));
+            values.reserve(rows);
+            for (uint64_t row = 0; rows != row; ++row)
+            {
+                values.push_back(readVarint(column));
+            }
+        }
+    }
+}
+
+} // namespace statsColumns
+
+} //namespace matchSelector
+} //namespace alignment
+} //namespace isaac
@@ -55,7 +55,7 @@ TemplateDetector::TemplateDetector(
                          flowcell::getMaxBarcodeLength(flowcellLayoutList_))),
   threadTemplateBuilders_(threadTemplateBuilders),
   templateLengthDistributions_(barcodeMetadataList_.size(), TemplateLengthDistribution(detectTemplateBlockSize, mateDriftRange)),
-  unprocessedClusterId_(0),
+  clusterScheduler_(computeThreads_.size(), CLUSTERS_AT_A_TIME_MIN, CLUSTERS_AT_A_TIME, 0.01),
   pendingClusterId_(0)
 {
 }
@@ -74,7 +74,7 @@ void TemplateDetector::collectModels(
     std::vector<alignment::TemplateLengthStatistics>& templateLengthStatistics,
     Cluster& ourThreadCluster,
     TemplateBuilder& templateBuilder,
-    const MatchFinderT& matchFinder,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     common::StaticVector<BarcodeAlignmentModel, CLUSTERS_AT_A_TIME>& threadBarcodeModels)
 {
     const reference::ContigLists &threadContigLists = contigLists_.threadNodeContainer();
@@ -100,7 +100,7 @@ void TemplateDetector::collectModels(
         const templateBuilder::AlignmentType alignmentType = templateBuilder.buildFragments(
                 threadContigLists.at(barcodeReference),
                 tileReads, adapterClipper,
-                matchFinder, MATCH_FINDER_TOO_MANY_REPEATS, ourThreadCluster, false);
+                *referenceMatchFinders.at(barcodeReference), MATCH_FINDER_TOO_MANY_REPEATS, ourThreadCluster, false);
 
         if (templateBuilder::Normal == alignmentType)
         {
@@ -119,7 +119,7 @@ void TemplateDetector::templateLengthThread(
     const unsigned threadNumber,
     const flowcell::TileMetadata& tileMetadata, const BclClusters& bclData,
     const matchFinder::ClusterInfos& clusterInfos,
-    const MatchFinderT& matchFinder,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     std::size_t &statsToBuild,
     std::vector<alignment::TemplateLengthStatistics>& templateLengthStatistics)
 {
@@ -134,13 +134,11 @@ void TemplateDetector::templateLengthThread(
 
 
     boost::unique_lock<boost::mutex> lock(mutex_);
-    while (statsToBuild && tileMetadata.getClusterCount() != unprocessedClusterId_)
+    uint64_t clusterRangeBegin = 0;
+    uint64_t clusterRangeEnd = 0;
+    while (statsToBuild && clusterScheduler_.next(threadNumber, clusterRangeBegin, clusterRangeEnd))
     {
         common::StaticVector<BarcodeAlignmentModel, CLUSTERS_AT_A_TIME> threadBarcodeModels;
-        const unsigned clusterRangeBegin = unprocessedClusterId_;
-        static const unsigned clustersAtATime = CLUSTERS_AT_A_TIME;
-        const unsigned clusterRangeEnd = clusterRangeBegin + std::min(clustersAtATime, tileMetadata.getClusterCount() - clusterRangeBegin);
-        unprocessedClusterId_ = clusterRangeEnd;
 
         {
             common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
@@ -148,7 +146,7 @@ void TemplateDetector::templateLengthThread(
                           clusterInfos, tileReads, tileMetadata, barcodeLength,
                           readNameLength, statsToBuild,
                           templateLengthStatistics, ourThreadCluster,
-                          ourThreadTemplateBuilder, matchFinder,
+                          ourThreadTemplateBuilder, referenceMatchFinders,
                           threadBarcodeModels);
         }
 
@@ -180,32 +178,36 @@ void TemplateDetector::templateLengthThread(
     }
 }
 
-template <typename MatchFinderT>
-void TemplateDetector::determineTemplateLengths(
+/**
+ * \return true if the template length statistics of the tile are not going to be detected from the tile data
+ */
+static bool tlsUndetectable(
+    const flowcell::ReadMetadataList &tileReads,
+    const TemplateLengthStatistics &userTemplateLengthStatistics)
+{
+    ISAAC_ASSERT_MSG(2 >= tileReads.size(), "only single-ended and paired reads are supported");
+    return 2 != tileReads.size() || userTemplateLengthStatistics.isStable();
+}
+
+std::size_t TemplateDetector::prepareTile(
     const flowcell::TileMetadata &tileMetadata,
-    const matchFinder::ClusterInfos &clusterInfos,
-    const std::vector<RestOfGenomeCorrection> &restOfGenomeCorrections,
-    const MatchFinderT &matchFinder,
-    const BclClusters &bclData,
-    std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics,
-    matchSelector::MatchSelectorStats &stats)
+    std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics)
 {
     const flowcell::Layout &flowcell = flowcellLayoutList_.at(tileMetadata.getFlowcellIndex());
     const flowcell::ReadMetadataList &tileReads = flowcell.getReadMetadataList();
 
-    ISAAC_ASSERT_MSG(2 >= tileReads.size(), "only single-ended and paired reads are supported");
-
-    if (2 != tileReads.size())
+    if (tlsUndetectable(tileReads, userTemplateLengthStatistics_))
     {
-        ISAAC_THREAD_CERR << "Using unstable template-length statistics for single-ended data" << std::endl;
-        return;
-    }
-
-    if (userTemplateLengthStatistics_.isStable())
-    {
-        ISAAC_THREAD_CERR << "Using user-defined template-length statistics: " << userTemplateLengthStatistics_ << std::endl;
-        std::fill(templateLengthStatistics.begin(), templateLengthStatistics.end(), userTemplateLengthStatistics_);
-        return;
+        if (2 != tileReads.size())
+        {
+            ISAAC_THREAD_CERR << "Using unstable template-length statistics for single-ended data" << std::endl;
+        }
+        else
+        {
+            ISAAC_THREAD_CERR << "Using user-defined template-length statistics: " << userTemplateLengthStatistics_ << std::endl;
+            std::fill(templateLengthStatistics.begin(), templateLengthStatistics.end(), userTemplateLengthStatistics_);
+        }
+        return 0;
     }
 
     if (perTileTls_)
@@ -239,21 +241,23 @@ void TemplateDetector::determineTemplateLengths(
 
     ISAAC_THREAD_CERR << "Determining template length statistics for " << statsToBuild << " barcodes on " << tileMetadata << std::endl;
 
-    if (statsToBuild)
+    clusterScheduler_.reset(tileMetadata.getClusterCount(), true);
+    pendingClusterId_ = 0;
+    return statsToBuild;
+}
+
+void TemplateDetector::finalizeTile(
+    const flowcell::TileMetadata &tileMetadata,
+    std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics,
+    matchSelector::MatchSelectorStats &stats)
+{
+    const flowcell::Layout &flowcell = flowcellLayoutList_.at(tileMetadata.getFlowcellIndex());
+    if (tlsUndetectable(flowcell.getReadMetadataList(), userTemplateLengthStatistics_))
     {
-        unprocessedClusterId_ = 0;
-        pendingClusterId_ = 0;
-
-        computeThreads_.execute(boost::bind(&TemplateDetector::templateLengthThread<MatchFinderT>, this, _1,
-                                            boost::ref(tileMetadata),
-                                            boost::ref(bclData),
-                                            boost::ref(clusterInfos),
-                                            boost::ref(matchFinder),
-                                            boost::ref(statsToBuild),
-                                            boost::ref(templateLengthStatistics)));
+        return;
     }
 
-    barcode = 0;
+    std::size_t barcode = 0;
     BOOST_FOREACH(TemplateLengthDistribution &templateLengthDistribution, templateLengthDistributions_)
     {
         const flowcell::BarcodeMetadata &barcodeMetadata = barcodeMetadataList_[barcode];
@@ -275,19 +279,19 @@ void TemplateDetector::determineTemplateLengths(
 
 template <typename KmerT> struct InstantiateTemplates : TemplateDetector
 {
-    typedef ClusterHashMatchFinder<reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> >> MatchFinderT;
+    typedef ClusterHashMatchFinder<reference::NumaReferenceHash<reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > > > MatchFinderT;
 
-    void determineTemplateLengths(
+    void templateLengthThread(
+        const unsigned threadNumber,
         const flowcell::TileMetadata &tileMetadata,
-        const matchFinder::ClusterInfos &clusterInfos,
-        const std::vector<RestOfGenomeCorrection> &restOfGenomeCorrection,
-        const MatchFinderT &matchFinder,
         const BclClusters &bclData,
-        std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics,
-        matchSelector::MatchSelectorStats &stats)
+        const matchFinder::ClusterInfos &clusterInfos,
+        const std::vector<const MatchFinderT *> &referenceMatchFinders,
+        std::size_t &statsToBuild,
+        std::vector<alignment::TemplateLengthStatistics> &templateLengthStatistics)
     {
-        TemplateDetector::determineTemplateLengths(tileMetadata, clusterInfos, restOfGenomeCorrection, matchFinder, bclData,
-                templateLengthStatistics, stats);
+        TemplateDetector::templateLengthThread(
+            threadNumber, tileMetadata, bclData, clusterInfos, referenceMatchFinders, statsToBuild, templateLengthStatistics);
     }
 };
 
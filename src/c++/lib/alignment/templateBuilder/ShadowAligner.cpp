@@ -26,6 +26,7 @@
 #include "alignment/templateBuilder/FragmentSequencingAdapterClipper.hh"
 #include "oligo/Kmer.hh"
 #include "oligo/KmerGenerator.hpp"
+#include "common/BitHacks.hh"
 #include "common/Debug.hh"
 
 namespace isaac
@@ -52,7 +53,9 @@ ShadowAligner<SHADOW_KMER_LENGTH>::ShadowAligner(
       splitAlignments_(splitAlignments),
       flowcellLayoutList_(flowcellLayoutList),
       ungappedAligner_(collectMismatchCycles, alignmentCfg),
-      cigarBuffer_(cigarBuffer)
+      cigarBuffer_(cigarBuffer),
+      shadowKmers_(shadowKmerCount_, 0),
+      shadowKmerEpoch_(0)
 {
     static const std::size_t SHADOW_CANDIDATE_POSITIONS_MAX_EVER = 10000;
     shadowCandidatePositions_.reserve(SHADOW_CANDIDATE_POSITIONS_MAX_EVER);
@@ -61,19 +64,24 @@ ShadowAligner<SHADOW_KMER_LENGTH>::ShadowAligner(
 template <unsigned SHADOW_KMER_LENGTH>
 unsigned ShadowAligner<SHADOW_KMER_LENGTH>::hashShadowKmers(const std::vector<char> &sequence)
 {
-    shadowKmerPositions_.clear();
-    // initialize all k-mers to the magic value -1 (NOT_FOUND)
-    shadowKmerPositions_.resize(shadowKmerCount_, -1);
-    // 
+    // entries stored by the previous attempts become invisible as soon as the epoch changes
+    if (SHADOW_KMER_EPOCH_MAX == shadowKmerEpoch_)
+    {
+        std::fill(shadowKmers_.begin(), shadowKmers_.end(), 0);
+        shadowKmerEpoch_ = 0;
+    }
+    ++shadowKmerEpoch_;
+    const uint32_t epochBits = shadowKmerEpoch_ << SHADOW_KMER_POSITION_BITS;
+
     oligo::KmerGenerator<SHADOW_KMER_LENGTH, unsigned, std::vector<char>::const_iterator> kmerGenerator(sequence.begin(), sequence.end());
     unsigned positionsCount = 0;
     unsigned kmer;
     std::vector<char>::const_iterator position;
     while (kmerGenerator.next(kmer, position))
     {
-        if (-1 == shadowKmerPositions_[kmer])
+        if (epochBits != (shadowKmers_[kmer] & ~SHADOW_KMER_POSITION_MASK))
         {
-            shadowKmerPositions_[kmer] = (position - sequence.begin());
+            shadowKmers_[kmer] = epochBits | (position - sequence.begin());
             ++positionsCount;
         }
     }
@@ -91,46 +99,84 @@ bool ShadowAligner<SHADOW_KMER_LENGTH>::findShadowCandidatePositions(
 {
     hashShadowKmers(shadowSequence);
 
-    // find matching positions in the reference by k-mer comparison
-    oligo::KmerGenerator<SHADOW_KMER_LENGTH, unsigned, reference::Contig::const_iterator> kmerGenerator(referenceBegin, referenceEnd);
-    unsigned kmer;
-    reference::Contig::const_iterator position = referenceBegin;
-    while(kmerGenerator.next(kmer, position))
+    static const unsigned BITS_PER_WORD = 32;
+    const uint64_t rangeLength = alignmentStartPositionRange.second - alignmentStartPositionRange.first + 1;
+    const std::size_t maskWords = (rangeLength + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    if (shadowCandidateMask_.size() < maskWords)
+    {
+        shadowCandidateMask_.resize(maskWords, 0);
+    }
+
+    // find matching positions in the reference by k-mer comparison. The bases are translated a block at a time
+    // so that the translation has no dependency on the rolling kmer and the compiler can vectorize it.
+    static const unsigned SCAN_BLOCK_BASES = 256;
+    static const unsigned KMER_MASK = shadowKmerCount_ - 1;
+    const oligo::Translator<> translator;
+    const uint32_t epochBits = shadowKmerEpoch_ << SHADOW_KMER_POSITION_BITS;
+    unsigned char blockOligos[SCAN_BLOCK_BASES];
+    unsigned kmer = 0;
+    unsigned validBases = 0;
+    std::size_t candidatesCount = 0;
+    bool candidatesFull = false;
+    for (reference::Contig::const_iterator blockBegin = referenceBegin; !candidatesFull && referenceEnd != blockBegin;)
     {
-        if (-1 != shadowKmerPositions_[kmer])
+        const unsigned blockLength = std::min<std::size_t>(SCAN_BLOCK_BASES, std::distance(blockBegin, referenceEnd));
+        for (unsigned i = 0; blockLength != i; ++i)
         {
-            const int64_t candidatePosition = position - referenceBegin - shadowKmerPositions_[kmer] + referenceOffset;
+            blockOligos[i] = translator[blockBegin[i]];
+        }
 
-            // avoid positions that will place mate outside the requested range. This can happen if rightmost k-mer of the mate matches the
-            // first kmer of the reference like so:
-            // <MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMM
-            //                          RRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRR
-            if (alignmentStartPositionRange.first <= candidatePosition && alignmentStartPositionRange.second >= candidatePosition)
+        for (unsigned i = 0; blockLength != i; ++i)
+        {
+            const unsigned oligo = blockOligos[i];
+            // N found, start over
+            validBases = oligo::INVALID_OLIGO > oligo ? validBases + 1 : 0;
+            kmer = ((kmer << oligo::BITS_PER_BASE) | (oligo & oligo::BCL_BASE_MASK)) & KMER_MASK;
+            const uint32_t shadowKmer = shadowKmers_[kmer];
+            if (SHADOW_KMER_LENGTH <= validBases && epochBits == (shadowKmer & ~SHADOW_KMER_POSITION_MASK))
             {
-                // avoid spurious repetitions of start positions
-                if (shadowCandidatePositions.empty() || shadowCandidatePositions.back() != candidatePosition)
+                const int64_t kmerPosition = std::distance(referenceBegin, blockBegin) + i - (SHADOW_KMER_LENGTH - 1);
+                const int64_t candidatePosition = kmerPosition - (shadowKmer & SHADOW_KMER_POSITION_MASK) + referenceOffset;
+
+                // avoid positions that will place mate outside the requested range. This can happen if rightmost k-mer of the mate matches the
+                // first kmer of the reference like so:
+                // <MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMM
+                //                          RRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRRR
+                if (alignmentStartPositionRange.first <= candidatePosition && alignmentStartPositionRange.second >= candidatePosition)
                 {
-                    if (shadowCandidatePositions.size() == shadowCandidatePositions.capacity())
+                    const uint64_t bit = candidatePosition - alignmentStartPositionRange.first;
+                    uint32_t &word = shadowCandidateMask_[bit / BITS_PER_WORD];
+                    const uint32_t bitMask = uint32_t(1) << (bit % BITS_PER_WORD);
+                    if (!(word & bitMask))
                     {
-                        // too many candidate positions. Just stop here. The alignment score will be miserable anyway.
-                        break;
+                        if (shadowCandidatePositions.capacity() == candidatesCount)
+                        {
+                            // too many candidate positions. Just stop here. The alignment score will be miserable anyway.
+                            candidatesFull = true;
+                            break;
+                        }
+                        word |= bitMask;
+                        ++candidatesCount;
                     }
-                    shadowCandidatePositions.push_back(candidatePosition);
-    //                ISAAC_THREAD_CERR << "kmer: " << oligo::Bases<2, oligo::Kmer>(kmer, shadowKmerLength_) << " " << candidatePosition << std::endl;
                 }
             }
         }
+        blockBegin += blockLength;
     }
 
-    // remove duplicate positions
-    if (!shadowCandidatePositions.empty())
+    // collect the marked positions in ascending order, resetting the mask for the next attempt
+    for (std::size_t wordIndex = 0; candidatesCount; ++wordIndex)
     {
-        std::sort(shadowCandidatePositions.begin(), shadowCandidatePositions.end());
-        shadowCandidatePositions.erase(std::unique(shadowCandidatePositions.begin(), shadowCandidatePositions.end()), shadowCandidatePositions.end());
-        return true;
+        uint32_t word = shadowCandidateMask_[wordIndex];
+        shadowCandidateMask_[wordIndex] = 0;
+        for (; word; word &= word - 1, --candidatesCount)
+        {
+            shadowCandidatePositions.push_back(
+                alignmentStartPositionRange.first + wordIndex * BITS_PER_WORD + common::lsbSet(word));
+        }
     }
 
-    return false;
+    return !shadowCandidatePositions.empty();
 }
 
 /**
@@ -0,0 +1,253 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file BamIndexReader.cpp
+ **
+ ** \brief see BamIndexReader.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <fstream>
+
+#include <boost/format.hpp>
+
+#include "bam/BamIndexReader.hh"
+#include "bgzf/BgzfReader.hh"
+#include "common/Debug.hh"
+#include "common/Endianness.hh"
+
+namespace isaac
+{
+namespace bam
+{
+
+namespace
+{
+
+/**
+ * \brief Sequential little-endian reader over the uncompressed index data
+ */
+class IndexData
+{
+    const std::vector<char> &data_;
+    std::vector<char>::const_iterator it_;
+    const boost::filesystem::path &path_;
+public:
+    IndexData(const std::vector<char> &data, const boost::filesystem::path &path) :
+        data_(data), it_(data_.begin()), path_(path)
+    {
+    }
+
+    template <typename T>
+    T get()
+    {
+        if (std::size_t(std::distance(it_, data_.end())) < sizeof(T))
+        {
+            BOOST_THROW_EXCEPTION(BamIndexException(
+                (boost::format("Unexpected end of index data at offset %d in %s") %
+                    std::distance(data_.begin(), it_) % path_.string()).str()));
+        }
+        T ret;
+        it_ = common::extractLittleEndian(it_, ret);
+        return ret;
+    }
+
+    void skip(const std::size_t bytes)
+    {
+        if (std::size_t(std::distance(it_, data_.end())) < bytes)
+        {
+            BOOST_THROW_EXCEPTION(BamIndexException(
+                (boost::format("Unexpected end of index data at offset %d in %s") %
+                    std::distance(data_.begin(), it_) % path_.string()).str()));
+        }
+        it_ += bytes;
+    }
+
+    bool checkMagic(const char *magic)
+    {
+        if (std::size_t(std::distance(it_, data_.end())) >= 4 && std::equal(magic, magic + 4, it_))
+        {
+            it_ += 4;
+            return true;
+        }
+        return false;
+    }
+};
+
+void readFile(const boost::filesystem::path &indexPath, std::vector<char> &data)
+{
+    std::ifstream is(indexPath.c_str(), std::ios_base::binary);
+    if (!is)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Failed to open index file: %s") % indexPath).str()));
+    }
+
+    if (bgzf::BgzfReader::isBgzfCompressed(is))
+    {
+        bgzf::BgzfReader reader(1);
+        reader.reserveBuffers();
+        while (!is.eof())
+        {
+            const unsigned blockSize = reader.readNextBlock(is);
+            if (blockSize)
+            {
+                data.resize(data.size() + blockSize);
+                reader.uncompressCurrentBlock(&data.front() + data.size() - blockSize, blockSize);
+            }
+        }
+    }
+    else
+    {
+        // files shorter than bgzf header are left at eof by isBgzfCompressed
+        is.clear();
+        is.seekg(0);
+        // istreambuf_iterator does not update the stream state, only the buffer can tell about failures
+        data.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        if (is.bad())
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Failed to read index file: %s") % indexPath).str()));
+        }
+    }
+}
+
+void readChunks(IndexData &index, std::vector<BgzfVirtualOffset> &recordOffsets)
+{
+    const int32_t nChunk = index.get<int32_t>();
+    for (int32_t chunk = 0; chunk < nChunk; ++chunk)
+    {
+        // chunk begin is always a beginning of a record
+        recordOffsets.push_back(index.get<uint64_t>());
+        index.skip(sizeof(uint64_t));
+    }
+}
+
+} // namespace
+
+BamIndexReader::BamIndexReader(const boost::filesystem::path &indexPath)
+{
+    std::vector<char> data;
+    readFile(indexPath, data);
+
+    IndexData index(data, indexPath);
+    if (index.checkMagic("BAI\1"))
+    {
+        // 37450 is (8^6-1)/7+1 the pseudo-bin storing the reference metadata
+        static const uint32_t BAI_PSEUDO_BIN = 37450;
+        const int32_t nRef = index.get<int32_t>();
+        for (int32_t ref = 0; ref < nRef; ++ref)
+        {
+            const int32_t nBin = index.get<int32_t>();
+            for (int32_t bin = 0; bin < nBin; ++bin)
+            {
+                if (BAI_PSEUDO_BIN == index.get<uint32_t>())
+                {
+                    // unmapped read counts in the second pseudo-chunk are not offsets
+                    index.skip(sizeof(int32_t) + 2 * 2 * sizeof(uint64_t));
+                }
+                else
+                {
+                    readChunks(index, recordOffsets_);
+                }
+            }
+            const int32_t nIntv = index.get<int32_t>();
+            for (int32_t intv = 0; intv < nIntv; ++intv)
+            {
+                recordOffsets_.push_back(index.get<uint64_t>());
+            }
+        }
+    }
+    else if (index.checkMagic("CSI\1"))
+    {
+        index.get<int32_t>(); //min_shift
+        const int32_t depth = index.get<int32_t>();
+        const uint32_t csiPseudoBin = ((1U << ((depth + 1) * 3)) - 1) / 7 + 1;
+        index.skip(index.get<int32_t>()); //l_aux
+        const int32_t nRef = index.get<int32_t>();
+        for (int32_t ref = 0; ref < nRef; ++ref)
+        {
+            const int32_t nBin = index.get<int32_t>();
+            for (int32_t bin = 0; bin < nBin; ++bin)
+            {
+                const uint32_t binNumber = index.get<uint32_t>();
+                const BgzfVirtualOffset loffset = index.get<uint64_t>();
+                if (csiPseudoBin == binNumber)
+                {
+                    index.skip(sizeof(int32_t) + 2 * 2 * sizeof(uint64_t));
+                }
+                else
+                {
+                    recordOffsets_.push_back(loffset);
+                    readChunks(index, recordOffsets_);
+                }
+            }
+        }
+    }
+    else
+    {
+        BOOST_THROW_EXCEPTION(BamIndexException(
+            (boost::format("Unrecognized index file format: %s") % indexPath.string()).str()));
+    }
+
+    // empty intervals of the linear index are stored as 0
+    recordOffsets_.erase(std::remove(recordOffsets_.begin(), recordOffsets_.end(), 0UL), recordOffsets_.end());
+    std::sort(recordOffsets_.begin(), recordOffsets_.end());
+    recordOffsets_.erase(std::unique(recordOffsets_.begin(), recordOffsets_.end()), recordOffsets_.end());
+
+    ISAAC_THREAD_CERR << "Loaded " << recordOffsets_.size() << " record offsets from " << indexPath << std::endl;
+}
+
+boost::filesystem::path BamIndexReader::findIndex(const boost::filesystem::path &bamPath)
+{
+    const boost::filesystem::path candidates[] =
+    {
+        bamPath.string() + ".bai",
+        boost::filesystem::path(bamPath).replace_extension(".bai"),
+        bamPath.string() + ".csi",
+    };
+
+    for (const boost::filesystem::path &candidate : candidates)
+    {
+        if (boost::filesystem::exists(candidate))
+        {
+            if (boost::filesystem::last_write_time(candidate) < boost::filesystem::last_write_time(bamPath))
+            {
+                ISAAC_THREAD_CERR << "WARNING: Ignoring index " << candidate << " which is older than " << bamPath << std::endl;
+            }
+            else
+            {
+                return candidate;
+            }
+        }
+    }
+    return boost::filesystem::path();
+}
+
+BamFileRegions BamIndexReader::makeRegions(const uint64_t minRegionCompressedBytes) const
+{
+    BamFileRegions ret;
+    BgzfVirtualOffset regionBegin = 0;
+    for (const BgzfVirtualOffset offset : recordOffsets_)
+    {
+        if (getCompressedOffset(offset) - getCompressedOffset(regionBegin) >= minRegionCompressedBytes)
+        {
+            ret.push_back(BamFileRegion(regionBegin, offset));
+            regionBegin = offset;
+        }
+    }
+    ret.push_back(BamFileRegion(regionBegin, BamFileRegion::END_OF_FILE));
+
+    return ret;
+}
+
+} // namespace bam
+} // namespace isaac
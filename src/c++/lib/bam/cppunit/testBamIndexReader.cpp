@@ -0,0 +1,203 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/assign.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "RegistryName.hh"
+#include "testBamIndexReader.hh"
+
+#include "bgzf/BgzfCompressor.hh"
+
+using isaac::bam::BamFileRegion;
+using isaac::bam::BamFileRegions;
+using isaac::bam::BamIndexReader;
+using isaac::bam::BgzfVirtualOffset;
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBamIndexReader, registryName("BamIndexReader"));
+
+void TestBamIndexReader::setUp()
+{
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory_);
+}
+
+void TestBamIndexReader::tearDown()
+{
+    boost::filesystem::remove_all(directory_);
+}
+
+boost::filesystem::path TestBamIndexReader::writeIndex(
+    const std::string &name, const std::string &data, const bool compress) const
+{
+    const boost::filesystem::path path = directory_ / name;
+    std::ofstream os(path.c_str(), std::ios_base::binary);
+    if (compress)
+    {
+        boost::iostreams::filtering_ostream bgzfStream;
+        bgzfStream.push(isaac::bgzf::BgzfCompressor(), 65535, 0);
+        bgzfStream.push(os);
+        bgzfStream.write(data.data(), data.size());
+        bgzfStream.strict_sync();
+    }
+    else
+    {
+        os.write(data.data(), data.size());
+    }
+    return path;
+}
+
+/**
+ * \brief Builds uncompressed little-endian index content
+ */
+struct IndexData : public std::string
+{
+    template <typename T>
+    IndexData &put(const T value)
+    {
+        for (std::size_t i = 0; sizeof(T) != i; ++i)
+        {
+            push_back(char(uint64_t(value) >> (i * 8)));
+        }
+        return *this;
+    }
+
+    IndexData &chunk(const BgzfVirtualOffset begin, const BgzfVirtualOffset end)
+    {
+        return put(begin).put(end);
+    }
+};
+
+static BgzfVirtualOffset vo(const uint64_t compressed, const unsigned uncompressed)
+{
+    return compressed << 16 | uncompressed;
+}
+
+/**
+ * \brief Three references, the middle one has nothing aligned to it
+ */
+static IndexData makeBai()
+{
+    IndexData ret;
+    ret.append("BAI\1", 4);
+    ret.put(int32_t(3));
+
+    // reference 0: one bin, the pseudo-bin and the linear index
+    ret.put(int32_t(2));
+    ret.put(uint32_t(4681)).put(int32_t(1)).chunk(vo(100, 0), vo(200, 5));
+    // pseudo-bin: reference span and 5 mapped, 3 unmapped reads that must not be taken for offsets
+    ret.put(uint32_t(37450)).put(int32_t(2)).chunk(vo(100, 0), vo(300, 0)).chunk(5, 3);
+    ret.put(int32_t(2)).put(vo(100, 0)).put(vo(200, 5));
+
+    // reference 1: empty
+    ret.put(int32_t(0));
+    ret.put(int32_t(0));
+
+    // reference 2: linear index has an empty interval
+    ret.put(int32_t(1));
+    ret.put(uint32_t(0)).put(int32_t(1)).chunk(vo(300, 0), vo(400, 0));
+    ret.put(int32_t(3)).put(uint64_t(0)).put(vo(300, 0)).put(vo(350, 12));
+
+    // n_no_coor
+    ret.put(uint64_t(7));
+    return ret;
+}
+
+static const std::vector<BgzfVirtualOffset> BAI_OFFSETS =
+    boost::assign::list_of(vo(100, 0))(vo(200, 5))(vo(300, 0))(vo(350, 12));
+
+void TestBamIndexReader::testBai()
+{
+    const BamIndexReader reader(writeIndex("test.bam.bai", makeBai()));
+    CPPUNIT_ASSERT_EQUAL(BAI_OFFSETS.size(), reader.getRecordOffsets().size());
+    CPPUNIT_ASSERT(std::equal(BAI_OFFSETS.begin(), BAI_OFFSETS.end(), reader.getRecordOffsets().begin()));
+}
+
+void TestBamIndexReader::testCsi()
+{
+    // with depth 6 the pseudo-bin is (8^7-1)/7+1. 37450 is the bai pseudo-bin but a regular bin here
+    static const uint32_t CSI_PSEUDO_BIN = 299594;
+    IndexData csi;
+    csi.append("CSI\1", 4);
+    csi.put(int32_t(14)).put(int32_t(6));
+    csi.put(int32_t(4)).put(uint32_t(0xdeadbeef));
+    csi.put(int32_t(2));
+
+    // reference 0
+    csi.put(int32_t(3));
+    csi.put(uint32_t(37450)).put(vo(150, 3)).put(int32_t(1)).chunk(vo(160, 0), vo(170, 0));
+    csi.put(uint32_t(4681)).put(vo(170, 0)).put(int32_t(2)).chunk(vo(170, 0), vo(180, 0)).chunk(vo(190, 1), vo(195, 0));
+    csi.put(CSI_PSEUDO_BIN).put(uint64_t(0)).put(int32_t(2)).chunk(vo(1000, 0), vo(2000, 0)).chunk(9, 0);
+
+    // reference 1: empty
+    csi.put(int32_t(0));
+
+    const std::vector<BgzfVirtualOffset> expected =
+        boost::assign::list_of(vo(150, 3))(vo(160, 0))(vo(170, 0))(vo(190, 1));
+
+    const BamIndexReader reader(writeIndex("test.bam.csi", csi));
+    CPPUNIT_ASSERT_EQUAL(expected.size(), reader.getRecordOffsets().size());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), reader.getRecordOffsets().begin()));
+
+    // csi files normally come bgzf-compressed
+    const BamIndexReader compressed(writeIndex("compressed.bam.csi", csi, true));
+    CPPUNIT_ASSERT_EQUAL(expected.size(), compressed.getRecordOffsets().size());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), compressed.getRecordOffsets().begin()));
+}
+
+void TestBamIndexReader::testCorrupt()
+{
+    const IndexData bai = makeBai();
+    // cut in the middle of the reference 2 linear index
+    const boost::filesystem::path truncated = writeIndex("truncated.bam.bai", bai.substr(0, bai.size() - 20));
+    CPPUNIT_ASSERT_THROW(BamIndexReader reader(truncated), isaac::bam::BamIndexException);
+
+    const boost::filesystem::path unknown = writeIndex("unknown.bam.bai", "BAM\1" + bai.substr(4));
+    CPPUNIT_ASSERT_THROW(BamIndexReader reader(unknown), isaac::bam::BamIndexException);
+}
+
+void TestBamIndexReader::testRegions()
+{
+    const BamIndexReader reader(writeIndex("test.bam.bai", makeBai()));
+
+    const BamFileRegions split = reader.makeRegions(150);
+    CPPUNIT_ASSERT_EQUAL(3UL, split.size());
+    CPPUNIT_ASSERT_EQUAL(vo(200, 5), split.at(0).end_);
+    CPPUNIT_ASSERT_EQUAL(vo(350, 12), split.at(1).end_);
+
+    const std::vector<uint64_t> sizes = boost::assign::list_of(1)(150)(250)(1000);
+    for (const uint64_t minRegionCompressedBytes : sizes)
+    {
+        const BamFileRegions regions = reader.makeRegions(minRegionCompressedBytes);
+        CPPUNIT_ASSERT(!regions.empty());
+        // the first region has to pick up the bam header and the reads that precede the first indexed offset
+        CPPUNIT_ASSERT_EQUAL(BgzfVirtualOffset(0), regions.front().begin_);
+        CPPUNIT_ASSERT_EQUAL(BamFileRegion::END_OF_FILE, regions.back().end_);
+        for (std::size_t i = 1; regions.size() != i; ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(regions.at(i - 1).end_, regions.at(i).begin_);
+        }
+
+        for (const BgzfVirtualOffset offset : BAI_OFFSETS)
+        {
+            const std::size_t containing = std::count_if(
+                regions.begin(), regions.end(),
+                [offset](const BamFileRegion &region){return region.begin_ <= offset && offset < region.end_;});
+            CPPUNIT_ASSERT_EQUAL(std::size_t(1), containing);
+        }
+    }
+}
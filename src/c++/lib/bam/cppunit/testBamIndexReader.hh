@@ -0,0 +1,46 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_BAM_TEST_BAM_INDEX_READER_HH
+#define iSAAC_BAM_TEST_BAM_INDEX_READER_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "bam/BamIndexReader.hh"
+
+class TestBamIndexReader : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBamIndexReader );
+    CPPUNIT_TEST( testBai );
+    CPPUNIT_TEST( testCsi );
+    CPPUNIT_TEST( testCorrupt );
+    CPPUNIT_TEST( testRegions );
+    CPPUNIT_TEST_SUITE_END();
+
+    boost::filesystem::path directory_;
+public:
+    void setUp();
+    void tearDown();
+    void testBai();
+    void testCsi();
+    void testCorrupt();
+    void testRegions();
+
+private:
+    boost::filesystem::path writeIndex(
+        const std::string &name, const std::string &data, const bool compress = false) const;
+};
+
+#endif // #ifndef iSAAC_BAM_TEST_BAM_INDEX_READER_HH
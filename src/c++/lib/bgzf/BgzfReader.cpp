@@ -49,12 +49,12 @@ inline bool isValidHeader(const bgzf::Header &header)
         header.xfield.SI1 == 66U && header.xfield.SI2 == 67U;
 }
 
-unsigned BgzfReader::readNextBlock(std::istream &is)
+unsigned BgzfReader::readNextBlock(std::istream &is, const uint64_t compressedBytesMax)
 {
     compressedBlockBuffer_.clear();
 
     unsigned ret = 0;
-    for (unsigned i = 0; i < blocksAtOnce_; ++i)
+    for (unsigned i = 0; i < blocksAtOnce_ && compressedBlockBuffer_.size() < compressedBytesMax; ++i)
     {
         compressedBlockBuffer_.resize(compressedBlockBuffer_.size() + sizeof(bgzf::Header));
         is.read(&compressedBlockBuffer_.front() + compressedBlockBuffer_.size() - sizeof(bgzf::Header), sizeof(bgzf::Header));
@@ -141,10 +141,62 @@ void ParallelBgzfReader::open(const boost::filesystem::path &filePath)
         BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Failed to open bgzf file: %s") % filePath).str()));
     }
     pendingBlockSize_ = 0;
+    compressedOffset_ = 0;
+    endCompressedOffset_ = -1UL;
+    endUncompressedBytes_ = 0;
+    endOfRange_ = false;
     is_.rdbuf(&fileBuffer_);
     ISAAC_THREAD_CERR << "Opened bgzf stream on " << filePath << std::endl;
 }
 
+void ParallelBgzfReader::open(
+    const boost::filesystem::path &filePath,
+    const uint64_t compressedBegin,
+    const uint64_t endCompressedOffset,
+    const unsigned endUncompressedBytes)
+{
+    open(filePath);
+    if (compressedBegin && !is_.seekg(compressedBegin))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, (boost::format("Failed to seek to %d in bgzf file: %s") %
+            compressedBegin % filePath).str()));
+    }
+    compressedOffset_ = compressedBegin;
+    endCompressedOffset_ = endCompressedOffset;
+    endUncompressedBytes_ = endUncompressedBytes;
+    endOfRange_ = compressedOffset_ >= endCompressedOffset_ && !endUncompressedBytes_;
+    ISAAC_THREAD_CERR << "Reading bgzf stream range " << compressedBegin << "-" << endCompressedOffset << ":" << endUncompressedBytes << std::endl;
+}
+
+/**
+ * \brief reads blocks not crossing the range end. The block at endCompressedOffset_ is read alone and
+ *        reported to contain only endUncompressedBytes_.
+ *
+ * \return number of uncompressed bytes to extract from the blocks read.
+ */
+unsigned ParallelBgzfReader::readNextBlock(BgzfReader &reader, std::istream &is)
+{
+    if (endOfRange_)
+    {
+        return 0;
+    }
+
+    unsigned ret = 0;
+    if (compressedOffset_ == endCompressedOffset_)
+    {
+        // only the beginning of the last block belongs to the range
+        ret = std::min(reader.readNextBlock(is, 1), endUncompressedBytes_);
+        endOfRange_ = true;
+    }
+    else
+    {
+        ret = reader.readNextBlock(is, endCompressedOffset_ - compressedOffset_);
+        endOfRange_ = compressedOffset_ + reader.getCompressedSize() >= endCompressedOffset_ && !endUncompressedBytes_;
+    }
+    compressedOffset_ += reader.getCompressedSize();
+    return ret;
+}
+
 void ParallelBgzfReader::waitForLoadSlot(boost::unique_lock<boost::mutex> &lock)
 {
     while (!loadSlotAvailable_)
@@ -204,7 +256,7 @@ void ParallelBgzfReader::readMoreDataParallel(const unsigned threadNumber, std::
             ourThreadOffset = -1UL;
         }
 
-        if (is.eof())
+        if (noMoreBlocks(is))
         {
             ISAAC_THREAD_CERR << "Thread " << threadNumber << " terminating due to eof" << " buffer.size()" << decompressed << std::endl;
             break;
@@ -219,18 +271,18 @@ void ParallelBgzfReader::readMoreDataParallel(const unsigned threadNumber, std::
             {
                 {
                     common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
-                    while (!is.eof() && !ourThreadBlockSize)
+                    while (!noMoreBlocks(is) && !ourThreadBlockSize)
                     {
-                        ourThreadBlockSize = ourThreadReader.readNextBlock(is);
+                        ourThreadBlockSize = readNextBlock(ourThreadReader, is);
                     }
                 }
                 if (!ourThreadBlockSize)
                 {
-                    ISAAC_ASSERT_MSG(is.eof(), "Unexpectedly stopped reading bgzf before the end of the input stream");
+                    ISAAC_ASSERT_MSG(noMoreBlocks(is), "Unexpectedly stopped reading bgzf before the end of the input stream");
                     ISAAC_THREAD_CERR << "Thread " << threadNumber << " reached eof while reading empty blocks" << std::endl;
                     break;
                 }
-                else if (is.eof())
+                else if (noMoreBlocks(is))
                 {
                     ISAAC_THREAD_CERR << "Thread " << threadNumber << " reached eof" << std::endl;
                 }
@@ -139,7 +139,8 @@ void BamSerializer::splitIfNeeded(
 }
 
 void BamSerializer::prepareForBam(
-    const reference::ContigList &contigList,
+    const reference::ContigLists &contigLists,
+    const flowcell::BarcodeMetadataList &barcodeMetadataList,
     PackedFragmentBuffer &data,
     BinData::IndexType &dataIndex,
     alignment::Cigar &splitCigars,
@@ -148,6 +149,10 @@ void BamSerializer::prepareForBam(
     // Caution, we will be appending to dataIndex
     BOOST_FOREACH(PackedFragmentBuffer::Index &index, std::make_pair(dataIndex.begin(), dataIndex.end()))
     {
+        // bins are shared between references. Unaligned records don't look at the reference
+        const flowcell::BarcodeMetadata &barcode = barcodeMetadataList.at(data.getFragment(index).barcode_);
+        const reference::ContigList &contigList =
+            contigLists.at(barcode.isUnmappedReference() ? 0 : barcode.getReferenceIndex());
         splitIfNeeded(contigList, data, index, dataIndex, splitCigars, splitInfoList);
     }
 
@@ -44,7 +44,7 @@ uint64_t BinSorter::serialize(
     }
     ISAAC_THREAD_CERR << "Sorting offsets for bam " << binData.bin_ << std::endl;
 
-    bamSerializer_.prepareForBam(contigLists_.front(), binData.data_, binData, binData.additionalCigars_, binData.splitInfoList_);
+    bamSerializer_.prepareForBam(contigLists_, barcodeMetadataList_, binData.data_, binData, binData.additionalCigars_, binData.splitInfoList_);
 
     ISAAC_THREAD_CERR << "Sorting offsets for bam done " << binData.bin_ << std::endl;
 
@@ -37,7 +37,9 @@
 #include "build/IndelLoader.hh"
 #include "common/Debug.hh"
 #include "common/FileSystem.hh"
+#include "common/PerfTrace.hh"
 #include "common/Threads.hpp"
+#include "cram/Cram.hh"
 #include "io/Fragment.hh"
 #include "reference/ContigLoader.hh"
 
@@ -87,10 +89,15 @@ uint64_t Build::estimateBinCompressedDataRequirements(
         }
     }
 
+    // cram containers are encoded from uncompressed bam records which are bigger than the bin data
+    // because of the unpacked qualities and tags
+    static const double CRAM_UNCOMPRESSED_BAM_RATIO = 2.0;
+
     // assume all data will take the same fraction or less than the number derived from demultiplexed fragments.
     return EMPTY_BGZF_BLOCK_SIZE +
         ((getBinTotalSize(binMetadata) * thisOutputFileBarcodeElements +
-            binMetadata.getTotalElements() - 1) / binMetadata.getTotalElements()) * expectedBgzfCompressionRatio_;
+            binMetadata.getTotalElements() - 1) / binMetadata.getTotalElements()) *
+            (OUTPUT_CRAM == outputFormat_ ? CRAM_UNCOMPRESSED_BAM_RATIO : expectedBgzfCompressionRatio_);
 }
 
 inline bool orderBySampleIndex(
@@ -104,7 +111,8 @@ inline bool orderBySampleIndex(
 std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > Build::createOutputFileStreams(
     const flowcell::TileMetadataList &tileMetadataList,
     const flowcell::BarcodeMetadataList &barcodeMetadataList,
-    boost::ptr_vector<bam::BamIndex> &bamIndexes) const
+    boost::ptr_vector<bam::BamIndex> &bamIndexes,
+    boost::ptr_vector<cram::CramIndex> &cramIndexes) const
 {
     unsigned sinkIndexToCreate = 0;
     std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > ret;
@@ -122,12 +130,18 @@ std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > Build::crea
             const boost::filesystem::path &bamPath = barcodeBamMapping_.getFilePath(barcode);
             if (!barcode.isUnmappedReference())
             {
-                ISAAC_THREAD_CERR << "Created BAM file: " << bamPath << std::endl;
+                ISAAC_THREAD_CERR << "Created " << (OUTPUT_CRAM == outputFormat_ ? "CRAM" : "BAM") << " file: " << bamPath << std::endl;
 
                 const reference::SortedReferenceMetadata &sampleReference =
                     sortedReferenceMetadataList_.at(barcode.getReferenceIndex());
+                const auto headerAdapter = makeSortedReferenceXmlBamHeaderAdapter(
+                    sampleReference,
+                    boost::bind(&BuildContigMap::isMapped, &contigMap_, barcode.getReferenceIndex(), _1),
+                    tileMetadataList, barcodeMetadataList,
+                    barcode.getSampleName());
 
                 std::string compressedHeader;
+                if (OUTPUT_BAM == outputFormat_)
                 {
                     std::ostringstream oss(compressedHeader);
                     boost::iostreams::filtering_ostream bgzfStream;
@@ -138,11 +152,7 @@ std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > Build::crea
                                          description_,
                                          bamHeaderTags_,
                                          bamPuFormat_,
-                                         makeSortedReferenceXmlBamHeaderAdapter(
-                                             sampleReference,
-                                             boost::bind(&BuildContigMap::isMapped, &contigMap_, barcode.getReferenceIndex(), _1),
-                                             tileMetadataList, barcodeMetadataList,
-                                             barcode.getSampleName()));
+                                         headerAdapter);
                     bgzfStream.strict_sync();
                     compressedHeader = oss.str();
                 }
@@ -159,26 +169,39 @@ std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > Build::crea
                 }
 
                 if (!bamStream) {
-                    BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open output BAM file " + bamPath.string()));
+                    BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open output file " + bamPath.string()));
                 }
 
-                if (!bamStream.write(compressedHeader.c_str(), compressedHeader.size()))
+                if (OUTPUT_CRAM == outputFormat_)
                 {
-                    BOOST_THROW_EXCEPTION(
-                        common::IoException(errno, (boost::format("Failed to write %d bytes into stream %s") %
-                            compressedHeader.size() % bamPath.string()).str()));
+                    const uint64_t headerLength = cram::serializeHeader(
+                        bamStream, barcode.getSampleName(),
+                        bam::makeHeaderText(argv_, description_, bamHeaderTags_, bamPuFormat_, headerAdapter));
+                    cramIndexes.push_back(new cram::CramIndex(bamPath, headerLength));
+                    bamIndexes.push_back(new bam::BamIndex());
                 }
+                else
+                {
+                    if (!bamStream.write(compressedHeader.c_str(), compressedHeader.size()))
+                    {
+                        BOOST_THROW_EXCEPTION(
+                            common::IoException(errno, (boost::format("Failed to write %d bytes into stream %s") %
+                                compressedHeader.size() % bamPath.string()).str()));
+                    }
 
-                // Create BAM Indexer
-                unsigned headerCompressedLength = compressedHeader.size();
-                unsigned contigCount = sampleReference.getFilteredContigsCount(
-                    boost::bind(&BuildContigMap::isMapped, &contigMap_, barcode.getReferenceIndex(), _1));
-                bamIndexes.push_back(new bam::BamIndex(bamPath, contigCount, headerCompressedLength));
+                    // Create BAM Indexer
+                    unsigned headerCompressedLength = compressedHeader.size();
+                    unsigned contigCount = sampleReference.getFilteredContigsCount(
+                        boost::bind(&BuildContigMap::isMapped, &contigMap_, barcode.getReferenceIndex(), _1));
+                    bamIndexes.push_back(new bam::BamIndex(bamPath, contigCount, headerCompressedLength));
+                    cramIndexes.push_back(new cram::CramIndex());
+                }
             }
             else
             {
                 ret.push_back(boost::shared_ptr<boost::iostreams::filtering_ostream>());
                 bamIndexes.push_back(new bam::BamIndex());
+                cramIndexes.push_back(new cram::CramIndex());
                 ISAAC_THREAD_CERR << "Skipped BAM file due to unmapped barcode reference: " << bamPath << " " << barcode << std::endl;
             }
             ++sinkIndexToCreate;
@@ -189,6 +212,46 @@ std::vector<boost::shared_ptr<boost::iostreams::filtering_ostream> > Build::crea
     return ret;
 }
 
+/**
+ * \brief Replaces bins that grew over targetBinSize during alignment with bins covering runs of their
+ *        positional parts. This lets coverage spikes get loaded, sorted and serialized in parallel
+ *        and within the memory budget. The bins keep following each other in the reference order so
+ *        the output does not change.
+ */
+static alignment::BinMetadataList splitOversizeBins(
+    const alignment::BinMetadataList& bins,
+    const uint64_t targetBinSize)
+{
+    alignment::BinMetadataList ret;
+    ret.reserve(bins.size());
+    BOOST_FOREACH(const alignment::BinMetadata &bin, bins)
+    {
+        if (!targetBinSize || !bin.isPartitioned() || targetBinSize >= bin.getDataSize())
+        {
+            ret.push_back(bin);
+            continue;
+        }
+
+        const std::size_t before = ret.size();
+        unsigned partsBegin = 0;
+        uint64_t partsSize = 0;
+        for (unsigned part = 0; bin.getPartCount() != part; ++part)
+        {
+            const uint64_t partSize = bin.getPartDataSize(part);
+            if (partsBegin != part && targetBinSize < partsSize + partSize)
+            {
+                ret.push_back(bin.getPartsBin(partsBegin, part));
+                partsBegin = part;
+                partsSize = 0;
+            }
+            partsSize += partSize;
+        }
+        ret.push_back(bin.getPartsBin(partsBegin, bin.getPartCount()));
+        ISAAC_THREAD_CERR << "Split " << bin << " into " << ret.size() - before << " bins" << std::endl;
+    }
+    return ret;
+}
+
 alignment::BinMetadataCRefList filterBins(
     alignment::BinMetadataList& bins,
     const std::string &binRegexString)
@@ -301,6 +364,7 @@ Build::Build(const std::vector<std::string> &argv,
              const build::GapRealignerMode realignGaps,
              const unsigned realignMapqMin,
              const boost::filesystem::path &knownIndelsPath,
+             const OutputFormat outputFormat,
              const int bamGzipLevel,
              const std::string &bamPuFormat,
              const bool bamProduceMd5,
@@ -329,7 +393,7 @@ Build::Build(const std::vector<std::string> &argv,
      flowcellLayoutList_(flowcellLayoutList),
      tileMetadataList_(tileMetadataList),
      barcodeMetadataList_(barcodeMetadataList),
-     bins_(bins),
+     bins_(splitOversizeBins(bins, targetBinSize)),
      binRefs_(rearrangeBins(
          filterBins(bins_, binRegexString), keepUnaligned, putUnalignedInTheBack)),
      sortedReferenceMetadataList_(sortedReferenceMetadataList),
@@ -339,6 +403,7 @@ Build::Build(const std::vector<std::string> &argv,
      maxComputers_(maxComputers),
      allocatedBins_(0),
      maxSavers_(maxSavers),
+     outputFormat_(outputFormat),
      bamGzipLevel_(bamGzipLevel),
      bamPuFormat_(bamPuFormat),
      bamProduceMd5_(bamProduceMd5),
@@ -361,13 +426,17 @@ Build::Build(const std::vector<std::string> &argv,
      forceTermination_(false),
      threads_(maxComputers_ + maxLoaders_ + maxSavers_),
      contigLists_(contigLists),
-     barcodeBamMapping_(demultiplexing::mapBarcodesToFiles(outputDirectory_, barcodeMetadataList_, "sorted.bam")),
+     barcodeBamMapping_(demultiplexing::mapBarcodesToFiles(
+         outputDirectory_, barcodeMetadataList_, OUTPUT_CRAM == outputFormat_ ? "sorted.cram" : "sorted.bam")),
      bamIndexes_(),
-     bamFileStreams_(createOutputFileStreams(tileMetadataList_, barcodeMetadataList_, bamIndexes_)),
+     cramIndexes_(),
+     bamFileStreams_(createOutputFileStreams(tileMetadataList_, barcodeMetadataList_, bamIndexes_, cramIndexes_)),
      stats_(binRefs_, barcodeMetadataList_),
      threadBgzfBuffers_(threads_.size(), BgzfBuffers(bamFileStreams_.size())),
      threadBgzfStreams_(threads_.size()),
      threadBamIndexParts_(threads_.size()),
+     cramReferences_(makeCramReferences()),
+     threadCramContainers_(threads_.size(), std::vector<cram::Containers>(bamFileStreams_.size())),
      knownIndels_((build::GapRealignerMode::REALIGN_NONE == realignGaps_ || knownIndelsPath.empty()) ?
          gapRealigner::Gaps() : loadIndels(knownIndelsPath, sortedReferenceMetadataList_)),
      gapRealigner_(threads_.size(),
@@ -398,6 +467,37 @@ Build::Build(const std::vector<std::string> &argv,
 //    testBinsFitInRam();
 }
 
+/**
+ * \brief For each output file, lists the reference contigs in the order of bam refId
+ */
+std::vector<cram::ReferenceSequences> Build::makeCramReferences() const
+{
+    std::vector<cram::ReferenceSequences> ret;
+    if (OUTPUT_CRAM != outputFormat_)
+    {
+        return ret;
+    }
+
+    ret.resize(barcodeBamMapping_.getTotalSamples());
+    BOOST_FOREACH(const flowcell::BarcodeMetadata &barcode, barcodeMetadataList_)
+    {
+        cram::ReferenceSequences &references = ret.at(barcodeBamMapping_.getSampleIndex(barcode.getIndex()));
+        if (!barcode.isUnmappedReference() && references.empty())
+        {
+            const reference::ContigList &contigList = contigLists_.at(barcode.getReferenceIndex());
+            for (std::size_t contigId = 0; contigList.size() > contigId; ++contigId)
+            {
+                if (contigMap_.isMapped(barcode.getReferenceIndex(), contigId))
+                {
+                    const reference::ContigList::Contig &contig = contigList.at(contigId);
+                    references.push_back(cram::ReferenceSequence(contig.empty() ? 0 : &*contig.begin(), contig.size()));
+                }
+            }
+        }
+    }
+    return ret;
+}
+
 void Build::allocateThreadData(const std::size_t threadNumber)
 {
 //#ifdef HAVE_NUMA
@@ -434,11 +534,22 @@ void Build::run(common::ScopedMallocBlock &mallocBlock)
         std::ostream *stm = bamFileStreams_.at(fileIndex).get();
         if (stm)
         {
-            bam::serializeBgzfFooter(*stm);
-            stm->flush();
-            ISAAC_THREAD_CERR << "BAM file generated: " << bamFilePath.c_str() << "\n";
-            bamIndexes_.at(fileIndex).flush();
-            ISAAC_THREAD_CERR << "BAM index generated for " << bamFilePath.c_str() << "\n";
+            if (OUTPUT_CRAM == outputFormat_)
+            {
+                cram::serializeEof(*stm);
+                stm->flush();
+                ISAAC_THREAD_CERR << "CRAM file generated: " << bamFilePath.c_str() << "\n";
+                cramIndexes_.at(fileIndex).flush();
+                ISAAC_THREAD_CERR << "CRAM index generated for " << bamFilePath.c_str() << "\n";
+            }
+            else
+            {
+                bam::serializeBgzfFooter(*stm);
+                stm->flush();
+                ISAAC_THREAD_CERR << "BAM file generated: " << bamFilePath.c_str() << "\n";
+                bamIndexes_.at(fileIndex).flush();
+                ISAAC_THREAD_CERR << "BAM index generated for " << bamFilePath.c_str() << "\n";
+            }
         }
         ++fileIndex;
     }
@@ -566,7 +677,11 @@ void Build::reserveBuffers(
         while(bgzfStreams.size() < bamFileStreams_.size())
         {
             bgzfStreams.push_back(new boost::iostreams::filtering_ostream);
-            bgzfStreams.back().push(bgzf::BgzfCompressor(bamGzipLevel_), 65535, 0);
+            if (OUTPUT_BAM == outputFormat_)
+            {
+                bgzfStreams.back().push(bgzf::BgzfCompressor(bamGzipLevel_), 65535, 0);
+            }
+            // else cram containers are encoded from uncompressed bam records once the bin is serialized
             bgzfStreams.back().push(
                 boost::iostreams::back_insert_device<bam::BgzfBuffer >(
                     bgzfBuffers.at(bgzfStreams.size()-1)));
@@ -999,6 +1114,7 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
     //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
             {
                 common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                ISAAC_PERF_SCOPE("build.load");
                 BinLoader binLoader;
                 binLoader.loadData(*binDataPtr);
             }
@@ -1015,6 +1131,7 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
                     {
                         common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(l);
+                        ISAAC_PERF_SCOPE("build.sortDedupe");
                         binSorter_.resolveDuplicates(*binDataPtr, stats_);
                     }
                     --dedupingThreads;
@@ -1038,7 +1155,10 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
                             ISAAC_THREAD_CERR << "Realigning against " << getTotalGapsCount(binDataPtr->realignerGaps_) <<
                                 " unique gaps. " << binDataPtr->bin_ << std::endl;
                         }
-                        gapRealigner_.threadRealignGaps(l, *binDataPtr, nextUnprocessed, tn);
+                        {
+                            ISAAC_PERF_SCOPE("build.realign");
+                            gapRealigner_.threadRealignGaps(l, *binDataPtr, nextUnprocessed, tn);
+                        }
                         if (!--threadsIn)
                         {
                             ISAAC_THREAD_CERR << "Realigning gaps done. " << binDataPtr->bin_ << std::endl;
@@ -1059,9 +1179,17 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
                     {
                         common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(l);
                         // Don't use tn!!! the streams have been allocated for the threadNumber.
-                        binSorter_.serialize(
-                            *binDataPtr, threadBgzfStreams_.at(threadNumber), threadBamIndexParts_.at(threadNumber));
-                        threadBgzfStreams_.at(threadNumber).clear();
+                        {
+                            // bgzf compression happens in the stream as the records are serialized
+                            ISAAC_PERF_SCOPE("build.serializeCompress");
+                            binSorter_.serialize(
+                                *binDataPtr, threadBgzfStreams_.at(threadNumber), threadBamIndexParts_.at(threadNumber));
+                            threadBgzfStreams_.at(threadNumber).clear();
+                        }
+                        if (OUTPUT_CRAM == outputFormat_)
+                        {
+                            encodeCramContainers(threadNumber);
+                        }
                     }
                     --serializingThreads;
             //        ISAAC_THREAD_CERR << "Threads:" << allocatedBins_ << "," << dedupingThreads << "," << realigningThreads << "," << serializingThreads << "," << savingThreads << "," << loadingThreads << std::endl;
@@ -1079,6 +1207,7 @@ void Build::sortBinParallel(alignment::BinMetadataCRefList::iterator &nextUnproc
         waitForSaveSlot(lock, thisThreadBinIt, nextUnsavedBinIt);
         ISAAC_BLOCK_WITH_CLENAUP(boost::bind(&Build::returnSaveSlot, this, boost::ref(nextUnsavedBinIt), thisThreadBinsEndIt, _1))
         {
+            ISAAC_PERF_SCOPE("build.save");
             saveAndReleaseBuffers(lock, thisThreadBinIt->get().getPath(), threadNumber);
         }
         --savingThreads;
@@ -1118,6 +1247,10 @@ void Build::saveAndReleaseBuffers(
             {
                 ISAAC_ASSERT_MSG(bgzfBuffer.empty(), "Unexpected data for bam file belonging to a sample with unmapped reference");
             }
+            else if (OUTPUT_CRAM == outputFormat_)
+            {
+                saveContainers(threadCramContainers_.at(threadNumber).at(index), *stm, cramIndexes_.at(index), filePath);
+            }
             else
             {
                 saveBuffer(bgzfBuffer, *stm, threadBamIndexParts_.at(threadNumber).at(index), bamIndexes_.at(index), filePath);
@@ -1125,6 +1258,10 @@ void Build::saveAndReleaseBuffers(
         }
         // release rest of the memory that was reserved for this bin
         bam::BgzfBuffer().swap(bgzfBuffer);
+        if (OUTPUT_CRAM == outputFormat_)
+        {
+            cram::Containers().swap(threadCramContainers_.at(threadNumber).at(index));
+        }
         ++index;
     }
     --allocatedBins_;
@@ -1150,5 +1287,52 @@ void Build::saveBuffer(
     ISAAC_THREAD_CERR << "Saving " << bgzfBuffer.size() << " bytes of sorted data for bin " << filePath.c_str() << " done in " << (clock() - start) / 1000 << "ms\n";
 }
 
+/**
+ * \brief Converts uncompressed bam records of the bin into cram containers and releases the bam data
+ */
+void Build::encodeCramContainers(const std::size_t threadNumber)
+{
+    ISAAC_PERF_SCOPE("build.cramEncode");
+    unsigned index = 0;
+    BOOST_FOREACH(bam::BgzfBuffer &bgzfBuffer, threadBgzfBuffers_.at(threadNumber))
+    {
+        cram::Containers &containers = threadCramContainers_.at(threadNumber).at(index);
+        ISAAC_ASSERT_MSG(containers.empty(), "Expecting empty containers for output file " << index);
+        if (!bgzfBuffer.empty())
+        {
+            ISAAC_THREAD_CERR << "Encoding " << bgzfBuffer.size() << " bytes of bam data into cram containers" << std::endl;
+            cram::CramEncoder(cramReferences_.at(index), bamGzipLevel_).encode(
+                &bgzfBuffer.front(), &bgzfBuffer.front() + bgzfBuffer.size(), containers);
+            ISAAC_THREAD_CERR << "Encoding " << bgzfBuffer.size() << " bytes of bam data into " << containers.size() << " cram containers done" << std::endl;
+        }
+        bam::BgzfBuffer().swap(bgzfBuffer);
+        ++index;
+    }
+}
+
+void Build::saveContainers(
+    const cram::Containers &containers,
+    std::ostream &cramStream,
+    cram::CramIndex &cramIndex,
+    const boost::filesystem::path &filePath)
+{
+    ISAAC_THREAD_CERR << "Saving " << containers.size() << " cram containers for bin " << filePath.c_str() << std::endl;
+    const clock_t start = clock();
+    cram::Bytes bytes;
+    for (const cram::Container &container : containers)
+    {
+        bytes.clear();
+        const cram::ContainerLayout layout = cram::serializeContainer(bytes, container, cramIndex.getRecordCounter());
+        if (!cramStream.write(&bytes.front(), bytes.size()))
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(
+                errno, (boost::format("Failed to write cram container of %d bytes into cram stream") % bytes.size()).str()));
+        }
+        cramIndex.processContainer(container, layout);
+    }
+
+    ISAAC_THREAD_CERR << "Saving " << containers.size() << " cram containers for bin " << filePath.c_str() << " done in " << (clock() - start) / 1000 << "ms\n";
+}
+
 } // namespace build
 } // namespace isaac
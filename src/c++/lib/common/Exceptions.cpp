@@ -93,10 +93,5 @@ PostConditionException::PostConditionException(const std::string &message)
 {
 }
 
-LibXsltException::LibXsltException()
-    : IsaacException(EINVAL, "libxslt failure")
-{
-}
-
 } // namespace common
 } // namespace isaac
@@ -17,6 +17,11 @@
  ** \author Roman Petrovski
  **/
 
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+
 #include "common/config.h"
 
 #ifdef HAVE_NUMA
@@ -54,10 +59,130 @@ static bool numaAvailable(bool set = false, bool enable = false)
     return available_;
 }
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif //MAP_HUGE_SHIFT
+
+static const std::size_t HUGE_PAGE_2M = std::size_t(1) << 21;
+static const std::size_t HUGE_PAGE_1G = std::size_t(1) << 30;
+
+static HugePages hugePagesMode(bool set = false, HugePages mode = HugePagesOff)
+{
+    static bool set_ = false;
+    static HugePages mode_ = HugePagesOff;
+
+    if (set)
+    {
+        ISAAC_VERIFY_MSG(!set_, "huge pages mode is expected to be set once per lifetime of the process. mode_ = " << mode_);
+        mode_ = mode;
+        set_ = true;
+    }
+
+    return mode_;
+}
+
+/**
+ * \return page size the allocation gets rounded to or 0 if the allocation does not go into huge pages.
+ *         Depends only on size so that deallocation can tell how the memory was obtained.
+ */
+static std::size_t getHugePageSize(const std::size_t size)
+{
+    const HugePages mode = hugePagesMode();
+    if (HugePagesOff == mode || HUGE_PAGE_2M > size)
+    {
+        return 0;
+    }
+    return HugePages1G == mode && HUGE_PAGE_1G <= size ? HUGE_PAGE_1G : HUGE_PAGE_2M;
+}
+
+static std::size_t roundUpToPage(const std::size_t size, const std::size_t pageSize)
+{
+    return (size + pageSize - 1) / pageSize * pageSize;
+}
+
+/**
+ * \brief applies the node policy to a fresh mapping before any of it is touched
+ */
+static void bindToNode(void *p, const std::size_t length, const int node)
+{
+#ifdef HAVE_NUMA
+    if (isNumaAvailable())
+    {
+        if (numa::defaultNodeInterleave == node)
+        {
+            numa_interleave_memory(p, length, numa_all_nodes_ptr);
+        }
+        else if (numa::defaultNodeLocal != node)
+        {
+            numa_tonode_memory(p, length, numa::numaNodes.at(node));
+        }
+        // local memory is placed on first touch by the thread that uses it
+    }
+#endif //HAVE_NUMA
+}
+
+/**
+ * \brief Maps size bytes in explicit huge pages. If none are reserved, falls back to ordinary pages aligned to the
+ *        huge page size and advised for transparent huge pages.
+ */
+static void *hugePagesAllocate(const std::size_t size, const std::size_t pageSize, const int node)
+{
+    const std::size_t length = roundUpToPage(size, pageSize);
+    if (HugePagesTransparent != hugePagesMode())
+    {
+        const int pageSizeFlag = (HUGE_PAGE_1G == pageSize ? 30 : 21) << MAP_HUGE_SHIFT;
+        void *ret = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | pageSizeFlag, -1, 0);
+        if (MAP_FAILED != ret)
+        {
+            bindToNode(ret, length, node);
+            ISAAC_THREAD_CERR << "hugePagesAllocate mapped " << length << " bytes on node " << node << " in " <<
+                (pageSize >> 20) << "MB pages" << std::endl;
+            return ret;
+        }
+        ISAAC_THREAD_CERR << "WARNING: hugePagesAllocate could not map " << length << " bytes in " <<
+            (pageSize >> 20) << "MB pages, errno: " << errno << ":" << strerror(errno) <<
+            ". Falling back to transparent huge pages" << std::endl;
+    }
+
+    // transparent huge pages only form in 2MB-aligned ranges. Map extra and trim the ends
+    char *mapped = static_cast<char *>(mmap(0, length + HUGE_PAGE_2M, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (MAP_FAILED == mapped)
+    {
+        return 0;
+    }
+    char *ret = mapped + (HUGE_PAGE_2M - reinterpret_cast<uintptr_t>(mapped) % HUGE_PAGE_2M) % HUGE_PAGE_2M;
+    if (mapped != ret)
+    {
+        munmap(mapped, ret - mapped);
+    }
+    const std::size_t tail = mapped + length + HUGE_PAGE_2M - (ret + length);
+    if (tail)
+    {
+        munmap(ret + length, tail);
+    }
+    bindToNode(ret, length, node);
+#ifdef MADV_HUGEPAGE
+    if (!madvise(ret, length, MADV_HUGEPAGE))
+    {
+        ISAAC_THREAD_CERR << "hugePagesAllocate mapped " << length << " bytes on node " << node <<
+            " advised for transparent huge pages" << std::endl;
+        return ret;
+    }
+#endif //MADV_HUGEPAGE
+    ISAAC_THREAD_CERR << "WARNING: hugePagesAllocate mapped " << length << " bytes on node " << node <<
+        " in regular pages, errno: " << errno << ":" << strerror(errno) << std::endl;
+    return ret;
+}
+
 // NB: __n is permitted to be 0.  The C++ standard says nothing
 // about what the return value is when __n == 0.
 void* numaAllocate(std::size_t size, const int node)
 {
+    if (const std::size_t pageSize = getHugePageSize(size))
+    {
+        return hugePagesAllocate(size, pageSize, node);
+    }
+
 
     if (!isNumaAvailable())
     {
@@ -89,6 +214,12 @@ void* numaAllocate(std::size_t size, const int node)
 // __p is not permitted to be a null pointer.
 void numaDeallocate(void * p, std::size_t size, const int node)
 {
+    if (const std::size_t pageSize = getHugePageSize(size))
+    {
+        munmap(p, roundUpToPage(size, pageSize));
+        return;
+    }
+
     if (!isNumaAvailable())
     {
         ::operator delete(p);
@@ -109,6 +240,11 @@ void numaDeallocate(void * p, std::size_t size, const int node)
 } // namespace numa
 
 
+void hugePagesInitialize(const HugePages hugePages)
+{
+    numa::hugePagesMode(true, hugePages);
+}
+
 bool isNumaAvailable()
 {
     return numa::numaAvailable();
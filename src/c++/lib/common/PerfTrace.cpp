@@ -0,0 +1,339 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file PerfTrace.cpp
+ **
+ ** Per-stage begin/end event recording for performance analysis.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+#include <boost/array.hpp>
+#include <boost/format.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+#include "common/PerfTrace.hh"
+#include "common/SystemCompatibility.hh"
+
+namespace isaac
+{
+namespace common
+{
+namespace perf
+{
+
+namespace
+{
+
+struct Event
+{
+    const char *stage_;
+    uint64_t begin_;
+    uint64_t end_;
+};
+
+struct Aggregate
+{
+    const char *stage_;
+    uint64_t count_;
+    uint64_t totalNs_;
+    uint64_t maxNs_;
+    // earliest begin and latest end across all calls. Gives the wall time of the stage even when run by many threads
+    uint64_t firstBegin_;
+    uint64_t lastEnd_;
+};
+
+/**
+ * \brief Ring buffer of events of one thread. Never accessed concurrently: it is owned by one thread between
+ *        attachThread and detachThread and only read by dump when no traced threads run.
+ */
+class ThreadTrace
+{
+    // distinct stage literals seen by one thread. Beyond that, stages are still traced but not aggregated
+    static const std::size_t AGGREGATES_MAX = 128;
+
+    const unsigned id_;
+    std::vector<Event> events_;
+    uint64_t recorded_;
+    boost::array<Aggregate, AGGREGATES_MAX> aggregates_;
+    std::size_t aggregatesCount_;
+
+public:
+    ThreadTrace(const unsigned id, const std::size_t capacity) :
+        id_(id), events_(capacity), recorded_(0), aggregatesCount_(0)
+    {
+    }
+
+    void record(const char *stage, const uint64_t begin, const uint64_t end)
+    {
+        if (!events_.empty())
+        {
+            const Event event = {stage, begin, end};
+            events_[recorded_ % events_.size()] = event;
+        }
+        ++recorded_;
+
+        // stages are string literals, pointer comparison is good enough to find them among the few recorded
+        Aggregate *aggregate = aggregates_.begin();
+        while (aggregates_.begin() + aggregatesCount_ != aggregate && stage != aggregate->stage_)
+        {
+            ++aggregate;
+        }
+        if (aggregates_.begin() + aggregatesCount_ == aggregate)
+        {
+            if (AGGREGATES_MAX == aggregatesCount_)
+            {
+                return;
+            }
+            const Aggregate empty = {stage, 0, 0, 0, begin, end};
+            *aggregate = empty;
+            ++aggregatesCount_;
+        }
+        const uint64_t duration = end - begin;
+        ++aggregate->count_;
+        aggregate->totalNs_ += duration;
+        aggregate->maxNs_ = std::max(aggregate->maxNs_, duration);
+        aggregate->firstBegin_ = std::min(aggregate->firstBegin_, begin);
+        aggregate->lastEnd_ = std::max(aggregate->lastEnd_, end);
+    }
+
+    unsigned getId() const {return id_;}
+    uint64_t getDropped() const {return recorded_ - getEventsCount();}
+    std::size_t getEventsCount() const {return std::min<uint64_t>(recorded_, events_.size());}
+    /// oldest event first
+    const Event &getEvent(const std::size_t i) const
+    {
+        return events_.size() < recorded_ ? events_[(recorded_ + i) % events_.size()] : events_[i];
+    }
+
+    const Aggregate *aggregatesBegin() const {return aggregates_.begin();}
+    const Aggregate *aggregatesEnd() const {return aggregates_.begin() + aggregatesCount_;}
+};
+
+std::atomic<bool> enabled_(false);
+// bumped by disable so that the threads can tell their threadTrace_ points to a freed buffer
+std::atomic<unsigned> generation_(0);
+std::size_t eventsPerThread_ = 0;
+uint64_t enabledTime_ = 0;
+boost::mutex mutex_;
+boost::ptr_vector<ThreadTrace> traces_;
+// traces released by the terminated threads. Has the capacity to hold all traces_ so that detachThread does not
+// allocate
+std::vector<ThreadTrace *> released_;
+
+iSAAC_THREAD_LOCAL ThreadTrace *threadTrace_ = 0;
+iSAAC_THREAD_LOCAL unsigned threadGeneration_ = 0;
+
+/**
+ * \return buffer of the calling thread or 0 if it has none or the one it had is gone with disable
+ */
+ThreadTrace *getThreadTrace()
+{
+    if (threadTrace_ && generation_ != threadGeneration_)
+    {
+        threadTrace_ = 0;
+    }
+    return threadTrace_;
+}
+
+} // namespace
+
+void enable(const std::size_t eventsPerThread)
+{
+    eventsPerThread_ = eventsPerThread;
+    enabledTime_ = now();
+    enabled_ = true;
+    attachThread();
+}
+
+void disable()
+{
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    enabled_ = false;
+    ++generation_;
+    threadTrace_ = 0;
+    released_.clear();
+    traces_.clear();
+}
+
+bool enabled()
+{
+    return enabled_;
+}
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void attachThread()
+{
+    if (!enabled_ || getThreadTrace())
+    {
+        return;
+    }
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if (!enabled_)
+    {
+        return;
+    }
+    threadGeneration_ = generation_;
+    if (released_.empty())
+    {
+        traces_.push_back(new ThreadTrace(traces_.size(), eventsPerThread_));
+        released_.reserve(traces_.size());
+        threadTrace_ = &traces_.back();
+    }
+    else
+    {
+        threadTrace_ = released_.back();
+        released_.pop_back();
+    }
+}
+
+void detachThread()
+{
+    if (getThreadTrace())
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if (generation_ == threadGeneration_)
+        {
+            released_.push_back(threadTrace_);
+        }
+        threadTrace_ = 0;
+    }
+}
+
+void record(const char *stage, const uint64_t beginNs, const uint64_t endNs)
+{
+    if (!getThreadTrace())
+    {
+        // threads not created by ThreadVector get their buffer on first use
+        attachThread();
+        if (!threadTrace_)
+        {
+            // tracing got disabled while the event was in progress
+            return;
+        }
+    }
+    threadTrace_->record(stage, beginNs, endNs);
+}
+
+static void openOutput(const boost::filesystem::path &path, std::ofstream &os)
+{
+    os.open(path.c_str());
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open perf trace file " + path.string()));
+    }
+}
+
+static void dumpChromeTrace(const boost::filesystem::path &path)
+{
+    std::ofstream os;
+    openOutput(path, os);
+
+    uint64_t dropped = 0;
+    os << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const ThreadTrace &trace : traces_)
+    {
+        dropped += trace.getDropped();
+        os << (first ? "" : ",\n") <<
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace.getId() <<
+            ",\"args\":{\"name\":\"thread " << trace.getId() << "\"}}";
+        first = false;
+        for (std::size_t i = 0; i < trace.getEventsCount(); ++i)
+        {
+            const Event &event = trace.getEvent(i);
+            os << ",\n{\"name\":\"" << event.stage_ << "\",\"cat\":\"isaac\",\"ph\":\"X\",\"pid\":1,\"tid\":" <<
+                trace.getId() <<
+                ",\"ts\":" << boost::format("%.3f") % ((event.begin_ - enabledTime_) / 1000.0) <<
+                ",\"dur\":" << boost::format("%.3f") % ((event.end_ - event.begin_) / 1000.0) << "}";
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped << "}}\n";
+
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write perf trace file " + path.string()));
+    }
+    if (dropped)
+    {
+        ISAAC_THREAD_CERR << "WARNING: " << dropped << " oldest events were not stored in " << path <<
+            ". Increase the trace buffer size to keep them" << std::endl;
+    }
+}
+
+static void dumpStages(const boost::filesystem::path &path)
+{
+    // same stage literal can have different addresses in different translation units
+    std::map<std::string, Aggregate> stages;
+    std::map<std::string, unsigned> stageThreads;
+    for (const ThreadTrace &trace : traces_)
+    {
+        for (const Aggregate *aggregate = trace.aggregatesBegin(); trace.aggregatesEnd() != aggregate; ++aggregate)
+        {
+            const Aggregate empty = {aggregate->stage_, 0, 0, 0, aggregate->firstBegin_, aggregate->lastEnd_};
+            Aggregate &stage = stages.insert(std::make_pair(std::string(aggregate->stage_), empty)).first->second;
+            stage.count_ += aggregate->count_;
+            stage.totalNs_ += aggregate->totalNs_;
+            stage.maxNs_ = std::max(stage.maxNs_, aggregate->maxNs_);
+            stage.firstBegin_ = std::min(stage.firstBegin_, aggregate->firstBegin_);
+            stage.lastEnd_ = std::max(stage.lastEnd_, aggregate->lastEnd_);
+            ++stageThreads[aggregate->stage_];
+        }
+    }
+
+    std::ofstream os;
+    openOutput(path, os);
+    os << "#stage\tcount\tthreads\ttotal_ms\tmean_ms\tmax_ms\twall_ms\n";
+    for (const std::map<std::string, Aggregate>::value_type &stage : stages)
+    {
+        os << stage.first << '\t' << stage.second.count_ << '\t' << stageThreads[stage.first] << '\t' <<
+            boost::format("%.3f\t%.3f\t%.3f\t%.3f") %
+                (stage.second.totalNs_ / 1e6) %
+                (stage.second.totalNs_ / 1e6 / stage.second.count_) %
+                (stage.second.maxNs_ / 1e6) %
+                ((stage.second.lastEnd_ - stage.second.firstBegin_) / 1e6) << '\n';
+    }
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write perf stages file " + path.string()));
+    }
+}
+
+void dump(const boost::filesystem::path &directory)
+{
+    if (!enabled_)
+    {
+        return;
+    }
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    dumpChromeTrace(directory / "PerfTrace.json");
+    dumpStages(directory / "PerfStages.tsv");
+    ISAAC_THREAD_CERR << "Perf trace stored in " << directory / "PerfTrace.json" << std::endl;
+}
+
+} // namespace perf
+} // namespace common
+} // namespace isaac
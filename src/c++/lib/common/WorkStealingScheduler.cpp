@@ -0,0 +1,176 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file WorkStealingScheduler.cpp
+ **
+ ** \brief Hands out chunks of an index range to a fixed set of threads.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+#include <chrono>
+
+#include <boost/thread/locks.hpp>
+
+#include "common/Debug.hh"
+#include "common/WorkStealingScheduler.hh"
+
+namespace isaac
+{
+namespace common
+{
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WorkStealingScheduler::WorkStealingScheduler(
+    const unsigned threads,
+    const unsigned chunkMin,
+    const unsigned chunkMax,
+    const double chunkSeconds) :
+    chunkMin_(std::max(1U, chunkMin)),
+    chunkMax_(std::max(chunkMin_, chunkMax)),
+    chunkSeconds_(chunkSeconds),
+    ordered_(false),
+    threads_(threads),
+    steals_(0)
+{
+    ISAAC_ASSERT_MSG(threads, "At least one thread is required");
+    for (ThreadRange &thread : threads_)
+    {
+        thread.chunk_ = chunkMin_;
+    }
+}
+
+void WorkStealingScheduler::reset(const uint64_t items, const bool ordered)
+{
+    ordered_ = ordered;
+    const uint64_t parts = ordered_ ? 1 : threads_.size();
+    uint64_t begin = 0;
+    for (std::size_t i = 0; threads_.size() != i; ++i)
+    {
+        ThreadRange &thread = threads_[i];
+        // spread the remainder over the first threads
+        const uint64_t length = i < parts ? items / parts + (i < items % parts) : 0;
+        thread.begin_ = begin;
+        thread.end_ = begin + length;
+        thread.remaining_ = length;
+        thread.claimedNs_ = 0;
+        begin += length;
+    }
+    steals_ = 0;
+}
+
+void WorkStealingScheduler::adaptChunk(ThreadRange &thread)
+{
+    const uint64_t now = nowNs();
+    if (thread.claimedNs_ && thread.claimedItems_)
+    {
+        const double seconds = double(now - thread.claimedNs_) / 1e9;
+        const double target = seconds > 0.0 ? chunkSeconds_ * thread.claimedItems_ / seconds : chunkMax_;
+        // grow gradually as a cheap chunk is often followed by an expensive one, shrink at once
+        thread.chunk_ = std::max<double>(chunkMin_, std::min<double>(std::min<double>(chunkMax_, thread.chunk_ * 2.0), target));
+    }
+    thread.claimedNs_ = now;
+}
+
+bool WorkStealingScheduler::claim(ThreadRange &range, const unsigned chunk, uint64_t &begin, uint64_t &end)
+{
+    boost::lock_guard<boost::mutex> lock(range.mutex_);
+    if (range.begin_ == range.end_)
+    {
+        return false;
+    }
+    begin = range.begin_;
+    end = std::min<uint64_t>(range.end_, begin + chunk);
+    range.begin_ = end;
+    range.remaining_ = range.end_ - range.begin_;
+    return true;
+}
+
+bool WorkStealingScheduler::steal(const unsigned threadNumber, uint64_t &begin, uint64_t &end)
+{
+    ThreadRange &thief = threads_[threadNumber];
+    while (true)
+    {
+        ThreadRange *victim = 0;
+        uint64_t victimRemaining = 0;
+        for (std::size_t i = 1; threads_.size() != i; ++i)
+        {
+            ThreadRange &candidate = threads_[(threadNumber + i) % threads_.size()];
+            const uint64_t remaining = candidate.remaining_.load(std::memory_order_relaxed);
+            if (remaining > victimRemaining)
+            {
+                victim = &candidate;
+                victimRemaining = remaining;
+            }
+        }
+
+        if (!victim)
+        {
+            return false;
+        }
+
+        uint64_t stolenBegin = 0;
+        uint64_t stolenEnd = 0;
+        {
+            boost::lock_guard<boost::mutex> lock(victim->mutex_);
+            const uint64_t remaining = victim->end_ - victim->begin_;
+            if (!remaining)
+            {
+                // someone got there first. Look again
+                continue;
+            }
+            // not worth splitting what the thief would take in one chunk anyway
+            const uint64_t take = remaining <= thief.chunk_ ? remaining : remaining - remaining / 2;
+            stolenEnd = victim->end_;
+            stolenBegin = stolenEnd - take;
+            victim->end_ = stolenBegin;
+            victim->remaining_ = victim->end_ - victim->begin_;
+        }
+        ++steals_;
+
+        {
+            boost::lock_guard<boost::mutex> lock(thief.mutex_);
+            thief.begin_ = stolenBegin;
+            thief.end_ = stolenEnd;
+            thief.remaining_ = stolenEnd - stolenBegin;
+        }
+        if (claim(thief, thief.chunk_, begin, end))
+        {
+            return true;
+        }
+        // someone stole it all from us in between. Unlikely but possible
+    }
+}
+
+bool WorkStealingScheduler::next(const unsigned threadNumber, uint64_t &begin, uint64_t &end)
+{
+    ThreadRange &thread = threads_.at(threadNumber);
+    adaptChunk(thread);
+
+    const bool ret = ordered_ ?
+        claim(threads_.front(), thread.chunk_, begin, end) :
+        (claim(thread, thread.chunk_, begin, end) || steal(threadNumber, begin, end));
+
+    // the next call does not measure the time the thread spends elsewhere after running out of work
+    thread.claimedItems_ = ret ? end - begin : 0;
+    thread.claimedNs_ = ret ? thread.claimedNs_ : 0;
+    return ret;
+}
+
+} // namespace common
+} // namespace isaac
@@ -0,0 +1,124 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/thread.hpp>
+
+#include "RegistryName.hh"
+#include "testPerfTrace.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestPerfTrace, registryName("PerfTrace"));
+
+void TestPerfTrace::setUp()
+{
+}
+
+void TestPerfTrace::tearDown()
+{
+    // don't let tracing leak into the suites that run after this one
+    isaac::common::perf::disable();
+}
+
+static std::string readFile(const boost::filesystem::path &path)
+{
+    std::ifstream is(path.c_str());
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return ss.str();
+}
+
+void TestPerfTrace::testDump()
+{
+    using namespace isaac::common;
+    const boost::filesystem::path directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+
+    // two events per thread. The oldest one of the three below gets dropped from the trace but not from the stages
+    perf::enable(2);
+    CPPUNIT_ASSERT(perf::enabled());
+    perf::record("test.stage", 1000, 2000);
+    perf::record("test.stage", 3000, 7000);
+    {
+        ISAAC_PERF_SCOPE("test.other");
+    }
+    perf::record("test.stage", 8000, 9000);
+    perf::dump(directory);
+
+    const std::string trace = readFile(directory / "PerfTrace.json");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), trace.find("{\"traceEvents\":["));
+    CPPUNIT_ASSERT(std::string::npos != trace.find("\"droppedEvents\":2"));
+    CPPUNIT_ASSERT(std::string::npos != trace.find("\"name\":\"test.other\""));
+    CPPUNIT_ASSERT(std::string::npos != trace.find("\"name\":\"test.stage\""));
+
+    const std::string stages = readFile(directory / "PerfStages.tsv");
+    CPPUNIT_ASSERT(std::string::npos != stages.find("test.other\t1\t1\t"));
+    CPPUNIT_ASSERT(std::string::npos != stages.find("test.stage\t3\t1\t0.006\t0.002\t0.004\t0.008\n"));
+
+    boost::filesystem::remove_all(directory);
+}
+
+void TestPerfTrace::testDisable()
+{
+    using namespace isaac::common;
+    const boost::filesystem::path directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+
+    perf::enable(2);
+    perf::record("test.stage", 1000, 2000);
+    perf::disable();
+    CPPUNIT_ASSERT(!perf::enabled());
+    {
+        ISAAC_PERF_SCOPE("test.other");
+    }
+    perf::dump(directory);
+    CPPUNIT_ASSERT(!boost::filesystem::exists(directory / "PerfTrace.json"));
+
+    boost::filesystem::remove_all(directory);
+}
+
+void TestPerfTrace::testDisableAttachedThread()
+{
+    using namespace isaac::common;
+    const boost::filesystem::path directory =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory);
+
+    perf::enable(4);
+    boost::barrier barrier(2);
+    boost::thread thread([&barrier]()
+    {
+        perf::record("test.before", 1000, 2000);
+        barrier.wait();
+        barrier.wait();
+        // the buffer the thread had is gone. It must get a new one instead of writing into the freed memory
+        perf::record("test.after", 3000, 4000);
+        perf::detachThread();
+    });
+    barrier.wait();
+    perf::disable();
+    perf::enable(4);
+    barrier.wait();
+    thread.join();
+
+    perf::dump(directory);
+    const std::string trace = readFile(directory / "PerfTrace.json");
+    CPPUNIT_ASSERT(std::string::npos == trace.find("\"name\":\"test.before\""));
+    CPPUNIT_ASSERT(std::string::npos != trace.find("\"name\":\"test.after\""));
+
+    boost::filesystem::remove_all(directory);
+}
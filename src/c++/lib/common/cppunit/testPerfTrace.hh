@@ -0,0 +1,35 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_COMMON_TEST_PERF_TRACE_HH
+#define iSAAC_COMMON_TEST_PERF_TRACE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "common/PerfTrace.hh"
+
+class TestPerfTrace : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestPerfTrace );
+    CPPUNIT_TEST( testDump );
+    CPPUNIT_TEST( testDisable );
+    CPPUNIT_TEST( testDisableAttachedThread );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void tearDown();
+    void testDump();
+    void testDisable();
+    void testDisableAttachedThread();
+};
+
+#endif // #ifndef iSAAC_COMMON_TEST_PERF_TRACE_HH
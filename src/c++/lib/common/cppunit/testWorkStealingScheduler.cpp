@@ -0,0 +1,108 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "RegistryName.hh"
+#include "testWorkStealingScheduler.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestWorkStealingScheduler, registryName("WorkStealingScheduler"));
+
+void TestWorkStealingScheduler::setUp()
+{
+}
+
+void TestWorkStealingScheduler::tearDown()
+{
+}
+
+void TestWorkStealingScheduler::testSteal()
+{
+    using isaac::common::WorkStealingScheduler;
+    // chunk time is large enough for the chunk size to stay at minimum
+    WorkStealingScheduler scheduler(2, 10, 10, 1000.0);
+    scheduler.reset(100, false);
+
+    uint64_t begin = 0, end = 0;
+    // thread 0 owns [0, 50), thread 1 owns [50, 100)
+    CPPUNIT_ASSERT(scheduler.next(1, begin, end));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(50), begin);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(60), end);
+
+    std::vector<unsigned> handedOut(100, 0);
+    std::fill(handedOut.begin() + begin, handedOut.begin() + end, 1);
+    // thread 0 takes its own and then the back half of what is left of thread 1
+    while (scheduler.next(0, begin, end))
+    {
+        for (uint64_t i = begin; end != i; ++i)
+        {
+            ++handedOut[i];
+        }
+    }
+    CPPUNIT_ASSERT(scheduler.getSteals());
+    CPPUNIT_ASSERT(!scheduler.next(1, begin, end));
+    CPPUNIT_ASSERT(std::vector<unsigned>(100, 1) == handedOut);
+}
+
+void TestWorkStealingScheduler::testOrdered()
+{
+    using isaac::common::WorkStealingScheduler;
+    WorkStealingScheduler scheduler(3, 7, 7, 1000.0);
+    scheduler.reset(30, true);
+
+    uint64_t expectedBegin = 0;
+    uint64_t begin = 0, end = 0;
+    for (unsigned thread = 0; scheduler.next(thread, begin, end); thread = (thread + 1) % 3)
+    {
+        CPPUNIT_ASSERT_EQUAL(expectedBegin, begin);
+        CPPUNIT_ASSERT_EQUAL(std::min<uint64_t>(30, begin + 7), end);
+        expectedBegin = end;
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(30), expectedBegin);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), scheduler.getSteals());
+}
+
+void TestWorkStealingScheduler::testThreads()
+{
+    using isaac::common::WorkStealingScheduler;
+    static const unsigned THREADS = 4;
+    static const uint64_t ITEMS = 100000;
+    WorkStealingScheduler scheduler(THREADS, 1, 1000, 0.0001);
+    std::vector<unsigned> handedOut(ITEMS, 0);
+
+    for (unsigned pass = 0; 3 != pass; ++pass)
+    {
+        scheduler.reset(ITEMS, false);
+        boost::thread_group threads;
+        for (unsigned thread = 0; THREADS != thread; ++thread)
+        {
+            threads.create_thread([&scheduler, &handedOut, thread]()
+            {
+                uint64_t begin = 0, end = 0;
+                while (scheduler.next(thread, begin, end))
+                {
+                    for (uint64_t i = begin; end != i; ++i)
+                    {
+                        // ranges never overlap, so no synchronization is needed
+                        ++handedOut[i];
+                    }
+                }
+            });
+        }
+        threads.join_all();
+    }
+
+    CPPUNIT_ASSERT(std::vector<unsigned>(ITEMS, 3) == handedOut);
+}
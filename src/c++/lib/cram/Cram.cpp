@@ -0,0 +1,269 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file Cram.cpp
+ **
+ ** CRAM 3.0 file structure primitives: integer encodings, blocks and containers.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <zlib.h>
+
+#include <boost/format.hpp>
+
+#include "cram/Cram.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+void appendItf8(Bytes &bytes, const int value)
+{
+    const unsigned u = value;
+    if (!(u & ~0x7FU))
+    {
+        bytes.push_back(u);
+    }
+    else if (!(u & ~0x3FFFU))
+    {
+        bytes.push_back(0x80 | (u >> 8));
+        bytes.push_back(u);
+    }
+    else if (!(u & ~0x1FFFFFU))
+    {
+        bytes.push_back(0xC0 | (u >> 16));
+        bytes.push_back(u >> 8);
+        bytes.push_back(u);
+    }
+    else if (!(u & ~0x0FFFFFFFU))
+    {
+        bytes.push_back(0xE0 | (u >> 24));
+        bytes.push_back(u >> 16);
+        bytes.push_back(u >> 8);
+        bytes.push_back(u);
+    }
+    else
+    {
+        bytes.push_back(0xF0 | ((u >> 28) & 0x0F));
+        bytes.push_back(u >> 20);
+        bytes.push_back(u >> 12);
+        bytes.push_back(u >> 4);
+        bytes.push_back(u & 0x0F);
+    }
+}
+
+void appendLtf8(Bytes &bytes, const int64_t value)
+{
+    const uint64_t u = value;
+    // number of bytes following the first one
+    unsigned extra = 0;
+    while (extra < 8 && (u >> (7 * (extra + 1))))
+    {
+        ++extra;
+    }
+
+    if (8 == extra)
+    {
+        bytes.push_back(0xFF);
+    }
+    else
+    {
+        // extra leading 1 bits followed by 0 and the top bits of the value
+        const unsigned char marker = 0xFF << (8 - extra);
+        bytes.push_back(marker | (u >> (8 * extra)));
+    }
+    for (int shift = 8 * (extra - 1); shift >= 0; shift -= 8)
+    {
+        bytes.push_back(u >> shift);
+    }
+}
+
+void appendItf8Array(Bytes &bytes, const std::vector<int> &values)
+{
+    appendItf8(bytes, values.size());
+    for (const int value : values)
+    {
+        appendItf8(bytes, value);
+    }
+}
+
+static void appendCrc32(Bytes &bytes, const std::size_t from)
+{
+    const uLong crc = crc32(crc32(0L, Z_NULL, 0),
+                            reinterpret_cast<const Bytef*>(&bytes.front() + from), bytes.size() - from);
+    appendInt32(bytes, crc);
+}
+
+/**
+ * \return false if compressed data is not smaller than the original
+ */
+static bool gzipCompress(const Bytes &data, const int gzipLevel, Bytes &compressed)
+{
+    z_stream strm = z_stream();
+    // 31 produces gzip wrapper which is what CRAM readers expect for method 1
+    if (Z_OK != deflateInit2(&strm, gzipLevel, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(EINVAL, "deflateInit2 failed"));
+    }
+
+    compressed.resize(deflateBound(&strm, data.size()));
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(&data.front()));
+    strm.avail_in = data.size();
+    strm.next_out = reinterpret_cast<Bytef*>(&compressed.front());
+    strm.avail_out = compressed.size();
+    const int ret = deflate(&strm, Z_FINISH);
+    deflateEnd(&strm);
+    if (Z_STREAM_END != ret)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(
+            EINVAL, (boost::format("deflate failed with %d for %d bytes") % ret % data.size()).str()));
+    }
+    compressed.resize(strm.total_out);
+    return compressed.size() < data.size();
+}
+
+void appendBlock(
+    Bytes &bytes,
+    BlockMethod method,
+    const BlockContentType contentType,
+    const int contentId,
+    const Bytes &data,
+    const int gzipLevel)
+{
+    const std::size_t blockBegin = bytes.size();
+    Bytes compressed;
+    if (GZIP == method && (data.empty() || !gzipCompress(data, gzipLevel, compressed)))
+    {
+        method = RAW;
+    }
+    const Bytes &payload = RAW == method ? data : compressed;
+
+    appendByte(bytes, method);
+    appendByte(bytes, contentType);
+    appendItf8(bytes, contentId);
+    appendItf8(bytes, payload.size());
+    appendItf8(bytes, data.size());
+    appendBytes(bytes, payload);
+    appendCrc32(bytes, blockBegin);
+}
+
+static void appendContainerHeader(
+    Bytes &bytes,
+    const int length,
+    const int refId,
+    const int start,
+    const int span,
+    const int records,
+    const int64_t recordCounter,
+    const int64_t bases,
+    const int blocks,
+    const std::vector<int> &landmarks)
+{
+    const std::size_t headerBegin = bytes.size();
+    appendInt32(bytes, length);
+    appendItf8(bytes, refId);
+    appendItf8(bytes, start);
+    appendItf8(bytes, span);
+    appendItf8(bytes, records);
+    appendLtf8(bytes, recordCounter);
+    appendLtf8(bytes, bases);
+    appendItf8(bytes, blocks);
+    appendItf8Array(bytes, landmarks);
+    appendCrc32(bytes, headerBegin);
+}
+
+ContainerLayout serializeContainer(
+    Bytes &bytes,
+    const Container &container,
+    const int64_t recordCounter)
+{
+    Bytes sliceHeader;
+    appendItf8(sliceHeader, container.refId_);
+    appendItf8(sliceHeader, container.start_);
+    appendItf8(sliceHeader, container.span_);
+    appendItf8(sliceHeader, container.records_);
+    appendLtf8(sliceHeader, recordCounter);
+    appendItf8(sliceHeader, container.dataBlocksCount_);
+    appendItf8Array(sliceHeader, container.contentIds_);
+    // no embedded reference
+    appendItf8(sliceHeader, -1);
+    appendBytes(sliceHeader, reinterpret_cast<const char*>(container.refMd5_.begin()),
+                reinterpret_cast<const char*>(container.refMd5_.end()));
+
+    Bytes blocks;
+    blocks.reserve(container.compressionHeaderBlock_.size() + sliceHeader.size() + container.dataBlocks_.size() + 64);
+    appendBytes(blocks, container.compressionHeaderBlock_);
+    ContainerLayout ret;
+    ret.landmark_ = blocks.size();
+    appendBlock(blocks, RAW, MAPPED_SLICE, 0, sliceHeader, 0);
+    appendBytes(blocks, container.dataBlocks_);
+    ret.sliceSize_ = blocks.size() - ret.landmark_;
+
+    const std::size_t containerBegin = bytes.size();
+    appendContainerHeader(
+        bytes, blocks.size(), container.refId_, container.start_, container.span_, container.records_,
+        recordCounter, container.bases_,
+        // compression header + slice header + data blocks
+        2 + container.dataBlocksCount_,
+        std::vector<int>(1, ret.landmark_));
+    appendBytes(bytes, blocks);
+    ret.size_ = bytes.size() - containerBegin;
+    return ret;
+}
+
+static void write(std::ostream &os, const Bytes &bytes)
+{
+    if (!os.write(&bytes.front(), bytes.size()))
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(
+            errno, (boost::format("Failed to write %d bytes into cram stream") % bytes.size()).str()));
+    }
+}
+
+uint64_t serializeHeader(std::ostream &os, const std::string &fileId, const std::string &headerText)
+{
+    Bytes bytes;
+    appendBytes(bytes, "CRAM", "CRAM" + 4);
+    appendByte(bytes, 3);
+    appendByte(bytes, 0);
+    std::string paddedFileId(fileId.substr(0, 20));
+    paddedFileId.resize(20, '\0');
+    appendBytes(bytes, &*paddedFileId.begin(), &*paddedFileId.begin() + paddedFileId.size());
+
+    Bytes headerData;
+    appendInt32(headerData, headerText.size());
+    appendBytes(headerData, &*headerText.begin(), &*headerText.begin() + headerText.size());
+    Bytes block;
+    appendBlock(block, RAW, FILE_HEADER, 0, headerData, 0);
+
+    appendContainerHeader(bytes, block.size(), 0, 0, 0, 0, 0, 0, 1, std::vector<int>(1, 0));
+    appendBytes(bytes, block);
+
+    write(os, bytes);
+    return bytes.size();
+}
+
+void serializeEof(std::ostream &os)
+{
+    static const unsigned char CRAM3_EOF[] =
+    {
+        0x0f, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x0f, 0xe0, 0x45, 0x4f, 0x46, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x00, 0x05, 0xbd, 0xd9, 0x4f, 0x00, 0x01, 0x00, 0x06, 0x06, 0x01, 0x00, 0x01, 0x00,
+        0x01, 0x00, 0xee, 0x63, 0x01, 0x4b
+    };
+    write(os, Bytes(CRAM3_EOF, CRAM3_EOF + sizeof(CRAM3_EOF)));
+}
+
+} // namespace cram
+} // namespace isaac
@@ -0,0 +1,477 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file CramEncoder.cpp
+ **
+ ** Converts serialized bam records into CRAM 3.0 containers.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cstring>
+
+#include "common/MD5Sum.hh"
+#include "cram/CramEncoder.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+namespace bamRecord
+{
+
+template <typename T>
+inline T get(const char *p)
+{
+    T ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+// offsets of the fields relative to the end of block_size
+inline int refId(const char *r) {return get<int>(r);}
+inline int pos(const char *r) {return get<int>(r + 4);}
+inline unsigned readNameLength(const char *r) {return static_cast<unsigned char>(r[8]);}
+inline unsigned mapq(const char *r) {return static_cast<unsigned char>(r[9]);}
+inline unsigned cigarOps(const char *r) {return get<unsigned short>(r + 12);}
+inline unsigned flag(const char *r) {return get<unsigned short>(r + 14);}
+inline int seqLength(const char *r) {return get<int>(r + 16);}
+inline int nextRefId(const char *r) {return get<int>(r + 20);}
+inline int nextPos(const char *r) {return get<int>(r + 24);}
+inline int tlen(const char *r) {return get<int>(r + 28);}
+inline const char *readName(const char *r) {return r + 32;}
+inline const char *cigar(const char *r) {return readName(r) + readNameLength(r);}
+inline const unsigned char *seq(const char *r) {return reinterpret_cast<const unsigned char*>(cigar(r) + cigarOps(r) * 4);}
+inline const char *qual(const char *r) {return reinterpret_cast<const char*>(seq(r)) + (seqLength(r) + 1) / 2;}
+inline const char *tags(const char *r) {return qual(r) + seqLength(r);}
+
+inline char base(const unsigned char *seq, const int i)
+{
+    static const char BAM_BASES[] = "=ACMGRSVTWYHKDBN";
+    return BAM_BASES[(seq[i / 2] >> (i % 2 ? 0 : 4)) & 0xF];
+}
+
+/**
+ * \return number of reference bases covered by the cigar
+ */
+inline int referenceLength(const char *r)
+{
+    int ret = 0;
+    for (unsigned i = 0; cigarOps(r) > i; ++i)
+    {
+        const unsigned op = get<unsigned>(cigar(r) + i * 4);
+        switch (op & 0xF)
+        {
+        case 0: case 2: case 3: case 7: case 8:
+            ret += op >> 4;
+            break;
+        default:
+            break;
+        }
+    }
+    return ret;
+}
+
+inline std::size_t tagValueSize(const char type, const char *value)
+{
+    switch (type)
+    {
+    case 'A': case 'c': case 'C':
+        return 1;
+    case 's': case 'S':
+        return 2;
+    case 'i': case 'I': case 'f':
+        return 4;
+    case 'Z': case 'H':
+        return strlen(value) + 1;
+    case 'B':
+        return 1 + 4 + get<int>(value + 1) * tagValueSize(value[0], 0);
+    default:
+        ISAAC_ASSERT_MSG(false, "Unexpected bam tag type " << type);
+        return 0;
+    }
+}
+
+} // namespace bamRecord
+
+/**
+ * \return index of the base in ACGTN or -1
+ */
+inline int substitutionIndex(const char base)
+{
+    switch (base)
+    {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    case 'N': return 4;
+    default: return -1;
+    }
+}
+
+CramEncoder::CramEncoder(const ReferenceSequences &references, const int gzipLevel) :
+    references_(references),
+    gzipLevel_(gzipLevel),
+    series_(DATA_SERIES_END)
+{
+}
+
+void CramEncoder::encode(const char *bamBegin, const char *bamEnd, Containers &containers)
+{
+    while (bamEnd != bamBegin)
+    {
+        containers.push_back(Container());
+        bamBegin = encodeContainer(bamBegin, bamEnd, containers.back());
+    }
+}
+
+const char *CramEncoder::encodeContainer(const char *begin, const char *end, Container &container)
+{
+    for (Bytes &s : series_)
+    {
+        s.clear();
+    }
+    tagBlocks_.clear();
+    tagLines_.clear();
+    tagDictionary_.clear();
+
+    const int refId = bamRecord::refId(begin + 4);
+    container.refId_ = std::max(refId, UNMAPPED_REF_ID);
+    int alignmentStart = 0;
+    int alignmentEnd = 0;
+    while (end != begin && RECORDS_PER_CONTAINER_MAX > container.records_ && refId == bamRecord::refId(begin + 4))
+    {
+        const char *record = begin + 4;
+        encodeRecord(record, container.refId_);
+        if (UNMAPPED_REF_ID != container.refId_)
+        {
+            const int recordStart = bamRecord::pos(record) + 1;
+            const int recordEnd = recordStart + std::max(bamRecord::referenceLength(record), 1) - 1;
+            alignmentStart = container.records_ ? std::min(alignmentStart, recordStart) : recordStart;
+            alignmentEnd = std::max(alignmentEnd, recordEnd);
+        }
+        container.bases_ += bamRecord::seqLength(record);
+        ++container.records_;
+        begin = record + bamRecord::get<int>(begin);
+    }
+
+    if (UNMAPPED_REF_ID != container.refId_)
+    {
+        container.start_ = alignmentStart;
+        container.span_ = alignmentEnd - alignmentStart + 1;
+
+        const ReferenceSequence &reference = references_.at(container.refId_);
+        const std::size_t from = std::min<std::size_t>(container.start_ - 1, reference.length_);
+        const std::size_t to = std::min<std::size_t>(from + container.span_, reference.length_);
+        common::MD5Sum md5;
+        md5.update(reference.begin_ + from, to - from);
+        const common::MD5Sum::Digest digest = md5.getDigest();
+        std::copy(digest.data, digest.data + sizeof(digest.data), container.refMd5_.begin());
+    }
+
+    makeCompressionHeader(container);
+    makeDataBlocks(container);
+    return begin;
+}
+
+void CramEncoder::encodeRecord(const char *record, const int refId)
+{
+    static const int CF_QUALITY_AS_ARRAY = 0x1;
+    static const int CF_DETACHED = 0x2;
+    static const int CF_NO_SEQ = 0x8;
+    static const unsigned BAM_FUNMAP = 0x4;
+    static const unsigned BAM_FMUNMAP = 0x8;
+    static const unsigned BAM_FMREVERSE = 0x20;
+
+    const int seqLength = bamRecord::seqLength(record);
+    const bool hasQualities = seqLength && char(0xFF) != *bamRecord::qual(record);
+    const unsigned flag = bamRecord::flag(record);
+
+    put(BF, flag);
+    put(CF, CF_DETACHED | (hasQualities ? CF_QUALITY_AS_ARRAY : 0) | (seqLength ? 0 : CF_NO_SEQ));
+    put(RL, seqLength);
+    put(AP, UNMAPPED_REF_ID == refId ? 0 : bamRecord::pos(record) + 1);
+    put(RG, -1);
+    // read name is stored with its terminating zero which is the BYTE_ARRAY_STOP stop byte
+    appendBytes(series_[RN], bamRecord::readName(record), bamRecord::cigar(record));
+    put(MF, ((flag & BAM_FMREVERSE) ? 1 : 0) | ((flag & BAM_FMUNMAP) ? 2 : 0));
+    put(NS, bamRecord::nextRefId(record));
+    put(NP, bamRecord::nextPos(record) + 1);
+    put(TS, bamRecord::tlen(record));
+
+    const char *recordEnd = record + bamRecord::get<int>(record - 4);
+    encodeTags(bamRecord::tags(record), recordEnd);
+
+    if (!(flag & BAM_FUNMAP))
+    {
+        ISAAC_ASSERT_MSG(seqLength, "Mapped records without sequence are not supported");
+        const ReferenceSequence &reference = references_.at(refId);
+        encodeFeatures(record, reference.begin_, reference.length_, hasQualities);
+        put(MQ, bamRecord::mapq(record));
+    }
+    else
+    {
+        const unsigned char *seq = bamRecord::seq(record);
+        for (int i = 0; seqLength > i; ++i)
+        {
+            putByte(BA, bamRecord::base(seq, i));
+        }
+    }
+
+    if (hasQualities)
+    {
+        appendBytes(series_[QS], bamRecord::qual(record), bamRecord::qual(record) + seqLength);
+    }
+}
+
+void CramEncoder::encodeTags(const char *tagsBegin, const char *tagsEnd)
+{
+    std::string line;
+    while (tagsEnd > tagsBegin)
+    {
+        const char type = tagsBegin[2];
+        const char *value = tagsBegin + 3;
+        const std::size_t size = bamRecord::tagValueSize(type, value);
+        line.append(tagsBegin, value);
+
+        const int key =
+            (static_cast<unsigned char>(tagsBegin[0]) << 16) |
+            (static_cast<unsigned char>(tagsBegin[1]) << 8) |
+            static_cast<unsigned char>(type);
+        std::map<int, std::pair<int, Bytes> >::iterator it = tagBlocks_.find(key);
+        if (tagBlocks_.end() == it)
+        {
+            it = tagBlocks_.insert(std::make_pair(key, std::make_pair(int(DATA_SERIES_END + tagBlocks_.size()), Bytes()))).first;
+        }
+        appendItf8(it->second.second, size);
+        appendBytes(it->second.second, value, value + size);
+        tagsBegin = value + size;
+    }
+
+    std::map<std::string, int>::const_iterator it = tagLines_.find(line);
+    if (tagLines_.end() == it)
+    {
+        it = tagLines_.insert(std::make_pair(line, int(tagDictionary_.size()))).first;
+        tagDictionary_.push_back(line);
+    }
+    put(TL, it->second);
+}
+
+void CramEncoder::encodeFeatures(
+    const char *record, const char *contigBegin, const std::size_t contigLength, const bool hasQualities)
+{
+    const unsigned char *seq = bamRecord::seq(record);
+    const char *qual = bamRecord::qual(record);
+    int features = 0;
+    int previousPosition = 0;
+    int readPos = 0;
+    std::size_t refPos = bamRecord::pos(record);
+
+    // positions are 1-based and stored as deltas from the previous feature
+    auto feature = [&](const char code)
+    {
+        putByte(FC, code);
+        put(FP, readPos + 1 - previousPosition);
+        previousPosition = readPos + 1;
+        ++features;
+    };
+
+    for (unsigned i = 0; bamRecord::cigarOps(record) > i; ++i)
+    {
+        const unsigned op = bamRecord::get<unsigned>(bamRecord::cigar(record) + i * 4);
+        const unsigned length = op >> 4;
+        switch (op & 0xF)
+        {
+        case 0: case 7: case 8:
+            for (const int matchEnd = readPos + length; matchEnd != readPos; ++readPos, ++refPos)
+            {
+                const char readBase = bamRecord::base(seq, readPos);
+                const int readIndex = substitutionIndex(readBase);
+                const int refIndex = contigLength > refPos ? substitutionIndex(contigBegin[refPos]) : -1;
+                if (-1 == readIndex || -1 == refIndex)
+                {
+                    feature('B');
+                    putByte(BA, readBase);
+                    putByte(QS, hasQualities ? qual[readPos] : char(0xFF));
+                }
+                else if (readIndex != refIndex)
+                {
+                    feature('X');
+                    // substitution matrix lists the four alternatives in ACGTN order
+                    putByte(BS, readIndex < refIndex ? readIndex : readIndex - 1);
+                }
+            }
+            break;
+        case 1: case 4:
+        {
+            const DataSeries ds = 1 == (op & 0xF) ? IN : SC;
+            feature(IN == ds ? 'I' : 'S');
+            for (const int end = readPos + length; end != readPos; ++readPos)
+            {
+                putByte(ds, bamRecord::base(seq, readPos));
+            }
+            putByte(ds, 0);
+            break;
+        }
+        case 2:
+            feature('D');
+            put(DL, length);
+            refPos += length;
+            break;
+        case 3:
+            feature('N');
+            put(RS, length);
+            refPos += length;
+            break;
+        case 5:
+            feature('H');
+            put(HC, length);
+            break;
+        case 6:
+            feature('P');
+            put(PD, length);
+            break;
+        default:
+            ISAAC_ASSERT_MSG(false, "Unexpected cigar operation " << (op & 0xF));
+        }
+    }
+    put(FN, features);
+}
+
+static void appendEncoding(Bytes &bytes, const int codecId, const Bytes &parameters)
+{
+    appendItf8(bytes, codecId);
+    appendItf8(bytes, parameters.size());
+    appendBytes(bytes, parameters);
+}
+
+static void appendExternal(Bytes &bytes, const int contentId)
+{
+    static const int EXTERNAL = 1;
+    Bytes parameters;
+    appendItf8(parameters, contentId);
+    appendEncoding(bytes, EXTERNAL, parameters);
+}
+
+static void appendByteArrayStop(Bytes &bytes, const char stop, const int contentId)
+{
+    static const int BYTE_ARRAY_STOP = 5;
+    Bytes parameters(1, stop);
+    appendItf8(parameters, contentId);
+    appendEncoding(bytes, BYTE_ARRAY_STOP, parameters);
+}
+
+static void appendByteArrayLen(Bytes &bytes, const int contentId)
+{
+    static const int BYTE_ARRAY_LEN = 4;
+    Bytes parameters;
+    appendExternal(parameters, contentId);
+    appendExternal(parameters, contentId);
+    appendEncoding(bytes, BYTE_ARRAY_LEN, parameters);
+}
+
+/**
+ * \brief size of map in bytes, number of entries, entries
+ */
+static void appendMap(Bytes &bytes, const int entries, const Bytes &map)
+{
+    Bytes counted;
+    appendItf8(counted, entries);
+    appendBytes(counted, map);
+    appendItf8(bytes, counted.size());
+    appendBytes(bytes, counted);
+}
+
+void CramEncoder::makeCompressionHeader(Container &container) const
+{
+    static const char *DATA_SERIES_NAMES[] =
+    {
+        "", "BF", "CF", "RL", "AP", "RG", "RN", "MF", "NS", "NP", "TS", "TL", "FN", "FC", "FP", "BS",
+        "IN", "SC", "DL", "RS", "HC", "PD", "BA", "QS", "MQ"
+    };
+    static_assert(sizeof(DATA_SERIES_NAMES) / sizeof(DATA_SERIES_NAMES[0]) == DATA_SERIES_END, "Data series name missing");
+
+    Bytes header;
+
+    Bytes preservation;
+    appendBytes(preservation, "RN", "RN" + 2);
+    appendByte(preservation, 1);
+    appendBytes(preservation, "AP", "AP" + 2);
+    appendByte(preservation, 0);
+    appendBytes(preservation, "RR", "RR" + 2);
+    appendByte(preservation, 1);
+    appendBytes(preservation, "SM", "SM" + 2);
+    // each substitution code is the index of the read base among the alternatives
+    preservation.insert(preservation.end(), 5, 0x1B);
+    appendBytes(preservation, "TD", "TD" + 2);
+    Bytes dictionary;
+    for (const std::string &line : tagDictionary_)
+    {
+        appendBytes(dictionary, line.data(), line.data() + line.size());
+        appendByte(dictionary, 0);
+    }
+    appendItf8(preservation, dictionary.size());
+    appendBytes(preservation, dictionary);
+    appendMap(header, 5, preservation);
+
+    Bytes dataSeries;
+    for (int ds = BF; DATA_SERIES_END != ds; ++ds)
+    {
+        appendBytes(dataSeries, DATA_SERIES_NAMES[ds], DATA_SERIES_NAMES[ds] + 2);
+        if (RN == ds || IN == ds || SC == ds)
+        {
+            appendByteArrayStop(dataSeries, 0, ds);
+        }
+        else
+        {
+            appendExternal(dataSeries, ds);
+        }
+    }
+    appendMap(header, DATA_SERIES_END - BF, dataSeries);
+
+    Bytes tags;
+    for (const std::map<int, std::pair<int, Bytes> >::value_type &tag : tagBlocks_)
+    {
+        appendItf8(tags, tag.first);
+        appendByteArrayLen(tags, tag.second.first);
+    }
+    appendMap(header, tagBlocks_.size(), tags);
+
+    appendBlock(container.compressionHeaderBlock_, RAW, COMPRESSION_HEADER, 0, header, 0);
+}
+
+void CramEncoder::makeDataBlocks(Container &container) const
+{
+    // everything is stored in external blocks
+    appendBlock(container.dataBlocks_, RAW, CORE_DATA, 0, Bytes(), 0);
+    container.dataBlocksCount_ = 1;
+    for (int ds = BF; DATA_SERIES_END != ds; ++ds)
+    {
+        if (!series_[ds].empty())
+        {
+            appendBlock(container.dataBlocks_, GZIP, EXTERNAL_DATA, ds, series_[ds], gzipLevel_);
+            container.contentIds_.push_back(ds);
+            ++container.dataBlocksCount_;
+        }
+    }
+    for (const std::map<int, std::pair<int, Bytes> >::value_type &tag : tagBlocks_)
+    {
+        appendBlock(container.dataBlocks_, GZIP, EXTERNAL_DATA, tag.second.first, tag.second.second, gzipLevel_);
+        container.contentIds_.push_back(tag.second.first);
+        ++container.dataBlocksCount_;
+    }
+}
+
+} // namespace cram
+} // namespace isaac
@@ -0,0 +1,73 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file CramIndex.cpp
+ **
+ ** Keeps track of container placement in the cram file and produces the .crai index.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "cram/CramIndex.hh"
+
+namespace isaac
+{
+namespace cram
+{
+
+void CramIndex::processContainer(const Container &container, const ContainerLayout &layout)
+{
+    const Entry entry =
+    {
+        container.refId_,
+        container.start_,
+        container.span_,
+        fileOffset_,
+        layout.landmark_,
+        layout.sliceSize_
+    };
+    entries_.push_back(entry);
+    fileOffset_ += layout.size_;
+    recordCounter_ += container.records_;
+}
+
+void CramIndex::flush() const
+{
+    const boost::filesystem::path craiPath = cramPath_.string() + ".crai";
+    boost::iostreams::filtering_ostream os;
+    os.push(boost::iostreams::gzip_compressor());
+    os.push(boost::iostreams::file_sink(craiPath.string(), std::ios_base::binary));
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open output CRAM index file " + craiPath.string()));
+    }
+
+    for (const Entry &entry : entries_)
+    {
+        os << entry.refId_ << '\t' << entry.start_ << '\t' << entry.span_ << '\t' <<
+            entry.containerOffset_ << '\t' << entry.sliceOffset_ << '\t' << entry.sliceSize_ << '\n';
+    }
+
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write CRAM index file " + craiPath.string()));
+    }
+    // gzip compressor is not flushable. Closing the chain writes out the gzip footer
+    os.reset();
+}
+
+} // namespace cram
+} // namespace isaac
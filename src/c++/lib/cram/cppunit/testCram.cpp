@@ -0,0 +1,147 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "RegistryName.hh"
+#include "testCram.hh"
+
+#include "common/MD5Sum.hh"
+
+using namespace std;
+using isaac::cram::Bytes;
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestCram, registryName("Cram"));
+
+void TestCram::setUp()
+{
+}
+
+void TestCram::tearDown()
+{
+}
+
+static Bytes itf8(const int value)
+{
+    Bytes ret;
+    isaac::cram::appendItf8(ret, value);
+    return ret;
+}
+
+static Bytes ltf8(const int64_t value)
+{
+    Bytes ret;
+    isaac::cram::appendLtf8(ret, value);
+    return ret;
+}
+
+static Bytes bytes(const std::string &hex)
+{
+    Bytes ret;
+    for (std::size_t i = 0; hex.size() > i; i += 2)
+    {
+        ret.push_back(std::stoi(hex.substr(i, 2), 0, 16));
+    }
+    return ret;
+}
+
+void TestCram::testItf8()
+{
+    CPPUNIT_ASSERT(bytes("00") == itf8(0));
+    CPPUNIT_ASSERT(bytes("7f") == itf8(0x7f));
+    CPPUNIT_ASSERT(bytes("8080") == itf8(0x80));
+    CPPUNIT_ASSERT(bytes("bfff") == itf8(0x3fff));
+    CPPUNIT_ASSERT(bytes("c04000") == itf8(0x4000));
+    CPPUNIT_ASSERT(bytes("e0200000") == itf8(0x200000));
+    CPPUNIT_ASSERT(bytes("f100000000") == itf8(0x10000000));
+    CPPUNIT_ASSERT(bytes("ffffffff0f") == itf8(-1));
+}
+
+void TestCram::testLtf8()
+{
+    CPPUNIT_ASSERT(bytes("00") == ltf8(0));
+    CPPUNIT_ASSERT(bytes("8080") == ltf8(0x80));
+    CPPUNIT_ASSERT(bytes("c04000") == ltf8(0x4000));
+    CPPUNIT_ASSERT(bytes("f010000000") == ltf8(0x10000000));
+    CPPUNIT_ASSERT(bytes("fd000000000000") == ltf8(0x1000000000000L));
+    CPPUNIT_ASSERT(bytes("ff0100000000000000") == ltf8(0x100000000000000L));
+    CPPUNIT_ASSERT(bytes("ffffffffffffffffff") == ltf8(-1L));
+}
+
+void TestCram::testEof()
+{
+    std::ostringstream os;
+    isaac::cram::serializeEof(os);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(38), os.str().size());
+}
+
+/**
+ * \brief single 6M record at position 0 with one mismatch against the reference
+ */
+static Bytes makeBamRecord()
+{
+    Bytes record;
+    isaac::cram::appendInt32(record, 0);                // refID
+    isaac::cram::appendInt32(record, 0);                // pos
+    record.push_back(3);                                // l_read_name
+    record.push_back(60);                               // mapq
+    record.push_back(0); record.push_back(0);           // bin
+    record.push_back(1); record.push_back(0);           // n_cigar_op
+    record.push_back(0); record.push_back(0);           // flag
+    isaac::cram::appendInt32(record, 6);                // l_seq
+    isaac::cram::appendInt32(record, -1);               // next_refID
+    isaac::cram::appendInt32(record, -1);               // next_pos
+    isaac::cram::appendInt32(record, 0);                // tlen
+    record.push_back('r'); record.push_back('1'); record.push_back(0);
+    isaac::cram::appendInt32(record, 6 << 4);           // 6M
+    // ACGAAC
+    record.push_back(0x12); record.push_back(0x41); record.push_back(0x12);
+    record.insert(record.end(), 6, 30);
+    const char tag[] = {'N', 'M', 'C', 1};
+    record.insert(record.end(), tag, tag + sizeof(tag));
+
+    Bytes ret;
+    isaac::cram::appendInt32(ret, record.size());
+    ret.insert(ret.end(), record.begin(), record.end());
+    return ret;
+}
+
+void TestCram::testEncoder()
+{
+    const std::string reference("ACGTACGTAC");
+    isaac::cram::ReferenceSequences references(1, isaac::cram::ReferenceSequence(reference.data(), reference.size()));
+
+    const Bytes bam = makeBamRecord();
+    isaac::cram::Containers containers;
+    isaac::cram::CramEncoder(references, 1).encode(&bam.front(), &bam.front() + bam.size(), containers);
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), containers.size());
+    const isaac::cram::Container &container = containers.front();
+    CPPUNIT_ASSERT_EQUAL(0, container.refId_);
+    CPPUNIT_ASSERT_EQUAL(1, container.start_);
+    CPPUNIT_ASSERT_EQUAL(6, container.span_);
+    CPPUNIT_ASSERT_EQUAL(1, container.records_);
+    CPPUNIT_ASSERT_EQUAL(int64_t(6), container.bases_);
+    CPPUNIT_ASSERT_EQUAL(int(container.contentIds_.size() + 1), container.dataBlocksCount_);
+
+    isaac::common::MD5Sum md5;
+    md5.update(reference.data(), 6);
+    CPPUNIT_ASSERT(0 == memcmp(md5.getDigest().data, container.refMd5_.begin(), 16));
+
+    Bytes serialized;
+    const isaac::cram::ContainerLayout layout = isaac::cram::serializeContainer(serialized, container, 0);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(serialized.size()), layout.size_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(container.compressionHeaderBlock_.size()), layout.landmark_);
+}
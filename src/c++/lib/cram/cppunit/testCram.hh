@@ -0,0 +1,38 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_CRAM_TEST_CRAM_HH
+#define iSAAC_CRAM_TEST_CRAM_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "cram/CramEncoder.hh"
+
+class TestCram : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestCram );
+    CPPUNIT_TEST( testItf8 );
+    CPPUNIT_TEST( testLtf8 );
+    CPPUNIT_TEST( testEof );
+    CPPUNIT_TEST( testEncoder );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void tearDown();
+    void testItf8();
+    void testLtf8();
+    void testEof();
+    void testEncoder();
+};
+
+#endif // #ifndef iSAAC_CRAM_TEST_CRAM_HH
@@ -17,6 +17,8 @@
  ** \author Roman Petrovski
  **/
 
+#include <algorithm>
+
 #include "demultiplexing/BarcodeResolver.hh"
 
 namespace isaac
@@ -263,10 +265,339 @@ BarcodeResolver::BarcodeResolver(
     const flowcell::BarcodeMetadataList &allBarcodeMetadata,
     const flowcell::BarcodeMetadataList &barcodeGroup)
     : allBarcodeMetadata_(allBarcodeMetadata)
-    , mismatchBarcodes_(generateMismatches(allBarcodeMetadata_, barcodeGroup))
     , unknownBarcodeIndex_(barcodeGroup.at(0).getIndex())
+    , barcodeLength_(0)
+    , lookupMode_(CompareAll)
     , barcodeHits_(allBarcodeMetadata_.size())
 {
+    parseSamples(barcodeGroup);
+    // Will throw common::InvalidOptionException if a sequence is within mismatches of different barcodes
+    checkCollisions();
+
+    // table entries can't index more samples than LOOKUP_SAMPLES_MAX. Such lanes get resolved by comparison.
+    if (!samples_.empty() && DIRECT_LOOKUP_ENTRIES_MAX >= getTableSize(barcodeLength_) &&
+        LOOKUP_SAMPLES_MAX >= samples_.size())
+    {
+        buildBarcodeTable();
+        lookupMode_ = LookupBarcode;
+    }
+    else if (!samples_.empty() && componentLengths_.end() == std::find_if(
+        componentLengths_.begin(), componentLengths_.end(), [](const unsigned length){return DIRECT_LOOKUP_ENTRIES_MAX < getTableSize(length);}) &&
+        buildComponentTables())
+    {
+        lookupMode_ = LookupComponents;
+    }
+
+    ISAAC_THREAD_CERR << "Resolving " << samples_.size() << " barcodes of length " << barcodeLength_ << " by " <<
+        (LookupBarcode == lookupMode_ ? "barcode lookup" : LookupComponents == lookupMode_ ? "component lookup" : "comparison") << std::endl;
+}
+
+/**
+ * \return 5^length or the first power of 5 above DIRECT_LOOKUP_ENTRIES_MAX whichever is smaller
+ */
+uint64_t BarcodeResolver::getTableSize(const unsigned length)
+{
+    uint64_t entries = 1;
+    for (unsigned i = 0; length != i && DIRECT_LOOKUP_ENTRIES_MAX >= entries; ++i)
+    {
+        entries *= BASE_VARIANTS;
+    }
+    return entries;
+}
+
+/**
+ * \brief Bases are digits of a base-5 number. Unlike the 3-bit kmer itself this does not leave holes in the table
+ */
+uint64_t BarcodeResolver::getTableIndex(const Kmer sequence, const unsigned length)
+{
+    uint64_t ret = 0;
+    for (unsigned i = length; i--;)
+    {
+        ret = ret * BASE_VARIANTS + ((sequence >> (i * BITS_PER_BASE)) & kmerMask_);
+    }
+    return ret;
+}
+
+void BarcodeResolver::parseSamples(const flowcell::BarcodeMetadataList &barcodeGroup)
+{
+    ISAAC_ASSERT_MSG(!barcodeGroup.empty(), "Barcode list must be not empty");
+    ISAAC_ASSERT_MSG(barcodeGroup.at(0).isDefault(), "The very first barcode must be the 'unknown indexes or no index' one");
+    static const oligo::Translator<true> translator = {};
+
+    samples_.reserve(barcodeGroup.size() - 1);
+    // Don't parse the 'unknown indexes' barcode.
+    BOOST_FOREACH(const flowcell::BarcodeMetadata &barcodeMetadata, std::make_pair(barcodeGroup.begin() + 1, barcodeGroup.end()))
+    {
+        const std::string &sequence = barcodeMetadata.getSequence();
+        ISAAC_ASSERT_MSG(!sequence.empty(), "only default barcode can have an empty sequence and it must not be passed here");
+
+        SampleBarcode sample;
+        sample.sequence_ = 0;
+        sample.barcodeIndex_ = barcodeMetadata.getIndex();
+        std::vector<unsigned> componentLengths(1, 0);
+        BOOST_FOREACH(const char base, sequence)
+        {
+            if ('-' != base)
+            {
+                sample.sequence_ = (sample.sequence_ << BITS_PER_BASE) | translator[base];
+                ++componentLengths.back();
+            }
+            else
+            {
+                componentLengths.push_back(0);
+            }
+        }
+        const std::vector<unsigned> &componentMismatches = barcodeMetadata.getComponentMismatches();
+        ISAAC_ASSERT_MSG(componentMismatches.size() >= componentLengths.size(), "Mismatches must be specified for each component of " << barcodeMetadata);
+        sample.componentMismatches_.assign(componentMismatches.begin(), componentMismatches.begin() + componentLengths.size());
+
+        if (samples_.empty())
+        {
+            componentLengths_ = componentLengths;
+        }
+        else if (componentLengths_ != componentLengths)
+        {
+            BOOST_THROW_EXCEPTION(
+                common::InvalidOptionException("Barcode components of " + boost::lexical_cast<std::string>(barcodeMetadata) +
+                    " differ in length from those of " +
+                    boost::lexical_cast<std::string>(allBarcodeMetadata_.at(samples_.front().barcodeIndex_))));
+        }
+        samples_.push_back(sample);
+    }
+
+    // the last component occupies the least significant bits
+    componentShifts_.resize(componentLengths_.size());
+    for (std::size_t component = componentLengths_.size(); component--;)
+    {
+        componentShifts_[component] = barcodeLength_ * BITS_PER_BASE;
+        barcodeLength_ += componentLengths_[component];
+    }
+    ISAAC_ASSERT_MSG(MAX_BARCODE_LENGTH >= barcodeLength_, "Barcode is too long: " << barcodeLength_);
+}
+
+/**
+ * \brief A sequence within mismatches of two barcodes exists if and only if every component of one barcode
+ *        differs from that of the other by no more than the sum of the component mismatches of both
+ *
+ * \throws common::InvalidOptionException if any two barcodes collide.
+ */
+void BarcodeResolver::checkCollisions() const
+{
+    for (SampleBarcodes::const_iterator left = samples_.begin(); samples_.end() != left; ++left)
+    {
+        for (SampleBarcodes::const_iterator right = left + 1; samples_.end() != right; ++right)
+        {
+            unsigned component = 0;
+            while (componentLengths_.size() != component &&
+                countMismatches(getComponent(left->sequence_, component), getComponent(right->sequence_, component)) <=
+                    left->componentMismatches_[component] + right->componentMismatches_[component])
+            {
+                ++component;
+            }
+            if (componentLengths_.size() == component)
+            {
+                BOOST_THROW_EXCEPTION(
+                    common::InvalidOptionException("Barcode collision detected. Barcode " +
+                        boost::lexical_cast<std::string>(allBarcodeMetadata_.at(left->barcodeIndex_)) +
+                        " collides with " + boost::lexical_cast<std::string>(allBarcodeMetadata_.at(right->barcodeIndex_))));
+            }
+        }
+    }
+}
+
+void BarcodeResolver::buildBarcodeTable()
+{
+    ISAAC_ASSERT_MSG(LOOKUP_SAMPLES_MAX >= samples_.size(), "Too many barcodes for the lookup table: " << samples_.size());
+    barcodeTable_.resize(getTableSize(barcodeLength_), 0);
+
+    Barcodes variants;
+    for (const SampleBarcode &sample : samples_)
+    {
+        variants.clear();
+        generateBarcodeMismatches(allBarcodeMetadata_.at(sample.barcodeIndex_), variants);
+        const LookupEntry sampleEntry = LookupEntry((&sample - &samples_.front() + 1) << MISMATCHES_BITS);
+        for (const Barcode &variant : variants)
+        {
+            LookupEntry &entry = barcodeTable_[getTableIndex(variant.getSequence(), barcodeLength_)];
+            ISAAC_ASSERT_MSG(!entry || sampleEntry == (entry & ~MISMATCHES_MASK), "Collisions are expected to be detected before");
+            // variants going back and forth over the same base report more mismatches than there really are
+            entry = sampleEntry | std::min<unsigned>(MISMATCHES_MASK, countMismatches(variant.getSequence(), sample.sequence_));
+        }
+    }
+}
+
+/**
+ * \return false if a component has more distinct sequences than the table entries can index. No tables are built then.
+ */
+bool BarcodeResolver::buildComponentTables()
+{
+    componentTables_.resize(componentLengths_.size());
+    componentSequences_.resize(componentLengths_.size());
+    std::vector<std::vector<unsigned> > sampleComponentIndexes(samples_.size(), std::vector<unsigned>(componentLengths_.size()));
+    for (unsigned component = 0; componentLengths_.size() != component; ++component)
+    {
+        const unsigned length = componentLengths_[component];
+
+        // distinct component sequences with the largest mismatches any sample allows for them
+        std::vector<std::pair<Kmer, unsigned> > distinct;
+        for (const SampleBarcode &sample : samples_)
+        {
+            distinct.push_back(std::make_pair(getComponent(sample.sequence_, component), sample.componentMismatches_[component]));
+        }
+        std::sort(distinct.begin(), distinct.end());
+        // with mismatches sorted in increasing order, keep the last of each sequence
+        distinct.erase(distinct.begin(), std::unique(distinct.rbegin(), distinct.rend(),
+                                   [](const std::pair<Kmer, unsigned> &left, const std::pair<Kmer, unsigned> &right)
+                                   {return left.first == right.first;}).base());
+        if (LOOKUP_SAMPLES_MAX <= distinct.size())
+        {
+            componentTables_.clear();
+            componentSequences_.clear();
+            return false;
+        }
+
+        std::vector<Kmer> &sequences = componentSequences_[component];
+        LookupTable &table = componentTables_[component];
+        table.resize(getTableSize(length), 0);
+        for (const std::pair<Kmer, unsigned> &original : distinct)
+        {
+            sequences.push_back(original.first);
+            const LookupEntry originalEntry = LookupEntry(sequences.size() << MISMATCHES_BITS);
+            const unsigned iterations = getMismatchKmersCount(length, original.second);
+            for (unsigned iteration = 0; iterations != iteration; ++iteration)
+            {
+                const Kmer variant =
+                    0 == original.second ? original.first :
+                    1 == original.second ? get1MismatchKmer(original.first, length, 0, iteration).first :
+                        get2MismatchKmer(original.first, length, 0, iteration).first;
+                LookupEntry &entry = table[getTableIndex(variant, length)];
+                if (!entry)
+                {
+                    entry = originalEntry | std::min<unsigned>(MISMATCHES_MASK, countMismatches(variant, original.first));
+                }
+                else if (originalEntry != (entry & ~MISMATCHES_MASK))
+                {
+                    // the other component can still tell the barcodes apart
+                    entry = AMBIGUOUS_ENTRY;
+                }
+            }
+        }
+
+        for (const SampleBarcode &sample : samples_)
+        {
+            sampleComponentIndexes[&sample - &samples_.front()][component] =
+                std::lower_bound(sequences.begin(), sequences.end(), getComponent(sample.sequence_, component)) - sequences.begin();
+        }
+    }
+
+    for (std::size_t sample = 0; samples_.size() != sample; ++sample)
+    {
+        uint64_t key = 0;
+        for (unsigned component = 0; componentLengths_.size() != component; ++component)
+        {
+            key = key * componentSequences_[component].size() + sampleComponentIndexes[sample][component];
+        }
+        componentSamples_.push_back(std::make_pair(key, sample));
+    }
+    std::sort(componentSamples_.begin(), componentSamples_.end());
+    return true;
+}
+
+bool BarcodeResolver::matchSample(const SampleBarcode &sample, const Kmer sequence, unsigned &mismatches) const
+{
+    mismatches = 0;
+    for (unsigned component = 0; componentLengths_.size() != component; ++component)
+    {
+        const unsigned componentMismatches =
+            countMismatches(getComponent(sequence, component), getComponent(sample.sequence_, component));
+        if (sample.componentMismatches_[component] < componentMismatches)
+        {
+            return false;
+        }
+        mismatches += componentMismatches;
+    }
+    return true;
+}
+
+/**
+ * \brief Since no two barcodes collide, the first one that matches is the only one
+ */
+bool BarcodeResolver::compareAll(const Kmer sequence, unsigned &sample, unsigned &mismatches) const
+{
+    for (sample = 0; samples_.size() != sample; ++sample)
+    {
+        if (matchSample(samples_[sample], sequence, mismatches))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BarcodeResolver::lookupComponents(const Kmer sequence, unsigned &sample, unsigned &mismatches) const
+{
+    uint64_t key = 0;
+    for (unsigned component = 0; componentLengths_.size() != component; ++component)
+    {
+        const uint64_t index = getTableIndex(getComponent(sequence, component), componentLengths_[component]);
+        const LookupEntry entry = componentTables_[component].size() > index ? componentTables_[component][index] : 0;
+        if (!entry)
+        {
+            // no barcode has this component within mismatches
+            return false;
+        }
+        if (AMBIGUOUS_ENTRY == entry)
+        {
+            return compareAll(sequence, sample, mismatches);
+        }
+        key = key * componentSequences_[component].size() + (entry >> MISMATCHES_BITS) - 1;
+    }
+
+    const std::vector<std::pair<uint64_t, unsigned> >::const_iterator it = std::lower_bound(
+        componentSamples_.begin(), componentSamples_.end(), std::make_pair(key, 0U));
+    if (componentSamples_.end() == it || key != it->first)
+    {
+        return false;
+    }
+    // every component is within mismatches of only one sample sheet sequence. If the barcode that has all of them
+    // allows fewer mismatches than some other barcode with the same component, the sequence is unknown
+    sample = it->second;
+    return matchSample(samples_[sample], sequence, mismatches);
+}
+
+bool BarcodeResolver::lookup(const Kmer sequence, unsigned &sample, unsigned &mismatches) const
+{
+    switch (lookupMode_)
+    {
+    case LookupBarcode:
+    {
+        const uint64_t index = getTableIndex(sequence, barcodeLength_);
+        const LookupEntry entry = barcodeTable_.size() > index ? barcodeTable_[index] : 0;
+        sample = (entry >> MISMATCHES_BITS) - 1;
+        mismatches = entry & MISMATCHES_MASK;
+        return entry;
+    }
+    case LookupComponents:
+        return lookupComponents(sequence, sample, mismatches);
+    default:
+        return compareAll(sequence, sample, mismatches);
+    }
+}
+
+void BarcodeResolver::resolveBatch(Barcodes::iterator begin, const Barcodes::iterator end) const
+{
+    for (; end != begin; ++begin)
+    {
+        Barcode &dataBarcode = *begin;
+        ISAAC_ASSERT_MSG(dataBarcode.getBarcode() == unknownBarcodeIndex_, "Data barcodes are expected to have the index preset to 'unknown'");
+        unsigned sample = 0;
+        unsigned mismatches = 0;
+        if (lookup(dataBarcode.getSequence(), sample, mismatches))
+        {
+            dataBarcode.setBarcodeId(BarcodeId(dataBarcode.getTile(), samples_[sample].barcodeIndex_, dataBarcode.getCluster(),
+                                               std::min<unsigned>(BarcodeId::MISMATCHES_MASK, mismatches)));
+        }
+    }
 }
 
 inline std::ostream &operator << (std::ostream &os, const std::vector<unsigned> &mismatchesPerComponent)
@@ -298,48 +629,44 @@ Barcodes::iterator BarcodeResolver::recordSameBarcodeHits(
 }
 
 /**
- * \brief Updates barcode indexes with those of the matching mismatch barcodes.
+ * \brief Updates barcode indexes with those of the matching barcodes.
  *        Index 0 is reserved for the undetermined barcode.
  */
 void BarcodeResolver::resolve(
     Barcodes &dataBarcodes,
+    common::ThreadVector &threads,
     demultiplexing::DemultiplexingStats &demultiplexingStats)
 {
     ISAAC_THREAD_CERR << "Resolving barcodes for " << dataBarcodes.size() << " clusters against " <<
-        mismatchBarcodes_.size() << " mismatch variants" << std::endl;
+        samples_.size() << " barcodes" << std::endl;
+
+    threads.execute([this, &dataBarcodes](const unsigned threadNumber, const unsigned threadsTotal)
+    {
+        const std::size_t batchSize = (dataBarcodes.size() + threadsTotal - 1) / threadsTotal;
+        const std::size_t batchBegin = std::min(dataBarcodes.size(), batchSize * threadNumber);
+        resolveBatch(dataBarcodes.begin() + batchBegin,
+                     dataBarcodes.begin() + std::min(dataBarcodes.size(), batchBegin + batchSize));
+    });
+
+    // only the unknown ones need to be grouped by sequence for the statistics
+    const Barcodes::iterator unknownBegin = std::partition(
+        dataBarcodes.begin(), dataBarcodes.end(),
+        [this](const Barcode &dataBarcode){return unknownBarcodeIndex_ != dataBarcode.getBarcode();});
 
     uint64_t totalBarcodeHits = 0;
-    std::sort(dataBarcodes.begin(), dataBarcodes.end(), orderBySequence);
-    Barcodes::const_iterator mismatchBarcodeIterator = mismatchBarcodes_.begin();
+    for (Barcodes::const_iterator dataBarcodeIterator = dataBarcodes.begin();
+        unknownBegin != dataBarcodeIterator; ++dataBarcodeIterator)
+    {
+        ++barcodeHits_.at(dataBarcodeIterator->getBarcode());
+        ++totalBarcodeHits;
+        demultiplexingStats.recordBarcode(dataBarcodeIterator->getBarcodeId());
+    }
 
-    for(Barcodes::iterator dataBarcodeIterator = dataBarcodes.begin();
+    std::sort(unknownBegin, dataBarcodes.end(), orderBySequence);
+    for(Barcodes::iterator dataBarcodeIterator = unknownBegin;
         dataBarcodes.end() != dataBarcodeIterator; ++dataBarcodeIterator)
     {
-        Barcode &dataBarcode = *dataBarcodeIterator;
-        // rewind sample sheet to the first data match
-        while(mismatchBarcodes_.end() != mismatchBarcodeIterator &&
-            dataBarcode.getSequence() > mismatchBarcodeIterator->getSequence())
-        {
-            ISAAC_ASSERT_MSG(dataBarcode.getBarcode() == unknownBarcodeIndex_, "Data barcodes are expected to have the index preset to 'unknown'");
-            ++mismatchBarcodeIterator;
-        }
-
-        if (mismatchBarcodes_.end() != mismatchBarcodeIterator && dataBarcode.getSequence() == mismatchBarcodeIterator->getSequence())
-        {
-            // match!, set the index in data
-            BarcodeId barcodeId(dataBarcode.getTile(), mismatchBarcodeIterator->getBarcode(),
-                                dataBarcode.getCluster(), mismatchBarcodeIterator->getMismatches());
-            dataBarcode.setBarcodeId(barcodeId);
-            ++barcodeHits_.at(mismatchBarcodeIterator->getBarcode());
-            ++totalBarcodeHits;
-            demultiplexingStats.recordBarcode(barcodeId);
-        }
-        else
-        {
-            dataBarcodeIterator = recordSameBarcodeHits(dataBarcodeIterator, dataBarcodes.end(), demultiplexingStats);
-        }
-
-        // else dataBarcode.getSequence() < mismatchBarcodeIterator->getSequence(), no match, move on
+        dataBarcodeIterator = recordSameBarcodeHits(dataBarcodeIterator, dataBarcodes.end(), demultiplexingStats);
     }
 
     if (!dataBarcodes.empty())
@@ -347,7 +674,7 @@ void BarcodeResolver::resolve(
         demultiplexingStats.finalizeUnknownBarcodeHits(unknownBarcodeIndex_);
     }
     ISAAC_THREAD_CERR << "Resolving barcodes done for " << dataBarcodes.size() << " clusters against " <<
-        mismatchBarcodes_.size() << " mismatch variants. Found barcode hits breakdown. Total(" << totalBarcodeHits << "):"<< std::endl;
+        samples_.size() << " barcodes. Found barcode hits breakdown. Total(" << totalBarcodeHits << "):"<< std::endl;
 
     BOOST_FOREACH(const uint64_t &barcodeHits, barcodeHits_)
     {
@@ -165,3 +165,169 @@ void TestBarcodeResolver::testMismatchCollision()
 
 }
 
+
+static isaac::flowcell::BarcodeMetadataList makeBarcodes(const std::vector<std::string> &sequences)
+{
+    isaac::flowcell::BarcodeMetadataList ret(sequences.size() + 1);
+    const std::vector<unsigned> compMism(2, 1);
+    ret.at(0).setUnknown();
+    ret.at(0).setIndex(0);
+    ret.at(0).setComponentMismatches(compMism);
+    for (unsigned i = 1; ret.size() != i; ++i)
+    {
+        ret.at(i).setSequence(sequences.at(i - 1));
+        ret.at(i).setIndex(i);
+        ret.at(i).setComponentMismatches(compMism);
+    }
+    return ret;
+}
+
+static Kmer makeKmer(const std::string &sequence)
+{
+    static const isaac::oligo::Translator<true> translator = {};
+    Kmer ret = 0;
+    BOOST_FOREACH(const char base, sequence)
+    {
+        if ('-' != base)
+        {
+            ret = (ret << BITS_PER_BASE) | translator[base];
+        }
+    }
+    return ret;
+}
+
+/**
+ * \return "barcode:mismatches" for each sequence
+ */
+static std::vector<std::string> resolveMetadata(
+    const isaac::flowcell::BarcodeMetadataList &barcodeMetadataList,
+    const std::vector<std::string> &sequences)
+{
+    BarcodeResolver resolver(barcodeMetadataList, barcodeMetadataList);
+    Barcodes dataBarcodes;
+    BOOST_FOREACH(const std::string &sequence, sequences)
+    {
+        dataBarcodes.push_back(Barcode(makeKmer(sequence), BarcodeId(0, 0, dataBarcodes.size(), 0)));
+    }
+    isaac::common::ThreadVector threads(3);
+    DemultiplexingStats stats(isaac::flowcell::FlowcellLayoutList(), barcodeMetadataList);
+    resolver.resolve(dataBarcodes, threads, stats);
+
+    std::vector<std::string> ret(sequences.size());
+    BOOST_FOREACH(const Barcode &dataBarcode, dataBarcodes)
+    {
+        ret.at(dataBarcode.getCluster()) = boost::lexical_cast<std::string>(dataBarcode.getBarcode()) + ":" +
+            boost::lexical_cast<std::string>(dataBarcode.getMismatches());
+    }
+    return ret;
+}
+
+static std::vector<std::string> resolve(
+    const std::vector<std::string> &barcodes,
+    const std::vector<std::string> &sequences)
+{
+    return resolveMetadata(makeBarcodes(barcodes), sequences);
+}
+
+void TestBarcodeResolver::testResolveBarcodeLookup()
+{
+    const std::vector<std::string> resolved = resolve(
+        boost::assign::list_of("AAAA-CCCC")("GGGG-TTTT"),
+        boost::assign::list_of("AAAA-CCCC")("GGGG-TTTT")("AAAN-CCCG")("GGCG-TTTT")("AACC-CCCC")("CCCC-AAAA")("AAAA-TTTT"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:0"), resolved.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("2:0"), resolved.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:2"), resolved.at(2));
+    CPPUNIT_ASSERT_EQUAL(std::string("2:1"), resolved.at(3));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(4));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(5));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(6));
+}
+
+void TestBarcodeResolver::testResolveComponentLookup()
+{
+    // first components are close enough for AAAAAAAG to be within mismatches of both
+    const std::vector<std::string> resolved = resolve(
+        boost::assign::list_of("AAAAAAAA-CCCCCCCC")("AAAAAAAC-TTTTTTTT")("GGGGGGGG-CCCCCCCC"),
+        boost::assign::list_of("AAAAAAAA-CCCCCCCC")("AAAAAAAG-CCCCCCCC")("AAAAAAAG-TTTTTTTN")("GGGGGGGG-CCCCCCCA")
+            ("AAAAAAAA-TTTTTTTT")("GGGGGGGG-TTTTTTTT")("AAAAAACC-CCCCCCCC"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:0"), resolved.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:1"), resolved.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::string("2:2"), resolved.at(2));
+    CPPUNIT_ASSERT_EQUAL(std::string("3:1"), resolved.at(3));
+    CPPUNIT_ASSERT_EQUAL(std::string("2:1"), resolved.at(4));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(5));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(6));
+}
+
+void TestBarcodeResolver::testResolveCompare()
+{
+    // too long for a lookup table
+    const std::vector<std::string> resolved = resolve(
+        boost::assign::list_of("AAAAAAAAAAAA")("CCCCCCCCCCCC"),
+        boost::assign::list_of("AAAAAAAAAAAA")("CCCCCCCCCCCN")("AAAAAAAAAACC")("GGGGGGGGGGGG"));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:0"), resolved.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("2:1"), resolved.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(2));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(3));
+}
+
+/**
+ * \brief unique 8-base sequence for each number below 4^8
+ */
+static std::string makeSequence(const unsigned number)
+{
+    std::string ret;
+    for (unsigned base = 0; 8 != base; ++base)
+    {
+        ret.push_back("ACGT"[(number >> (base * 2)) & 3]);
+    }
+    return ret;
+}
+
+void TestBarcodeResolver::testResolveTooManySamples()
+{
+    // more samples than the lookup table entries can index. The sequences below resolve to the barcodes that fit
+    // into BarcodeId
+    static const unsigned SAMPLES = 8200;
+    std::vector<std::string> barcodes;
+    std::vector<std::string> componentBarcodes;
+    for (unsigned i = 0; SAMPLES != i; ++i)
+    {
+        barcodes.push_back(makeSequence(i));
+        componentBarcodes.push_back(makeSequence(i) + "-" + makeSequence(i));
+    }
+
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList = makeBarcodes(barcodes);
+    isaac::flowcell::BarcodeMetadataList componentMetadataList = makeBarcodes(componentBarcodes);
+    for (unsigned i = 0; barcodeMetadataList.size() != i; ++i)
+    {
+        // exact matches only, otherwise the sequences collide
+        barcodeMetadataList.at(i).setComponentMismatches(std::vector<unsigned>(2, 0));
+        componentMetadataList.at(i).setComponentMismatches(std::vector<unsigned>(2, 0));
+    }
+
+    // short enough for barcode lookup
+    std::vector<std::string> resolved = resolveMetadata(
+        barcodeMetadataList,
+        boost::assign::list_of(makeSequence(0))(makeSequence(4000))(makeSequence(SAMPLES)));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:0"), resolved.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("4001:0"), resolved.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(2));
+
+    // short enough components for component lookup
+    resolved = resolveMetadata(
+        componentMetadataList,
+        boost::assign::list_of(makeSequence(0) + makeSequence(0))(makeSequence(4000) + makeSequence(4000))
+            (makeSequence(0) + makeSequence(1)));
+    CPPUNIT_ASSERT_EQUAL(std::string("1:0"), resolved.at(0));
+    CPPUNIT_ASSERT_EQUAL(std::string("4001:0"), resolved.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0"), resolved.at(2));
+}
+
+void TestBarcodeResolver::testResolverCollision()
+{
+    const isaac::flowcell::BarcodeMetadataList barcodeMetadataList =
+        makeBarcodes(boost::assign::list_of("AAAAAAAA-CCCCCCCC")("AAAAAAAC-CCCCCCCG"));
+    CPPUNIT_ASSERT_THROW(BarcodeResolver(barcodeMetadataList, barcodeMetadataList), isaac::common::InvalidOptionException);
+    CPPUNIT_ASSERT_NO_THROW(BarcodeResolver(barcodeMetadataList, makeBarcodes(boost::assign::list_of("AAAAAAAA-CCCCCCCC"))));
+}
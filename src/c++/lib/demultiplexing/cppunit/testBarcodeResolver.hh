@@ -31,6 +31,11 @@ class TestBarcodeResolver : public CppUnit::TestFixture
     CPPUNIT_TEST( testOneComponent );
     CPPUNIT_TEST( testTwoComponents );
     CPPUNIT_TEST( testMismatchCollision );
+    CPPUNIT_TEST( testResolveBarcodeLookup );
+    CPPUNIT_TEST( testResolveComponentLookup );
+    CPPUNIT_TEST( testResolveCompare );
+    CPPUNIT_TEST( testResolveTooManySamples );
+    CPPUNIT_TEST( testResolverCollision );
     CPPUNIT_TEST_SUITE_END();
 private:
 public:
@@ -40,6 +45,11 @@ public:
     void testOneComponent();
     void testTwoComponents();
     void testMismatchCollision();
+    void testResolveBarcodeLookup();
+    void testResolveComponentLookup();
+    void testResolveCompare();
+    void testResolveTooManySamples();
+    void testResolverCollision();
 };
 
 #endif // #ifndef iSAAC_OPTIONS_TEST_BARCODE_RESOLVER_HH
@@ -38,6 +38,7 @@ BamLoader::BamLoader(
     // one of the threads is busy parsing
     bgzfReader_(std::max(1U, coresMax - 1), BUFFER_SIZE / std::max(1U, coresMax - 1) / bgzf::BgzfReader::UNCOMPRESSED_BGZF_BLOCK_SIZE / 10),
     lastUnparsedBytes_(0),
+    firstRecordOffset_(0),
     // since the loading from bam has to happen sequentially, and we can have only one thread parsing,
     // the only parallelization can occur between a thread parsing and a bunch of threads loading and decompressing
     // so, 2 is a good ceiling here
@@ -33,6 +33,7 @@
 #include <boost/algorithm/string/regex.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include "common/BitHacks.hh"
 #include "common/Exceptions.hh"
 #include "demultiplexing/SampleSheetCsv.hh"
 #include "oligo/Mask.hh"
@@ -62,6 +63,8 @@ using boost::format;
 #define ELAND_GAP_SCORING_STRING "2:-1:-15:-3:-25"
 static const std::vector<std::string> SUPPORTED_BAM_EXCLUDE_TAGS =
     boost::assign::list_of("AS")("BC")("NM")("OC")("RG")("SM")("ZX")("ZY");
+// each extra mismatch multiplies the permuted copies of the reference hash
+static const unsigned SEED_MISMATCHES_MAX = 2;
 
 #define BIN_8_QSCORE_MAP "0-1:0,2-9:7,10-19:11,20-24:22,25-29:27,30-34:32,35-39:37,40-63:40"
 
@@ -91,7 +94,7 @@ AlignOptions::AlignOptions()
 #endif //ISAAC_DEV_STATS_ENABLED
     , barcodeMismatchesStringList(1, "1")
     , hashTableBucketCount(0)
-    , referenceName("default")
+    , referenceNameList(1, "default")
     , tempDirectoryString("./Temp")
     , outputDirectoryString("./Aligned")
     , seedLength(16)
@@ -108,16 +111,21 @@ AlignOptions::AlignOptions()
     , targetBinSizeMB(0)
     , jobs(boost::thread::hardware_concurrency())
     , enableNuma(false)
+    , hugePagesString("off")
+    , hugePages(common::HugePagesOff)
     , candidateMatchesMax(800)
     , matchFinderTooManyRepeats(4000)
     , matchFinderWayTooManyRepeats(100000)
     , matchFinderShadowSplitRepeats(100000)
+    , seedExtensionRepeats(0)
+    , seedMismatches(0)
     , seedBaseQualityMin(3)
     , repeatThreshold(100)
     , mateDriftRange(-1)
     , neighborhoodSizeThreshold(0) //(10000) - disabled by default as so far the neighbor matcher only increased the probability of misplaced reads
     , startFromString("Start")
     , startFrom(workflow::AlignWorkflow::Start)
+    , resumeAlignment(false)
     , stopAtString("Finish")
     , stopAt(workflow::AlignWorkflow::Finish)
     , verbosity(2)
@@ -141,6 +149,8 @@ AlignOptions::AlignOptions()
     , realignedGapsPerFragment(4)
     , clipSemialigned(false) // Note that GATK jumps to 9000 conflict from 5000 if clipSemialigned is off
     , clipOverlapping(true)
+    , clipAdapterOverlap(false)
+    , keepReadNames(true)
     , scatterRepeats(true)
     , rescueShadows(true)
     , trimPEAdapters(true)
@@ -177,6 +187,8 @@ AlignOptions::AlignOptions()
     , realignGapsString("sample")
     , realignGaps(build::REALIGN_SAMPLE)
     , realignMapqMin(60)
+    , outputFormatString("bam")
+    , outputFormat(build::OUTPUT_BAM)
     , bamGzipLevel(boost::iostreams::gzip::best_speed)
     , bamPuFormat("%F:%L:%B")
     , bamProduceMd5(true)
@@ -187,15 +199,17 @@ AlignOptions::AlignOptions()
     , anchorMate(true)
     , binRegexString("all")
     , decoyRegexString("decoy")  //("(?!.*)") // negative lookahead regex should not match anything. So nothing is a decoy by default
+    , sampleClusters(0.0)
     , userTemplateLengthStatistics()
     , statsImageFormatString("none")
-    , statsImageFormat(reports::AlignmentReportGenerator::gif)
+    , statsImageFormat(reports::AlignmentReportGenerator::svg)
     , qScoreBin(false)
     , qScoreBinValueString("identity")
     , bamExcludeTags("ZX,ZY")
     , optionalFeatures(parseBamExcludeTags(bamExcludeTags))
     , pessimisticMapQ(false)
     , detectTemplateBlockSize(10000)
+    , perfTraceEvents(0)
     , disableResume(false)
 {
     static bool bufferBins = false;
@@ -273,8 +287,12 @@ AlignOptions::AlignOptions()
                 "Gaps from alignments with lower MAPQ will not be used as candidates for gap realignment")
         ("known-indels"           , bpo::value<std::string>(&knownIndelsPathString),
                 "path to a VCF file containing known indels fore realignment.")
+        ("output-format"            , bpo::value<std::string>(&outputFormatString)->default_value(outputFormatString),
+                "Format of the sorted alignment files."
+                "\n  - bam               : bgzf-compressed BAM with .bai index"
+                "\n  - cram              : CRAM 3.0 with .crai index. Sequences are stored as differences against the reference")
         ("bam-gzip-level"           , bpo::value<int>(&bamGzipLevel)->default_value(bamGzipLevel),
-                "Gzip level to use for BAM")
+                "Gzip level to use for BAM. Also applies to CRAM data blocks")
         ("bam-header-tag"           , bpo::value<std::vector<std::string> >(&bamHeaderTags)->multitoken(),
                 "Additional bam entries that are copied into the header of each produced bam file. Use '\\t' to represent tab separators.")
         ("bam-produce-md5"     , bpo::value<bool>(&bamProduceMd5)->default_value(bamProduceMd5),
@@ -295,6 +313,10 @@ AlignOptions::AlignOptions()
                 "When set, the MAPQ is computed as MAPQ:=min(60, min(SM, AS)), otherwise MAPQ:=min(60, max(SM, AS))")
         ("detect-template-block-size" , bpo::value<unsigned>(&detectTemplateBlockSize)->default_value(detectTemplateBlockSize),
             "Number of pairs to use as a single block for template length statistics detection")
+        ("perf-trace-events"        , bpo::value<unsigned>(&perfTraceEvents)->default_value(perfTraceEvents),
+            "When not 0, the duration of each processing stage is recorded and stored in Stats/PerfTrace.json "
+            "(chrome://tracing format) and Stats/PerfStages.tsv. The value is the maximum number of most recent "
+            "events kept for each thread.")
         ("description"              , bpo::value<std::string>(&description), "Free form text to be stored in the Isaac @PG DS bam header tag")
         ("tiles"                    , bpo::value<std::vector<std::string> >(&tilesFilterList),
                 "Comma-separated list of regular expressions to select only a subset of the tiles available in the flow-cell."
@@ -320,11 +342,13 @@ AlignOptions::AlignOptions()
         ("target-bin-size"            , bpo::value<uint64_t>(&targetBinSizeMB)->default_value(targetBinSizeMB),
             "Isaac will attempt to bin temporary data so that each bin is close to targetBinSize in megabytes "
             "(1024 * 1024 bytes). Value of 0 will cause Isaac to compute the target bin size automatically based on "
-            "the available memory.")
-        ("reference-genome,r"       , bpo::value<std::string>(&sortedReferenceXmlString),
-                "Full path to the reference genome XML descriptor."
+            "the available memory. Bins that grow larger due to coverage spikes are broken down by position for bam "
+            "generation.")
+        ("reference-genome,r"       , bpo::value<std::vector<std::string> >(&sortedReferenceXmlStringList),
+                "Full path to the reference genome XML descriptor. Multiple entries allowed. All references are aligned "
+                "against in the same pass over the data, each barcode against the reference it is mapped to."
             )
-        ("reference-name,n"       , bpo::value<std::string>(&referenceName)->default_value(referenceName),
+        ("reference-name,n"       , bpo::value<std::vector<std::string> >(&referenceNameList)->default_value(referenceNameList, referenceNameList.at(0)),
                 "Unique symbolic name of the reference. Multiple entries allowed. Each entry is associated with "
                 "the corresponding --reference-genome and will be matched against the 'reference' column "
                 "in the sample sheet. "
@@ -340,6 +364,13 @@ AlignOptions::AlignOptions()
                 "Maximum number of compute threads to run in parallel")
         ("enable-numa"                   , bpo::value<bool>(&enableNuma)->default_value(enableNuma)->implicit_value(true),
                 "Replicate static data across NUMA nodes, lock threads to their NUMA nodes, allocate thread private data on the corresponding NUMA node")
+        ("huge-pages"                    , bpo::value<std::string>(&hugePagesString)->default_value(hugePagesString),
+                "Put the reference, reference hash, base calls and other large buffers into huge pages to reduce TLB misses: "
+                "\n  - off             : Use regular pages."
+                "\n  - transparent     : Advise the kernel to back the buffers with transparent huge pages."
+                "\n  - 2m              : Use reserved 2MB huge pages. Falls back to transparent if none are available."
+                "\n  - 1g              : Same as 2m, except that buffers of 1GB and more use reserved 1GB pages."
+        )
         ("candidate-matches-max"                   , bpo::value<std::size_t>(&candidateMatchesMax)->default_value(candidateMatchesMax),
                 "Maximum number of candidate matches to be considered for finding the best alignment. If seeds yield a greater number, "
                 "the alignment generally is not performed. Other mechanisms such as shadow rescue may still place the fragment.")
@@ -350,6 +381,14 @@ AlignOptions::AlignOptions()
                 "has gone over match-finder-too-many-repeats on all seeds or over candidate-matches-max when seed position merge was attempted ")
         ("match-finder-shadow-split-repeats"                   , bpo::value<unsigned>(&matchFinderShadowSplitRepeats)->default_value(matchFinderShadowSplitRepeats),
                 "Maximum number of seed candidate matches to be considered for finding a possible alignment split.")
+        ("seed-extension-repeats"                   , bpo::value<unsigned>(&seedExtensionRepeats)->default_value(seedExtensionRepeats),
+                "Reference hash buckets with at least this many positions get indexed again by the seed followed by the next "
+                "seed-length bases. Seeds that exceed match-finder-too-many-repeats are then resolved with one extra lookup "
+                "instead of being dropped. Costs extra memory proportional to the number of indexed positions. 0 disables.")
+        ("seed-mismatches"                   , bpo::value<unsigned>(&seedMismatches)->default_value(seedMismatches),
+                "Number of mismatches tolerated when looking up seeds that have no exact match in the reference. "
+                "Requires one permuted copy of the reference kmers per combination of mismatching seed blocks: "
+                "2 copies for 1 mismatch, 6 copies for 2 mismatches. 0 disables.")
         ("seed-base-quality-min"                   , bpo::value<unsigned int>(&seedBaseQualityMin)->default_value(seedBaseQualityMin),
                 "Minimum base quality for the seed to be used in alignment candidate search.")
         ("input-concurrent-load"            , bpo::value<unsigned>(&inputLoadersMax)->default_value(inputLoadersMax),
@@ -374,11 +413,11 @@ AlignOptions::AlignOptions()
         ("start-from"               , bpo::value<std::string>(&startFromString)->default_value(startFromString),
                 "Start processing at the specified stage:"
                 "\n  - Start            : don't resume, start from beginning"
-                "\n  - Align            : same as Start"
+                "\n  - Align            : continue alignment from the last chunk of tiles completed by the interrupted run"
                 "\n  - AlignmentReports : regenerate alignment reports and bam"
                 "\n  - Bam              : resume at bam generation"
                 "\n  - Finish           : Same as Bam."
-                "\n  - Last             : resume from the last successful step"
+                "\n  - Last             : resume from the last successful step. Same as Align if alignment is not complete"
                 "\nNote that although Isaac attempts to perform some basic validation, the only safe option is 'Start' "
                 "The primary purpose of the feature is to reduce the time required to diagnose the issues rather than "
                 "be used on a regular basis."
@@ -456,6 +495,10 @@ AlignOptions::AlignOptions()
                 "Maximum read name length (fastq and bam only). Value of 0 causes the read name length to be determined "
                 "by reading the first records of the input data. Shorter than needed read names can cause duplicate "
                 "names in the output bam files.")
+        ("keep-read-names"      , bpo::value<bool>(&keepReadNames)->default_value(keepReadNames),
+                "Unset to discard the original read names of fastq and bam input. The names are then generated from "
+                "flowcell, lane, tile and cluster number the same way as for bcl input. Reduces the temporary file "
+                "sizes and the memory needed for bam generation.")
         ("pre-sort-bins"            , bpo::value<bool>(&preSortBins)->default_value(preSortBins),
             "Unset this value if you are working with references that have many contigs (1000+)")
         ("pre-allocate-bins"   , bpo::value<bool>(&preAllocateBins)->default_value(preAllocateBins),
@@ -471,6 +514,10 @@ AlignOptions::AlignOptions()
                 "When set, reads have their bases soft-clipped on either sides until a stretch of 5 matches is found")
         ("clip-overlapping"         , bpo::value<bool>(&clipOverlapping)->default_value(clipOverlapping),
                 "When set, the pairs that have read ends overlapping each other will have the lower-quality end soft-clipped.")
+        ("clip-adapter-overlap"     , bpo::value<bool>(&clipAdapterOverlap)->default_value(clipAdapterOverlap),
+                "When set, pairs with the insert shorter than the reads are detected before seeding by comparing the reads "
+                "with each other and with the adapter sequences. The adapter bases are then excluded from seeding and "
+                "soft-clipped. Saves time on short-insert libraries such as cfDNA and amplicons.")
 // gappedMismatchesMax is currently ignored in the implementation
 //        ("gapped-mismatches-max"   , bpo::value<unsigned>(&gappedMismatchesMax)->default_value(gappedMismatchesMax),
 //                "Maximum number of mismatches allowed to accept a gapped alignment when Smith-Waterman is used.")
@@ -549,12 +596,19 @@ AlignOptions::AlignOptions()
                 "all the memory on the system and cause it to crash. Default value is taken from ulimit -v.")
         ("cluster,c"                , bpo::value<std::vector<std::size_t> >(&clusterIdList)->multitoken(),
                 "Restrict the alignment to the specified cluster Id (multiple entries allowed)")
+        ("sample-clusters"          , bpo::value<double>(&sampleClusters)->default_value(sampleClusters),
+                "Align only a sample of clusters to quickly estimate the alignment and template length statistics. "
+                "Values below 1 give the fraction of clusters to align in each tile, values of 1 and above give "
+                "the number of clusters to align in each tile. The sampled clusters are spread evenly over the tile. "
+                "Unless --stop-at is specified, the processing stops after the alignment reports. "
+                "0 aligns all clusters.")
         ("tls"                      , bpo::value<std::string>(&tlsString),
                 "Template-length statistics in the format 'min:median:max:lowStdDev:highStdDev:M0:M1', "
                 "where M0 and M1 are the numeric value of the models (0=FFp, 1=FRp, 2=RFp, 3=RRp, 4=FFm, 5=FRm, 6=RFm, 7=RRm)")
         ("stats-image-format", bpo::value<std::string>(&statsImageFormatString)->default_value(statsImageFormatString),
                 "Format to use for images during stats generation"
-                "\n - gif        : produce .gif type plots"
+                "\n - svg        : produce .svg type plots"
+                "\n - gif        : same as svg. Kept for compatibility"
                 "\n - none       : no stat generation"
         )
         ("remap-qscores"   , bpo::value<std::string>(&qScoreBinValueString),
@@ -636,22 +690,26 @@ void AlignOptions::verifyMandatoryPaths(bpo::variables_map &vm)
         baseCallsDirectory = boost::filesystem::absolute(baseCallsDirectory);
     }
 
-    sortedReferenceXml = sortedReferenceXmlString;
-    if (sortedReferenceXml.empty())
-    {
-        const format message = format("\n   *** The 'reference-genome' can't be empty ***\n") % sortedReferenceXml;
-        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
-    }
-    if(!exists(sortedReferenceXml))
-    {
-        const format message = format("\n   *** The 'reference-genome' does not exist: %s ***\n") % sortedReferenceXml;
-        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
-    }
-    sortedReferenceXml = boost::filesystem::absolute(sortedReferenceXml);
-    if(!exists(sortedReferenceXml))
+    BOOST_FOREACH(const std::string &sortedReferenceXmlString, sortedReferenceXmlStringList)
     {
-        const format message = format("\n   *** The 'reference-genome' does not exist: %s ***\n") % sortedReferenceXml;
-        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        bfs::path sortedReferenceXml = sortedReferenceXmlString;
+        if (sortedReferenceXml.empty())
+        {
+            const format message = format("\n   *** The 'reference-genome' can't be empty ***\n") % sortedReferenceXml;
+            BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        }
+        if(!exists(sortedReferenceXml))
+        {
+            const format message = format("\n   *** The 'reference-genome' does not exist: %s ***\n") % sortedReferenceXml;
+            BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        }
+        sortedReferenceXml = boost::filesystem::absolute(sortedReferenceXml);
+        if(!exists(sortedReferenceXml))
+        {
+            const format message = format("\n   *** The 'reference-genome' does not exist: %s ***\n") % sortedReferenceXml;
+            BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        }
+        sortedReferenceXmlList.push_back(sortedReferenceXml);
     }
 
     tempDirectory = tempDirectoryString;
@@ -701,6 +759,20 @@ build::GapRealignerMode AlignOptions::parseGapRealignment()
     return build::REALIGN_NONE;
 }
 
+build::OutputFormat AlignOptions::parseOutputFormat()
+{
+    if(outputFormatString == "bam")
+    {
+        return build::OUTPUT_BAM;
+    }
+    else if(outputFormatString != "cram")
+    {
+        const format message = format("\n   *** The 'output-format' value is invalid %s ***\n") % outputFormatString;
+        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+    }
+    return build::OUTPUT_CRAM;
+}
+
 void AlignOptions::parseExecutionTargets()
 {
     const static std::vector<std::string> allowedStageStrings =
@@ -726,6 +798,8 @@ void AlignOptions::parseExecutionTargets()
         3 == startFromPos ? workflow::AlignWorkflow::AlignmentReportsDone :
         4 == startFromPos ? workflow::AlignWorkflow::BamDone :
                             workflow::AlignWorkflow::Last;
+    // the tile chunks completed by the alignment are recorded unless --disable-resume is set
+    resumeAlignment = 1 == startFromPos || 5 == startFromPos;
 
     std::vector<std::string>::const_iterator stopAtIt =
         std::find(allowedStageStrings.begin(), allowedStageStrings.end(), stopAtString);
@@ -747,6 +821,21 @@ void AlignOptions::parseExecutionTargets()
                          workflow::AlignWorkflow::Last;
 }
 
+void AlignOptions::parseSampleClusters(const bpo::variables_map &vm)
+{
+    if (0.0 > sampleClusters)
+    {
+        const format message = format("\n   *** The 'sample-clusters' value must not be negative: %f ***\n") % sampleClusters;
+        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+    }
+
+    if (sampleClusters && vm["stop-at"].defaulted())
+    {
+        // bam built from the sample is of little use. Reports is all that is needed for the estimates.
+        stopAt = workflow::AlignWorkflow::AlignmentReportsDone;
+    }
+}
+
 void AlignOptions::parseMemoryControl()
 {
     const std::vector<std::string> allowedMemoryControlStrings =
@@ -772,6 +861,21 @@ void AlignOptions::parseMemoryControl()
     }
 }
 
+void AlignOptions::parseHugePages()
+{
+    const std::vector<std::string> allowedHugePagesStrings =
+        boost::assign::list_of("off")("transparent")("2m")("1g");
+    std::vector<std::string>::const_iterator hugePagesIt =
+        std::find(allowedHugePagesStrings.begin(), allowedHugePagesStrings.end(), hugePagesString);
+    if (allowedHugePagesStrings.end() == hugePagesIt)
+    {
+        const boost::format message = boost::format("\n   *** Invalid value given '%s' for --huge-pages ***\n") %
+            hugePagesString;
+        BOOST_THROW_EXCEPTION(common::InvalidOptionException(message.str()));
+    }
+    hugePages = common::HugePages(hugePagesIt - allowedHugePagesStrings.begin());
+}
+
 void AlignOptions::parseGapScoring()
 {
     if ("bwa" == gapScoringString)
@@ -990,14 +1094,36 @@ void AlignOptions::parseTemplateLength()
 
 void AlignOptions::parseReferenceGenomes()
 {
-    referenceMetadataList.push_back(reference::ReferenceMetadata(referenceName, sortedReferenceXml, referenceMetadataList.size()));
+    if (referenceNameList.size() != sortedReferenceXmlList.size())
+    {
+        const format message = format("\n   *** The number of 'reference-name' (%d) must match the number of "
+            "'reference-genome' (%d) ***\n") % referenceNameList.size() % sortedReferenceXmlList.size();
+        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+    }
+    for (std::size_t i = 0; sortedReferenceXmlList.size() != i; ++i)
+    {
+        const std::vector<std::string>::const_iterator previous = referenceNameList.begin() + i;
+        if (previous != std::find<std::vector<std::string>::const_iterator>(referenceNameList.begin(), previous, referenceNameList.at(i)))
+        {
+            const format message = format("\n   *** The 'reference-name' must be unique: %s ***\n") % referenceNameList.at(i);
+            BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        }
+        referenceMetadataList.push_back(reference::ReferenceMetadata(
+            referenceNameList.at(i), sortedReferenceXmlList.at(i), referenceMetadataList.size()));
+    }
+    if (1 < referenceMetadataList.size() && !knownIndelsPath.empty())
+    {
+        const format message = format("\n   *** The 'known-indels' is not supported with multiple 'reference-genome' ***\n");
+        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+    }
 }
 
 void AlignOptions::parseStatsImageFormat()
 {
-    if(statsImageFormatString == "gif")
+    // gif is no longer produced. Accept it as svg so that the existing command lines still work
+    if(statsImageFormatString == "svg" || statsImageFormatString == "gif")
     {
-        statsImageFormat = reports::AlignmentReportGenerator::gif;
+        statsImageFormat = reports::AlignmentReportGenerator::svg;
     }
     else if(statsImageFormatString == "none")
     {
@@ -1267,6 +1393,15 @@ void AlignOptions::postProcess(bpo::variables_map &vm)
             " is not supported. ***\n"));
     }
 
+    if (SEED_MISMATCHES_MAX < seedMismatches ||
+        (seedMismatches && (seedLength % (2 * common::upperPowerOfTwo(seedMismatches)))))
+    {
+        const format message = format("\n   *** --seed-mismatches %d is not supported with --seed-length %d. "
+            "At most %d mismatches can be tolerated and seed length must split into %d blocks ***\n") %
+            seedMismatches % seedLength % SEED_MISMATCHES_MAX % (2 * common::upperPowerOfTwo(seedMismatches));
+        BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+    }
+
     std::vector<boost::filesystem::path> sampleSheetPathList = parseSampleSheetPaths();
     for (std::size_t i = 0; baseCallsDirectoryList.size() > i; ++i)
     {
@@ -1381,11 +1516,14 @@ void AlignOptions::postProcess(bpo::variables_map &vm)
     }
 
     realignGaps = parseGapRealignment();
+    outputFormat = parseOutputFormat();
     std::for_each(bamHeaderTags.begin(), bamHeaderTags.end(), unescapeSlashT);
     validateSampleSheets(realignGaps, barcodeMetadataList);
 
     parseExecutionTargets();
+    parseSampleClusters(vm);
     parseMemoryControl();
+    parseHugePages();
     parseGapScoring();
     parseSmithWatermanOptions();
     parseDodgyAlignmentScore();
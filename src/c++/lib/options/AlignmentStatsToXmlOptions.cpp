@@ -0,0 +1,64 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file AlignmentStatsToXmlOptions.cpp
+ **
+ ** Command line options for 'alignmentStatsToXml'
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <string>
+#include <vector>
+#include <boost/assign.hpp>
+#include <boost/foreach.hpp>
+
+#include "options/AlignmentStatsToXmlOptions.hh"
+
+namespace isaac
+{
+namespace options
+{
+
+namespace bpo = boost::program_options;
+
+AlignmentStatsToXmlOptions::AlignmentStatsToXmlOptions()
+{
+    namedOptions_.add_options()
+        ("input-file,i",        bpo::value<boost::filesystem::path>(&inputFile),
+                                "AlignmentStats.bin produced by isaac-align")
+        ("output-file,o",       bpo::value<boost::filesystem::path>(&outputFile),
+                                "Path of the AlignmentStats.xml to produce")
+        ;
+}
+
+void AlignmentStatsToXmlOptions::postProcess(bpo::variables_map &vm)
+{
+    if(vm.count("help"))
+    {
+        return;
+    }
+    using isaac::common::InvalidOptionException;
+    using boost::format;
+    const std::vector<std::string> requiredOptions = boost::assign::list_of("input-file")("output-file");
+    BOOST_FOREACH(const std::string &required, requiredOptions)
+    {
+        if(!vm.count(required))
+        {
+            const format message = format("\n   *** The '%s' option is required ***\n") % required;
+            BOOST_THROW_EXCEPTION(InvalidOptionException(message.str()));
+        }
+    }
+}
+
+} //namespace option
+} // namespace isaac
@@ -292,6 +292,107 @@ ReferenceHashT ReferenceHasher<ReferenceHashT>::generate(const uint64_t bucketCo
     return ret;
 }
 
+template <typename ReferenceHashT>
+ReferenceHashT ReferenceHasher<ReferenceHashT>::generate(const uint64_t bucketCount, const unsigned extensionRepeatsMin)
+{
+    return generate(bucketCount, extensionRepeatsMin, 0);
+}
+
+template <typename ReferenceHashT>
+ReferenceHashT ReferenceHasher<ReferenceHashT>::generate(
+    const uint64_t bucketCount, const unsigned extensionRepeatsMin, const unsigned seedMismatches)
+{
+    ReferenceHashT ret(bucketCount);
+
+    generate(ret);
+    if (extensionRepeatsMin)
+    {
+        extend(ret, extensionRepeatsMin);
+    }
+    if (seedMismatches)
+    {
+        permutate(ret, seedMismatches);
+    }
+
+    return ret;
+}
+
+/**
+ * \brief Indexes positions of each extended bucket by the kmer that follows the bucket kmer in the reference.
+ *        Buckets are interleaved between threads as the repetitive ones tend to be clustered by key.
+ */
+template <typename ReferenceHashT>
+void ReferenceHasher<ReferenceHashT>::extendBuckets(
+    ReferenceHashT &referenceHash,
+    const unsigned threadNumber,
+    const std::size_t threads) const
+{
+    static const unsigned KMER_BASES = oligo::KmerTraits<KmerT>::KMER_BASES;
+    const oligo::Translator<> translator;
+    std::vector<std::pair<KmerT, Offset> > extensions;
+    for (std::size_t bucketIndex = threadNumber; referenceHash.extendedBuckets_.size() > bucketIndex; bucketIndex += threads)
+    {
+        typename ReferenceHashT::ExtendedBucket &bucket = referenceHash.extendedBuckets_[bucketIndex];
+        const typename ReferenceHashT::MatchRange positions = std::make_pair(
+            referenceHash.positions_.begin() + (bucket.key_ ? referenceHash.offsets_[bucket.key_ - 1] : 0),
+            referenceHash.positions_.begin() + referenceHash.offsets_[bucket.key_]);
+
+        extensions.clear();
+        for (typename ReferenceHashT::const_iterator it = positions.first; positions.second != it; ++it)
+        {
+            const Offset extensionOffset = *it + KMER_BASES;
+            KmerT extension(0);
+            if (extensionOffset + KMER_BASES <= contigList_.endOffset(contigList_.contigIdFromOffset(*it)) &&
+                oligo::makeKmer<KMER_BASES>(contigList_.referenceBegin() + extensionOffset, translator, extension))
+            {
+                extensions.push_back(std::make_pair(extension, *it));
+            }
+        }
+        std::sort(extensions.begin(), extensions.end());
+
+        bucket.end_ = bucket.begin_ + extensions.size();
+        Offset offset = bucket.begin_;
+        for (const std::pair<KmerT, Offset> &extension : extensions)
+        {
+            referenceHash.extensionKmers_[offset] = extension.first;
+            referenceHash.extensionPositions_[offset] = extension.second;
+            ++offset;
+        }
+    }
+}
+
+template <typename ReferenceHashT>
+void ReferenceHasher<ReferenceHashT>::extend(ReferenceHashT &ret, const unsigned extensionRepeatsMin)
+{
+    ISAAC_ASSERT_MSG(extensionRepeatsMin, "Extension of all buckets is not supported");
+    ret.extensionRepeatsMin_ = extensionRepeatsMin;
+    ret.extendedBuckets_.clear();
+
+    Offset total = 0;
+    for (std::size_t key = 0; ret.offsets_.size() != key; ++key)
+    {
+        const Offset count = ret.offsets_[key] - (key ? ret.offsets_[key - 1] : 0);
+        if (extensionRepeatsMin <= count)
+        {
+            const typename ReferenceHashT::ExtendedBucket bucket = {typename ReferenceHashT::KeyT(key), total, total + count};
+            ret.extendedBuckets_.push_back(bucket);
+            total += count;
+        }
+    }
+
+    ret.extensionKmers_.resize(total, KmerT(0));
+    ret.extensionPositions_.resize(total);
+
+    threads_.execute(
+        [this, &ret](const unsigned threadNumber, const std::size_t threads)
+        {
+            extendBuckets(ret, threadNumber, threads);
+        }, threadsMax_);
+
+    ISAAC_THREAD_CERR << " extended " << ret.extendedBuckets_.size() << " buckets with at least " <<
+        extensionRepeatsMin << " positions. " << total << " positions indexed" << std::endl;
+}
+
 //template<typename ReferenceHashT>
 //void ReferenceHasher<ReferenceHashT>::dumpDistribution(ReferenceHashT& ret)
 //{
@@ -377,6 +478,130 @@ void ReferenceHasher<ReferenceHashT>::generate(ReferenceHashT &ret)
 
     ISAAC_THREAD_CERR << " sorted " << ret.offsets_.back() << " positions" << std::endl;
 }
+template <typename ReferenceHashT>
+bool ReferenceHasher<ReferenceHashT>::canPermutate(const unsigned seedMismatches)
+{
+    const unsigned blocksCount = 2 * common::upperPowerOfTwo(seedMismatches);
+    return seedMismatches && !(oligo::KmerTraits<KmerT>::KMER_BASES % blocksCount);
+}
+
+/**
+ * \brief Orders the kmers of each permuted prefix by kmer and position. Prefixes are interleaved between threads
+ */
+template <typename ReferenceHashT>
+void ReferenceHasher<ReferenceHashT>::sortPermutedPrefixes(
+    ReferenceHashT &referenceHash,
+    const unsigned threadNumber,
+    const std::size_t threads)
+{
+    std::vector<std::pair<KmerT, Offset> > entries;
+    for (std::size_t prefix = threadNumber; referenceHash.permutedPrefixOffsets_.size() > prefix + 1; prefix += threads)
+    {
+        const Offset begin = referenceHash.permutedPrefixOffsets_[prefix];
+        const Offset end = referenceHash.permutedPrefixOffsets_[prefix + 1];
+        // the last offset of one permutation is followed by the first offset of the next one
+        if (begin < end)
+        {
+            entries.clear();
+            for (Offset entry = begin; end != entry; ++entry)
+            {
+                entries.push_back(std::make_pair(referenceHash.permutedKmers_[entry], referenceHash.permutedPositions_[entry]));
+            }
+            std::sort(entries.begin(), entries.end());
+            Offset entry = begin;
+            for (const std::pair<KmerT, Offset> &kmerPosition : entries)
+            {
+                referenceHash.permutedKmers_[entry] = kmerPosition.first;
+                referenceHash.permutedPositions_[entry] = kmerPosition.second;
+                ++entry;
+            }
+        }
+    }
+}
+
+/**
+ * \brief Builds one copy of the reference kmers for each block permutation, bucketed by the permuted prefix which
+ *        is required to match exactly.
+ */
+template <typename ReferenceHashT>
+void ReferenceHasher<ReferenceHashT>::permutate(ReferenceHashT &ret, const unsigned seedMismatches)
+{
+    static const unsigned KMER_BASES = oligo::KmerTraits<KmerT>::KMER_BASES;
+    static const unsigned KMER_BITS = oligo::KmerTraits<KmerT>::KMER_BITS;
+    if (!canPermutate(seedMismatches))
+    {
+        BOOST_THROW_EXCEPTION(common::InvalidParameterException(
+            (boost::format("%d-mers can't be split into blocks required to tolerate %d mismatches") %
+                KMER_BASES % seedMismatches).str()));
+    }
+
+    const unsigned blocksCount = 2 * common::upperPowerOfTwo(seedMismatches);
+    ret.seedMismatches_ = seedMismatches;
+    // the exact blocks can be longer than a reasonable prefix table. The scan checks the whole kmer anyway.
+    ret.prefixBits_ = std::min(KMER_BITS / blocksCount * (blocksCount - seedMismatches), unsigned(PERMUTED_PREFIX_BITS_MAX));
+    // prefix length above chain length ensures all permutations are applied to the original kmer
+    ret.permutations_ = oligo::getPermutateList<KmerT>(seedMismatches, KMER_BITS + 1, false);
+
+    const std::size_t permutationsCount = ret.permutations_.size();
+    const uint64_t prefixCount = uint64_t(1) << ret.prefixBits_;
+    const unsigned suffixBits = KMER_BITS - ret.prefixBits_;
+    const std::size_t kmers = ret.positions_.size();
+    ISAAC_TRACE_STAT("ReferenceHasher::permutate: " << permutationsCount << " permutations of " << kmers <<
+                     " kmers with " << ret.prefixBits_ << "-bit prefixes");
+
+    ret.permutedPrefixOffsets_.assign(permutationsCount * (prefixCount + 1), 0);
+    ret.permutedKmers_.resize(permutationsCount * kmers, KmerT(0));
+    ret.permutedPositions_.resize(permutationsCount * kmers);
+
+    const oligo::Translator<> translator;
+    const auto referenceKmer = [this, &translator](const Offset position) -> KmerT
+    {
+        KmerT kmer(0);
+        ISAAC_VERIFY_MSG(oligo::makeKmer<KMER_BASES>(contigList_.referenceBegin() + position, translator, kmer),
+                         "Invalid kmer at hashed position " << position);
+        return kmer;
+    };
+
+    // count the prefixes shifted by one so that the partial sums produce the beginnings
+    for (const Offset position : ret.positions_)
+    {
+        const KmerT kmer = referenceKmer(position);
+        for (std::size_t permutation = 0; permutationsCount != permutation; ++permutation)
+        {
+            ++ret.permutedPrefixOffsets_[permutation * (prefixCount + 1) + (ret.permutations_[permutation](kmer).bits_ >> suffixBits) + 1];
+        }
+    }
+    Offset total = 0;
+    for (Offset &offset : ret.permutedPrefixOffsets_)
+    {
+        total += offset;
+        offset = total;
+    }
+    ISAAC_ASSERT_MSG(permutationsCount * kmers == total, "Permuted kmer count mismatch " << total);
+
+    Offsets cursors(ret.permutedPrefixOffsets_.begin(), ret.permutedPrefixOffsets_.end());
+    for (const Offset position : ret.positions_)
+    {
+        const KmerT kmer = referenceKmer(position);
+        for (std::size_t permutation = 0; permutationsCount != permutation; ++permutation)
+        {
+            const KmerT permuted = ret.permutations_[permutation](kmer);
+            const Offset entry = cursors[permutation * (prefixCount + 1) + (permuted.bits_ >> suffixBits)]++;
+            ret.permutedKmers_[entry] = permuted;
+            ret.permutedPositions_[entry] = position;
+        }
+    }
+
+    threads_.execute(
+        [&ret](const unsigned threadNumber, const std::size_t threads)
+        {
+            sortPermutedPrefixes(ret, threadNumber, threads);
+        }, threadsMax_);
+
+    ISAAC_THREAD_CERR << " permuted " << kmers << " kmers " << permutationsCount << " times to tolerate " <<
+        seedMismatches << " mismatches" << std::endl;
+}
+
 //
 template class ReferenceHasher<ReferenceHash<oligo::VeryShortKmerType> >;
 //template class ReferenceHasher<ReferenceHash<oligo::BasicKmerType<16>, common::NumaAllocator<void, 0> > >;
@@ -150,6 +150,40 @@ bool SortedReferenceMetadata::singleFileReference() const {
     return contigs_.end() == different;
 }
 
+SortedReferenceMetadata::Contigs mergeContigs(const SortedReferenceMetadataList &sortedReferenceMetadataList)
+{
+    if (1 == sortedReferenceMetadataList.size())
+    {
+        return sortedReferenceMetadataList.front().getContigs();
+    }
+
+    SortedReferenceMetadata::Contigs ret;
+    for (const SortedReferenceMetadata &sortedReferenceMetadata : sortedReferenceMetadataList)
+    {
+        const SortedReferenceMetadata::Contigs &contigs = sortedReferenceMetadata.getContigs();
+        if (ret.size() < contigs.size())
+        {
+            ret.resize(contigs.size());
+        }
+        for (std::size_t i = 0; contigs.size() != i; ++i)
+        {
+            if (ret[i].totalBases_ < contigs[i].totalBases_ || ret[i].name_.empty())
+            {
+                ret[i] = contigs[i];
+            }
+        }
+    }
+
+    uint64_t genomicPosition = 0;
+    for (std::size_t i = 0; ret.size() != i; ++i)
+    {
+        ret[i].index_ = i;
+        ret[i].genomicPosition_ = genomicPosition;
+        genomicPosition += ret[i].totalBases_;
+    }
+    return ret;
+}
+
 } // namespace reference
 } // namespace isaac
 
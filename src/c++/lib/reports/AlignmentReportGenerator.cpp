@@ -12,175 +12,868 @@
  **
  ** \file AlignmentReportGenerator.cpp
  **
- ** Reorders aligned data and stores results in bam file.
+ ** Generates the html alignment reports and svg charts from the alignment statistics.
  **
  ** \author Roman Petrovski
  **/
 
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <set>
+
 #include <boost/filesystem.hpp>
-#include <boost/foreach.hpp>
 #include <boost/format.hpp>
 
 #include "config.h"
-//#include <libxml/xmlmemory.h>
-//#include <libxml/debugXML.h>
-//#include <libxml/HTMLtree.h>
-//#include <libxml/xmlIO.h>
-//#include <libxml/DOCBparser.h>
-//#include <libxml/xinclude.h>
-//#include <libxml/catalog.h>
-#include <libxslt/xslt.h>
-#include <libxslt/xsltInternals.h>
-#include <libxslt/transform.h>
-#include <libxslt/xsltutils.h>
-#include <libexslt/exslt.h>
 
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
 #include "common/FileSystem.hh"
-#include "common/Process.hh"
-#include "flowcell/BarcodeMetadata.hh"
+#include "common/Threads.hpp"
+#include "demultiplexing/Barcode.hh"
 #include "package/InstallationPaths.hh"
 #include "reports/AlignmentReportGenerator.hh"
-
-extern int xmlLoadExtDtdDefaultValue;
+#include "reports/SvgWriter.hh"
+#include "reports/TileMismatchCharts.hh"
 
 namespace isaac
 {
 namespace reports
 {
 
+namespace
+{
+
+static const std::string ALL("all");
+// flowcell id, project, sample, barcode
+typedef std::tuple<std::string, std::string, std::string, std::string> NodeNames;
+static const char *CSS_FILE_NAME = "Report.css";
+// relative path from a node page to the root of html directory
+static const std::string NODE_TO_HTML_ROOT("../../../../");
+// relative path from a node page to the root of images directory
+static const std::string NODE_TO_IMAGES_ROOT("../../../../../svg/");
+
+static const boost::format INDEX_PAGE_FORMAT(
+    "<html>\n"
+    "<frameset cols=\"15%%, 85%%\">\n"
+    "    <frame src=\"tree.html\"/>\n"
+    "    <frame name=\"flowcellsummaryframe\"/>\n"
+    "</frameset>\n"
+    "<body>\n"
+    "<p>%s</p>\n"
+    "</body>\n"
+    "</html>\n");
+
+static const boost::format NODE_PAGE_HEADER_FORMAT(
+    "<html>\n"
+    "<link rel=\"stylesheet\" href=\"%s%s\" type=\"text/css\"/>\n"
+    "<body>\n"
+    "<table width=\"100%%\">\n"
+    "    <tr>\n"
+    "        <td><p>%s</p></td>\n"
+    "        <td>%s</td>\n"
+    "    </tr>\n"
+    "</table>\n");
+
+static const boost::format ALTERNATIVE_VIEW_FORMAT("<p align=\"right\"><a href=\"%s\">%s</a></p>");
+
+static const boost::format MISMATCH_LINKS_FORMAT(
+    "<p>\n"
+    "Flowcell Tile Mismatch Graphs\n"
+    "<a href=\"%1%%2%/all/all/all/PfCycleMismatches.html\">Pf</a> / "
+    "<a href=\"%1%%2%/all/all/all/RawCycleMismatches.html\">Raw</a>\n"
+    "</p>\n"
+    "<p>\n"
+    "Flowcell Tile Mismatch Curves\n"
+    "<a href=\"%1%%2%/all/all/all/PfCycleMismatchFragments.html\">Pf</a> / "
+    "<a href=\"%1%%2%/all/all/all/RawCycleMismatchFragments.html\">Raw</a>\n"
+    "</p>\n");
+
+static const boost::format PAGE_FOOTER_FORMAT(
+    "<p>%s</p>\n"
+    "</body>\n"
+    "</html>\n");
+
+static const boost::format TREE_LINK_FORMAT(
+    "<tr>%s<td colspan=\"%d\"><a href=\"%s/lane.html\" target=\"flowcellsummaryframe\">%s</a></td></tr>\n");
+
+static const boost::format TILE_IMAGE_CELL_FORMAT(
+    "<td><a href=\"%1%%2%.svg\"><img height=\"84\" width=\"84\" src=\"%1%%2%_thumb.svg\"/></a></td>");
+
+void openOutput(const boost::filesystem::path &path, std::ofstream &os)
+{
+    os.open(path.c_str());
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open file for writing: " + path.string()));
+    }
+}
+
+void checkOutput(const std::ostream &os, const boost::filesystem::path &path)
+{
+    if (!os)
+    {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write file: " + path.string()));
+    }
+}
+
+std::string formatCount(const uint64_t count)
+{
+    std::string ret = boost::lexical_cast<std::string>(count);
+    for (int pos = int(ret.size()) - 3; 0 < pos; pos -= 3)
+    {
+        ret.insert(pos, 1, ',');
+    }
+    return ret;
+}
+
+std::string formatPercent(const uint64_t count, const uint64_t total)
+{
+    return total ? (boost::format("%.2f") % (100.0 * count / total)).str() : std::string();
+}
+
+std::string formatRatio(const uint64_t value, const uint64_t total)
+{
+    return total ? (boost::format("%.2f") % (double(value) / total)).str() : std::string();
+}
+
+std::string formatMbases(const uint64_t bases)
+{
+    return formatCount(std::llround(bases / 1000000.0));
+}
+
+std::string formatPercentPair(const uint64_t uniqueCount, const uint64_t uniqueTotal, const uint64_t count, const uint64_t total)
+{
+    const std::string unique = formatPercent(uniqueCount, uniqueTotal);
+    const std::string all = formatPercent(count, total);
+    return unique.empty() && all.empty() ? std::string() : unique + " / " + all;
+}
+
+std::string formatCountPercent(const uint64_t count, const uint64_t total)
+{
+    return total ? formatCount(count) + "<br/>(" + formatPercent(count, total) + "%)" : std::string();
+}
+
+/**
+ * \brief mean +/- population standard deviation of the values collected from individual tiles
+ */
+template <typename GetterT>
+std::string formatMeanAndStddev(const std::vector<alignment::TemplateLengthStatistics> &tileStats, GetterT getter)
+{
+    if (tileStats.empty())
+    {
+        return "0";
+    }
+    double sum = 0.0;
+    for (const alignment::TemplateLengthStatistics &stats : tileStats)
+    {
+        sum += getter(stats);
+    }
+    const double mean = sum / tileStats.size();
+    if (3 > tileStats.size())
+    {
+        return (boost::format("%.0f") % mean).str();
+    }
+    double squares = 0.0;
+    for (const alignment::TemplateLengthStatistics &stats : tileStats)
+    {
+        squares += (getter(stats) - mean) * (getter(stats) - mean);
+    }
+    return (boost::format("%.0f +/-%.0f") % mean % std::sqrt(squares / tileStats.size())).str();
+}
+
+std::string getFlowcellDisplayName(const std::string &name)
+{
+    return ALL == name ? "[all flowcells]" : escapeXml(name);
+}
+
+std::string getProjectDisplayName(const std::string &name)
+{
+    return ALL == name ? "[all projects]" :
+        flowcell::BarcodeMetadata::DEFAULT_PROJECT == name ? "[default project]" : escapeXml(name);
+}
+
+std::string getSampleDisplayName(const std::string &name)
+{
+    return ALL == name ? "[all samples]" :
+        flowcell::BarcodeMetadata::UNKNOWN_SAMPLE == name ? "[unknown sample]" : escapeXml(name);
+}
+
+std::string getBarcodeDisplayName(const std::string &name)
+{
+    return ALL == name ? "[all barcodes]" :
+        flowcell::BarcodeMetadata::UNKNOWN_BARCODE == name ? "[unknown barcode]" : escapeXml(name);
+}
+
+/**
+ * \brief on the pages that list individual barcodes, each of the project, sample, barcode aggregated on the page
+ *        is expanded into the individual values
+ */
+bool rowMatches(const std::string &pageValue, const std::string &rowValue)
+{
+    return ALL == pageValue ? ALL != rowValue : pageValue == rowValue;
+}
+
+std::string getTileImagePath(
+    const flowcell::TileMetadata &tile, const bool passesFilter, const bool curves)
+{
+    return (boost::format("s_%d_%04d_%s_%s") %
+        tile.getLane() % tile.getTile() % (passesFilter ? "Pf" : "Raw") %
+        (curves ? "mismatch-fragments" : "mismatches")).str();
+}
+
+/**
+ * \brief lane number followed by project, sample and barcode columns for the values that are aggregated on the page
+ */
+void writeLaneHeaderColumns(std::ostream &os, const NodeNames &node, const bool showBarcodes)
+{
+    os << "<th>#</th>";
+    if (showBarcodes)
+    {
+        if (ALL == std::get<1>(node))
+        {
+            os << "<th>Project</th>";
+        }
+        if (ALL == std::get<2>(node))
+        {
+            os << "<th>Sample</th>";
+        }
+        if (ALL == std::get<3>(node))
+        {
+            os << "<th>Barcode sequence</th>";
+        }
+    }
+}
+
+unsigned getLaneExtraColumns(const NodeNames &node, const bool showBarcodes)
+{
+    return showBarcodes ? (ALL == std::get<1>(node)) + (ALL == std::get<2>(node)) + (ALL == std::get<3>(node)) : 0;
+}
+
+void writeLaneColumns(
+    std::ostream &os,
+    const NodeNames &node,
+    const NodeNames &rowNode,
+    const unsigned lane,
+    const bool showBarcodes)
+{
+    os << "<td>" << lane << "</td>";
+    if (showBarcodes)
+    {
+        if (ALL == std::get<1>(node))
+        {
+            os << "<td>" << getProjectDisplayName(std::get<1>(rowNode)) << "</td>";
+        }
+        if (ALL == std::get<2>(node))
+        {
+            os << "<td>" << getSampleDisplayName(std::get<2>(rowNode)) << "</td>";
+        }
+        if (ALL == std::get<3>(node))
+        {
+            os << "<td>" << getBarcodeDisplayName(std::get<3>(rowNode)) << "</td>";
+        }
+    }
+}
+
+} // anonymous namespace
+
 AlignmentReportGenerator::AlignmentReportGenerator(
-    const std::vector<flowcell::Layout> &flowcellLayoutList,
+    const flowcell::FlowcellLayoutList &flowcellLayoutList,
     const flowcell::BarcodeMetadataList &barcodeMetadataList,
-    const boost::filesystem::path &alignmentStatsXmlPath,
-    const boost::filesystem::path &demultiplexingStatsXmlPath,
-    const boost::filesystem::path &tempDirectory,
+    const flowcell::TileMetadataList &tileMetadataList,
+    const std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats,
+    const demultiplexing::DemultiplexingStats &demultiplexingStats,
     const boost::filesystem::path &outputDirectory,
-    const ImageFileFormat imageFileFormat)
+    const ImageFileFormat imageFileFormat,
+    const unsigned threads)
     :flowcellLayoutList_(flowcellLayoutList),
-     alignmentStatsXmlPath_(alignmentStatsXmlPath),
-     demultiplexingStatsXmlPath_(demultiplexingStatsXmlPath),
-     tempDirectory_(tempDirectory),
-     gnuplotScriptPath_(tempDirectory_/"gnuplot-generate-images.dat"),
+     barcodeMetadataList_(barcodeMetadataList),
+     tileMetadataList_(tileMetadataList),
+     tileStats_(tileStats),
+     demultiplexingStats_(demultiplexingStats),
      outputDirectoryHtml_(outputDirectory/"html"),
-     outputDirectoryImages_(outputDirectory/"gif"),
-     imageFileFormat_(imageFileFormat)
-
-{
-    std::vector<boost::filesystem::path> createList =
-        boost::assign::list_of(outputDirectoryHtml_)(outputDirectoryImages_);
-    createList.push_back(outputDirectoryHtml_/"all");
-    createList.push_back(outputDirectoryHtml_/"all"/"all");
-    createList.push_back(outputDirectoryHtml_/"all"/"all"/"all");
-    createList.push_back(outputDirectoryHtml_/"all"/"all"/"all"/"all");
-    BOOST_FOREACH(const flowcell::BarcodeMetadata &barcodeMetadata, barcodeMetadataList)
-    {
-        createList.push_back(outputDirectoryHtml_/"all"/barcodeMetadata.getProject());
-        createList.push_back(outputDirectoryHtml_/"all"/barcodeMetadata.getProject()/"all");
-        createList.push_back(outputDirectoryHtml_/"all"/barcodeMetadata.getProject()/"all"/"all");
-        createList.push_back(outputDirectoryHtml_/"all"/barcodeMetadata.getProject()/barcodeMetadata.getSampleName());
-        createList.push_back(outputDirectoryHtml_/"all"/barcodeMetadata.getProject()/barcodeMetadata.getSampleName()/"all");
-    }
-    BOOST_FOREACH(const flowcell::Layout& flowcell, flowcellLayoutList_)
-    {
-        const boost::filesystem::path flowcellHtmlPath = outputDirectoryHtml_ / flowcell.getFlowcellId();
-        createList.push_back(flowcellHtmlPath);
-        const boost::filesystem::path flowcellImagesPath = outputDirectoryImages_ / flowcell.getFlowcellId();
-        createList.push_back(flowcellImagesPath);
-        createList.push_back(flowcellHtmlPath/"all");
-        createList.push_back(flowcellHtmlPath/"all"/"all");
-        createList.push_back(flowcellHtmlPath/"all"/"all"/"all");
-        createList.push_back(flowcellImagesPath/"all");
-        createList.push_back(flowcellImagesPath/"all"/"all");
-        createList.push_back(flowcellImagesPath/"all"/"all"/"all");
-        BOOST_FOREACH(const flowcell::BarcodeMetadata &barcodeMetadata, barcodeMetadataList)
-        {
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject());
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject()/"all");
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject()/"all"/"all");
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject()/barcodeMetadata.getSampleName());
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject()/barcodeMetadata.getSampleName()/"all");
-            createList.push_back(flowcellHtmlPath/barcodeMetadata.getProject()/barcodeMetadata.getSampleName()/barcodeMetadata.getName());
-
-//            createList.push_back(flowcellImagesPath/barcodeMetadata.getProject());
-//            createList.push_back(flowcellImagesPath/barcodeMetadata.getProject()/barcodeMetadata.getSampleName());
-//            createList.push_back(flowcellImagesPath/barcodeMetadata.getProject()/barcodeMetadata.getSampleName()/barcodeMetadata.getName());
+     outputDirectoryImages_(outputDirectory/"svg"),
+     imageFileFormat_(imageFileFormat),
+     threads_(threads)
+{
+    ISAAC_ASSERT_MSG(tileStats_.size() >= tileMetadataList_.size(), "Statistics are required for all tiles " <<
+                     tileStats_.size() << " < " << tileMetadataList_.size());
+}
+
+std::vector<AlignmentReportGenerator::Node> AlignmentReportGenerator::getBarcodeNodes(
+    const flowcell::BarcodeMetadata &barcode)
+{
+    const std::string &flowcellId = barcode.getFlowcellId();
+    const std::string &project = barcode.getProject();
+    const std::string &sample = barcode.getSampleName();
+    return std::vector<Node>{
+        Node(flowcellId, project, sample, barcode.getName()),
+        Node(flowcellId, project, sample, ALL),
+        Node(flowcellId, project, ALL, ALL),
+        Node(flowcellId, ALL, ALL, ALL),
+        Node(ALL, project, sample, ALL),
+        Node(ALL, project, ALL, ALL),
+        Node(ALL, ALL, ALL, ALL)};
+}
+
+boost::filesystem::path AlignmentReportGenerator::getNodePath(const Node &node)
+{
+    return boost::filesystem::path(std::get<0>(node)) / std::get<1>(node) / std::get<2>(node) / std::get<3>(node);
+}
+
+void AlignmentReportGenerator::aggregateStats()
+{
+    nodeStats_.clear();
+    for (const flowcell::TileMetadata &tile : tileMetadataList_)
+    {
+        const alignment::matchSelector::MatchSelectorStats &stats = tileStats_.at(tile.getIndex());
+        const flowcell::ReadMetadataList &readMetadataList =
+            flowcellLayoutList_.at(tile.getFlowcellIndex()).getReadMetadataList();
+
+        // template length statistics are per tile. Aggregate the tile first, then remember its template length stats
+        std::map<Node, std::map<unsigned, ReadStats> > tileNodeStats;
+        for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+        {
+            if (barcode.getFlowcellIndex() == tile.getFlowcellIndex() && barcode.getLane() == tile.getLane())
+            {
+                for (const Node &node : getBarcodeNodes(barcode))
+                {
+                    std::map<unsigned, ReadStats> &nodeReads = tileNodeStats[node];
+                    for (const flowcell::ReadMetadata &read : readMetadataList)
+                    {
+                        ReadStats &readStats = nodeReads[read.getNumber()];
+                        readStats.pf_ += stats.getReadBarcodeTileStat(read, barcode, true);
+                        readStats.raw_ += stats.getReadBarcodeTileStat(read, barcode, false);
+                    }
+                }
+            }
+        }
+
+        for (const std::pair<const Node, std::map<unsigned, ReadStats> > &nodeReads : tileNodeStats)
+        {
+            LaneStats &laneStats = nodeStats_[nodeReads.first][tile.getLane()];
+            for (const std::pair<const unsigned, ReadStats> &read : nodeReads.second)
+            {
+                laneStats.reads_[read.first].pf_ += read.second.pf_;
+                laneStats.reads_[read.first].raw_ += read.second.raw_;
+            }
+            if (!nodeReads.second.empty())
+            {
+                const alignment::matchSelector::TileBarcodeStats &firstRead = nodeReads.second.begin()->second.raw_;
+                if (firstRead.templateLengthStatisticsSet_ && !firstRead.templateLengthStatisticsConflicts_)
+                {
+                    laneStats.tileTemplateLengthStatistics_.push_back(firstRead.templateLengthStatistics_);
+                }
+            }
         }
     }
 
-    common::createDirectories(createList);
+    for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+    {
+        const std::vector<Node> nodes = getBarcodeNodes(barcode);
+        for (const Node &node : nodes)
+        {
+            nodeStats_[node][barcode.getLane()].demultiplexing_ += demultiplexingStats_.getLaneBarcodeStat(barcode);
+        }
+        nodeStats_[nodes.front()][barcode.getLane()].referenceName_ = barcode.getReference();
+    }
+}
 
-    boost::filesystem::remove(gnuplotScriptPath_);
-    if (boost::filesystem::exists(gnuplotScriptPath_))
+void AlignmentReportGenerator::createDirectories() const
+{
+    std::vector<boost::filesystem::path> createList;
+    createList.push_back(outputDirectoryHtml_);
+    for (const NodeStats::value_type &node : nodeStats_)
     {
-        BOOST_THROW_EXCEPTION(
-            common::IoException(errno, "Failed to remove the following temporary file:" + gnuplotScriptPath_.string()));
+        createList.push_back(outputDirectoryHtml_ / std::get<0>(node.first));
+        createList.push_back(outputDirectoryHtml_ / std::get<0>(node.first) / std::get<1>(node.first));
+        createList.push_back(outputDirectoryHtml_ / std::get<0>(node.first) / std::get<1>(node.first) / std::get<2>(node.first));
+        createList.push_back(outputDirectoryHtml_ / getNodePath(node.first));
     }
 
+    if (none != imageFileFormat_)
+    {
+        createList.push_back(outputDirectoryImages_);
+        for (const flowcell::Layout &flowcell : flowcellLayoutList_)
+        {
+            createList.push_back(outputDirectoryImages_ / flowcell.getFlowcellId());
+            createList.push_back(outputDirectoryImages_ / flowcell.getFlowcellId() / ALL);
+            createList.push_back(outputDirectoryImages_ / flowcell.getFlowcellId() / ALL / ALL);
+            createList.push_back(outputDirectoryImages_ / flowcell.getFlowcellId() / ALL / ALL / ALL);
+        }
+    }
+    common::createDirectories(createList);
 }
 
 void AlignmentReportGenerator::run()
 {
-    const char *params[] = {"OUTPUT_DIRECTORY_HTML_PARAM", "''",
-                            "OUTPUT_DIRECTORY_IMAGES_PARAM", "''",
-                            "TEMP_DIRECTORY_PARAM", "''",
-                            "DEMULTIPLEXING_STATS_XML_PARAM", "''",
-                            "GNUPLOT_SCRIPT_PATH_PARAM", "''",
-                            "iSAAC_FULL_DATADIR_PARAM", "''",
-                            0};
-    const std::string quotedOutputHtmlDirectory = "'" + outputDirectoryHtml_.string() + "'";
-    params[1] = quotedOutputHtmlDirectory.c_str();
-    const std::string quotedOutputImagesDirectory = "'" + outputDirectoryImages_.string() + "'";
-    params[3] = quotedOutputImagesDirectory.c_str();
-    const std::string quotedTempDirectory = "'" + tempDirectory_.string() + "'";
-    params[5] = quotedTempDirectory.c_str();
-    const std::string quotedDemultiplexingStatsXml= "'" + demultiplexingStatsXmlPath_.string() + "'";
-    params[7] = quotedDemultiplexingStatsXml.c_str();
-    const std::string quotedGnuplotScriptPath = "'" + gnuplotScriptPath_.string() + "'";
-    params[9] = quotedGnuplotScriptPath.c_str();
+    aggregateStats();
+    createDirectories();
 
     const boost::filesystem::path isaacFullDataDir = package::expandPath(iSAAC_FULL_DATADIR);
-    const std::string quotedIsaacFullDataDirPath = "'" + isaacFullDataDir.string() + "'";
-    params[11] = quotedIsaacFullDataDirPath.c_str();
+    boost::filesystem::copy_file(isaacFullDataDir / "css" / CSS_FILE_NAME, outputDirectoryHtml_ / CSS_FILE_NAME,
+                                 boost::filesystem::copy_option::overwrite_if_exists);
+
+    std::vector<std::function<void()> > jobs;
+    jobs.push_back(std::bind(&AlignmentReportGenerator::writeIndexPage, this));
+    jobs.push_back(std::bind(&AlignmentReportGenerator::writeTreePage, this));
+    for (const NodeStats::value_type &node : nodeStats_)
+    {
+        jobs.push_back(std::bind(&AlignmentReportGenerator::writeSummaryPage, this, std::cref(node.first), false));
+        if (ALL != std::get<0>(node.first) && ALL == std::get<3>(node.first))
+        {
+            jobs.push_back(std::bind(&AlignmentReportGenerator::writeSummaryPage, this, std::cref(node.first), true));
+        }
+    }
+
+    if (none != imageFileFormat_)
+    {
+        for (const flowcell::Layout &flowcell : flowcellLayoutList_)
+        {
+            for (const bool passesFilter : {true, false})
+            {
+                for (const bool curves : {false, true})
+                {
+                    jobs.push_back(std::bind(&AlignmentReportGenerator::writeTileMismatchPage,
+                                             this, std::cref(flowcell), passesFilter, curves));
+                }
+            }
+        }
+        for (const flowcell::TileMetadata &tile : tileMetadataList_)
+        {
+            jobs.push_back(std::bind(&AlignmentReportGenerator::writeTileImages, this, std::cref(tile)));
+        }
+    }
+
+    std::atomic<std::size_t> nextJob(0);
+    common::ThreadVector threads(std::max(1U, std::min<unsigned>(threads_, jobs.size())));
+    threads.execute([&jobs, &nextJob](const unsigned threadNumber, const unsigned threadsTotal)
+    {
+        for (std::size_t job = nextJob++; jobs.size() > job; job = nextJob++)
+        {
+            jobs.at(job)();
+        }
+    });
+}
+
+void AlignmentReportGenerator::writeIndexPage() const
+{
+    const boost::filesystem::path path = outputDirectoryHtml_ / "index.html";
+    std::ofstream os;
+    openOutput(path, os);
+    os << boost::format(INDEX_PAGE_FORMAT) % iSAAC_VERSION_FULL;
+    checkOutput(os, path);
+}
+
+void AlignmentReportGenerator::writeTreePage() const
+{
+    const boost::filesystem::path path = outputDirectoryHtml_ / "tree.html";
+    std::ofstream os;
+    openOutput(path, os);
+    os << "<html>\n<link rel=\"stylesheet\" href=\"" << CSS_FILE_NAME << "\" type=\"text/css\"/>\n<body>\n<table>\n";
+
+    std::vector<std::string> flowcellIds;
+    for (const flowcell::Layout &flowcell : flowcellLayoutList_)
+    {
+        if (flowcellIds.end() == std::find(flowcellIds.begin(), flowcellIds.end(), flowcell.getFlowcellId()))
+        {
+            flowcellIds.push_back(flowcell.getFlowcellId());
+        }
+    }
+    flowcellIds.push_back(ALL);
+
+    for (const std::string &flowcellId : flowcellIds)
+    {
+        os << boost::format(TREE_LINK_FORMAT) % "" % 4 %
+            getNodePath(Node(flowcellId, ALL, ALL, ALL)).string() % getFlowcellDisplayName(flowcellId);
+        for (NodeStats::const_iterator project = nodeStats_.lower_bound(Node(flowcellId, "", "", ""));
+            nodeStats_.end() != project && flowcellId == std::get<0>(project->first); ++project)
+        {
+            if (ALL == std::get<1>(project->first) || ALL != std::get<2>(project->first))
+            {
+                continue;
+            }
+            os << boost::format(TREE_LINK_FORMAT) % "<td/>" % 3 %
+                getNodePath(project->first).string() % getProjectDisplayName(std::get<1>(project->first));
+
+            for (NodeStats::const_iterator sample = nodeStats_.lower_bound(Node(flowcellId, std::get<1>(project->first), "", ""));
+                nodeStats_.end() != sample && flowcellId == std::get<0>(sample->first) &&
+                std::get<1>(project->first) == std::get<1>(sample->first); ++sample)
+            {
+                if (ALL == std::get<2>(sample->first) || ALL != std::get<3>(sample->first))
+                {
+                    continue;
+                }
+                os << boost::format(TREE_LINK_FORMAT) % "<td/><td/>" % 2 %
+                    getNodePath(sample->first).string() % getSampleDisplayName(std::get<2>(sample->first));
+
+                std::vector<NodeStats::const_iterator> barcodes;
+                for (NodeStats::const_iterator barcode =
+                        nodeStats_.lower_bound(Node(flowcellId, std::get<1>(sample->first), std::get<2>(sample->first), ""));
+                    nodeStats_.end() != barcode && flowcellId == std::get<0>(barcode->first) &&
+                    std::get<1>(sample->first) == std::get<1>(barcode->first) &&
+                    std::get<2>(sample->first) == std::get<2>(barcode->first); ++barcode)
+                {
+                    if (ALL != std::get<3>(barcode->first))
+                    {
+                        // unknown barcode goes on top
+                        barcodes.insert(
+                            flowcell::BarcodeMetadata::UNKNOWN_BARCODE == std::get<3>(barcode->first) ?
+                                barcodes.begin() : barcodes.end(), barcode);
+                    }
+                }
+                for (const NodeStats::const_iterator &barcode : barcodes)
+                {
+                    os << boost::format(TREE_LINK_FORMAT) % "<td/><td/><td/>" % 1 %
+                        getNodePath(barcode->first).string() % getBarcodeDisplayName(std::get<3>(barcode->first));
+                }
+            }
+        }
+    }
+    os << "</table>\n</body>\n</html>\n";
+    checkOutput(os, path);
+}
+
+std::vector<AlignmentReportGenerator::Row> AlignmentReportGenerator::getRows(
+    const Node &node, const bool showBarcodes) const
+{
+    std::vector<Row> ret;
+    for (const NodeStats::value_type &rowNode : nodeStats_)
+    {
+        if (showBarcodes ?
+            (std::get<0>(node) == std::get<0>(rowNode.first) &&
+                rowMatches(std::get<1>(node), std::get<1>(rowNode.first)) &&
+                rowMatches(std::get<2>(node), std::get<2>(rowNode.first)) &&
+                rowMatches(std::get<3>(node), std::get<3>(rowNode.first))) :
+            node == rowNode.first)
+        {
+            for (const NodeLaneStats::value_type &lane : rowNode.second)
+            {
+                const Row row = {lane.first, &rowNode.first, &lane.second};
+                ret.push_back(row);
+            }
+        }
+    }
+    std::stable_sort(ret.begin(), ret.end(), [](const Row &left, const Row &right){return left.lane_ < right.lane_;});
+    return ret;
+}
+
+void AlignmentReportGenerator::writeSummaryPage(const Node &node, const bool showBarcodes) const
+{
+    const boost::filesystem::path path =
+        outputDirectoryHtml_ / getNodePath(node) / (showBarcodes ? "laneBarcode.html" : "lane.html");
+    std::ofstream os;
+    openOutput(path, os);
+
+    const std::string displayPath =
+        getFlowcellDisplayName(std::get<0>(node)) + " / " + getProjectDisplayName(std::get<1>(node)) + " / " +
+        getSampleDisplayName(std::get<2>(node)) + " / " + getBarcodeDisplayName(std::get<3>(node));
+    const bool flowcellPage = ALL != std::get<0>(node);
+    std::string alternativeView;
+    if (flowcellPage && ALL == std::get<3>(node))
+    {
+        alternativeView = showBarcodes ?
+            (boost::format(ALTERNATIVE_VIEW_FORMAT) %
+                (NODE_TO_HTML_ROOT + getNodePath(node).string() + "/lane.html") % "hide barcodes").str() :
+            (boost::format(ALTERNATIVE_VIEW_FORMAT) % "laneBarcode.html" % "show barcodes").str();
+    }
+    os << boost::format(NODE_PAGE_HEADER_FORMAT) % NODE_TO_HTML_ROOT % CSS_FILE_NAME % displayPath % alternativeView;
+
+    writeYieldSummaryTable(os, node);
+
+    const std::vector<Row> rows = getRows(node, showBarcodes);
+    std::set<unsigned> readNumbers;
+    for (const Row &row : rows)
+    {
+        for (const std::pair<const unsigned, ReadStats> &read : row.laneStats_->reads_)
+        {
+            readNumbers.insert(read.first);
+        }
+    }
+    for (const unsigned readNumber : readNumbers)
+    {
+        os << "<p>Lane Summary : Read " << readNumber << "</p>\n";
+        writeLaneSummaryTable(os, node, rows, showBarcodes, readNumber);
+    }
+
+    if (flowcellPage && none != imageFileFormat_)
+    {
+        os << boost::format(MISMATCH_LINKS_FORMAT) % NODE_TO_HTML_ROOT % std::get<0>(node);
+    }
+
+    os << "<p>Additional Paired Statistics</p>\n";
+    writeLanePairedStatsTable(os, node, rows, showBarcodes);
+
+    if (flowcell::BarcodeMetadata::UNKNOWN_BARCODE == std::get<3>(node))
+    {
+        os << "<p>Top Unknown Barcodes</p>\n";
+        writeUnknownBarcodesTable(os, std::get<0>(node));
+    }
+
+    os << boost::format(PAGE_FOOTER_FORMAT) % iSAAC_VERSION_FULL;
+    checkOutput(os, path);
+}
+
+void AlignmentReportGenerator::writeYieldSummaryTable(std::ostream &os, const Node &node) const
+{
+    uint64_t clustersRaw = 0;
+    uint64_t clustersPf = 0;
+    uint64_t yieldPf = 0;
+    const NodeStats::const_iterator it = nodeStats_.find(node);
+    if (nodeStats_.end() != it)
+    {
+        for (const NodeLaneStats::value_type &lane : it->second)
+        {
+            if (!lane.second.reads_.empty())
+            {
+                clustersRaw += lane.second.reads_.begin()->second.raw_.clusterCount_;
+                clustersPf += lane.second.reads_.begin()->second.pf_.clusterCount_;
+            }
+            for (const std::pair<const unsigned, ReadStats> &read : lane.second.reads_)
+            {
+                yieldPf += read.second.pf_.yield_;
+            }
+        }
+    }
+
+    os << "<table border=\"1\" ID=\"ReportTable\">\n"
+        "<tr><th>Clusters (Raw)</th><th>Clusters(PF)</th><th>Yield (MBases)</th></tr>\n" <<
+        boost::format("<tr><td>%s</td><td>%s</td><td>%s</td></tr>\n") %
+            formatCount(clustersRaw) % formatCount(clustersPf) % formatMbases(yieldPf) <<
+        "</table>\n";
+}
+
+void AlignmentReportGenerator::writeLaneSummaryTable(
+    std::ostream &os, const Node &node, const std::vector<Row> &rows, const bool showBarcodes,
+    const unsigned readNumber) const
+{
+    os << "<table border=\"1\" ID=\"ReportTable\">\n" <<
+        boost::format("<tr><th colspan=\"%d\">Lane</th><th colspan=\"5\">Raw data</th><th colspan=\"7\">Filtered data</th></tr>\n") %
+            (1 + getLaneExtraColumns(node, showBarcodes)) <<
+        "<tr>";
+    writeLaneHeaderColumns(os, node, showBarcodes);
+    os << "<th>Clusters</th><th>% of the<br/>lane</th><th>% Perfect<br/>barcode</th><th>% One mismatch<br/>barcode</th>"
+        "<th>Mismatch % (mapq&gt;3/all)</th>"
+        "<th>Clusters</th><th>Yield (Mbases)</th><th>% PF<br/>Clusters</th><th>% Align (mapq&gt;3/all)</th>"
+        "<th>Mismatch % (mapq&gt;3/all)</th><th>% &gt;= Q30<br/>bases</th><th>Mean Quality<br/>Score</th></tr>\n";
+
+    for (const Row &row : rows)
+    {
+        const std::map<unsigned, ReadStats>::const_iterator read = row.laneStats_->reads_.find(readNumber);
+        if (row.laneStats_->reads_.end() == read)
+        {
+            continue;
+        }
+        const alignment::matchSelector::TileBarcodeStats &raw = read->second.raw_;
+        const alignment::matchSelector::TileBarcodeStats &pf = read->second.pf_;
+        const demultiplexing::LaneBarcodeStats &demultiplexing = row.laneStats_->demultiplexing_;
+
+        uint64_t laneClusters = 0;
+        const NodeStats::const_iterator laneNode = nodeStats_.find(Node(std::get<0>(*row.node_), ALL, ALL, ALL));
+        if (nodeStats_.end() != laneNode)
+        {
+            const NodeLaneStats::const_iterator lane = laneNode->second.find(row.lane_);
+            if (laneNode->second.end() != lane)
+            {
+                laneClusters = lane->second.demultiplexing_.barcodeCount_;
+            }
+        }
+
+        os << "<tr>";
+        writeLaneColumns(os, node, *row.node_, row.lane_, showBarcodes);
+        os << boost::format("<td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td>") %
+            formatCount(demultiplexing.barcodeCount_) %
+            formatPercent(demultiplexing.barcodeCount_, laneClusters) %
+            formatPercent(demultiplexing.perfectBarcodeCount_, demultiplexing.barcodeCount_) %
+            formatPercent(demultiplexing.oneMismatchBarcodeCount_, demultiplexing.barcodeCount_) %
+            formatPercentPair(raw.uniquelyAlignedMismatches_, raw.uniquelyAlignedBasesOutsideIndels_,
+                              raw.mismatches_, raw.basesOutsideIndels_);
+        os << boost::format("<td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td>") %
+            formatCount(pf.clusterCount_) %
+            formatMbases(pf.yield_) %
+            formatPercent(pf.clusterCount_, raw.clusterCount_) %
+            formatPercentPair(pf.uniquelyAlignedFragmentCount_, pf.clusterCount_, pf.alignedFragmentCount_, pf.clusterCount_) %
+            formatPercentPair(pf.uniquelyAlignedMismatches_, pf.uniquelyAlignedBasesOutsideIndels_,
+                              pf.mismatches_, pf.basesOutsideIndels_) %
+            formatPercent(pf.yieldQ30_, pf.yield_) %
+            formatRatio(pf.qualityScoreSum_, pf.yield_);
+        os << "</tr>\n";
+    }
+    os << "</table>\n";
+}
+
+void AlignmentReportGenerator::writeLanePairedStatsTable(
+    std::ostream &os, const Node &node, const std::vector<Row> &rows, const bool showBarcodes) const
+{
+    using alignment::TemplateLengthStatistics;
+    os << "<table border=\"1\" ID=\"ReportTable\">\n" <<
+        boost::format("<tr><th colspan=\"%d\">Lane</th><th rowspan=\"2\">Ref</th>"
+            "<th colspan=\"5\">Relative Orientation Statistics</th>"
+            "<th colspan=\"5\">Mean Template Length Statistics across tiles</th>"
+            "<th colspan=\"3\">Template Statistics<br/>(% of individually uniquely alignable pairs)</th></tr>\n") %
+            (1 + getLaneExtraColumns(node, showBarcodes)) <<
+        "<tr>";
+    writeLaneHeaderColumns(os, node, showBarcodes);
+    os << "<th>F-:<br/>&gt;R2 R1&gt;</th><th>F+:<br/>&gt;R1 R2&gt;</th><th>R-:<br/>&lt;R2 R1&gt;</th><th>R+:<br/>&gt;R1 R2&lt;</th>"
+        "<th>Total</th><th>Median</th><th>Below<br/>median SD</th><th>Above<br/>median SD</th>"
+        "<th>Low<br/>thresh.</th><th>High<br/>thresh.</th>"
+        "<th>Too<br/>small</th><th>Too<br/>large</th><th>Orientation<br/>and size OK</th></tr>\n";
 
-    xmlSubstituteEntitiesDefault(1);
-    xmlLoadExtDtdDefaultValue = 1;
+    for (const Row &row : rows)
+    {
+        if (row.laneStats_->reads_.empty())
+        {
+            continue;
+        }
+        // orientation and size are the properties of the whole template and are identical in all reads
+        const alignment::matchSelector::TileBarcodeStats &pf = row.laneStats_->reads_.begin()->second.pf_;
+        const uint64_t fm = pf.alignmentModelCounts_[TemplateLengthStatistics::FFp] + pf.alignmentModelCounts_[TemplateLengthStatistics::RRm];
+        const uint64_t fp = pf.alignmentModelCounts_[TemplateLengthStatistics::RRp] + pf.alignmentModelCounts_[TemplateLengthStatistics::FFm];
+        const uint64_t rm = pf.alignmentModelCounts_[TemplateLengthStatistics::RFp] + pf.alignmentModelCounts_[TemplateLengthStatistics::FRm];
+        const uint64_t rp = pf.alignmentModelCounts_[TemplateLengthStatistics::FRp] + pf.alignmentModelCounts_[TemplateLengthStatistics::RFm];
+        const uint64_t total = fm + fp + rm + rp;
+        const uint64_t undersized = pf.nominalModelCounts_[TemplateLengthStatistics::Undersized];
+        const uint64_t oversized = pf.nominalModelCounts_[TemplateLengthStatistics::Oversized];
+        const uint64_t nominal = pf.nominalModelCounts_[TemplateLengthStatistics::Nominal];
+        const uint64_t checked = undersized + oversized + nominal;
+        const std::vector<TemplateLengthStatistics> &tls = row.laneStats_->tileTemplateLengthStatistics_;
 
-    exsltRegisterAll();
+        os << "<tr>";
+        writeLaneColumns(os, node, *row.node_, row.lane_, showBarcodes);
+        os << "<td>" << escapeXml(row.laneStats_->referenceName_) << "</td>";
+        os << boost::format("<td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td>") %
+            formatCountPercent(fm, total) % formatCountPercent(fp, total) %
+            formatCountPercent(rm, total) % formatCountPercent(rp, total) % formatCount(total);
+        os << boost::format("<td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td>") %
+            formatMeanAndStddev(tls, std::mem_fn(&TemplateLengthStatistics::getMedian)) %
+            formatMeanAndStddev(tls, std::mem_fn(&TemplateLengthStatistics::getLowStdDev)) %
+            formatMeanAndStddev(tls, std::mem_fn(&TemplateLengthStatistics::getHighStdDev)) %
+            formatMeanAndStddev(tls, std::mem_fn(&TemplateLengthStatistics::getMin)) %
+            formatMeanAndStddev(tls, std::mem_fn(&TemplateLengthStatistics::getMax));
+        os << boost::format("<td>%s</td><td>%s</td><td>%s</td>") %
+            formatCountPercent(undersized, checked) % formatCountPercent(oversized, checked) %
+            formatCountPercent(nominal, checked);
+        os << "</tr>\n";
+    }
+    os << "</table>\n";
+}
 
-    xsltStylesheetPtr cur = xsltParseStylesheetFile((const xmlChar *)(isaacFullDataDir / "xsl" / "alignment" / "GenerateReport.xsl").string().c_str());
-    xmlDocPtr doc = xmlParseFile(alignmentStatsXmlPath_.string().c_str());
-    xmlDocPtr res = xsltApplyStylesheet(cur, doc, params);
-//    int xsltprocRes = xsltSaveResultToFile(0, res, cur);
+void AlignmentReportGenerator::writeUnknownBarcodesTable(std::ostream &os, const std::string &flowcellId) const
+{
+    os << "<table border=\"1\" ID=\"ReportTable\">\n<tr><th>Lane</th><th>Count</th><th>Sequence</th></tr>\n";
+    std::map<unsigned, const flowcell::BarcodeMetadata *> laneUnknownBarcodes;
+    for (const flowcell::BarcodeMetadata &barcode : barcodeMetadataList_)
+    {
+        if (barcode.isUnknown() && flowcellId == barcode.getFlowcellId())
+        {
+            laneUnknownBarcodes.insert(std::make_pair(barcode.getLane(), &barcode));
+        }
+    }
+    for (const std::pair<const unsigned, const flowcell::BarcodeMetadata *> &lane : laneUnknownBarcodes)
+    {
+        const demultiplexing::UnknownBarcodeHits &hits =
+            demultiplexingStats_.getLaneUnknwonBarcodeStat(lane.second->getIndex()).topUnknownBarcodes_;
+        const unsigned barcodeLength = flowcellLayoutList_.at(lane.second->getFlowcellIndex()).getBarcodeLength();
+        for (demultiplexing::UnknownBarcodeHits::const_iterator hit = hits.begin(); hits.end() != hit; ++hit)
+        {
+            os << "<tr>";
+            if (hits.begin() == hit)
+            {
+                os << "<th rowspan=\"" << hits.size() << "\">" << lane.first << "</th>";
+            }
+            os << "<td>" << formatCount(hit->second) << "</td><td>" <<
+                demultiplexing::bases(hit->first, barcodeLength) << "</td></tr>\n";
+        }
+    }
+    os << "</table>\n";
+}
 
-    xsltFreeStylesheet(cur);
-    xmlFreeDoc(res);
-    xmlFreeDoc(doc);
+void AlignmentReportGenerator::writeTileMismatchPage(
+    const flowcell::Layout &flowcell, const bool passesFilter, const bool curves) const
+{
+    const boost::filesystem::path path =
+        outputDirectoryHtml_ / getNodePath(Node(flowcell.getFlowcellId(), ALL, ALL, ALL)) /
+        ((passesFilter ? "Pf" : "Raw") + std::string(curves ? "CycleMismatchFragments.html" : "CycleMismatches.html"));
+    std::ofstream os;
+    openOutput(path, os);
 
-    xsltCleanupGlobals();
-    xmlCleanupParser();
-    if (!res)
+    std::set<unsigned> lanes;
+    std::set<unsigned> tileNumbers;
+    std::map<std::pair<unsigned, unsigned>, const flowcell::TileMetadata *> tiles;
+    for (const flowcell::TileMetadata &tile : tileMetadataList_)
     {
-        BOOST_THROW_EXCEPTION(common::LibXsltException());
+        if (flowcell.getIndex() == tile.getFlowcellIndex())
+        {
+            lanes.insert(tile.getLane());
+            tileNumbers.insert(tile.getTile());
+            tiles.insert(std::make_pair(std::make_pair(tile.getLane(), tile.getTile()), &tile));
+        }
     }
-//    if (-1 == xsltprocRes)
-//    {
-//        BOOST_THROW_EXCEPTION(common::LibXsltException());
-//    }
 
-    // Only generate output plots if not turned off
-    if(none != imageFileFormat_)
+    const std::string imagesPath = NODE_TO_IMAGES_ROOT + getNodePath(Node(flowcell.getFlowcellId(), ALL, ALL, ALL)).string() + "/";
+    os << "<html>\n<link rel=\"stylesheet\" href=\"" << NODE_TO_HTML_ROOT << CSS_FILE_NAME << "\" type=\"text/css\"/>\n<body>\n" <<
+        "<table border=\"1\" ID=\"ReportTable\">\n<tr><th>Tile:</th>";
+    for (const unsigned lane : lanes)
+    {
+        os << "<th>lane" << lane << "</th>";
+    }
+    os << "</tr>\n";
+    for (const unsigned tileNumber : tileNumbers)
     {
-        // And the gnuplot script path exists
-        if (boost::filesystem::exists(gnuplotScriptPath_))
+        os << "<tr><th>" << tileNumber << "</th>";
+        for (const unsigned lane : lanes)
         {
-            std::string gnuplotCmd = "gnuplot " + gnuplotScriptPath_.string();
-            common::executeCommand(gnuplotCmd);
+            const std::map<std::pair<unsigned, unsigned>, const flowcell::TileMetadata *>::const_iterator tile =
+                tiles.find(std::make_pair(lane, tileNumber));
+            if (tiles.end() == tile)
+            {
+                os << "<td/>";
+            }
+            else
+            {
+                os << boost::format(TILE_IMAGE_CELL_FORMAT) % imagesPath % getTileImagePath(*tile->second, passesFilter, curves);
+            }
         }
+        os << "</tr>\n";
     }
+    os << "</table>\n" << boost::format(PAGE_FOOTER_FORMAT) % iSAAC_VERSION_FULL;
+    checkOutput(os, path);
 }
 
+void AlignmentReportGenerator::writeTileImages(const flowcell::TileMetadata &tile) const
+{
+    const flowcell::ReadMetadataList &readMetadataList =
+        flowcellLayoutList_.at(tile.getFlowcellIndex()).getReadMetadataList();
+    const alignment::matchSelector::MatchSelectorStats &stats = tileStats_.at(tile.getIndex());
+    const boost::filesystem::path directory =
+        outputDirectoryImages_ / getNodePath(Node(tile.getFlowcellId(), ALL, ALL, ALL));
+
+    for (const bool passesFilter : {true, false})
+    {
+        for (const bool curves : {false, true})
+        {
+            const std::string name = getTileImagePath(tile, passesFilter, curves);
+            for (const bool thumbnail : {false, true})
+            {
+                const boost::filesystem::path path = directory / (name + (thumbnail ? "_thumb.svg" : ".svg"));
+                std::ofstream os;
+                openOutput(path, os);
+                if (curves)
+                {
+                    writeTileMismatchCurvesChart(os, name, readMetadataList, stats, passesFilter, thumbnail);
+                }
+                else
+                {
+                    writeTileMismatchesChart(os, name, readMetadataList, stats, passesFilter, thumbnail);
+                }
+                checkOutput(os, path);
+            }
+        }
+    }
+}
 
 } // namespace reports
 } // namespace isaac
@@ -0,0 +1,86 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file SvgWriter.cpp
+ **
+ ** \brief Minimal writer of svg images for the report charts.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <boost/format.hpp>
+
+#include "reports/SvgWriter.hh"
+
+namespace isaac
+{
+namespace reports
+{
+
+std::string escapeXml(const std::string &text)
+{
+    std::string ret;
+    ret.reserve(text.size());
+    for (const char c : text)
+    {
+        switch (c)
+        {
+        case '&': ret += "&amp;"; break;
+        case '<': ret += "&lt;"; break;
+        case '>': ret += "&gt;"; break;
+        case '"': ret += "&quot;"; break;
+        case '\'': ret += "&#39;"; break;
+        default: ret += c; break;
+        }
+    }
+    return ret;
+}
+
+SvgWriter::SvgWriter(std::ostream &os, const unsigned width, const unsigned height) : os_(os)
+{
+    os_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n" <<
+        boost::format("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\" "
+            "font-family=\"monospace\" font-size=\"12\">\n") % width % height % width % height <<
+        boost::format("<rect x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" fill=\"#ffffff\"/>\n") % width % height;
+}
+
+SvgWriter::~SvgWriter()
+{
+    os_ << "</svg>\n";
+}
+
+void SvgWriter::rect(const double x, const double y, const double width, const double height, const char *fill)
+{
+    os_ << boost::format("<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" fill=\"%s\"/>\n") %
+        x % y % width % height % fill;
+}
+
+void SvgWriter::line(const double x1, const double y1, const double x2, const double y2, const char *stroke)
+{
+    os_ << boost::format("<line x1=\"%.2f\" y1=\"%.2f\" x2=\"%.2f\" y2=\"%.2f\" stroke=\"%s\" stroke-width=\"1\"/>\n") %
+        x1 % y1 % x2 % y2 % stroke;
+}
+
+void SvgWriter::text(const double x, const double y, const char *anchor, const std::string &text)
+{
+    os_ << boost::format("<text x=\"%.2f\" y=\"%.2f\" text-anchor=\"%s\">%s</text>\n") %
+        x % y % anchor % escapeXml(text);
+}
+
+void SvgWriter::verticalText(const double x, const double y, const std::string &text)
+{
+    os_ << boost::format("<text x=\"%.2f\" y=\"%.2f\" text-anchor=\"middle\" transform=\"rotate(-90 %.2f %.2f)\">%s</text>\n") %
+        x % y % x % y % escapeXml(text);
+}
+
+} // namespace reports
+} // namespace isaac
@@ -0,0 +1,275 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file TileMismatchCharts.cpp
+ **
+ ** \brief Per-cycle mismatch charts of a tile in svg format.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <algorithm>
+
+#include <boost/format.hpp>
+
+#include "common/Debug.hh"
+#include "reports/SvgWriter.hh"
+#include "reports/TileMismatchCharts.hh"
+
+namespace isaac
+{
+namespace reports
+{
+
+namespace
+{
+
+static const unsigned THUMBNAIL_SIZE = 84;
+// pixels per cycle in full size charts
+static const unsigned CYCLE_WIDTH = 3;
+static const unsigned PLOT_WIDTH_MIN = 300;
+static const unsigned CHART_HEIGHT = 600;
+static const double MARGIN_LEFT = 60.0;
+static const double MARGIN_RIGHT = 20.0;
+static const double MARGIN_TOP = 50.0;
+static const double MARGIN_BOTTOM = 70.0;
+
+static const char *AXIS_COLOUR = "#404040";
+static const char *GRID_COLOUR = "#d0d0d0";
+static const char *MISMATCH_COLOUR = "#ff0000";
+static const char *BLANK_COLOUR = "#0000ff";
+
+// mismatch curves from the tallest to the shortest so that the shorter ones are drawn on top
+static const unsigned CURVES = 5;
+static const char *CURVE_COLOURS[CURVES] = {"#000000", "#00ff00", "#0000ff", "#ff0000", "#777777"};
+static const char *CURVE_TITLES[CURVES] = {"4 or less", "3 or less", "2 or less", "1 or less", "0 mismatches"};
+
+struct CycleRange
+{
+    unsigned first_;
+    unsigned last_;
+    unsigned getCount() const {return last_ - first_ + 1;}
+};
+
+CycleRange getCycleRange(const flowcell::ReadMetadataList &readMetadataList)
+{
+    ISAAC_ASSERT_MSG(!readMetadataList.empty(), "At least one read is required");
+    CycleRange ret = {readMetadataList.front().getFirstCycle(), readMetadataList.front().getLastCycle()};
+    for (const flowcell::ReadMetadata &read : readMetadataList)
+    {
+        ret.first_ = std::min(ret.first_, read.getFirstCycle());
+        ret.last_ = std::max(ret.last_, read.getLastCycle());
+    }
+    return ret;
+}
+
+std::string getFullTitle(
+    const std::string &title,
+    const flowcell::ReadMetadataList &readMetadataList,
+    const alignment::matchSelector::MatchSelectorStats &tileStats,
+    const bool passesFilter)
+{
+    std::string ret = title + " Uniquely aligned fragments:";
+    for (const flowcell::ReadMetadata &read : readMetadataList)
+    {
+        ret += (boost::format(" R%d:%d") % read.getNumber() %
+            tileStats.getReadTileStat(read, passesFilter).uniquelyAlignedFragmentCount_).str();
+    }
+    return ret;
+}
+
+unsigned getCycleTickStep(const unsigned cycles)
+{
+    static const unsigned steps[] = {5, 10, 25, 50, 100, 250, 500};
+    for (const unsigned step : steps)
+    {
+        if (20 >= cycles / step)
+        {
+            return step;
+        }
+    }
+    return 1000;
+}
+
+/**
+ * \brief Maps cycles and percentages onto a rectangle of the image. Bars grow from the bottom of the rectangle
+ *        unless the plot is inverted
+ */
+class Plot
+{
+public:
+    Plot(
+        SvgWriter &svg, const CycleRange &cycles,
+        const double left, const double top, const double width, const double height,
+        const double percentMax, const bool inverted) :
+        svg_(svg), cycles_(cycles), left_(left), top_(top), width_(width), height_(height),
+        percentMax_(percentMax), inverted_(inverted)
+    {
+    }
+
+    double getSlotWidth() const {return width_ / cycles_.getCount();}
+    double getX(const unsigned cycle) const {return left_ + (cycle - cycles_.first_) * getSlotWidth();}
+    double getY(const double percent) const
+    {
+        const double h = std::min(percent, percentMax_) / percentMax_ * height_;
+        return inverted_ ? top_ + h : top_ + height_ - h;
+    }
+
+    void bar(const unsigned cycle, const double percent, const char *colour, const double barWidth)
+    {
+        if (0.0 < percent)
+        {
+            const double x = getX(cycle) + (getSlotWidth() - barWidth) / 2.0;
+            const double y = getY(percent);
+            svg_.rect(x, inverted_ ? top_ : y, barWidth, inverted_ ? y - top_ : top_ + height_ - y, colour);
+        }
+    }
+
+    void grid(const double percentStep, const std::string &label, const bool cycleLabels)
+    {
+        for (double percent = 0.0; percent <= percentMax_; percent += percentStep)
+        {
+            const double y = getY(percent);
+            svg_.line(left_, y, left_ + width_, y, GRID_COLOUR);
+            svg_.text(left_ - 4.0, y + 4.0, "end", (boost::format("%g") % percent).str());
+        }
+        const unsigned step = getCycleTickStep(cycles_.getCount());
+        for (unsigned cycle = (cycles_.first_ + step - 1) / step * step; cycle <= cycles_.last_; cycle += step)
+        {
+            const double x = getX(cycle) + getSlotWidth() / 2.0;
+            svg_.line(x, top_, x, top_ + height_, GRID_COLOUR);
+            if (cycleLabels)
+            {
+                svg_.text(x, top_ + height_ + 14.0, "middle", (boost::format("%d") % cycle).str());
+            }
+        }
+        svg_.line(left_, top_, left_, top_ + height_, AXIS_COLOUR);
+        svg_.line(left_, inverted_ ? top_ : top_ + height_, left_ + width_, inverted_ ? top_ : top_ + height_, AXIS_COLOUR);
+        svg_.verticalText(left_ - 40.0, top_ + height_ / 2.0, label);
+    }
+
+private:
+    SvgWriter &svg_;
+    const CycleRange cycles_;
+    const double left_;
+    const double top_;
+    const double width_;
+    const double height_;
+    const double percentMax_;
+    const bool inverted_;
+};
+
+double percentOf(const int64_t count, const uint64_t total)
+{
+    return total ? 100.0 * count / total : 0.0;
+}
+
+} // anonymous namespace
+
+void writeTileMismatchesChart(
+    std::ostream &os,
+    const std::string &title,
+    const flowcell::ReadMetadataList &readMetadataList,
+    const alignment::matchSelector::MatchSelectorStats &tileStats,
+    const bool passesFilter,
+    const bool thumbnail)
+{
+    static const double PERCENT_MAX = 20.0;
+    const CycleRange cycles = getCycleRange(readMetadataList);
+    const double plotWidth = thumbnail ? THUMBNAIL_SIZE : std::max(PLOT_WIDTH_MIN, cycles.getCount() * CYCLE_WIDTH);
+    const double left = thumbnail ? 0.0 : MARGIN_LEFT;
+    const double top = thumbnail ? 0.0 : MARGIN_TOP;
+    const double panelHeight = thumbnail ? THUMBNAIL_SIZE / 2.0 : (CHART_HEIGHT - MARGIN_TOP - MARGIN_BOTTOM) / 2.0;
+
+    SvgWriter svg(os,
+                  thumbnail ? THUMBNAIL_SIZE : left + plotWidth + MARGIN_RIGHT,
+                  thumbnail ? THUMBNAIL_SIZE : CHART_HEIGHT);
+    Plot mismatches(svg, cycles, left, top, plotWidth, panelHeight, PERCENT_MAX, false);
+    Plot blanks(svg, cycles, left, top + panelHeight, plotWidth, panelHeight, PERCENT_MAX, true);
+    if (!thumbnail)
+    {
+        svg.text(left + plotWidth / 2.0, 20.0, "middle", getFullTitle(title, readMetadataList, tileStats, passesFilter));
+        mismatches.grid(5.0, "% mismatches", false);
+        blanks.grid(5.0, "% blanks", true);
+        svg.text(left + plotWidth / 2.0, CHART_HEIGHT - MARGIN_BOTTOM + 35.0, "middle", "Cycle Number");
+    }
+
+    const double barWidth = thumbnail ? std::max(1.0, mismatches.getSlotWidth() / 2.0) : mismatches.getSlotWidth() / 2.0;
+    for (const flowcell::ReadMetadata &read : readMetadataList)
+    {
+        const alignment::matchSelector::TileStats &stats = tileStats.getReadTileStat(read, passesFilter);
+        for (unsigned cycle = read.getFirstCycle(); read.getLastCycle() >= cycle; ++cycle)
+        {
+            mismatches.bar(cycle, percentOf(stats.cycleUniquelyAlignedMismatches_[cycle], stats.uniquelyAlignedFragmentCount_),
+                           MISMATCH_COLOUR, barWidth);
+            blanks.bar(cycle, percentOf(stats.cycleUniquelyAlignedBlanks_[cycle], stats.uniquelyAlignedFragmentCount_),
+                       BLANK_COLOUR, barWidth);
+        }
+    }
+}
+
+void writeTileMismatchCurvesChart(
+    std::ostream &os,
+    const std::string &title,
+    const flowcell::ReadMetadataList &readMetadataList,
+    const alignment::matchSelector::MatchSelectorStats &tileStats,
+    const bool passesFilter,
+    const bool thumbnail)
+{
+    static const double PERCENT_MAX = 100.0;
+    const CycleRange cycles = getCycleRange(readMetadataList);
+    const double plotWidth = thumbnail ? THUMBNAIL_SIZE : std::max(PLOT_WIDTH_MIN, cycles.getCount() * CYCLE_WIDTH);
+    const double left = thumbnail ? 0.0 : MARGIN_LEFT;
+    const double top = thumbnail ? 0.0 : MARGIN_TOP;
+    const double plotHeight = thumbnail ? THUMBNAIL_SIZE : CHART_HEIGHT - MARGIN_TOP - MARGIN_BOTTOM;
+
+    SvgWriter svg(os,
+                  thumbnail ? THUMBNAIL_SIZE : left + plotWidth + MARGIN_RIGHT,
+                  thumbnail ? THUMBNAIL_SIZE : CHART_HEIGHT);
+    Plot plot(svg, cycles, left, top, plotWidth, plotHeight, PERCENT_MAX, false);
+    if (!thumbnail)
+    {
+        svg.text(left + plotWidth / 2.0, 20.0, "middle", getFullTitle(title, readMetadataList, tileStats, passesFilter));
+        plot.grid(10.0, "% uniquely aligned fragments with 'x' mismatches or less", true);
+        svg.text(left + plotWidth / 2.0, top + plotHeight + 35.0, "middle", "Cycle Number");
+        for (unsigned curve = 0; CURVES != curve; ++curve)
+        {
+            const double x = left + curve * plotWidth / CURVES;
+            svg.rect(x, top + plotHeight + 48.0, 10.0, 10.0, CURVE_COLOURS[curve]);
+            svg.text(x + 14.0, top + plotHeight + 57.0, "start", CURVE_TITLES[curve]);
+        }
+    }
+
+    const double barWidth = thumbnail ? std::max(1.0, plot.getSlotWidth() / 2.0) : plot.getSlotWidth() / 2.0;
+    for (const flowcell::ReadMetadata &read : readMetadataList)
+    {
+        const alignment::matchSelector::TileStats &stats = tileStats.getReadTileStat(read, passesFilter);
+        const int64_t count = stats.uniquelyAlignedFragmentCount_;
+        for (unsigned cycle = read.getFirstCycle(); read.getLastCycle() >= cycle; ++cycle)
+        {
+            const int64_t none = count - stats.cycleUniquelyAlignedMoreMismatchFragments_[cycle];
+            const int64_t values[CURVES] = {
+                none + stats.cycleUniquelyAligned4MismatchFragments_[cycle],
+                none + stats.cycleUniquelyAligned3MismatchFragments_[cycle],
+                none + stats.cycleUniquelyAligned2MismatchFragments_[cycle],
+                none + stats.cycleUniquelyAligned1MismatchFragments_[cycle],
+                none};
+            for (unsigned curve = 0; CURVES != curve; ++curve)
+            {
+                plot.bar(cycle, percentOf(values[curve], count), CURVE_COLOURS[curve], barWidth);
+            }
+        }
+    }
+}
+
+} // namespace reports
+} // namespace isaac
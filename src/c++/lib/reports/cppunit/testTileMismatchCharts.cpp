@@ -0,0 +1,139 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testTileMismatchCharts.cpp
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <sstream>
+#include <string>
+
+#include <boost/assign.hpp>
+
+#include "RegistryName.hh"
+#include "testTileMismatchCharts.hh"
+
+#include "alignment/matchSelector/MatchSelectorStats.hh"
+#include "reports/SvgWriter.hh"
+#include "reports/TileMismatchCharts.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestTileMismatchCharts, registryName("TileMismatchCharts"));
+
+using namespace isaac;
+
+TestTileMismatchCharts::TestTileMismatchCharts() :
+    readMetadataList_(boost::assign::list_of
+        (flowcell::ReadMetadata(1, 4, 0, 0))
+        (flowcell::ReadMetadata(5, 10, 1, 4)))
+{
+    barcodeMetadataList_.push_back(flowcell::BarcodeMetadata("FC1", 0, 1, 0, false, flowcell::SequencingAdapterMetadataList()));
+    barcodeMetadataList_.back().setIndex(0);
+}
+
+void TestTileMismatchCharts::setUp()
+{
+}
+
+void TestTileMismatchCharts::tearDown()
+{
+}
+
+static std::size_t countOf(const std::string &text, const std::string &what)
+{
+    std::size_t ret = 0;
+    for (std::size_t pos = text.find(what); std::string::npos != pos; pos = text.find(what, pos + what.size()))
+    {
+        ++ret;
+    }
+    return ret;
+}
+
+void TestTileMismatchCharts::testSvgWriter()
+{
+    CPPUNIT_ASSERT_EQUAL(std::string("a&lt;b&gt; &amp; &quot;c&#39;"), reports::escapeXml("a<b> & \"c'"));
+
+    std::ostringstream os;
+    {
+        reports::SvgWriter svg(os, 200, 100);
+        svg.rect(1, 2, 3, 4.5, "#ff0000");
+        svg.line(0, 0, 10, 10, "#000000");
+        svg.text(5, 6, "middle", "x<y");
+    }
+    const std::string svg = os.str();
+    CPPUNIT_ASSERT_EQUAL(0UL, svg.find("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg "));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("width=\"200\" height=\"100\""));
+    CPPUNIT_ASSERT(std::string::npos != svg.find(
+        "<rect x=\"1.00\" y=\"2.00\" width=\"3.00\" height=\"4.50\" fill=\"#ff0000\"/>\n"));
+    CPPUNIT_ASSERT(std::string::npos != svg.find(
+        "<line x1=\"0.00\" y1=\"0.00\" x2=\"10.00\" y2=\"10.00\" stroke=\"#000000\" stroke-width=\"1\"/>\n"));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("text-anchor=\"middle\">x&lt;y</text>\n"));
+    // background and the one drawn
+    CPPUNIT_ASSERT_EQUAL(2UL, countOf(svg, "<rect "));
+    CPPUNIT_ASSERT_EQUAL(svg.size() - std::string("</svg>\n").size(), svg.rfind("</svg>\n"));
+}
+
+/**
+ * \brief 10 uniquely aligned fragments per read. One of them has a mismatch at cycle 2, two have a blank at cycle 6
+ */
+std::string TestTileMismatchCharts::renderMismatchesChart(const std::string &title, const bool thumbnail) const
+{
+    alignment::matchSelector::MatchSelectorStats stats(true, barcodeMetadataList_);
+    for (const flowcell::ReadMetadata &read : readMetadataList_)
+    {
+        stats.getReadTileStat(read, true).uniquelyAlignedFragmentCount_ = 10;
+    }
+    stats.getReadTileStat(readMetadataList_[0], true).cycleUniquelyAlignedMismatches_[2] = 1;
+    stats.getReadTileStat(readMetadataList_[1], true).cycleUniquelyAlignedBlanks_[6] = 2;
+    // the other filter state must not show up
+    stats.getReadTileStat(readMetadataList_[0], false).uniquelyAlignedFragmentCount_ = 1;
+    stats.getReadTileStat(readMetadataList_[0], false).cycleUniquelyAlignedMismatches_[3] = 1;
+
+    std::ostringstream os;
+    reports::writeTileMismatchesChart(os, title, readMetadataList_, stats, true, thumbnail);
+    return os.str();
+}
+
+void TestTileMismatchCharts::testMismatchesChart()
+{
+    const std::string svg = renderMismatchesChart("Lane <1> & co", false);
+    CPPUNIT_ASSERT_EQUAL(0UL, svg.find("<?xml "));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "<svg "));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "</svg>"));
+    // 10 cycles are narrower than the minimum plot width
+    CPPUNIT_ASSERT(std::string::npos != svg.find("width=\"380\" height=\"600\""));
+
+    CPPUNIT_ASSERT(std::string::npos != svg.find("Lane &lt;1&gt; &amp; co Uniquely aligned fragments: R1:10 R2:10</text>"));
+    CPPUNIT_ASSERT(std::string::npos == svg.find("<1>"));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "% mismatches</text>"));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "% blanks</text>"));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "Cycle Number</text>"));
+
+    // a bar per non-empty cycle. 10% of the 20% scale is half of the 240 pixel panel, 20% is all of it
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "fill=\"#ff0000\""));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "fill=\"#0000ff\""));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("height=\"120.00\" fill=\"#ff0000\""));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("height=\"240.00\" fill=\"#0000ff\""));
+}
+
+void TestTileMismatchCharts::testThumbnail()
+{
+    const std::string svg = renderMismatchesChart("Lane 1", true);
+    CPPUNIT_ASSERT(std::string::npos != svg.find("width=\"84\" height=\"84\""));
+    CPPUNIT_ASSERT_EQUAL(0UL, countOf(svg, "<text "));
+    CPPUNIT_ASSERT_EQUAL(0UL, countOf(svg, "<line "));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "fill=\"#ff0000\""));
+    CPPUNIT_ASSERT_EQUAL(1UL, countOf(svg, "fill=\"#0000ff\""));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("height=\"21.00\" fill=\"#ff0000\""));
+    CPPUNIT_ASSERT(std::string::npos != svg.find("height=\"42.00\" fill=\"#0000ff\""));
+    CPPUNIT_ASSERT_EQUAL(svg.size() - std::string("</svg>\n").size(), svg.rfind("</svg>\n"));
+}
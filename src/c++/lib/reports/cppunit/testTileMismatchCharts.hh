@@ -0,0 +1,48 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file testTileMismatchCharts.hh
+ **
+ ** \author Roman Petrovski
+ **/
+
+#ifndef iSAAC_REPORTS_TEST_TILE_MISMATCH_CHARTS_HH
+#define iSAAC_REPORTS_TEST_TILE_MISMATCH_CHARTS_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "flowcell/BarcodeMetadata.hh"
+#include "flowcell/ReadMetadata.hh"
+
+class TestTileMismatchCharts : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestTileMismatchCharts );
+    CPPUNIT_TEST( testSvgWriter );
+    CPPUNIT_TEST( testMismatchesChart );
+    CPPUNIT_TEST( testThumbnail );
+    CPPUNIT_TEST_SUITE_END();
+private:
+    const isaac::flowcell::ReadMetadataList readMetadataList_;
+    isaac::flowcell::BarcodeMetadataList barcodeMetadataList_;
+
+    std::string renderMismatchesChart(const std::string &title, const bool thumbnail) const;
+
+public:
+    TestTileMismatchCharts();
+    void setUp();
+    void tearDown();
+    void testSvgWriter();
+    void testMismatchesChart();
+    void testThumbnail();
+};
+
+#endif // #ifndef iSAAC_REPORTS_TEST_TILE_MISMATCH_CHARTS_HH
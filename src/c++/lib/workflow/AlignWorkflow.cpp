@@ -75,6 +75,8 @@ AlignWorkflow::AlignWorkflow(
     const unsigned seedLength,
     const flowcell::BarcodeMetadataList &barcodeMetadataList,
     const bool cleanupIntermediary,
+    const bool checkpointAlignment,
+    const bool resumeAlignment,
     const unsigned bclTilesPerChunk,
     const bool ignoreMissingBcls,
     const bool ignoreMissingFilters,
@@ -88,6 +90,8 @@ AlignWorkflow::AlignWorkflow(
     const unsigned matchFinderTooManyRepeats,
     const unsigned matchFinderWayTooManyRepeats,
     const unsigned matchFinderShadowSplitRepeats,
+    const unsigned seedExtensionRepeats,
+    const unsigned seedMismatches,
     const unsigned seedBaseQualityMin,
     const unsigned repeatThreshold,
     const int mateDriftRange,
@@ -109,6 +113,8 @@ AlignWorkflow::AlignWorkflow(
     const unsigned realignedGapsPerFragment,
     const bool clipSemialigned,
     const bool clipOverlapping,
+    const bool clipAdapterOverlap,
+    const bool keepReadNames,
     const bool scatterRepeats,
     const bool rescueShadows,
     const bool trimPEAdapters,
@@ -132,6 +138,7 @@ AlignWorkflow::AlignWorkflow(
     const build::GapRealignerMode realignGaps,
     const unsigned realignMapqMin,
     const boost::filesystem::path &knownIndelsPath,
+    const build::OutputFormat outputFormat,
     const int bamGzipLevel,
     const std::string &bamPuFormat,
     const bool bamProduceMd5,
@@ -145,6 +152,7 @@ AlignWorkflow::AlignWorkflow(
     const std::string &decoyRegexString,
     const common::ScopedMallocBlock::Mode memoryControl,
     const std::vector<std::size_t> &clusterIdList,
+    const double sampleClusters,
     const alignment::TemplateLengthStatistics &userTemplateLengthStatistics,
     const reports::AlignmentReportGenerator::ImageFileFormat statsImageFormat,
     const bool qScoreBin,
@@ -167,6 +175,8 @@ AlignWorkflow::AlignWorkflow(
     , matchFinderTooManyRepeats_(matchFinderTooManyRepeats)
     , matchFinderWayTooManyRepeats_(matchFinderWayTooManyRepeats)
     , matchFinderShadowSplitRepeats_(matchFinderShadowSplitRepeats)
+    , seedExtensionRepeats_(seedExtensionRepeats)
+    , seedMismatches_(seedMismatches)
     , seedBaseQualityMin_(seedBaseQualityMin)
     , repeatThreshold_(repeatThreshold)
     , mateDriftRange_(mateDriftRange)
@@ -174,8 +184,11 @@ AlignWorkflow::AlignWorkflow(
     , ignoreNeighbors_(ignoreNeighbors)
     , ignoreRepeats_(ignoreRepeats)
     , clusterIdList_(clusterIdList)
+    , sampleClusters_(sampleClusters)
     , barcodeMetadataList_(barcodeMetadataList)
     , cleanupIntermediary_(cleanupIntermediary)
+    , checkpointAlignment_(checkpointAlignment)
+    , resumeAlignment_(resumeAlignment)
     , bclTilesPerChunk_(bclTilesPerChunk)
     , ignoreMissingBcls_(ignoreMissingBcls)
     , ignoreMissingFilters_(ignoreMissingFilters)
@@ -184,7 +197,7 @@ AlignWorkflow::AlignWorkflow(
     // assume most fragments will have a one-component CIGAR.
     , estimatedFragmentSize_(io::FragmentHeader::getMinTotalLength(
         flowcell::getMaxReadLength(flowcellLayoutList_),
-        flowcell::getMaxClusterName(flowcellLayoutList_)))
+        keepReadNames ? flowcell::getMaxClusterName(flowcellLayoutList_) : 0))
     , expectedBgzfCompressionRatio_(expectedBgzfCompressionRatio)
     , targetFragmentsPerBin_(targetBinSize ?
         targetBinSize / estimatedFragmentSize_ :
@@ -205,6 +218,8 @@ AlignWorkflow::AlignWorkflow(
     , realignedGapsPerFragment_(realignedGapsPerFragment)
     , clipSemialigned_(clipSemialigned)
     , clipOverlapping_(clipOverlapping)
+    , clipAdapterOverlap_(clipAdapterOverlap)
+    , keepReadNames_(keepReadNames)
     , scatterRepeats_(scatterRepeats)
     , rescueShadows_(rescueShadows)
     , trimPEAdapters_(trimPEAdapters)
@@ -223,6 +238,7 @@ AlignWorkflow::AlignWorkflow(
     , realignGaps_(realignGaps)
     , realignMapqMin_(realignMapqMin)
     , knownIndelsPath_(knownIndelsPath)
+    , outputFormat_(outputFormat)
     , bamGzipLevel_(bamGzipLevel)
     , bamPuFormat_(bamPuFormat)
     , bamProduceMd5_(bamProduceMd5)
@@ -248,6 +264,7 @@ AlignWorkflow::AlignWorkflow(
       // dummy initialization. Will be replaced with real object once match finding is over
     , foundMatchesMetadata_(tempDirectory_, barcodeMetadataList_, 0, sortedReferenceMetadataList_)
     , barcodeTemplateLengthStatistics_(barcodeMetadataList_.size())
+    , demultiplexingStats_(flowcellLayoutList_, barcodeMetadataList_)
     , detectTemplateBlockSize_(detectTemplateBlockSize)
 {
     ISAAC_THREAD_CERR << "Aligner: expectedCoverage_ " << expectedCoverage_ << std::endl;
@@ -290,13 +307,17 @@ reference::SortedReferenceMetadataList AlignWorkflow::loadSortedReferenceXml(
 void AlignWorkflow::findMatches(
     alignWorkflow::FoundMatchesMetadata &foundMatches,
     alignment::BinMetadataList &binMetadataList,
-    std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics) const
+    std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats) const
 {
     alignWorkflow::FindHashMatchesTransition findMatchesTransition(
         hashTableBucketCount_,
         flowcellLayoutList_,
         barcodeMetadataList_,
         cleanupIntermediary_,
+        checkpointAlignment_,
+        resumeAlignment_,
         bclTilesPerChunk_,
         ignoreMissingBcls_,
         ignoreMissingFilters_,
@@ -310,6 +331,8 @@ void AlignWorkflow::findMatches(
         matchFinderTooManyRepeats_,
         matchFinderWayTooManyRepeats_,
         matchFinderShadowSplitRepeats_,
+        seedExtensionRepeats_,
+        seedMismatches_,
         seedBaseQualityMin_,
         repeatThreshold_,
         neighborhoodSizeThreshold_,
@@ -319,6 +342,7 @@ void AlignWorkflow::findMatches(
         tempSaversMax_,
         memoryControl_,
         clusterIdList_,
+        sampleClusters_,
         sortedReferenceMetadataList_,
         contigLists_,
         optionalFeatures_ & BamZX,
@@ -326,7 +350,7 @@ void AlignWorkflow::findMatches(
         userTemplateLengthStatistics_, mapqThreshold_, perTileTls_, pfOnly_,
         reports::AlignmentReportGenerator::none != statsImageFormat_,
         baseQualityCutoff_,
-        keepUnaligned_, clipSemialigned_, clipOverlapping_,
+        keepUnaligned_, clipSemialigned_, clipOverlapping_, clipAdapterOverlap_, keepReadNames_,
         scatterRepeats_, rescueShadows_, trimPEAdapters_, anchorMate_, gappedMismatchesMax_, smitWatermanGapsMax_, smartSmithWaterman_, smitWatermanGapSizeMax_, splitAlignments_,
         alignmentCfg_,
         dodgyAlignmentScore_, anomalousPairHandicap_,
@@ -339,7 +363,9 @@ void AlignWorkflow::findMatches(
         binRegexString_,
         detectTemplateBlockSize_);
 
-    findMatchesTransition.perform(seedLength_, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath_);
+    findMatchesTransition.perform(
+        seedLength_, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath_,
+        matchSelectorStats, demultiplexingStats);
 }
 
 void AlignWorkflow::cleanupBins() const
@@ -355,13 +381,13 @@ void AlignWorkflow::cleanupBins() const
 
 void AlignWorkflow::generateAlignmentReports() const
 {
-    ISAAC_THREAD_CERR << "Generating the match selector reports from " << matchSelectorStatsXmlPath_ << std::endl;
+    ISAAC_THREAD_CERR << "Generating the match selector reports in " << reportsDirectory_ << std::endl;
     reports::AlignmentReportGenerator reportGenerator(flowcellLayoutList_, barcodeMetadataList_,
-                                                  matchSelectorStatsXmlPath_, demultiplexingStatsXmlPath_,
-                                                  tempDirectory_, reportsDirectory_,
-                                                  statsImageFormat_);
+                                                  foundMatchesMetadata_.tileMetadataList_,
+                                                  matchSelectorStats_, demultiplexingStats_,
+                                                  reportsDirectory_, statsImageFormat_, coresMax_);
     reportGenerator.run();
-    ISAAC_THREAD_CERR << "Generating the match selector reports done from " << matchSelectorStatsXmlPath_ << std::endl;
+    ISAAC_THREAD_CERR << "Generating the match selector reports done in " << reportsDirectory_ << std::endl;
 }
 
 const demultiplexing::BarcodePathMap AlignWorkflow::generateBam(
@@ -379,7 +405,7 @@ const demultiplexing::BarcodePathMap AlignWorkflow::generateBam(
                        contigLists_.node0Container(),
                        projectsDirectory_,
                        tempLoadersMax_, coresMax_, outputSaversMax_, realignGaps_, realignMapqMin_, knownIndelsPath_,
-                       bamGzipLevel_, bamPuFormat_, bamProduceMd5_, bamHeaderTags_, expectedCoverage_, targetBinSize_, expectedBgzfCompressionRatio_, singleLibrarySamples_,
+                       outputFormat_, bamGzipLevel_, bamPuFormat_, bamProduceMd5_, bamHeaderTags_, expectedCoverage_, targetBinSize_, expectedBgzfCompressionRatio_, singleLibrarySamples_,
                        keepDuplicates_, markDuplicates_, anchorMate_,
                        realignGapsVigorously_, realignDodgyFragments_, realignedGapsPerFragment_,
                        clipSemialigned_, alignmentCfg_,
@@ -454,7 +480,9 @@ AlignWorkflow::State AlignWorkflow::step()
     {
     case Start:
     {
-        findMatches(foundMatchesMetadata_, selectedMatchesMetadata_, barcodeTemplateLengthStatistics_);
+        findMatches(
+            foundMatchesMetadata_, selectedMatchesMetadata_, barcodeTemplateLengthStatistics_,
+            matchSelectorStats_, demultiplexingStats_);
         state_ = getNextState();
         break;
     }
@@ -0,0 +1,139 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file AlignProgress.cpp
+ **
+ ** \brief Persistent record of the tile chunks completed by the alignment phase.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cerrno>
+#include <fstream>
+
+#include <boost/format.hpp>
+
+#include "common/Debug.hh"
+#include "common/Exceptions.hh"
+#include "workflow/AlignWorkflowSerialization.hh"
+#include "workflow/alignWorkflow/AlignProgress.hh"
+
+namespace isaac
+{
+namespace workflow
+{
+namespace alignWorkflow
+{
+
+AlignProgress::AlignProgress(
+    const boost::filesystem::path &tempDirectory,
+    const bool collectCycleStats,
+    const flowcell::BarcodeMetadataList &barcodeMetadataList) :
+    tempDirectory_(tempDirectory),
+    collectCycleStats_(collectCycleStats),
+    barcodeMetadataList_(barcodeMetadataList),
+    nextChunk_(0)
+{
+}
+
+boost::filesystem::path AlignProgress::getChunkPath(const std::size_t chunk) const
+{
+    return tempDirectory_ / (boost::format("AlignProgress-%06d.txt") % chunk).str();
+}
+
+void AlignProgress::clear()
+{
+    unsigned removed = 0;
+    for (std::size_t chunk = 0; boost::filesystem::remove(getChunkPath(chunk)); ++chunk)
+    {
+        ++removed;
+    }
+    if (removed)
+    {
+        ISAAC_THREAD_CERR << "Removed " << removed << " alignment progress records of a previous run" << std::endl;
+    }
+    loadedChunks_.clear();
+    nextChunk_ = 0;
+}
+
+void AlignProgress::load(
+    alignment::BinMetadataList &binMetadataList,
+    std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+    demultiplexing::DemultiplexingStats &demultiplexingStats)
+{
+    loadedChunks_.clear();
+    for (nextChunk_ = 0; boost::filesystem::exists(getChunkPath(nextChunk_)); ++nextChunk_)
+    {
+        const boost::filesystem::path chunkPath = getChunkPath(nextChunk_);
+        std::ifstream ifs(chunkPath.string().c_str());
+        if (!ifs)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open " + chunkPath.string()));
+        }
+        boost::archive::text_iarchive ia(ifs);
+
+        loadedChunks_.push_back(Chunk());
+        Chunk &chunk = loadedChunks_.back();
+        ia >> boost::serialization::make_nvp("tiles", chunk.tiles_);
+        for (std::size_t i = 0; chunk.tiles_.size() != i; ++i)
+        {
+            chunk.tileStats_.push_back(alignment::matchSelector::MatchSelectorStats(collectCycleStats_, barcodeMetadataList_));
+            ia >> boost::serialization::make_nvp("tileStats", chunk.tileStats_.back());
+        }
+
+        // only the state of the last chunk matters. Earlier ones get overwritten
+        binMetadataList.clear();
+        ia >> boost::serialization::make_nvp("bins", binMetadataList);
+        ia >> boost::serialization::make_nvp("tls", barcodeTemplateLengthStatistics);
+        ia >> boost::serialization::make_nvp("demultiplexing", demultiplexingStats);
+    }
+    ISAAC_THREAD_CERR << "Loaded " << loadedChunks_.size() << " alignment progress records" << std::endl;
+}
+
+void AlignProgress::save(
+    const flowcell::TileMetadataList &chunkTiles,
+    const std::vector<alignment::matchSelector::MatchSelectorStats> &tileStats,
+    const alignment::BinMetadataList &binMetadataList,
+    const std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
+    const demultiplexing::DemultiplexingStats &demultiplexingStats)
+{
+    const boost::filesystem::path chunkPath = getChunkPath(nextChunk_);
+    const boost::filesystem::path tmp = chunkPath.string() + ".tmp";
+    {
+        std::ofstream ofs(tmp.string().c_str());
+        if (!ofs)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to open " + tmp.string()));
+        }
+        boost::archive::text_oarchive oa(ofs);
+        oa << boost::serialization::make_nvp("tiles", chunkTiles);
+        for (const flowcell::TileMetadata &tile : chunkTiles)
+        {
+            oa << boost::serialization::make_nvp("tileStats", tileStats.at(tile.getIndex()));
+        }
+        oa << boost::serialization::make_nvp("bins", binMetadataList);
+        oa << boost::serialization::make_nvp("tls", barcodeTemplateLengthStatistics);
+        oa << boost::serialization::make_nvp("demultiplexing", demultiplexingStats);
+        if (!ofs)
+        {
+            BOOST_THROW_EXCEPTION(common::IoException(errno, "Failed to write " + tmp.string()));
+        }
+    }
+    // the record either exists complete or does not exist at all
+    boost::filesystem::rename(tmp, chunkPath);
+    ISAAC_THREAD_CERR << "Recorded alignment progress " << chunkPath << " for " << chunkTiles.size() << " tiles" << std::endl;
+    ++nextChunk_;
+}
+
+} // namespace alignWorkflow
+} // namespace workflow
+} // namespace isaac
@@ -17,6 +17,9 @@
  ** \author Roman Petrovski
  **/
 
+#include <boost/exception/diagnostic_information.hpp>
+#include <boost/lexical_cast.hpp>
+
 #include "oligo/Nucleotides.hh"
 #include "workflow/alignWorkflow/BamDataSource.hh"
 #include "workflow/alignWorkflow/bamDataSource/SingleEndClusterExtractor.hh"
@@ -59,6 +62,21 @@ unsigned BamClusterLoader::loadPairedReads(
         }
         else
         {
+            clusterCount = clusterExtractor_.extractMated(
+                readMetadataList.at(0).getLength(), readMetadataList.at(1).getLength(), nameLengthMax, clusterCount,
+                clusterIt, pfIt);
+            if (!clusterCount)
+            {
+                // there is no room to extract any more mated items. Resume on next call.
+                return requestedClusterCount;
+            }
+
+            if (inputExhausted_)
+            {
+                // only the mated clusters can be produced until the caller collects the unpaired reads
+                break;
+            }
+
             if (!clusterExtractor_.isEmpty())
             {
                 ISAAC_THREAD_CERR << "resuming from " << clusterExtractor_.size() << " pending elements" << std::endl;
@@ -85,8 +103,12 @@ unsigned BamClusterLoader::loadPairedReads(
 
             if (clusterCount)
             {
-                // we've ran out of data in the bam file. See if unpaired items can be paired
-                clusterExtractor_.startExtractingUnpaired();
+                inputExhausted_ = true;
+                if (resolveUnpaired_)
+                {
+                    // we've ran out of data in the bam file. See if unpaired items can be paired
+                    clusterExtractor_.startExtractingUnpaired();
+                }
             }
         }
     }
@@ -104,6 +126,8 @@ void BamClusterLoader::open(
         clusterExtractor_.open(flowcellId);
         bamLoader_.open(bamPath);
         flowcellId_ = flowcellId;
+        resolveUnpaired_ = true;
+        inputExhausted_ = false;
     }
     else
     {
@@ -111,6 +135,20 @@ void BamClusterLoader::open(
     }
 }
 
+void BamClusterLoader::open(
+    const std::string &tempKey,
+    const boost::filesystem::path &bamPath,
+    const bam::BamFileRegion &region)
+{
+    ISAAC_THREAD_CERR << "Opening " << region << " of " << bamPath << std::endl;
+    clusterExtractor_.open(tempKey);
+    bamLoader_.open(bamPath, region);
+    // force reopen if the next open is for the whole file
+    flowcellId_.clear();
+    resolveUnpaired_ = false;
+    inputExhausted_ = false;
+}
+
 template <typename InsertIt, typename PfInserIt>
 unsigned BamClusterLoader::loadSingleReads(
     unsigned clusterCount, const unsigned nameLengthMax, const flowcell::ReadMetadataList &readMetadataList,
@@ -167,7 +205,8 @@ BamBaseCallsSource::BamBaseCallsSource(
             getBamFileSize(bamFlowcellLayout_), bamFlowcellLayout.getFlowcellId().length(),
             bamFlowcellLayout_.getReadNameLength(),
             flowcell::getTotalReadLength(bamFlowcellLayout.getReadMetadataList()),
-            flowcell::getMinReadLength(bamFlowcellLayout.getReadMetadataList()))
+            flowcell::getMinReadLength(bamFlowcellLayout.getReadMetadataList()),
+            availableMemory / PENDING_MATES_MEMORY_FRACTION)
 {
 }
 
@@ -328,6 +367,324 @@ void BackgroundBamBaseCallsSource::loadClusters(
     ISAAC_THREAD_CERR << "BackgroundBamBaseCallsSource::loadClusters done" << std::endl;
 }
 
+RegionBamBaseCallsSource::RegionLoader::RegionLoader(
+    const bool cleanupIntermediary,
+    const unsigned coresMax,
+    const boost::filesystem::path &tempDirectoryPath,
+    const std::size_t maxBamFileLength,
+    const std::size_t maxTempKeyLength,
+    const flowcell::Layout &bamFlowcellLayout,
+    const unsigned clusterLength,
+    const std::size_t pendingMatesMemory) :
+        threads_(std::min(coresMax, 2U)),
+        bamClusterLoader_(
+            cleanupIntermediary, 0, threads_, coresMax, tempDirectoryPath,
+            maxBamFileLength, maxTempKeyLength,
+            bamFlowcellLayout.getReadNameLength(),
+            flowcell::getTotalReadLength(bamFlowcellLayout.getReadMetadataList()),
+            flowcell::getMinReadLength(bamFlowcellLayout.getReadMetadataList()),
+            pendingMatesMemory),
+        loading_(clusterLength),
+        loaded_(clusterLength),
+        region_(NO_REGION),
+        tileLoaded_(false),
+        regionDone_(false)
+{
+}
+
+static const std::string REGION_TEMP_KEY_SUFFIX = "-region";
+
+RegionBamBaseCallsSource::RegionBamBaseCallsSource(
+    const boost::filesystem::path &tempDirectoryPath,
+    const uint64_t availableMemory,
+    const unsigned clustersAtATimeMax,
+    const bool cleanupIntermediary,
+    const unsigned coresMax,
+    const flowcell::Layout &bamFlowcellLayout,
+    const bam::BamFileRegions &regions,
+    const unsigned regionLoadersCount) :
+        bamFlowcellLayout_(bamFlowcellLayout),
+        bamPath_(bamFlowcellLayout_.getAttribute<flowcell::Layout::Bam, flowcell::BamFilePathAttributeTag>()),
+        tileClustersMax_(clustersAtATimeMax),
+        clusterLength_(flowcell::getTotalReadLength(bamFlowcellLayout_.getReadMetadataList()) + bamFlowcellLayout_.getBarcodeLength() + bamFlowcellLayout_.getReadNameLength()),
+        regions_(regions),
+        unpairedReadsCache_(
+            tempDirectoryPath, getBamFileSize(bamFlowcellLayout_), bamFlowcellLayout_.getFlowcellId().length(),
+            bamFlowcellLayout_.getReadNameLength(),
+            flowcell::getTotalReadLength(bamFlowcellLayout_.getReadMetadataList()),
+            cleanupIntermediary,
+            availableMemory / PENDING_MATES_MEMORY_FRACTION),
+        clusters_(clusterLength_)
+{
+    ISAAC_ASSERT_MSG(regionLoadersCount, "At least one region loader is required");
+    const unsigned loadersCount = std::min<std::size_t>(regionLoadersCount, regions_.size());
+    ISAAC_THREAD_CERR << "Loading " << regions_.size() << " regions of " << bamPath_ << " with " << loadersCount << " loaders" << std::endl;
+    unpairedReadsCache_.open(bamFlowcellLayout_.getFlowcellId());
+
+    for (unsigned i = 0; loadersCount != i; ++i)
+    {
+        regionLoaders_.push_back(std::unique_ptr<RegionLoader>(new RegionLoader(
+            cleanupIntermediary, std::max(1U, coresMax / loadersCount), tempDirectoryPath,
+            getBamFileSize(bamFlowcellLayout_),
+            bamFlowcellLayout_.getFlowcellId().length() + REGION_TEMP_KEY_SUFFIX.length() + 10,
+            bamFlowcellLayout_, clusterLength_,
+            availableMemory / PENDING_MATES_MEMORY_FRACTION / loadersCount)));
+    }
+
+    for (unsigned i = 0; loadersCount != i; ++i)
+    {
+        RegionLoader &regionLoader = *regionLoaders_[i];
+        loadThreads_.push_back(std::thread([this, &regionLoader, i](){loadRegionsThread(regionLoader, i);}));
+    }
+}
+
+RegionBamBaseCallsSource::~RegionBamBaseCallsSource()
+{
+    {
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        terminateRequested_ = true;
+        stateChangeEvent_.notify_all();
+    }
+    std::for_each(loadThreads_.begin(), loadThreads_.end(), [](std::thread &t){t.join();});
+}
+
+unsigned RegionBamBaseCallsSource::getRegionLoadersMax(
+    const uint64_t availableMemory,
+    const unsigned clustersAtATimeMax,
+    const unsigned coresMax,
+    const flowcell::Layout &bamFlowcellLayout)
+{
+    const uint64_t clusterLength = flowcell::getTotalReadLength(bamFlowcellLayout.getReadMetadataList()) +
+        bamFlowcellLayout.getBarcodeLength() + bamFlowcellLayout.getReadNameLength();
+    // each loader holds one tile being loaded and one waiting to be picked up
+    const uint64_t loaderMemory = clusterLength * clustersAtATimeMax * 2;
+    // there is no point in having a loader that does not have a core for parsing and another for decompression
+    return std::max<uint64_t>(1, std::min<uint64_t>(coresMax / 2, availableMemory / REGION_TILES_MEMORY_FRACTION / loaderMemory));
+}
+
+bam::BamFileRegions RegionBamBaseCallsSource::makeRegions(
+    const bam::BamIndexReader &bamIndex,
+    const unsigned clustersAtATimeMax,
+    const flowcell::Layout &bamFlowcellLayout)
+{
+    // with the quality scores taking most of the space, bgzf-compressed bam comes to roughly a byte per base
+    const uint64_t compressedBytesPerCluster = flowcell::getTotalReadLength(bamFlowcellLayout.getReadMetadataList());
+    return bamIndex.makeRegions(compressedBytesPerCluster * clustersAtATimeMax);
+}
+
+unsigned RegionBamBaseCallsSource::loadTile(BamClusterLoader &bamClusterLoader, alignment::BclClusters &clusters)
+{
+    clusters.reset(clusterLength_, tileClustersMax_);
+    alignment::BclClusters::iterator clustersEnd = clusters.cluster(0);
+    clusters.pf().clear();
+    std::back_insert_iterator<std::vector<bool> > pfIt(clusters.pf());
+    const unsigned clustersLoaded = bamClusterLoader.loadClusters(tileClustersMax_,
+        bamFlowcellLayout_.getReadNameLength(), bamFlowcellLayout_.getReadMetadataList(), clustersEnd, pfIt);
+    clusters.reset(clusterLength_, clustersLoaded);
+    return clustersLoaded;
+}
+
+void RegionBamBaseCallsSource::loadRegionsThread(RegionLoader &regionLoader, const std::size_t regionLoaderIndex)
+{
+    ISAAC_THREAD_CERR<< "RegionBamBaseCallsSource load thread " << regionLoaderIndex << " started" << std::endl;
+    const std::string tempKey = bamFlowcellLayout_.getFlowcellId() + REGION_TEMP_KEY_SUFFIX +
+        boost::lexical_cast<std::string>(regionLoaderIndex);
+
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    try
+    {
+        while (!terminateRequested_ && regions_.size() != nextRegion_)
+        {
+            // regions are taken in order so that the client can find the loader for the next region
+            regionLoader.region_ = nextRegion_++;
+            {
+                common::unlock_guard<std::unique_lock<std::mutex> > unlock(lock);
+                regionLoader.bamClusterLoader_.open(tempKey, bamPath_, regions_.at(regionLoader.region_));
+            }
+
+            while (!terminateRequested_ && !regionLoader.regionDone_)
+            {
+                unsigned loadedClustersCount = 0;
+                {
+                    // make sure client thread can pick up previous tile while we're loading this one
+                    common::unlock_guard<std::unique_lock<std::mutex> > unlock(lock);
+                    loadedClustersCount = loadTile(regionLoader.bamClusterLoader_, regionLoader.loading_);
+                }
+
+                while (regionLoader.tileLoaded_ && !terminateRequested_)
+                {
+                    // last loaded tile has not been picked up
+                    stateChangeEvent_.wait(lock);
+                }
+
+                if (loadedClustersCount)
+                {
+                    regionLoader.loaded_.swap(regionLoader.loading_);
+                    regionLoader.tileLoaded_ = true;
+                }
+                else
+                {
+                    regionLoader.regionDone_ = true;
+                }
+                stateChangeEvent_.notify_all();
+            }
+
+            while (regionLoader.regionDone_ && !terminateRequested_)
+            {
+                // client has not collected the unpaired reads of the region yet
+                stateChangeEvent_.wait(lock);
+            }
+        }
+    }
+    catch (...)
+    {
+        // exceptions can't leave std::thread. Keep the first one for the client and stop the other loaders
+        if (!loaderException_)
+        {
+            loaderException_ = boost::current_exception();
+            ISAAC_THREAD_CERR << "ERROR: RegionBamBaseCallsSource load thread " << regionLoaderIndex <<
+                " caught an exception: " << boost::current_exception_diagnostic_information() << std::endl;
+        }
+        terminateRequested_ = true;
+        stateChangeEvent_.notify_all();
+        return;
+    }
+    ISAAC_THREAD_CERR<< "RegionBamBaseCallsSource load thread " << regionLoaderIndex << " terminated" << std::endl;
+}
+
+RegionBamBaseCallsSource::RegionLoader &RegionBamBaseCallsSource::waitForCurrentRegionLoader(std::unique_lock<std::mutex> &lock)
+{
+    while (true)
+    {
+        if (loaderException_)
+        {
+            boost::rethrow_exception(loaderException_);
+        }
+
+        for (std::unique_ptr<RegionLoader> &regionLoader : regionLoaders_)
+        {
+            if (currentRegion_ == regionLoader->region_ && (regionLoader->tileLoaded_ || regionLoader->regionDone_))
+            {
+                return *regionLoader;
+            }
+        }
+        stateChangeEvent_.wait(lock);
+    }
+}
+
+/**
+ * \brief Produces tile out of the reads that found their mates in the shared cache. If unpaired is set, all
+ *        regions are expected to be done and the reads that don't have mates are extracted too.
+ */
+unsigned RegionBamBaseCallsSource::extractCached(const bool unpaired)
+{
+    const flowcell::ReadMetadataList &readMetadataList = bamFlowcellLayout_.getReadMetadataList();
+    if (2 != readMetadataList.size())
+    {
+        // single-ended data does not have anything to pair
+        return 0;
+    }
+
+    clusters_.reset(clusterLength_, tileClustersMax_);
+    alignment::BclClusters::iterator clustersEnd = clusters_.cluster(0);
+    clusters_.pf().clear();
+    std::back_insert_iterator<std::vector<bool> > pfIt(clusters_.pf());
+
+    unsigned clusterCount = 0;
+    if (unpaired)
+    {
+        if (!unpairedReadsCache_.extractingUnpaired())
+        {
+            unpairedReadsCache_.startExtractingUnpaired();
+        }
+        clusterCount = unpairedReadsCache_.extractClusters(
+            readMetadataList.at(0).getLength(), readMetadataList.at(1).getLength(), bamFlowcellLayout_.getReadNameLength(),
+            tileClustersMax_, clustersEnd, pfIt);
+    }
+    else
+    {
+        clusterCount = unpairedReadsCache_.extractMated(
+            readMetadataList.at(0).getLength(), readMetadataList.at(1).getLength(), bamFlowcellLayout_.getReadNameLength(),
+            tileClustersMax_, clustersEnd, pfIt);
+    }
+
+    const unsigned clustersLoaded = tileClustersMax_ - clusterCount;
+    clusters_.reset(clusterLength_, clustersLoaded);
+    return clustersLoaded;
+}
+
+flowcell::TileMetadataList RegionBamBaseCallsSource::discoverTiles()
+{
+    ISAAC_THREAD_CERR << "RegionBamBaseCallsSource::discoverTiles" << std::endl;
+    std::unique_lock<std::mutex> lock(stateMutex_);
+
+    unsigned clustersLoaded = 0;
+    while (!clustersLoaded)
+    {
+        if (regions_.size() == currentRegion_)
+        {
+            clustersLoaded = extractCached(true);
+            break;
+        }
+
+        RegionLoader &regionLoader = waitForCurrentRegionLoader(lock);
+        if (regionLoader.tileLoaded_)
+        {
+            clusters_.swap(regionLoader.loaded_);
+            clustersLoaded = clusters_.getClusterCount();
+            regionLoader.tileLoaded_ = false;
+        }
+        else
+        {
+            if (2 == bamFlowcellLayout_.getReadMetadataList().size())
+            {
+                // the loader is waiting for us to collect the unpaired reads of its region
+                common::unlock_guard<std::unique_lock<std::mutex> > unlock(lock);
+                regionLoader.bamClusterLoader_.forEachUnpaired(
+                    [this](const char *record){unpairedReadsCache_.storeRecord(record);});
+            }
+            ISAAC_THREAD_CERR << "Done with " << regions_.at(currentRegion_) << " " <<
+                unpairedReadsCache_.getMatedCount() << " mated clusters cached" << std::endl;
+            regionLoader.regionDone_ = false;
+            regionLoader.region_ = RegionLoader::NO_REGION;
+            ++currentRegion_;
+            if (unpairedReadsCache_.getMatedCount() >= tileClustersMax_)
+            {
+                clustersLoaded = extractCached(false);
+            }
+        }
+        stateChangeEvent_.notify_all();
+    }
+
+    flowcell::TileMetadataList ret;
+    if (clustersLoaded)
+    {
+        ret.push_back(flowcell::TileMetadata(
+            bamFlowcellLayout_.getFlowcellId(), bamFlowcellLayout_.getIndex(), ++loadedTile_,
+            1, clustersLoaded, 0));
+    }
+    ISAAC_THREAD_CERR << "RegionBamBaseCallsSource::discoverTiles done" << std::endl;
+    return ret;
+}
+
+void RegionBamBaseCallsSource::loadClusters(
+    const flowcell::TileMetadata &tileMetadata,
+    alignment::BclClusters &bclData)
+{
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    if (loaderException_)
+    {
+        boost::rethrow_exception(loaderException_);
+    }
+
+    ISAAC_ASSERT_MSG(tileMetadata.getFlowcellIndex() == bamFlowcellLayout_.getIndex(), "Unexpected tile requested " << tileMetadata);
+    ISAAC_ASSERT_MSG(tileMetadata.getLane() == 1, "Unexpected tile lane requested: " << tileMetadata);
+    ISAAC_ASSERT_MSG(tileMetadata.getTile() == loadedTile_, "Unexpected tile tile requested: " << tileMetadata);
+
+    ISAAC_THREAD_CERR << "Loaded bam tile: " << tileMetadata << " with " << clusters_.getClusterCount() << " clusters" << std::endl;
+    bclData.swap(clusters_);
+}
+
 
 } // namespace alignWorkflow
 } // namespace workflow
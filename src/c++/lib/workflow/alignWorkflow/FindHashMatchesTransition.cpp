@@ -17,6 +17,9 @@
  ** \author Roman Petrovski
  **/
 
+#include <numeric>
+
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/ref.hpp>
 
 #include "alignment/HashMatchFinder.hh"
@@ -26,6 +29,7 @@
 #include "common/Debug.hh"
 #include "common/Exceptions.hh"
 #include "common/Numa.hh"
+#include "common/PerfTrace.hh"
 #include "demultiplexing/DemultiplexingStatsXml.hh"
 #include "flowcell/Layout.hh"
 #include "flowcell/ReadMetadata.hh"
@@ -110,9 +114,8 @@ void IoOverlapThreadWorker::run(
     unsigned &nextTile,
     unsigned &nextUnprocessedTile,
     DataSourceT &dataSource,
-    const HashMatchFinder &matchFinder,
+    const std::vector<const HashMatchFinder *> &referenceMatchFinders,
     alignment::matchFinder::TileClusterInfo &tileClusterInfo,
-    std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     common::ScopedMallocBlock &mallocBlock)
 {
     boost::unique_lock<boost::mutex> lock(mutex_);
@@ -128,6 +131,7 @@ void IoOverlapThreadWorker::run(
             {
                 common::ScopedMallocBlockUnblock unblockMalloc(mallocBlock);
                 common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                ISAAC_PERF_SCOPE("align.loadTile");
 
                 dataSource.resetBclData(tileMetadata, tileClusters_);
                 dataSource.loadClusters(tileMetadata, tileClusters_);
@@ -138,6 +142,7 @@ void IoOverlapThreadWorker::run(
             }
         }
 
+        uint64_t ticket = 0;
         ISAAC_BLOCK_WITH_CLENAUP([&](bool exceptionUnwinding)
         {
             if (exceptionUnwinding) {forceTermination_ = true;}
@@ -154,39 +159,62 @@ void IoOverlapThreadWorker::run(
 
                 stateChangedCondition_.wait(lock);
             }
-#ifdef ISAAC_ALIGNMENT_LOOP_ENABLED
-            while (true)
-#endif //ISAAC_ALIGNMENT_LOOP_ENABLED
+            ticket = matchSelector_.submitTile(tileMetadata, tileClusterInfo.at(tileMetadata.getIndex()), tileClusters_);
+            // the next tile can be submitted as soon as it is loaded. Compute threads move to it when they
+            // run out of clusters in this one.
+            ++nextUnprocessedTile;
+        }
+
+        ISAAC_BLOCK_WITH_CLENAUP([&](bool exceptionUnwinding)
+        {
+            if (exceptionUnwinding) {forceTermination_ = true;}
+            stateChangedCondition_.notify_all();
+        })
+        {
             {
                 common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
-                matchSelector_.parallelSelect(tileClusterInfo, barcodeTemplateLengthStatistics, tileMetadata, matchFinder, tileClusters_, fragmentStorage_);
+                ISAAC_PERF_SCOPE("align.selectMatches");
+                matchSelector_.waitTile(ticket);
             }
 
-            // swap the flush buffers while we still have compute lock
+            // other tiles might be still aligning and storing fragments. prepareFlush is expected to deal with it
             wait(flushing_, stateChangedCondition_, lock, forceTermination_);
             {
                 fragmentStorage_.prepareFlush();
             }
-            ++nextUnprocessedTile;
         }
 
         // flush asynchronously so that other guys can load and align at the same time
         ISAAC_BLOCK_WITH_CLENAUP(boost::bind(&release, boost::ref(flushing_), boost::ref(stateChangedCondition_), boost::ref(forceTermination_), _1))
 //        ISAAC_BLOCK_WITH_CLENAUP([&](bool){release(flushing_, stateChangedCondition_);})
         {
-            // flush slot already acquired when we had the compute slot but the state could have changed in between.
+            // flush slot already acquired when the tile was aligned but the state could have changed in between.
             if (forceTermination_)
             {
                 BOOST_THROW_EXCEPTION(common::ThreadingException("Terminating due to failures on other threads"));
             }
             {
                 common::unlock_guard<boost::unique_lock<boost::mutex> > unlock(lock);
+                ISAAC_PERF_SCOPE("align.flushFragments");
                 fragmentStorage_.flush();
             }
         }
     }
 }
 
+template <typename DataSourceT>
+void IoOverlapThreadWorker::skip(
+    const flowcell::TileMetadataList &tiles,
+    DataSourceT &dataSource)
+{
+    for (const flowcell::TileMetadata &tileMetadata : tiles)
+    {
+        ISAAC_THREAD_CERR << "Skipping tile aligned by the previous run: " << tileMetadata << std::endl;
+        dataSource.resetBclData(tileMetadata, tileClusters_);
+        dataSource.loadClusters(tileMetadata, tileClusters_);
+    }
+}
+
 } // namespace findHashMatchesTransition
 
 FindHashMatchesTransition::FindHashMatchesTransition(
@@ -194,6 +222,8 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     const flowcell::FlowcellLayoutList &flowcellLayoutList,
     const flowcell::BarcodeMetadataList &barcodeMetadataList,
     const bool cleanupIntermediary,
+    const bool checkpointAlignment,
+    const bool resumeAlignment,
     const unsigned bclTilesPerChunk,
     const bool ignoreMissingBcls,
     const bool ignoreMissingFilters,
@@ -207,6 +237,8 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     const unsigned matchFinderTooManyRepeats,
     const unsigned matchFinderWayTooManyRepeats,
     const unsigned matchFinderShadowSplitRepeats,
+    const unsigned seedExtensionRepeats,
+    const unsigned seedMismatches,
     const unsigned seedBaseQualityMin,
     const unsigned repeatThreshold,
     const unsigned neighborhoodSizeThreshold,
@@ -216,6 +248,7 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     const unsigned tempSaversMax,
     const common::ScopedMallocBlock::Mode memoryControl,
     const std::vector<std::size_t> &clusterIdList,
+    const double sampleClusters,
     const reference::SortedReferenceMetadataList &sortedReferenceMetadataList,
     const reference::NumaContigLists &contigLists,
     const bool extractClusterXy,
@@ -229,6 +262,8 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     const bool keepUnaligned,
     const bool clipSemialigned,
     const bool clipOverlapping,
+    const bool clipAdapterOverlap,
+    const bool keepReadNames,
     const bool scatterRepeats,
     const bool rescueShadows,
     const bool trimPEAdapters,
@@ -257,12 +292,16 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     , coresMax_(maxThreadCount)
     , candidateMatchesMax_(candidateMatchesMax)
     , matchFinderMaxRepeats_(std::max(matchFinderTooManyRepeats, std::max(matchFinderWayTooManyRepeats, matchFinderShadowSplitRepeats)))
+    , seedExtensionRepeats_(seedExtensionRepeats)
+    , seedMismatches_(seedMismatches)
     , seedBaseQualityMin_(seedBaseQualityMin)
     , seedLength_(seedLength)
     , repeatThreshold_(repeatThreshold)
     , neighborhoodSizeThreshold_(neighborhoodSizeThreshold)
     , barcodeMetadataList_(barcodeMetadataList)
     , cleanupIntermediary_(cleanupIntermediary)
+    , checkpointAlignment_(checkpointAlignment)
+    , resumeAlignment_(resumeAlignment)
     , bclTilesPerChunk_(bclTilesPerChunk)
     , ignoreMissingBcls_(ignoreMissingBcls)
     , ignoreMissingFilters_(ignoreMissingFilters)
@@ -288,7 +327,8 @@ FindHashMatchesTransition::FindHashMatchesTransition(
     // Have thread pool for the maximum number of threads we may potentially need.
     , threads_(std::max(inputLoadersMax_, coresMax_))
 
-    , ioOverlapThreads_(2)
+    // one thread per tile in flight plus the one that drives the compute threads
+    , ioOverlapThreads_(alignment::MatchSelector::TILES_IN_FLIGHT_MAX + 1)
     , contigLists_(contigLists)
 
     , alignmentCfg_(alignmentCfg)
@@ -300,6 +340,7 @@ FindHashMatchesTransition::FindHashMatchesTransition(
         candidateMatchesMax_,
         repeatThreshold_,
         clusterIdList_,
+        sampleClusters,
         mateDriftRange,
         userTemplateLengthStatistics,
         mapqThreshold,
@@ -315,6 +356,8 @@ FindHashMatchesTransition::FindHashMatchesTransition(
         keepUnaligned,
         clipSemialigned,
         clipOverlapping,
+        clipAdapterOverlap,
+        keepReadNames,
         scatterRepeats,
         rescueShadows,
         trimPEAdapters,
@@ -330,7 +373,9 @@ FindHashMatchesTransition::FindHashMatchesTransition(
         common::ScopedMallocBlock::Strict == memoryControl_,
         detectTemplateBlockSize),
         qScoreBin_(qScoreBin),
-        fullBclQScoreTable_(fullBclQScoreTable)
+        fullBclQScoreTable_(fullBclQScoreTable),
+        alignProgress_(tempDirectory_, collectCycleStats, barcodeMetadataList_),
+        chunk_(0)
 {
 }
 
@@ -340,9 +385,12 @@ void FindHashMatchesTransition::perform(
     alignWorkflow::FoundMatchesMetadata &foundMatches,
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-    const boost::filesystem::path &matchSelectorStatsXmlPath)
+    const boost::filesystem::path &matchSelectorStatsXmlPath,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats)
 {
-    align<KmerT>(foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath);
+    align<KmerT>(foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath,
+                 matchSelectorStats, demultiplexingStats);
 }
 
 
@@ -353,6 +401,8 @@ void FindHashMatchesTransition::perform(
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     const boost::filesystem::path &matchSelectorStatsXmlPath,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats,
     boost::mpl::true_ endofvec)
 {
     ISAAC_ASSERT_MSG(false, "Unexpected seed length " << seedLength);
@@ -365,18 +415,22 @@ void FindHashMatchesTransition::perform(
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     const boost::filesystem::path &matchSelectorStatsXmlPath,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats,
     boost::mpl::false_)
 {
     if(seedLength == boost::mpl::deref<It>::type::value)
     {
         perform<oligo::BasicKmerType<boost::mpl::deref<It>::type::value> >(
-            foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath);
+            foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath,
+            matchSelectorStats, demultiplexingStats);
     }
     else
     {
         typedef typename boost::mpl::next<It>::type Next;
         perform<Next,End>(
-            seedLength, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath, typename boost::is_same<Next,End>::type());
+            seedLength, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath,
+            matchSelectorStats, demultiplexingStats, typename boost::is_same<Next,End>::type());
     }
 }
 
@@ -385,14 +439,16 @@ void FindHashMatchesTransition::perform(
     alignWorkflow::FoundMatchesMetadata &foundMatches,
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-    const boost::filesystem::path &matchSelectorStatsXmlPath)
+    const boost::filesystem::path &matchSelectorStatsXmlPath,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats)
 {
     typedef boost::mpl::begin<oligo::SUPPORTED_KMERS>::type begin;
     typedef boost::mpl::end<oligo::SUPPORTED_KMERS>::type end;
 
     perform<begin,end>(
         seedLength, foundMatches, binMetadataList, barcodeTemplateLengthStatistics, matchSelectorStatsXmlPath,
-        boost::is_same<begin,end>::type());
+        matchSelectorStats, demultiplexingStats, boost::is_same<begin,end>::type());
 }
 
 
@@ -405,6 +461,7 @@ void FindHashMatchesTransition::resolveBarcodes(
     alignment::matchFinder::TileClusterInfo &tileClusterInfo,
     demultiplexing::DemultiplexingStats &demultiplexingStats)
 {
+    ISAAC_PERF_SCOPE("align.resolveBarcodes");
     ISAAC_ASSERT_MSG(!barcodeGroup.empty(), "At least 'none' barcode must be defined");
     if (1 == barcodeGroup.size())
     {
@@ -440,7 +497,7 @@ void FindHashMatchesTransition::resolveBarcodes(
             ISAAC_ASSERT_MSG(barcodeGroup.size(), "Barcode list must be not empty");
             ISAAC_ASSERT_MSG(barcodeGroup.at(0).isDefault(), "The very first barcode must be the 'unknown indexes or no index' one");
             barcodeSource.loadBarcodes(flowcell, barcodeGroup.at(0).getIndex(), currentTiles, barcodes);
-            barcodeResolver.resolve(barcodes, demultiplexingStats);
+            barcodeResolver.resolve(barcodes, threads_, demultiplexingStats);
 
             BOOST_FOREACH(const demultiplexing::Barcode &barcode, barcodes)
             {
@@ -495,12 +552,14 @@ template <typename ReferenceHashT>
 ReferenceHashT buildReferenceHash(
     const reference::ContigList &contigList,
     const std::size_t hashTableBucketCount,
+    const unsigned seedExtensionRepeats,
+    const unsigned seedMismatches,
     common::ThreadVector &threads,
     const unsigned coresMax)
 {
     reference::ReferenceHasher<ReferenceHashT> hasher(contigList, threads, coresMax);
 
-    ReferenceHashT ret = hasher.generate(hashTableBucketCount);
+    ReferenceHashT ret = hasher.generate(hashTableBucketCount, seedExtensionRepeats, seedMismatches);
 
     return ret;
 }
@@ -509,9 +568,9 @@ ReferenceHashT buildReferenceHash(
  * \brief Finds matches for the lane. Updates foundMatches with match information and tile metadata identified during
  *        the processing.
  */
-template <typename ReferenceHashT, typename DataSourceT>
+template <typename MatchFinderT, typename DataSourceT>
 void FindHashMatchesTransition::findLaneMatches(
-    const ReferenceHashT &referenceHash,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     const flowcell::Layout &flowcell,
     const unsigned lane,
     const flowcell::BarcodeMetadataList &laneBarcodes,
@@ -519,7 +578,8 @@ void FindHashMatchesTransition::findLaneMatches(
     DataSourceT &dataSource,
     demultiplexing::DemultiplexingStats &demultiplexingStats,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-    std::vector<findHashMatchesTransition::IoOverlapThreadWorker> &ioOverlapThreadWorkers)
+    std::vector<findHashMatchesTransition::IoOverlapThreadWorker> &ioOverlapThreadWorkers,
+    alignment::matchSelector::FragmentStorage &fragmentStorage)
 {
     if (!unprocessedTiles.empty())
     {
@@ -533,24 +593,37 @@ void FindHashMatchesTransition::findLaneMatches(
 
         ISAAC_THREAD_CERR << "Finding hash matches with repeat threshold: " << repeatThreshold_ << std::endl;
 
-        alignment::ClusterHashMatchFinder<ReferenceHashT, SEEDS_PER_MATCH_MAX> matchFinder(
-            referenceHash, candidateMatchesMax_, seedBaseQualityMin_, matchFinderMaxRepeats_);
-
         matchSelector_.reserveMemory(unprocessedTiles);
+        matchSelector_.beginTiles(unprocessedTiles);
 
         {
             unsigned current = 0;
             unsigned nextUnprocessed = 0;
             common::ScopedMallocBlock  mallocBlock(memoryControl_);
+            const unsigned tilesInFlight = std::min(unprocessedTiles.size(), ioOverlapThreadWorkers.size());
             ioOverlapThreads_.execute
             (
                 [&](const unsigned threadNumber, const unsigned threadsTotal)
                 {
-                    ioOverlapThreadWorkers.at(threadNumber).run(
-                        unprocessedTiles, current, nextUnprocessed, dataSource, matchFinder, tileClusterInfo,
-                        barcodeTemplateLengthStatistics, mallocBlock);
+                    if (tilesInFlight == threadNumber)
+                    {
+                        matchSelector_.alignTiles(
+                            unprocessedTiles.size(), referenceMatchFinders, barcodeTemplateLengthStatistics, fragmentStorage);
+                        return;
+                    }
+
+                    ISAAC_BLOCK_WITH_CLENAUP([&](bool exceptionUnwinding)
+                    {
+                        // don't leave compute threads waiting for tiles that will never come
+                        if (exceptionUnwinding) {matchSelector_.cancelTiles();}
+                    })
+                    {
+                        ioOverlapThreadWorkers.at(threadNumber).run(
+                            unprocessedTiles, current, nextUnprocessed, dataSource, referenceMatchFinders, tileClusterInfo,
+                            mallocBlock);
+                    }
                 },
-                std::min(unprocessedTiles.size(), ioOverlapThreadWorkers.size())
+                tilesInFlight + 1
             );
         }
 
@@ -600,11 +673,87 @@ static flowcell::BarcodeMetadataList findFlowcellLaneBarcodes(
 }
 
 
-template <typename ReferenceHashT, typename DataSourceT>
+unsigned FindHashMatchesTransition::getTilesInFlightMax(
+    const uint64_t availableMemory,
+    const unsigned maxTileClusters,
+    const flowcell::Layout &flowcell)
+{
+    const uint64_t clusterLength = flowcell::getTotalReadLength(flowcell.getReadMetadataList()) +
+        flowcell.getBarcodeLength() + flowcell.getReadNameLength();
+    const uint64_t tileMemory = std::max<uint64_t>(1, clusterLength * maxTileClusters);
+    // two tiles are needed to load one while aligning the other. More let compute threads move on to the next tile
+    // while the slowest clusters of the previous one are being aligned and the loader is busy.
+    return std::max<uint64_t>(2, std::min<uint64_t>(
+        alignment::MatchSelector::TILES_IN_FLIGHT_MAX, availableMemory / TILES_IN_FLIGHT_MEMORY_FRACTION / tileMemory));
+}
+
+uint64_t FindHashMatchesTransition::getReferenceHashReplicationPeak(
+    const std::vector<uint64_t> &hashMemorySizes,
+    const unsigned nodes)
+{
+    uint64_t interleaved = std::accumulate(hashMemorySizes.begin(), hashMemorySizes.end(), uint64_t(0));
+    uint64_t replicas = 0;
+    uint64_t ret = interleaved;
+    for (const uint64_t hashMemorySize : hashMemorySizes)
+    {
+        // the interleaved original is passed by value to the NumaReferenceHash constructor and is only released
+        // after all the replicas have been made
+        ret = std::max(ret, replicas + interleaved + hashMemorySize * nodes);
+        replicas += hashMemorySize * nodes;
+        interleaved -= hashMemorySize;
+    }
+    return ret;
+}
+
+bool FindHashMatchesTransition::canReplicateReferenceHash(
+    const uint64_t availableMemory,
+    const std::vector<uint64_t> &hashMemorySizes,
+    const unsigned nodes)
+{
+    if (1 >= nodes)
+    {
+        return false;
+    }
+    const uint64_t total = std::accumulate(hashMemorySizes.begin(), hashMemorySizes.end(), uint64_t(0));
+    const uint64_t peak = getReferenceHashReplicationPeak(hashMemorySizes, nodes);
+    const uint64_t aligning = total * nodes + availableMemory / TILES_IN_FLIGHT_MEMORY_FRACTION;
+    if (availableMemory < std::max(peak, aligning))
+    {
+        ISAAC_THREAD_CERR << "WARNING: not enough memory to replicate " << total <<
+            " bytes of reference hash on " << nodes << " NUMA nodes. Replication needs " << std::max(peak, aligning) <<
+            " bytes, available " << availableMemory << ". Using interleaved reference hash" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Makes sure the data source produces the same tiles as it did for the run that recorded the progress
+ */
+static void checkRecordedTiles(
+    const flowcell::TileMetadataList &recordedTiles,
+    const flowcell::TileMetadataList &tiles)
+{
+    if (recordedTiles.size() != tiles.size() ||
+        !std::equal(recordedTiles.begin(), recordedTiles.end(), tiles.begin(),
+                    [](const flowcell::TileMetadata &left, const flowcell::TileMetadata &right)
+                    {
+                        return left.getFlowcellIndex() == right.getFlowcellIndex() &&
+                            left.getLane() == right.getLane() && left.getTile() == right.getTile() &&
+                            left.getClusterCount() == right.getClusterCount() && left.getIndex() == right.getIndex();
+                    }))
+    {
+        BOOST_THROW_EXCEPTION(common::PreConditionException(
+            "Input data does not match the alignment progress recorded by the previous run. Use --start-from Start"));
+    }
+}
+
+template <typename MatchFinderT, typename DataSourceT>
 void FindHashMatchesTransition::processFlowcellTiles(
-    const ReferenceHashT &referenceHash,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
     const flowcell::Layout& flowcell,
     DataSourceT &dataSource,
+    const alignment::BinMetadataList &binMetadataList,
     demultiplexing::DemultiplexingStats &demultiplexingStats,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     FoundMatchesMetadata &foundMatches,
@@ -618,9 +767,12 @@ void FindHashMatchesTransition::processFlowcellTiles(
     flushing_ = false;
     forceTermination_ = false;
 
+    const unsigned tilesInFlight = getTilesInFlightMax(availableMemory_, dataSource.getMaxTileClusters(), flowcell);
+    ISAAC_THREAD_CERR << "Keeping up to " << tilesInFlight << " tiles in flight for " << flowcell << std::endl;
+
     ISAAC_TRACE_STAT("FindHashMatchesTransition::findLaneMatches before threads allocation")
     std::vector<findHashMatchesTransition::IoOverlapThreadWorker> ioOverlapThreadWorkers(
-        ioOverlapThreads_.size(),
+        tilesInFlight,
         findHashMatchesTransition::IoOverlapThreadWorker(
             mutex_,
             stateChangedCondition_,
@@ -657,17 +809,38 @@ void FindHashMatchesTransition::processFlowcellTiles(
                 // statistics properly
                 tileMetadata = foundMatches.tileMetadataList_.back();
             }
-            ISAAC_TRACE_STAT("FindHashMatchesTransition::processFlowcellTiles before findLaneMatches")
-            findLaneMatches(
-                referenceHash, flowcell, lane, laneBarcodes, laneTiles, dataSource,
-                demultiplexingStats, barcodeTemplateLengthStatistics, ioOverlapThreadWorkers);
+            if (alignProgress_.getLoadedChunkCount() > chunk_)
+            {
+                // aligned by the interrupted run. Keep the data source in step and take what the run has recorded
+                checkRecordedTiles(alignProgress_.getChunkTiles(chunk_), laneTiles);
+                ioOverlapThreadWorkers.front().skip(laneTiles, dataSource);
+                matchSelector_.restoreTileStats(laneTiles, alignProgress_.getChunkTileStats(chunk_));
+            }
+            else
+            {
+                ISAAC_TRACE_STAT("FindHashMatchesTransition::processFlowcellTiles before findLaneMatches")
+                findLaneMatches(
+                    referenceMatchFinders, flowcell, lane, laneBarcodes, laneTiles, dataSource,
+                    demultiplexingStats, barcodeTemplateLengthStatistics, ioOverlapThreadWorkers, fragmentStorage);
+
+                if (checkpointAlignment_)
+                {
+                    // no tiles are in flight between the chunks. Everything stored so far belongs to complete tiles
+                    ISAAC_PERF_SCOPE("align.checkpoint");
+                    fragmentStorage.sync();
+                    alignProgress_.save(
+                        laneTiles, matchSelector_.getTileStats(), binMetadataList, barcodeTemplateLengthStatistics, demultiplexingStats);
+                }
+            }
+            ++chunk_;
         }
     }
 }
 
-template <typename ReferenceHashT>
+template <typename MatchFinderT>
 void FindHashMatchesTransition::alignFlowcells(
-    const ReferenceHashT &referenceHash,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
+    const alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     demultiplexing::DemultiplexingStats &demultiplexingStats,
     FoundMatchesMetadata &foundMatches,
@@ -680,18 +853,42 @@ void FindHashMatchesTransition::alignFlowcells(
         {
             case flowcell::Layout::Bam:
             {
+                // the loading itself occurs on one thread at a time only. So, the real limit is to avoid using
+                // more cores for decompression than the system actually has.
+                // On the other hand, there might be a need to limit the io to 1 thread, while allowing
+                // for the multithreaded processing of other cpu-demanding things.
+                const unsigned bamCoresMax = std::min(inputLoadersMax_, coresMax_);
+                const boost::filesystem::path bamIndexPath = bam::BamIndexReader::findIndex(
+                    flowcell.getAttribute<flowcell::Layout::Bam, flowcell::BamFilePathAttributeTag>());
+                const unsigned regionLoaders = RegionBamBaseCallsSource::getRegionLoadersMax(
+                    availableMemory_, clustersAtATimeMax_, bamCoresMax, flowcell);
+                if (!bamIndexPath.empty() && 1 < regionLoaders)
+                {
+                    // with the index available, separate parts of the file can be parsed in parallel
+                    const bam::BamFileRegions regions = RegionBamBaseCallsSource::makeRegions(
+                        bam::BamIndexReader(bamIndexPath), clustersAtATimeMax_, flowcell);
+                    if (1 < regions.size())
+                    {
+                        RegionBamBaseCallsSource dataSource(
+                            tempDirectory_,
+                            availableMemory_,
+                            clustersAtATimeMax_,
+                            cleanupIntermediary_,
+                            bamCoresMax,
+                            flowcell, regions, regionLoaders);
+                        processFlowcellTiles(referenceMatchFinders, flowcell, dataSource, binMetadataList, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
+                        break;
+                    }
+                }
+
                 BackgroundBamBaseCallsSource dataSource(
                     tempDirectory_,
                     availableMemory_,
                     clustersAtATimeMax_,
                     cleanupIntermediary_,
-                    // the loading itself occurs on one thread at a time only. So, the real limit is to avoid using
-                    // more cores for decompression than the system actually has.
-                    // On the other hand, there might be a need to limit the io to 1 thread, while allowing
-                    // for the multithreaded processing of other cpu-demanding things.
-                    std::min(inputLoadersMax_, coresMax_),
+                    bamCoresMax,
                     flowcell, threads_);
-                processFlowcellTiles(referenceHash, flowcell, dataSource, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
+                processFlowcellTiles(referenceMatchFinders, flowcell, dataSource, binMetadataList, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
                 break;
             }
 
@@ -704,7 +901,7 @@ void FindHashMatchesTransition::alignFlowcells(
                     flowcell,
                     threads_);
 
-                processFlowcellTiles(referenceHash, flowcell, dataSource, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
+                processFlowcellTiles(referenceMatchFinders, flowcell, dataSource, binMetadataList, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
                 break;
             }
 
@@ -717,7 +914,7 @@ void FindHashMatchesTransition::alignFlowcells(
                 MultiTileBaseCallsSource<BclBaseCallsSource> multitileBaseCalls(bclTilesPerChunk_, flowcell, baseCalls);
 
                 processFlowcellTiles(
-                    referenceHash, flowcell, multitileBaseCalls, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
+                    referenceMatchFinders, flowcell, multitileBaseCalls, binMetadataList, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
                 break;
             }
 
@@ -728,7 +925,7 @@ void FindHashMatchesTransition::alignFlowcells(
                 MultiTileBaseCallsSource<BclBgzfBaseCallsSource> multitileBaseCalls(
                     bclTilesPerChunk_, flowcell, baseCalls);
 
-                processFlowcellTiles(referenceHash, flowcell, multitileBaseCalls, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
+                processFlowcellTiles(referenceMatchFinders, flowcell, multitileBaseCalls, binMetadataList, demultiplexingStats, barcodeTemplateLengthStatistics, foundMatches, fragmentStorage);
                 break;
             }
 
@@ -740,9 +937,10 @@ void FindHashMatchesTransition::alignFlowcells(
         }
     }
 }
-template <typename ReferenceHashT>
+template <typename MatchFinderT>
 void FindHashMatchesTransition::alignFlowcells(
-    const ReferenceHashT &referenceHash,
+    const std::vector<const MatchFinderT *> &referenceMatchFinders,
+    const alignment::BinMetadataList &checkpointBinMetadataList,
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
     demultiplexing::DemultiplexingStats &demultiplexingStats,
@@ -750,25 +948,26 @@ void FindHashMatchesTransition::alignFlowcells(
 {
     // unit of genome to use for counting alignment distribution
     static const unsigned TRACKING_BIN_LENGTH = 10000;
-    alignment::matchSelector::BinIndexMap binIndexMap(sortedReferenceMetadataList_.front(), TRACKING_BIN_LENGTH);
+    const reference::SortedReferenceMetadata::Contigs binContigs = reference::mergeContigs(sortedReferenceMetadataList_);
+    alignment::matchSelector::BinIndexMap binIndexMap(binContigs, TRACKING_BIN_LENGTH);
 
     ISAAC_TRACE_STAT("AlignWorkflow::selectMatches ")
     ISAAC_THREAD_CERR << "Selecting matches using " << binIndexMap << std::endl;
 
     alignment::matchSelector::BinningFragmentStorage fragmentStorage(
-        tempDirectory_, keepUnaligned_, binIndexMap, sortedReferenceMetadataList_.front().getContigs(),
+        tempDirectory_, keepUnaligned_, binIndexMap, binContigs,
         barcodeMetadataList_, preAllocateBins_, targetBinSize_, targetBinLength_,
-        coresMax_, binMetadataList);
+        coresMax_, checkpointBinMetadataList, binMetadataList);
 
 #ifdef ISAAC_DEV_STATS_ENABLED
         alignment::matchSelector::DebugStorage debugStorage(
-            contigLists_.node0Container().front(),
+            contigLists_.node0Container(),
             alignmentCfg_, flowcellLayoutList_, demultiplexingStatsXmlPath_.parent_path(), barcodeMetadataList_,
             coresMax_, fragmentStorage);
-        alignFlowcells(referenceHash, barcodeTemplateLengthStatistics, demultiplexingStats, ret, debugStorage);
+        alignFlowcells(referenceMatchFinders, binMetadataList, barcodeTemplateLengthStatistics, demultiplexingStats, ret, debugStorage);
         debugStorage.close();
 #else
-        alignFlowcells(referenceHash, barcodeTemplateLengthStatistics, demultiplexingStats, ret, fragmentStorage);
+        alignFlowcells(referenceMatchFinders, binMetadataList, barcodeTemplateLengthStatistics, demultiplexingStats, ret, fragmentStorage);
         fragmentStorage.close();
 #endif
 
@@ -779,29 +978,77 @@ void FindHashMatchesTransition::align(
     FoundMatchesMetadata &foundMatches,
     alignment::BinMetadataList &binMetadataList,
     std::vector<alignment::TemplateLengthStatistics> &barcodeTemplateLengthStatistics,
-    const boost::filesystem::path &matchSelectorStatsXmlPath)
+    const boost::filesystem::path &matchSelectorStatsXmlPath,
+    std::vector<alignment::matchSelector::MatchSelectorStats> &matchSelectorStats,
+    demultiplexing::DemultiplexingStats &demultiplexingStats)
 {
-//    typedef reference::ReferenceHash<KmerT, common::NumaAllocator<void, 0> > ReferenceHash;
-//    typedef reference::NumaReferenceHash<ReferenceHash> NumaReferenceHash;
-//    const NumaReferenceHash referenceHash(buildReferenceHash<ReferenceHash>(contigLists_.node0Container().front(), threads_, coresMax_));
-
     typedef reference::ReferenceHash<KmerT, common::NumaAllocator<void, common::numa::defaultNodeInterleave> > ReferenceHash;
-    const ReferenceHash referenceHash(buildReferenceHash<ReferenceHash>(
-        contigLists_.node0Container().front(), hashTableBucketCount_, threads_, coresMax_));
+    typedef reference::NumaReferenceHash<ReferenceHash> NumaReferenceHash;
+    typedef alignment::ClusterHashMatchFinder<NumaReferenceHash, SEEDS_PER_MATCH_MAX> MatchFinder;
+
+    demultiplexing::DemultiplexingStats laneDemultiplexingStats(flowcellLayoutList_, barcodeMetadataList_);
+    alignment::BinMetadataList checkpointBinMetadataList;
+    chunk_ = 0;
+    if (resumeAlignment_)
+    {
+        alignProgress_.load(checkpointBinMetadataList, barcodeTemplateLengthStatistics, laneDemultiplexingStats);
+    }
+    else
+    {
+        // stale records must not be mixed with the ones of this run
+        alignProgress_.clear();
+    }
+
+    // hash only the references that some barcode maps to. All of them stay in memory for the single pass
+    std::vector<unsigned> hashedReferences;
+    boost::ptr_vector<ReferenceHash> interleavedHashes;
+    std::vector<uint64_t> hashMemorySizes;
+    for (unsigned referenceIndex = 0; sortedReferenceMetadataList_.size() != referenceIndex; ++referenceIndex)
+    {
+        if (barcodeMetadataList_.end() == std::find_if(
+            barcodeMetadataList_.begin(), barcodeMetadataList_.end(),
+            [referenceIndex](const flowcell::BarcodeMetadata &barcode)
+            {return !barcode.isUnmappedReference() && referenceIndex == barcode.getReferenceIndex();}))
+        {
+            continue;
+        }
+        ISAAC_THREAD_CERR << "Hashing reference " << referenceIndex << std::endl;
+        interleavedHashes.push_back(new ReferenceHash(buildReferenceHash<ReferenceHash>(
+            contigLists_.node0Container().at(referenceIndex), hashTableBucketCount_, seedExtensionRepeats_, seedMismatches_, threads_, coresMax_)));
+        hashMemorySizes.push_back(interleavedHashes.back().getMemorySize());
+        hashedReferences.push_back(referenceIndex);
+    }
+
+    // compute threads are bound to their NUMA nodes by threads_, so findMatches only touches the node-local replica
+    const bool replicate = canReplicateReferenceHash(availableMemory_, hashMemorySizes, common::getNumaNodeCount());
+    boost::ptr_vector<NumaReferenceHash> referenceHashes;
+    boost::ptr_vector<MatchFinder> matchFinders;
+    std::vector<const MatchFinder *> referenceMatchFinders(sortedReferenceMetadataList_.size(), 0);
+    for (std::size_t i = 0; hashedReferences.size() != i; ++i)
+    {
+        referenceHashes.push_back(new NumaReferenceHash(std::move(interleavedHashes[i]), replicate));
+        matchFinders.push_back(new MatchFinder(
+            referenceHashes.back(), candidateMatchesMax_, seedBaseQualityMin_, matchFinderMaxRepeats_));
+        referenceMatchFinders.at(hashedReferences[i]) = &matchFinders.back();
+    }
+    interleavedHashes.clear();
+    ISAAC_THREAD_CERR << hashedReferences.size() << " reference hashes " << (replicate ? "replicated on " : "interleaved over ") <<
+        common::getNumaNodeCount() << " NUMA nodes" << std::endl;
 
     FoundMatchesMetadata ret(tempDirectory_, barcodeMetadataList_, 1, sortedReferenceMetadataList_);
-    demultiplexing::DemultiplexingStats demultiplexingStats(flowcellLayoutList_, barcodeMetadataList_);
 
     alignFlowcells(
-        referenceHash, binMetadataList,
-        barcodeTemplateLengthStatistics, demultiplexingStats, ret);
+        referenceMatchFinders, checkpointBinMetadataList, binMetadataList,
+        barcodeTemplateLengthStatistics, laneDemultiplexingStats, ret);
 
-    dumpStats(demultiplexingStats, ret.tileMetadataList_);
+    dumpStats(laneDemultiplexingStats, ret.tileMetadataList_);
     foundMatches.swap(ret);
+    demultiplexingStats.swap(laneDemultiplexingStats);
 
     matchSelector_.unreserve();
 
     matchSelector_.dumpStats(matchSelectorStatsXmlPath);
+    matchSelector_.releaseStats(matchSelectorStats);
 }
 
 void FindHashMatchesTransition::dumpStats(
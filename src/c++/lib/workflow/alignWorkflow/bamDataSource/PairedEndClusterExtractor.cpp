@@ -17,6 +17,8 @@
  ** \author Roman Petrovski
  **/
 
+#include <fstream>
+
 #include <boost/foreach.hpp>
 #include <boost/format.hpp>
 #include <boost/integer/static_min_max.hpp>
@@ -78,6 +80,62 @@ void TempFileClusterExtractor::open(const boost::filesystem::path &tempFilePath,
     tempFilePath_ = tempFilePath.c_str();
 }
 
+void UnpairedReadsCache::writeRecord(const unsigned partition, const char *record)
+{
+    std::ostream os(tempFiles_[partition].get());
+    const unsigned recordLength = PendingMatesTable::getRecordLength(record);
+    if (!os.write(record, recordLength))
+    {
+        BOOST_THROW_EXCEPTION(isaac::common::IoException(
+            errno, (boost::format("Failed to write: %d bytes into %s") % recordLength % common::pathStringToStdString(tempFilePaths_[partition])).str()));
+    }
+    tempFileSizes_[partition] += recordLength;
+}
+
+/**
+ * \brief moves all pending reads of the partition into its temporary file. All subsequent reads of
+ *        the partition will go straight into the file.
+ */
+void UnpairedReadsCache::spillPartition(const unsigned partition)
+{
+    ISAAC_THREAD_CERR << "Spilling pending reads partition " << partition << std::endl;
+    spilledPartitions_[partition] = true;
+    std::size_t spilled = 0;
+    pendingMates_.removePartition(
+        partition,
+        [this](const char *record){return getNameCrc<7>(crcWidth_, PendingMatesTable::getName(record), maxReadNameLength_);},
+        [this, partition, &spilled](const char *record){writeRecord(partition, record); ++spilled;});
+    ISAAC_THREAD_CERR << "Spilling partition " << partition << " done, " << spilled << " reads spilled, " <<
+        pendingMates_.size() << " reads remain pending" << std::endl;
+}
+
+/**
+ * \brief appends the cluster made of two mates to the matedClusters_
+ */
+void UnpairedReadsCache::storeMated(
+    const char *pendingRecord,
+    const char *record)
+{
+    const bool pendingIsReadOne = PendingMatesTable::getFlags(pendingRecord) & TempFileClusterExtractor::READ_ONE_FLAG;
+    ISAAC_ASSERT_MSG(pendingIsReadOne != bool(PendingMatesTable::getFlags(record) & TempFileClusterExtractor::READ_ONE_FLAG),
+                     "Out of two reads, one was expected to be read 1 and another read 2 " <<
+                     std::string(PendingMatesTable::getName(record), maxReadNameLength_));
+    const char *r1Record = pendingIsReadOne ? pendingRecord : record;
+    const char *r2Record = pendingIsReadOne ? record : pendingRecord;
+
+    matedClusters_.insert(matedClusters_.end(), pendingMates_.getBcl(r1Record), pendingMates_.getBclEnd(r1Record));
+    matedClusters_.insert(matedClusters_.end(), pendingMates_.getBcl(r2Record), pendingMates_.getBclEnd(r2Record));
+    matedClusters_.insert(matedClusters_.end(), PendingMatesTable::getName(r1Record), PendingMatesTable::getName(r1Record) + maxReadNameLength_);
+    //Although it should match, some datasets have it set differently for each read.
+    matedPf_.push_back(
+        (PendingMatesTable::getFlags(r1Record) & TempFileClusterExtractor::PASS_FILTER_FLAG) &&
+        (PendingMatesTable::getFlags(r2Record) & TempFileClusterExtractor::PASS_FILTER_FLAG));
+}
+
+/**
+ * \brief Pairs reads with their mates stored earlier. The ones that don't have mates yet are kept in memory
+ *        as long as pendingMates_ has room. Otherwise they go into the temporary files partitioned by name crc.
+ */
 template <typename IteratorT>
 void UnpairedReadsCache::storeUnpaired(
     IteratorT unpairedBegin,
@@ -88,54 +146,82 @@ void UnpairedReadsCache::storeUnpaired(
 //        ISAAC_ASSERT_MSG(false, "Unpaired resolution is not supported with ISAAC_DEV_STATS_ENABLED");
     return;
 #endif// ISAAC_DEV_STATS_ENABLED
-    common::StaticVector<char, 10240> byteBuff;
+    static const std::size_t NAME_OFFSET = sizeof(unsigned) + sizeof(TempFileClusterExtractor::FlagsType);
+    common::StaticVector<char, 10240> record;
     BOOST_FOREACH(const IndexRecord &idx, std::make_pair(unpairedBegin, unpairedEnd))
     {
         const flowcell::ReadMetadata &readMetadata = readMetadataList.at(!idx.getBlock().isReadOne());
 
         const bam::BamBlockHeader &block = idx.getBlock();
 
-        byteBuff.clear();
-        extractReadName(block, maxReadNameLength_, readMetadata, std::back_inserter(byteBuff));
-        ISAAC_ASSERT_MSG(byteBuff.size() == maxReadNameLength_, "Invalid number of name bytes extracted");
-        byteBuff.push_back(0);// 0 terminator is needed for name comparison during extraction
-        const unsigned nameCrc = getNameCrc<7>(crcWidth_, byteBuff.begin(), maxReadNameLength_);
-        std::ostream os(tempFiles_[nameCrc].get());
+        record.resize(NAME_OFFSET);
+        extractReadName(block, maxReadNameLength_, readMetadata, std::back_inserter(record));
+        ISAAC_ASSERT_MSG(record.size() == NAME_OFFSET + maxReadNameLength_, "Invalid number of name bytes extracted");
+        record.push_back(0);// 0 terminator is needed for name comparison during extraction
+        const std::size_t bclOffset = record.size();
+        record.resize(bclOffset + readMetadata.getLength());
+        bam::extractBcl(block, record.begin() + bclOffset, readMetadata);
 
-        const TempFileClusterExtractor::FlagsType flags =
+        reinterpret_cast<unsigned&>(record.front()) = record.size();
+        reinterpret_cast<TempFileClusterExtractor::FlagsType&>(record[sizeof(unsigned)]) =
             (block.isReadOne() ? TempFileClusterExtractor::READ_ONE_FLAG : 0) |
-                (block.isPf() ? TempFileClusterExtractor::PASS_FILTER_FLAG : 0) ;
-        const unsigned recordLength = sizeof(recordLength) + sizeof(flags) + byteBuff.size() + readMetadata.getLength();
-        if (!os.write(reinterpret_cast<const char*>(&recordLength), sizeof(unsigned)))
-        {
-            BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(unsigned) % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
-        }
-        tempFileSizes_[nameCrc] += sizeof(unsigned);
+                (block.isPf() ? TempFileClusterExtractor::PASS_FILTER_FLAG : 0);
 
-        if (!os.write(reinterpret_cast<const char*>(&flags), sizeof(flags)))
-        {
-            BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % sizeof(flags) % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
-        }
-        tempFileSizes_[nameCrc] += sizeof(flags);
+        storeRecord(record.begin());
+    }
+}
+
+/**
+ * \brief Pairs the record with its mate stored earlier or keeps it until the mate arrives.
+ */
+void UnpairedReadsCache::storeRecord(const char *record)
+{
+    const char *name = PendingMatesTable::getName(record);
+    const unsigned nameCrc = getNameCrc<7>(crcWidth_, name, maxReadNameLength_);
+    if (spilledPartitions_[nameCrc])
+    {
+        writeRecord(nameCrc, record);
+        return;
+    }
 
-        if (!os.write(byteBuff.begin(), byteBuff.size()))
+    const PendingMatesTable::NameHashType nameHash = PendingMatesTable::hashName(name, maxReadNameLength_);
+    const std::size_t slot = pendingMates_.find(nameHash, name);
+    if (PendingMatesTable::NOT_FOUND != slot)
+    {
+        storeMated(pendingMates_.getRecord(slot), record);
+        pendingMates_.erase(slot, nameCrc);
+    }
+    else
+    {
+        while (!pendingMates_.insert(nameHash, nameCrc, record))
         {
-            BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+            const unsigned largest = pendingMates_.empty() ? nameCrc : pendingMates_.getLargestPartition();
+            spillPartition(largest);
+            if (largest == nameCrc)
+            {
+                writeRecord(nameCrc, record);
+                break;
+            }
         }
-        tempFileSizes_[nameCrc] += byteBuff.size();
-
-        byteBuff.resize(readMetadata.getLength());
-        bam::extractBcl(idx.getBlock(), byteBuff.begin(), readMetadata);
+    }
+}
 
-        if (!os.write(&byteBuff.front(), byteBuff.size()))
+/**
+ * \brief Reads back the records spilled into the temporary file of the partition
+ */
+void UnpairedReadsCache::readSpilled(const unsigned partition, std::vector<char> &buffer)
+{
+    tempFiles_[partition].flush();
+    buffer.resize(tempFileSizes_[partition]);
+    if (!buffer.empty())
+    {
+        std::ifstream is(tempFilePaths_[partition].c_str(), std::ios_base::binary);
+        if (!is.read(&buffer.front(), buffer.size()))
         {
             BOOST_THROW_EXCEPTION(isaac::common::IoException(
-                errno, (boost::format("Failed to write: %d bytes into %s") % byteBuff.size() % common::pathStringToStdString(tempFilePaths_[nameCrc])).str()));
+                errno, (boost::format("Unable to read %d bytes from %s") % buffer.size() %
+                    common::pathStringToStdString(tempFilePaths_[partition])).str()));
         }
-        tempFileSizes_[nameCrc] += byteBuff.size();
     }
 }
 
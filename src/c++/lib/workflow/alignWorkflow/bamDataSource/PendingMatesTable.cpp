@@ -0,0 +1,193 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file PendingMatesTable.cpp
+ **
+ ** Bounded-memory store of bam reads waiting for their mates.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include "workflow/alignWorkflow/bamDataSource/PendingMatesTable.hh"
+
+namespace isaac
+{
+namespace workflow
+{
+namespace alignWorkflow
+{
+namespace bamDataSource
+{
+
+static std::size_t getSlotCount(const std::size_t memoryBudget, const std::size_t slotSize)
+{
+    // quarter of the budget goes to slots, the rest to the record storage
+    std::size_t ret = 1024;
+    while (ret * 2 * slotSize <= memoryBudget / 4)
+    {
+        ret *= 2;
+    }
+    return ret;
+}
+
+PendingMatesTable::PendingMatesTable(
+    const std::size_t memoryBudget,
+    const std::size_t partitionCount,
+    const std::size_t nameLength,
+    const std::size_t minRecordLength) :
+        nameLength_(nameLength),
+        slots_(getSlotCount(memoryBudget, sizeof(Slot))),
+        usedSlots_(0),
+        liveRecords_(0),
+        deadBytes_(0),
+        partitionBytes_(partitionCount, 0)
+{
+    // never let the arena be too small to hold a reasonable number of records
+    arena_.reserve(std::max(memoryBudget - std::min(memoryBudget, slots_.size() * sizeof(Slot)), minRecordLength * 1024));
+    ISAAC_THREAD_CERR << "PendingMatesTable: " << slots_.size() << " slots, " << arena_.capacity() << " bytes of record storage" << std::endl;
+}
+
+std::size_t PendingMatesTable::find(const NameHashType nameHash, const char *name) const
+{
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t slot = nameHash & mask; Slot::EMPTY != slots_[slot].offset_; slot = (slot + 1) & mask)
+    {
+        const Slot &s = slots_[slot];
+        if (s.isLive() && nameHash == s.nameHash_ && namesMatch(&arena_[s.offset_], name))
+        {
+            return slot;
+        }
+    }
+    return NOT_FOUND;
+}
+
+std::size_t PendingMatesTable::findFreeSlot(const NameHashType nameHash) const
+{
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t slot = nameHash & mask;
+    while (slots_[slot].isLive())
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void PendingMatesTable::erase(const std::size_t slot, const std::size_t partition)
+{
+    Slot &s = slots_[slot];
+    ISAAC_ASSERT_MSG(s.isLive(), "Attempt to erase a free slot " << slot);
+    char *record = &arena_[s.offset_];
+    const unsigned recordLength = getRecordLength(record);
+    *reinterpret_cast<FlagsType*>(record + sizeof(unsigned)) |= DEAD_FLAG;
+    deadBytes_ += recordLength;
+    partitionBytes_.at(partition) -= recordLength;
+    s.offset_ = Slot::ERASED;
+    --liveRecords_;
+}
+
+bool PendingMatesTable::insert(const NameHashType nameHash, const std::size_t partition, const char *record)
+{
+    const unsigned recordLength = getRecordLength(record);
+    // keep load factor below 1/2 to keep the probe sequences short
+    if (liveRecords_ >= slots_.size() / 2)
+    {
+        return false;
+    }
+
+    if (arena_.capacity() - arena_.size() < recordLength)
+    {
+        if (deadBytes_ < recordLength)
+        {
+            return false;
+        }
+        compact();
+    }
+    else if (usedSlots_ >= slots_.size() / 4 * 3)
+    {
+        // too many erased slots make the probe sequences long
+        rehash();
+    }
+
+    const std::size_t slot = findFreeSlot(nameHash);
+    if (Slot::EMPTY == slots_[slot].offset_)
+    {
+        ++usedSlots_;
+    }
+    slots_[slot].nameHash_ = nameHash;
+    slots_[slot].offset_ = arena_.size();
+    arena_.insert(arena_.end(), record, record + recordLength);
+    partitionBytes_.at(partition) += recordLength;
+    ++liveRecords_;
+    return true;
+}
+
+std::size_t PendingMatesTable::getLargestPartition() const
+{
+    return std::distance(partitionBytes_.begin(), std::max_element(partitionBytes_.begin(), partitionBytes_.end()));
+}
+
+/**
+ * \brief moves live records to the beginning of the arena preserving their order and rebuilds the slots
+ */
+void PendingMatesTable::compact()
+{
+    std::vector<char>::iterator to = arena_.begin();
+    for (std::vector<char>::iterator from = arena_.begin(); arena_.end() != from;)
+    {
+        const unsigned recordLength = getRecordLength(&*from);
+        if (!(getFlags(&*from) & DEAD_FLAG))
+        {
+            if (to != from)
+            {
+                std::copy(from, from + recordLength, to);
+            }
+            to += recordLength;
+        }
+        from += recordLength;
+    }
+    arena_.erase(to, arena_.end());
+    deadBytes_ = 0;
+    rehash();
+}
+
+void PendingMatesTable::rehash()
+{
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    usedSlots_ = 0;
+    for (std::vector<char>::const_iterator it = arena_.begin(); arena_.end() != it; it += getRecordLength(&*it))
+    {
+        if (!(getFlags(&*it) & DEAD_FLAG))
+        {
+            const NameHashType nameHash = hashName(getName(&*it), nameLength_);
+            const std::size_t slot = findFreeSlot(nameHash);
+            slots_[slot].nameHash_ = nameHash;
+            slots_[slot].offset_ = std::distance<std::vector<char>::const_iterator>(arena_.begin(), it);
+            ++usedSlots_;
+        }
+    }
+    ISAAC_ASSERT_MSG(usedSlots_ == liveRecords_, "Live record count mismatch " << usedSlots_ << " " << liveRecords_);
+}
+
+void PendingMatesTable::clear()
+{
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    usedSlots_ = 0;
+    liveRecords_ = 0;
+    arena_.clear();
+    deadBytes_ = 0;
+    std::fill(partitionBytes_.begin(), partitionBytes_.end(), 0);
+}
+
+} // namespace bamDataSource
+} // namespace alignWorkflow
+} // namespace workflow
+} // namespace isaac
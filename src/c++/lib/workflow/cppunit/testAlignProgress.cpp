@@ -0,0 +1,126 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <string>
+
+#include <boost/assign.hpp>
+
+#include "RegistryName.hh"
+#include "testAlignProgress.hh"
+
+#include "workflow/alignWorkflow/AlignProgress.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestAlignProgress, registryName("AlignProgress"));
+
+using namespace isaac;
+using alignment::matchSelector::MatchSelectorStats;
+using alignment::TemplateLengthStatistics;
+
+void TestAlignProgress::setUp()
+{
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory_);
+}
+
+void TestAlignProgress::tearDown()
+{
+    boost::filesystem::remove_all(directory_);
+}
+
+void TestAlignProgress::testRoundTrip()
+{
+    const flowcell::ReadMetadataList reads = boost::assign::list_of
+        (flowcell::ReadMetadata(1, 5, 0, 0))
+        (flowcell::ReadMetadata(6, 10, 1, 5));
+    const flowcell::FlowcellLayoutList flowcellLayoutList;
+
+    flowcell::BarcodeMetadataList barcodes;
+    barcodes.push_back(flowcell::BarcodeMetadata::constructUnknownBarcode(
+        "FC1", 0, 1, 0, flowcell::SequencingAdapterMetadataList()));
+    barcodes.back().setIndex(0);
+    barcodes.push_back(flowcell::BarcodeMetadata("FC1", 0, 1, 0, false, flowcell::SequencingAdapterMetadataList()));
+    barcodes.back().setIndex(1);
+
+    flowcell::TileMetadataList tiles;
+    flowcell::TileMetadataList chunk0Tiles;
+    flowcell::TileMetadataList chunk1Tiles;
+    for (unsigned i = 0; 3 != i; ++i)
+    {
+        tiles.push_back(flowcell::TileMetadata("FC1", 0, 1101 + i, 1, 1000, i));
+        (2 > i ? chunk0Tiles : chunk1Tiles).push_back(tiles.back());
+    }
+
+    std::vector<MatchSelectorStats> tileStats(tiles.size(), MatchSelectorStats(true, barcodes));
+    for (const flowcell::TileMetadata &tile : tiles)
+    {
+        tileStats.at(tile.getIndex()).getReadTileStat(reads.at(1), true).fragmentCount_ = 100 + tile.getIndex();
+    }
+
+    const reference::ReferencePosition binStart(0, 0);
+    alignment::BinMetadataList bins;
+    bins.push_back(alignment::BinMetadata(
+        barcodes.size(), 0, reference::ReferencePosition(reference::ReferencePosition::TooManyMatch), 0, directory_ / "bin-0.dat"));
+    bins.push_back(alignment::BinMetadata(barcodes.size(), 1, binStart, 1000, directory_ / "bin-1.dat"));
+    bins.at(1).incrementDataSize(binStart, 10);
+
+    std::vector<TemplateLengthStatistics> tls(barcodes.size());
+    demultiplexing::DemultiplexingStats demultiplexingStats(flowcellLayoutList, barcodes);
+
+    {
+        workflow::alignWorkflow::AlignProgress progress(directory_, true, barcodes);
+        progress.clear();
+        progress.save(chunk0Tiles, tileStats, bins, tls, demultiplexingStats);
+
+        // the state recorded with the last chunk is the one that gets restored
+        bins.at(1).incrementDataSize(binStart, 20);
+        tls.at(1) = TemplateLengthStatistics(100, 500, 300, 30, 40, TemplateLengthStatistics::FRp, TemplateLengthStatistics::RFm, -1, true);
+        demultiplexingStats.recordUnknownBarcode(1, 0);
+        progress.save(chunk1Tiles, tileStats, bins, tls, demultiplexingStats);
+    }
+
+    // a run interrupted during the save leaves the temporary file only
+    {
+        std::ofstream os((directory_ / "AlignProgress-000002.txt.tmp").c_str());
+        os << "truncated";
+    }
+
+    workflow::alignWorkflow::AlignProgress progress(directory_, true, barcodes);
+    alignment::BinMetadataList loadedBins;
+    std::vector<TemplateLengthStatistics> loadedTls;
+    demultiplexing::DemultiplexingStats loadedDemultiplexingStats(flowcellLayoutList, barcodes);
+    progress.load(loadedBins, loadedTls, loadedDemultiplexingStats);
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), progress.getLoadedChunkCount());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), progress.getChunkTiles(0).size());
+    CPPUNIT_ASSERT_EQUAL(1102U, progress.getChunkTiles(0).at(1).getTile());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), progress.getChunkTiles(1).size());
+    CPPUNIT_ASSERT_EQUAL(1103U, progress.getChunkTiles(1).at(0).getTile());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), progress.getChunkTileStats(0).size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(101), progress.getChunkTileStats(0).at(1).getReadTileStat(reads.at(1), true).fragmentCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(102), progress.getChunkTileStats(1).at(0).getReadTileStat(reads.at(1), true).fragmentCount_);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), progress.getChunkTileStats(1).at(0).getReadTileStat(reads.at(0), true).fragmentCount_);
+
+    CPPUNIT_ASSERT_EQUAL(bins.size(), loadedBins.size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(30), loadedBins.at(1).getDataSize());
+    CPPUNIT_ASSERT_EQUAL(bins.at(1).getPath(), loadedBins.at(1).getPath());
+    CPPUNIT_ASSERT(loadedBins.at(0).isUnalignedBin());
+    CPPUNIT_ASSERT_EQUAL(tls.size(), loadedTls.size());
+    CPPUNIT_ASSERT_EQUAL(300U, loadedTls.at(1).getMedian());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), loadedDemultiplexingStats.getLaneBarcodeStat(barcodes.at(1)).barcodeCount_);
+
+    progress.clear();
+    CPPUNIT_ASSERT(!boost::filesystem::exists(directory_ / "AlignProgress-000000.txt"));
+    progress.load(loadedBins, loadedTls, loadedDemultiplexingStats);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), progress.getLoadedChunkCount());
+}
@@ -0,0 +1,71 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/assign.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "RegistryName.hh"
+#include "testBamDataSource.hh"
+
+#include "bgzf/BgzfCompressor.hh"
+#include "workflow/alignWorkflow/BamDataSource.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestBamDataSource, registryName("BamDataSource"));
+
+void TestBamDataSource::setUp()
+{
+    directory_ = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    boost::filesystem::create_directories(directory_);
+}
+
+void TestBamDataSource::tearDown()
+{
+    boost::filesystem::remove_all(directory_);
+}
+
+void TestBamDataSource::testCorruptRegion()
+{
+    using namespace isaac;
+    // valid bgzf block header followed by a truncated body. Region loaders fail on their own threads
+    // as soon as they start decompressing
+    std::ostringstream compressed;
+    {
+        boost::iostreams::filtering_ostream bgzfStream;
+        bgzfStream.push(bgzf::BgzfCompressor(), 65535, 0);
+        bgzfStream.push(compressed);
+        bgzfStream << std::string(1000, 'x');
+        bgzfStream.strict_sync();
+    }
+    const boost::filesystem::path bamPath = directory_ / "truncated.bam";
+    {
+        std::ofstream os(bamPath.c_str(), std::ios_base::binary);
+        os << compressed.str().substr(0, 24);
+    }
+
+    const flowcell::ReadMetadataList readMetadataList =
+        boost::assign::list_of(flowcell::ReadMetadata(1, 50, 0, 0))(flowcell::ReadMetadata(51, 100, 1, 50));
+    const flowcell::Layout layout(
+        bamPath, flowcell::Layout::Bam, flowcell::BamFlowcellData(false), 1, 0, std::vector<unsigned>(),
+        readMetadataList, "truncated");
+
+    const bam::BamFileRegions regions = boost::assign::list_of
+        (bam::BamFileRegion(0, 500UL << 16))(bam::BamFileRegion(500UL << 16, bam::BamFileRegion::END_OF_FILE));
+
+    workflow::alignWorkflow::RegionBamBaseCallsSource source(
+        directory_, 64UL * 1024 * 1024, 1000, true, 2, layout, regions, 2);
+    CPPUNIT_ASSERT_THROW(source.discoverTiles(), common::IoException);
+}
@@ -0,0 +1,34 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_WORKFLOW_TEST_BAM_DATA_SOURCE_HH
+#define iSAAC_WORKFLOW_TEST_BAM_DATA_SOURCE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <boost/filesystem.hpp>
+
+class TestBamDataSource : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestBamDataSource );
+    CPPUNIT_TEST( testCorruptRegion );
+    CPPUNIT_TEST_SUITE_END();
+
+    boost::filesystem::path directory_;
+public:
+    void setUp();
+    void tearDown();
+    void testCorruptRegion();
+};
+
+#endif // #ifndef iSAAC_WORKFLOW_TEST_BAM_DATA_SOURCE_HH
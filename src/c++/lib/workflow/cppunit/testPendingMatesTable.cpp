@@ -0,0 +1,271 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "RegistryName.hh"
+#include "testPendingMatesTable.hh"
+
+#include "workflow/alignWorkflow/bamDataSource/PendingMatesTable.hh"
+
+using isaac::workflow::alignWorkflow::bamDataSource::PendingMatesTable;
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestPendingMatesTable, registryName("PendingMatesTable"));
+
+void TestPendingMatesTable::setUp()
+{
+}
+
+void TestPendingMatesTable::tearDown()
+{
+}
+
+static const std::size_t NAME_LENGTH = 8;
+// smallest table has 1024 slots of 16 bytes each
+static const std::size_t SLOTS_BYTES = 1024 * sizeof(uint64_t) * 2;
+
+static std::string makeName(const unsigned number)
+{
+    return (boost::format("r%07d") % number).str();
+}
+
+/**
+ * \brief [unsigned recordLength][unsigned char flags][name][0][bcl]
+ */
+static std::vector<char> makeRecord(const std::string &name, const std::size_t bclLength)
+{
+    const unsigned recordLength = sizeof(unsigned) + sizeof(PendingMatesTable::FlagsType) + NAME_LENGTH + 1 + bclLength;
+    std::vector<char> ret(reinterpret_cast<const char *>(&recordLength), reinterpret_cast<const char *>(&recordLength + 1));
+    ret.push_back(0);
+    ret.insert(ret.end(), name.begin(), name.end());
+    ret.push_back(0);
+    ret.resize(recordLength, name.at(NAME_LENGTH - 1));
+    return ret;
+}
+
+static const std::size_t RECORD_LENGTH = makeRecord(makeName(0), 11).size();
+
+static bool insert(PendingMatesTable &table, const unsigned number, const std::size_t partition, const std::size_t bclLength = 11)
+{
+    const std::string name = makeName(number);
+    return table.insert(
+        PendingMatesTable::hashName(name.c_str(), NAME_LENGTH), partition, &makeRecord(name, bclLength).front());
+}
+
+static std::size_t find(const PendingMatesTable &table, const unsigned number)
+{
+    const std::string name = makeName(number);
+    return table.find(PendingMatesTable::hashName(name.c_str(), NAME_LENGTH), name.c_str());
+}
+
+static std::string getName(const char *record)
+{
+    return std::string(PendingMatesTable::getName(record), NAME_LENGTH);
+}
+
+/**
+ * \return names of the records in the storage order. Records marked dead are skipped
+ */
+static std::vector<std::string> getStoredNames(const PendingMatesTable &table)
+{
+    std::vector<std::string> ret;
+    for (std::size_t offset = 0; table.getStorageEnd() != offset;
+        offset += PendingMatesTable::getRecordLength(table.getStorageRecord(offset)))
+    {
+        const char *record = table.getStorageRecord(offset);
+        if (!(PendingMatesTable::getFlags(record) & PendingMatesTable::DEAD_FLAG))
+        {
+            ret.push_back(getName(record));
+        }
+    }
+    return ret;
+}
+
+void TestPendingMatesTable::testInsertFindErase()
+{
+    PendingMatesTable table(1024 * 1024, 2, NAME_LENGTH, RECORD_LENGTH);
+    CPPUNIT_ASSERT(table.empty());
+    for (unsigned i = 0; 10 != i; ++i)
+    {
+        CPPUNIT_ASSERT(insert(table, i, i % 2));
+    }
+    CPPUNIT_ASSERT_EQUAL(10UL, table.size());
+
+    for (unsigned i = 0; 10 != i; ++i)
+    {
+        const std::size_t slot = find(table, i);
+        CPPUNIT_ASSERT(PendingMatesTable::NOT_FOUND != slot);
+        const char *record = table.getRecord(slot);
+        CPPUNIT_ASSERT_EQUAL(makeName(i), getName(record));
+        CPPUNIT_ASSERT_EQUAL(unsigned(RECORD_LENGTH), PendingMatesTable::getRecordLength(record));
+        CPPUNIT_ASSERT_EQUAL(11L, long(std::distance(table.getBcl(record), table.getBclEnd(record))));
+    }
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, find(table, 10));
+
+    table.erase(find(table, 3), 1);
+    CPPUNIT_ASSERT_EQUAL(9UL, table.size());
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, find(table, 3));
+    for (unsigned i = 0; 10 != i; ++i)
+    {
+        CPPUNIT_ASSERT(3 == i || PendingMatesTable::NOT_FOUND != find(table, i));
+    }
+    CPPUNIT_ASSERT_EQUAL(4 * RECORD_LENGTH, table.getPartitionBytes(1));
+    CPPUNIT_ASSERT_EQUAL(5 * RECORD_LENGTH, table.getPartitionBytes(0));
+
+    table.clear();
+    CPPUNIT_ASSERT(table.empty());
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, find(table, 0));
+    CPPUNIT_ASSERT_EQUAL(0UL, table.getPartitionBytes(0));
+}
+
+void TestPendingMatesTable::testReinsertOverErased()
+{
+    PendingMatesTable table(1024 * 1024, 1, NAME_LENGTH, RECORD_LENGTH);
+    // same hash for all three names forces them into one probe sequence
+    static const PendingMatesTable::NameHashType HASH = 5;
+    const std::string x = makeName(1), y = makeName(2), z = makeName(3);
+    CPPUNIT_ASSERT(table.insert(HASH, 0, &makeRecord(x, 11).front()));
+    CPPUNIT_ASSERT(table.insert(HASH, 0, &makeRecord(y, 11).front()));
+    const std::size_t xSlot = table.find(HASH, x.c_str());
+    const std::size_t ySlot = table.find(HASH, y.c_str());
+    CPPUNIT_ASSERT_EQUAL(HASH, xSlot);
+    CPPUNIT_ASSERT_EQUAL(HASH + 1, ySlot);
+
+    // y is found past the erased slot
+    table.erase(xSlot, 0);
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, table.find(HASH, x.c_str()));
+    CPPUNIT_ASSERT_EQUAL(ySlot, table.find(HASH, y.c_str()));
+
+    // erased slot gets reused, y stays where it was
+    CPPUNIT_ASSERT(table.insert(HASH, 0, &makeRecord(z, 11).front()));
+    CPPUNIT_ASSERT_EQUAL(xSlot, table.find(HASH, z.c_str()));
+    CPPUNIT_ASSERT_EQUAL(ySlot, table.find(HASH, y.c_str()));
+
+    CPPUNIT_ASSERT(table.insert(HASH, 0, &makeRecord(x, 11).front()));
+    CPPUNIT_ASSERT_EQUAL(HASH + 2, table.find(HASH, x.c_str()));
+    CPPUNIT_ASSERT_EQUAL(3UL, table.size());
+    CPPUNIT_ASSERT_EQUAL(3 * RECORD_LENGTH, table.getPartitionBytes(0));
+}
+
+void TestPendingMatesTable::testCompact()
+{
+    // storage for exactly 40 records
+    PendingMatesTable table(SLOTS_BYTES + RECORD_LENGTH * 40, 1, NAME_LENGTH, 0);
+    for (unsigned i = 0; 40 != i; ++i)
+    {
+        CPPUNIT_ASSERT(insert(table, i, 0));
+    }
+    CPPUNIT_ASSERT(!insert(table, 40, 0));
+
+    std::vector<std::string> expected;
+    for (unsigned i = 0; 40 != i; ++i)
+    {
+        if (i % 10)
+        {
+            expected.push_back(makeName(i));
+        }
+        else
+        {
+            table.erase(find(table, i), 0);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(40 * RECORD_LENGTH, table.getStorageEnd());
+
+    // no room at the end of the storage, the dead records get squeezed out
+    CPPUNIT_ASSERT(insert(table, 40, 0));
+    expected.push_back(makeName(40));
+    CPPUNIT_ASSERT_EQUAL(37 * RECORD_LENGTH, table.getStorageEnd());
+
+    const std::vector<std::string> stored = getStoredNames(table);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), stored.size());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), stored.begin()));
+    for (unsigned i = 0; 41 != i; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(bool(i % 10) || 40 == i, PendingMatesTable::NOT_FOUND != find(table, i));
+    }
+    CPPUNIT_ASSERT_EQUAL(37UL, table.size());
+    CPPUNIT_ASSERT_EQUAL(37 * RECORD_LENGTH, table.getPartitionBytes(0));
+}
+
+void TestPendingMatesTable::testRemovePartition()
+{
+    PendingMatesTable table(1024 * 1024, 3, NAME_LENGTH, RECORD_LENGTH);
+    // partition 1 records are longer, so it takes the most space even with the fewest records
+    for (unsigned i = 0; 30 != i; ++i)
+    {
+        const std::size_t partition = i % 3;
+        if (1 == partition && i % 2)
+        {
+            continue;
+        }
+        CPPUNIT_ASSERT(insert(table, i, partition, 1 == partition ? 100 : 11));
+    }
+    const std::size_t longRecordLength = makeRecord(makeName(0), 100).size();
+    CPPUNIT_ASSERT_EQUAL(5 * longRecordLength, table.getPartitionBytes(1));
+    CPPUNIT_ASSERT_EQUAL(10 * RECORD_LENGTH, table.getPartitionBytes(0));
+    CPPUNIT_ASSERT_EQUAL(1UL, table.getLargestPartition());
+
+    table.erase(find(table, 4), 1);
+    CPPUNIT_ASSERT_EQUAL(4 * longRecordLength, table.getPartitionBytes(1));
+
+    std::vector<std::string> removed;
+    table.removePartition(
+        1,
+        [](const char *record){return boost::lexical_cast<unsigned>(getName(record).substr(1)) % 3;},
+        [&removed](const char *record){removed.push_back(getName(record));});
+
+    std::sort(removed.begin(), removed.end());
+    const std::vector<std::string> expected = {makeName(10), makeName(16), makeName(22), makeName(28)};
+    CPPUNIT_ASSERT_EQUAL(expected.size(), removed.size());
+    CPPUNIT_ASSERT(std::equal(expected.begin(), expected.end(), removed.begin()));
+
+    CPPUNIT_ASSERT_EQUAL(0UL, table.getPartitionBytes(1));
+    CPPUNIT_ASSERT_EQUAL(10 * RECORD_LENGTH, table.getPartitionBytes(0));
+    CPPUNIT_ASSERT_EQUAL(10 * RECORD_LENGTH, table.getPartitionBytes(2));
+    CPPUNIT_ASSERT_EQUAL(20UL, table.size());
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, find(table, 10));
+    CPPUNIT_ASSERT(PendingMatesTable::NOT_FOUND != find(table, 9));
+}
+
+void TestPendingMatesTable::testBudget()
+{
+    // plenty of storage, the slots run out first: the load factor is kept below 1/2
+    PendingMatesTable slotsBound(SLOTS_BYTES + RECORD_LENGTH * 1024, 1, NAME_LENGTH, 0);
+    unsigned inserted = 0;
+    while (insert(slotsBound, inserted, 0))
+    {
+        ++inserted;
+    }
+    CPPUNIT_ASSERT_EQUAL(512U, inserted);
+
+    // storage runs out and there is nothing to reclaim
+    PendingMatesTable storageBound(SLOTS_BYTES + RECORD_LENGTH * 10, 1, NAME_LENGTH, 0);
+    for (unsigned i = 0; 10 != i; ++i)
+    {
+        CPPUNIT_ASSERT(insert(storageBound, i, 0));
+    }
+    CPPUNIT_ASSERT(!insert(storageBound, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(10UL, storageBound.size());
+    CPPUNIT_ASSERT_EQUAL(PendingMatesTable::NOT_FOUND, find(storageBound, 10));
+
+    // a dead record shorter than the new one does not help either
+    storageBound.erase(find(storageBound, 0), 0);
+    CPPUNIT_ASSERT(!insert(storageBound, 10, 0, 12));
+    CPPUNIT_ASSERT(insert(storageBound, 10, 0));
+    CPPUNIT_ASSERT_EQUAL(10UL, storageBound.size());
+}
@@ -0,0 +1,38 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_WORKFLOW_TEST_PENDING_MATES_TABLE_HH
+#define iSAAC_WORKFLOW_TEST_PENDING_MATES_TABLE_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestPendingMatesTable : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestPendingMatesTable );
+    CPPUNIT_TEST( testInsertFindErase );
+    CPPUNIT_TEST( testReinsertOverErased );
+    CPPUNIT_TEST( testCompact );
+    CPPUNIT_TEST( testRemovePartition );
+    CPPUNIT_TEST( testBudget );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void tearDown();
+    void testInsertFindErase();
+    void testReinsertOverErased();
+    void testCompact();
+    void testRemovePartition();
+    void testBudget();
+};
+
+#endif // #ifndef iSAAC_WORKFLOW_TEST_PENDING_MATES_TABLE_HH
@@ -0,0 +1,73 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#include <vector>
+
+#include <boost/assign.hpp>
+
+#include "RegistryName.hh"
+#include "testReferenceHashReplication.hh"
+
+#include "workflow/alignWorkflow/FindHashMatchesTransition.hh"
+
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( TestReferenceHashReplication, registryName("ReferenceHashReplication"));
+
+using isaac::workflow::alignWorkflow::FindHashMatchesTransition;
+
+void TestReferenceHashReplication::setUp()
+{
+}
+
+void TestReferenceHashReplication::tearDown()
+{
+}
+
+void TestReferenceHashReplication::testPeak()
+{
+    const std::vector<uint64_t> one = boost::assign::list_of(100);
+    // interleaved original stays next to the replicas of both nodes
+    CPPUNIT_ASSERT_EQUAL(uint64_t(300), FindHashMatchesTransition::getReferenceHashReplicationPeak(one, 2));
+
+    const std::vector<uint64_t> two = boost::assign::list_of(100)(50);
+    // first: 150 interleaved + 200 replicas. second: 200 replicas + 50 interleaved + 100 replicas
+    CPPUNIT_ASSERT_EQUAL(uint64_t(350), FindHashMatchesTransition::getReferenceHashReplicationPeak(two, 2));
+    // first: 150 interleaved + 400 replicas. second: 400 replicas + 50 interleaved + 200 replicas
+    CPPUNIT_ASSERT_EQUAL(uint64_t(650), FindHashMatchesTransition::getReferenceHashReplicationPeak(two, 4));
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), FindHashMatchesTransition::getReferenceHashReplicationPeak(std::vector<uint64_t>(), 2));
+}
+
+void TestReferenceHashReplication::testFit()
+{
+    const std::vector<uint64_t> one = boost::assign::list_of(100);
+    CPPUNIT_ASSERT(FindHashMatchesTransition::canReplicateReferenceHash(300, one, 2));
+    // 2x the hash holds the replicas but not the interleaved original during the replication
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(299, one, 2));
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(200, one, 2));
+
+    const std::vector<uint64_t> two = boost::assign::list_of(100)(50);
+    CPPUNIT_ASSERT(FindHashMatchesTransition::canReplicateReferenceHash(700, two, 4));
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(649, two, 4));
+
+    const std::vector<uint64_t> big = boost::assign::list_of(1000);
+    // the peak of 9000 fits but the 8000 of replicas leave no room for the tiles in flight
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(9000, big, 8));
+    CPPUNIT_ASSERT(FindHashMatchesTransition::canReplicateReferenceHash(9143, big, 8));
+}
+
+void TestReferenceHashReplication::testSingleNode()
+{
+    const std::vector<uint64_t> one = boost::assign::list_of(100);
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(1000000, one, 1));
+    CPPUNIT_ASSERT(!FindHashMatchesTransition::canReplicateReferenceHash(1000000, one, 0));
+}
@@ -0,0 +1,34 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **/
+
+#ifndef iSAAC_WORKFLOW_TEST_REFERENCE_HASH_REPLICATION_HH
+#define iSAAC_WORKFLOW_TEST_REFERENCE_HASH_REPLICATION_HH
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TestReferenceHashReplication : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE( TestReferenceHashReplication );
+    CPPUNIT_TEST( testPeak );
+    CPPUNIT_TEST( testFit );
+    CPPUNIT_TEST( testSingleNode );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+    void tearDown();
+    void testPeak();
+    void testFit();
+    void testSingleNode();
+};
+
+#endif // #ifndef iSAAC_WORKFLOW_TEST_REFERENCE_HASH_REPLICATION_HH
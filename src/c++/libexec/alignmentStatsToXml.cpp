@@ -0,0 +1,57 @@
+/**
+ ** Isaac Genome Alignment Software
+ ** Copyright (c) 2010-2017 Illumina, Inc.
+ ** All rights reserved.
+ **
+ ** This software is provided under the terms and conditions of the
+ ** GNU GENERAL PUBLIC LICENSE Version 3
+ **
+ ** You should have received a copy of the GNU GENERAL PUBLIC LICENSE Version 3
+ ** along with this program. If not, see
+ ** <https://github.com/illumina/licenses/>.
+ **
+ ** \file alignmentStatsToXml.cpp
+ **
+ ** Converts the columnar binary alignment statistics into the AlignmentStats.xml format.
+ **
+ ** \author Roman Petrovski
+ **/
+
+#include <cerrno>
+#include <fstream>
+
+#include "alignment/matchSelector/MatchSelectorStatsBinary.hh"
+#include "alignment/matchSelector/MatchSelectorStatsXml.hh"
+#include "common/Exceptions.hh"
+#include "options/AlignmentStatsToXmlOptions.hh"
+
+void alignmentStatsToXml(const isaac::options::AlignmentStatsToXmlOptions &options);
+
+int main(int argc, char *argv[])
+{
+    isaac::common::run(alignmentStatsToXml, argc, argv);
+}
+
+void alignmentStatsToXml(const isaac::options::AlignmentStatsToXmlOptions &options)
+{
+    using namespace isaac;
+    std::ifstream is(options.inputFile.string().c_str(), std::ios_base::binary);
+    if (!is) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to open file for reading: " + options.inputFile.string()));
+    }
+    alignment::matchSelector::MatchSelectorStatsBinaryReader reader(is);
+    std::vector<alignment::matchSelector::MatchSelectorStats> stats;
+    reader.readAll(stats);
+
+    std::ofstream os(options.outputFile.string().c_str());
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Unable to open file for writing: " + options.outputFile.string()));
+    }
+    alignment::matchSelector::MatchSelectorStatsXml statsXml(
+        reader.getCollectCycleStats(), reader.getFlowcellLayoutList(), reader.getBarcodeMetadataList(),
+        reader.getTileMetadataList(), stats);
+    statsXml.serialize(os);
+    if (!os) {
+        BOOST_THROW_EXCEPTION(common::IoException(errno, "ERROR: Failed to write: " + options.outputFile.string()));
+    }
+}
@@ -113,33 +113,25 @@ endif (HAVE_RT)
 isaac_find_any_library(CPPUNIT "cppunit/config-auto.h" cppunit${CPPUNIT_DEBUG} "" "")
 
 if (NOT WIN32)
-# In Windows, Boost, XML and XSLT libraries have already been built and included by this stage.
+# In Windows, Boost and XML libraries have already been built and included by this stage.
 isaac_find_boost(${iSAAC_BOOST_VERSION_MIN} "${iSAAC_BOOST_COMPONENTS}")
 
 set(REINSTDIR ${CMAKE_BINARY_DIR}/bootstrap)
 
-# XML2 - bootstrap first (if necessary) so xslt can build against it 
-# XSLT and EXSLT
-if((NOT HAVE_LIBXML2) OR (NOT HAVE_LIBXSLT) OR (NOT HAVE_LIBEXSLT))
+# XML2
+if(NOT HAVE_LIBXML2)
   find_package_version(LibXml2 ${iSAAC_LIBXML2_VERSION})
-  find_package_version(LibXslt ${iSAAC_LIBXSLT_VERSION})
-  find_package_version(LibExslt ${iSAAC_LIBEXSLT_VERSION})
 
-  if((NOT LIBXML2_FOUND) OR (NOT LIBXSLT_FOUND) OR (NOT LIBEXSLT_FOUND))
+  if(NOT LIBXML2_FOUND)
     redist_package(LIBXML2 ${iSAAC_LIBXML2_VERSION} 
                    "--prefix=${REINSTDIR};--without-modules;--without-http;--without-ftp;--without-python;--without-threads;--without-schematron;--without-debug;--without-iconv;--without-lzma")
     find_library_redist(LIBXML2 ${REINSTDIR} libxml/xpath.h xml2)
-    redist_package(LIBXSLT ${iSAAC_LIBXSLT_VERSION} "--prefix=${REINSTDIR};--with-libxml-prefix=${REINSTDIR};--without-plugins;--without-crypto")
-    find_library_redist(LIBEXSLT ${REINSTDIR} libexslt/exslt.h exslt)
-    find_library_redist(LIBXSLT ${REINSTDIR} libxslt/xsltconfig.h xslt)
-  endif((NOT LIBXML2_FOUND) OR (NOT LIBXSLT_FOUND) OR (NOT LIBEXSLT_FOUND))
-endif((NOT HAVE_LIBXML2) OR (NOT HAVE_LIBXSLT) OR (NOT HAVE_LIBEXSLT))
+  endif(NOT LIBXML2_FOUND)
+endif(NOT HAVE_LIBXML2)
 
 
 include_directories(BEFORE SYSTEM ${LIBXML2_INCLUDE_DIR})
-include_directories(BEFORE SYSTEM ${LIBXSLT_INCLUDE_DIR})
-include_directories(BEFORE SYSTEM ${LIBEXSLT_INCLUDE_DIR})
-set(iSAAC_DEP_LIB ${iSAAC_DEP_LIB} "${LIBEXSLT_LIBRARIES}" "${LIBXSLT_LIBRARIES}" "${LIBXML2_LIBRARIES}")
+set(iSAAC_DEP_LIB ${iSAAC_DEP_LIB} "${LIBXML2_LIBRARIES}")
 
 set (CMAKE_CXX_FLAGS_DEBUG "${iSAAC_CXX_OPTIMIZATION_FLAGS} -ggdb -D_GLIBCXX_DEBUG=1 -pedantic" CACHE STRING "g++ flags" FORCE)
 set (CMAKE_CXX_FLAGS_RELEASE "${iSAAC_CXX_OPTIMIZATION_FLAGS} -DNDEBUG" CACHE STRING "g++ flags" FORCE)
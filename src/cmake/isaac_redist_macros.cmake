@@ -13,7 +13,7 @@
 ##
 ## file isaac_redist_macrocs.cmake 
 ##
-## Configuration file for libxml2, libxslt library search, and redist
+## Configuration file for libxml2 library search, and redist
 ##
 ## author David Kimmel
 ##